@@ -87,6 +87,10 @@ void KisAnimationRenderingBenchmark::testCacheRendering()
     doc->image()->barrierLock();
     doc->image()->unlock();
 
+    const int numFrames = doc->image()->animationInterface()->fullClipRange().duration();
+    auto fps = [numFrames] (qint64 msecs) {
+        return 1000.0 * numFrames / qMax(qint64(1), msecs);
+    };
 
     for (int numCores = 1; numCores <= QThread::idealThreadCount(); numCores++) {
         QElapsedTimer timer;
@@ -95,7 +99,8 @@ void KisAnimationRenderingBenchmark::testCacheRendering()
         const int numClones = qMax(1, numCores / 2);
         runRenderingTest(doc->image(), numCores, numClones);
 
-        qDebug() << "Cores:" << numCores << "Clones:" << numClones << "Time:" << timer.elapsed();
+        const qint64 elapsed = timer.elapsed();
+        qDebug() << "Cores:" << numCores << "Clones:" << numClones << "Time:" << elapsed << "FPS:" << fps(elapsed);
     }
 
     for (int numCores = 1; numCores <= QThread::idealThreadCount(); numCores++) {
@@ -105,7 +110,8 @@ void KisAnimationRenderingBenchmark::testCacheRendering()
         const int numClones = numCores;
         runRenderingTest(doc->image(), numCores, numClones);
 
-        qDebug() << "Cores:" << numCores << "Clones:" << numClones << "Time:" << timer.elapsed();
+        const qint64 elapsed = timer.elapsed();
+        qDebug() << "Cores:" << numCores << "Clones:" << numClones << "Time:" << elapsed << "FPS:" << fps(elapsed);
     }
 }
 
@@ -36,6 +36,8 @@
 
 #include "kis_selection.h"
 #include <kis_iterator_ng.h>
+#include <kis_gaussian_kernel.h>
+#include <QBitArray>
 
 void KisBlurBenchmark::initTestCase()
 {
@@ -87,6 +89,28 @@ void KisBlurBenchmark::benchmarkFilter()
     }
 }
 
+void KisBlurBenchmark::benchmarkGaussianRadius_data()
+{
+    QTest::addColumn<qreal>("radius");
+
+    QList<qreal> radii;
+    radii << 1 << 2 << 5 << 10 << 20 << 50 << 100 << 200 << 500 << 1000;
+
+    Q_FOREACH (qreal radius, radii) {
+        QTest::newRow(QString("r%1").arg(radius).toLatin1()) << radius;
+    }
+}
 
+void KisBlurBenchmark::benchmarkGaussianRadius()
+{
+    QFETCH(qreal, radius);
+
+    const QRect rc(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT);
+    KisPaintDeviceSP dev = new KisPaintDevice(*m_device);
+
+    QBENCHMARK_ONCE {
+        KisGaussianKernel::applyGaussian(dev, rc, radius, radius, QBitArray(), 0);
+    }
+}
 
 QTEST_MAIN(KisBlurBenchmark)
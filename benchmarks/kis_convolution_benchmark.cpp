@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <QTest>
+
+#include "kis_convolution_benchmark.h"
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_paint_device.h>
+#include <kis_iterator_ng.h>
+#include <kis_convolution_kernel.h>
+#include <kis_convolution_painter.h>
+
+static const QRect imageRect(0, 0, 2048, 2048);
+
+void KisConvolutionBenchmark::initTestCase()
+{
+    m_colorSpace = KoColorSpaceRegistry::instance()->rgb8();
+    m_device = new KisPaintDevice(m_colorSpace);
+
+    KoColor color(m_colorSpace);
+    srand(31524744);
+
+    KisSequentialIterator it(m_device, imageRect);
+    while (it.nextPixel()) {
+        color.fromQColor(QColor(rand() % 255, rand() % 255, rand() % 255));
+        memcpy(it.rawData(), color.data(), m_colorSpace->pixelSize());
+    }
+}
+
+void KisConvolutionBenchmark::cleanupTestCase()
+{
+}
+
+void KisConvolutionBenchmark::benchmarkConvolution_data()
+{
+    QTest::addColumn<int>("kernelSize");
+
+    QList<int> sizes;
+    sizes << 3 << 5 << 7 << 11 << 21 << 51 << 101 << 201 << 301 << 501;
+
+    Q_FOREACH (int size, sizes) {
+        QTest::newRow(QString("%1x%1").arg(size).toLatin1()) << size;
+    }
+}
+
+void KisConvolutionBenchmark::benchmarkConvolution()
+{
+    QFETCH(int, kernelSize);
+
+    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> matrix(kernelSize, kernelSize);
+    matrix.fill(1.0);
+    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(matrix, 0, matrix.sum());
+
+    KisPaintDeviceSP dst = new KisPaintDevice(m_colorSpace);
+
+    QBENCHMARK_ONCE {
+        KisConvolutionPainter painter(dst);
+        painter.applyMatrix(kernel, m_device, imageRect.topLeft(), imageRect.topLeft(), imageRect.size(), BORDER_REPEAT);
+    }
+}
+
+QTEST_MAIN(KisConvolutionBenchmark)
@@ -32,6 +32,8 @@
 #include "kis_floodfill_benchmark.h"
 
 #include <kis_fill_painter.h>
+#include <floodfill/kis_scanline_fill.h>
+#include <kis_pixel_selection.h>
 
 #include <KoCompositeOps.h>
 
@@ -104,6 +106,51 @@ void KisFloodFillBenchmark::benchmarkFlood()
     //out.save("fill_output.png");
 }
 
+void KisFloodFillBenchmark::benchmarkFloodSelection_data()
+{
+    QTest::addColumn<bool>("complexRegion");
+    QTest::addColumn<bool>("useParallelFill");
+
+    QTest::newRow("large-serial") << false << false;
+    QTest::newRow("large-parallel") << false << true;
+    QTest::newRow("complex-serial") << true << false;
+    QTest::newRow("complex-parallel") << true << true;
+}
+
+void KisFloodFillBenchmark::benchmarkFloodSelection()
+{
+    QFETCH(bool, complexRegion);
+    QFETCH(bool, useParallelFill);
+
+    const QRect imageRect(0, 0, 8192, 8192);
+
+    KisPaintDeviceSP device = new KisPaintDevice(m_colorSpace);
+    device->fill(imageRect, KoColor(Qt::white, m_colorSpace));
+
+    if (complexRegion) {
+        // lots of dabs of similar colors, the fill has to wind around them
+        KisPainter painter(device);
+        painter.setFillStyle(KisPainter::FillStyleForegroundColor);
+
+        srand(31524744);
+
+        for (int i = 0; i < 20000; i++) {
+            const int value = 200 + rand() % 56;
+            painter.setPaintColor(KoColor(QColor(value, value, value), m_colorSpace));
+            painter.paintEllipse(rand() % imageRect.width(), rand() % imageRect.height(),
+                                 10 + rand() % 60, 10 + rand() % 60);
+        }
+    }
+
+    QBENCHMARK_ONCE {
+        KisPixelSelectionSP pixelSelection = new KisPixelSelection();
+
+        KisScanlineFill fill(device, QPoint(1, 1), imageRect);
+        fill.setThreshold(15);
+        fill.setUseParallelFill(useParallelFill);
+        fill.fillSelection(pixelSelection);
+    }
+}
 
 void KisFloodFillBenchmark::cleanupTestCase()
 {
@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_lazybrush_benchmark.h"
+
+#include <QTest>
+#include <QImage>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_paint_device.h>
+#include <kis_painter.h>
+
+#include "lazybrush/kis_lazy_fill_tools.h"
+#include "lazybrush/kis_multiway_cut.h"
+
+/**
+ * The lineart and the scribbles are scaled up to get the size of
+ * a full comic page
+ */
+static const int lineartScale = 4;
+
+static KisPaintDeviceSP loadLineartFile(const QString &name, bool convertToAlpha)
+{
+    QImage image(QString(FILES_DATA_DIR) + QDir::separator() + name);
+    Q_ASSERT(!image.isNull());
+
+    image = image.scaled(image.size() * lineartScale, Qt::IgnoreAspectRatio,
+                         convertToAlpha ? Qt::FastTransformation : Qt::SmoothTransformation);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
+    dev->convertFromQImage(image, 0);
+
+    if (convertToAlpha) {
+        dev = KisPainter::convertToAlphaAsAlpha(dev);
+    }
+
+    return dev;
+}
+
+void KisLazyBrushBenchmark::benchmarkOneWayCut()
+{
+    KisPaintDeviceSP mainDev = loadLineartFile("lazybrush_lineart.png", false);
+    KisPaintDeviceSP aLabelDev = loadLineartFile("lazybrush_lineart_a.png", true);
+    KisPaintDeviceSP bLabelDev = loadLineartFile("lazybrush_lineart_b.png", true);
+
+    KisPaintDeviceSP filteredMainDev = KisPainter::convertToAlphaAsGray(mainDev);
+    const QRect rect = filteredMainDev->exactBounds();
+
+    KoColor color(Qt::red, mainDev->colorSpace());
+    KisPaintDeviceSP resultColoring = new KisPaintDevice(mainDev->colorSpace());
+    KisPaintDeviceSP maskDevice = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+
+    QBENCHMARK_ONCE {
+        KisLazyFillTools::cutOneWay(color, filteredMainDev,
+                                    aLabelDev, bLabelDev,
+                                    resultColoring, maskDevice, rect);
+    }
+}
+
+void KisLazyBrushBenchmark::benchmarkMultiwayCut_data()
+{
+    QTest::addColumn<int>("numKeyStrokes");
+
+    QTest::newRow("2-strokes") << 2;
+    QTest::newRow("5-strokes") << 5;
+}
+
+void KisLazyBrushBenchmark::benchmarkMultiwayCut()
+{
+    QFETCH(int, numKeyStrokes);
+
+    KisPaintDeviceSP mainDev = loadLineartFile("lazybrush_lineart.png", false);
+
+    KisPaintDeviceSP filteredMainDev = KisPainter::convertToAlphaAsGray(mainDev);
+    const QRect rect = filteredMainDev->exactBounds();
+
+    KisPaintDeviceSP resultColoring = new KisPaintDevice(mainDev->colorSpace());
+    KisMultiwayCut cut(filteredMainDev, resultColoring, rect);
+
+    const QStringList scribbles = {"a", "b", "c", "d", "e"};
+    const QList<QColor> colors = {Qt::red, Qt::green, Qt::blue, Qt::yellow, Qt::magenta};
+
+    for (int i = 0; i < numKeyStrokes; i++) {
+        cut.addKeyStroke(loadLineartFile(QString("lazybrush_lineart_%1.png").arg(scribbles[i]), true),
+                         KoColor(colors[i], mainDev->colorSpace()));
+    }
+
+    QBENCHMARK_ONCE {
+        cut.run();
+    }
+}
+
+QTEST_MAIN(KisLazyBrushBenchmark)
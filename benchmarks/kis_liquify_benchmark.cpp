@@ -0,0 +1,114 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <QTest>
+#include <QPainter>
+
+#include "kis_liquify_benchmark.h"
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_paint_device.h>
+#include <kis_liquify_transform_worker.h>
+
+/**
+ * The size of the layer being liquified. The preview is rendered at
+ * the full resolution, like at 100% zoom.
+ */
+const int imageSize = 6000;
+const int pixelPrecision = 8;
+const int numDabs = 20;
+
+static QImage createSourceImage()
+{
+    QImage image(imageSize, imageSize, QImage::Format_ARGB32);
+
+    QPainter gc(&image);
+    gc.fillRect(image.rect(), Qt::white);
+
+    for (int i = 0; i < imageSize; i += 100) {
+        gc.fillRect(QRect(i, 0, 50, imageSize), QColor(255, 0, 0, 128));
+        gc.fillRect(QRect(0, i, imageSize, 50), QColor(0, 0, 255, 128));
+    }
+
+    return image;
+}
+
+static void applyDab(KisLiquifyTransformWorker *worker, int i)
+{
+    worker->translatePoints(QPointF(1000 + 100 * i, 3000),
+                            QPointF(10, -5), 60, false, 0.5);
+}
+
+void KisLiquifyBenchmark::benchmarkFullPreview()
+{
+    const QImage image = createSourceImage();
+
+    QBENCHMARK_ONCE {
+        for (int i = 0; i < numDabs; i++) {
+            KisLiquifyTransformWorker worker(image.rect(), 0, pixelPrecision);
+            applyDab(&worker, i);
+
+            QPointF offset;
+            worker.runOnQImage(image, QPointF(), QTransform(), &offset);
+        }
+    }
+}
+
+void KisLiquifyBenchmark::benchmarkIncrementalPreview()
+{
+    const QImage image = createSourceImage();
+
+    KisLiquifyTransformWorker worker(image.rect(), 0, pixelPrecision);
+
+    QPointF offset;
+    QImage preview = worker.runOnQImage(image, QPointF(), QTransform(), &offset);
+
+    QBENCHMARK_ONCE {
+        for (int i = 0; i < numDabs; i++) {
+            applyDab(&worker, i);
+
+            // the tool releases its preview before asking for a new one
+            preview = QImage();
+            preview = worker.runOnQImage(image, QPointF(), QTransform(), &offset);
+        }
+    }
+}
+
+void KisLiquifyBenchmark::benchmarkRunOnDevice()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QImage image = createSourceImage();
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->convertFromQImage(image, 0);
+
+    KisLiquifyTransformWorker worker(image.rect(), 0, pixelPrecision);
+
+    for (int i = 0; i < numDabs; i++) {
+        applyDab(&worker, i);
+    }
+
+    QBENCHMARK_ONCE {
+        worker.run(dev);
+    }
+}
+
+QTEST_MAIN(KisLiquifyBenchmark)
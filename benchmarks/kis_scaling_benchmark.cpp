@@ -0,0 +1,99 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <QTest>
+
+#include "kis_scaling_benchmark.h"
+#include "kis_benchmark_values.h"
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_paint_device.h>
+#include <kis_iterator_ng.h>
+#include <kis_filter_strategy.h>
+#include <kis_transform_worker.h>
+
+static KisFilterStrategy* createFilterStrategy(const QString &id)
+{
+    if (id == "Bilinear") {
+        return new KisBilinearFilterStrategy();
+    } else if (id == "Bicubic") {
+        return new KisBicubicFilterStrategy();
+    } else if (id == "Lanczos3") {
+        return new KisLanczos3FilterStrategy();
+    }
+
+    return new KisBoxFilterStrategy();
+}
+
+void KisScalingBenchmark::benchmarkScaling_data()
+{
+    QTest::addColumn<QString>("depth");
+    QTest::addColumn<QString>("filterId");
+    QTest::addColumn<qreal>("scale");
+
+    QStringList depths;
+    depths << "U8" << "U16" << "F32";
+
+    QStringList filters;
+    filters << "NearestNeighbor" << "Bilinear" << "Bicubic" << "Lanczos3";
+
+    QList<qreal> scales;
+    scales << 0.5 << 1.379 << 3.0;
+
+    Q_FOREACH (const QString &depth, depths) {
+        Q_FOREACH (const QString &filterId, filters) {
+            Q_FOREACH (qreal scale, scales) {
+                QTest::newRow(QString("%1-%2-%3").arg(depth).arg(filterId).arg(scale).toLatin1())
+                    << depth << filterId << scale;
+            }
+        }
+    }
+}
+
+void KisScalingBenchmark::benchmarkScaling()
+{
+    QFETCH(QString, depth);
+    QFETCH(QString, filterId);
+    QFETCH(qreal, scale);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", depth, "");
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    KoColor color(cs);
+    srand(31524744);
+
+    KisSequentialIterator it(dev, QRect(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT));
+    while (it.nextPixel()) {
+        color.fromQColor(QColor(rand() % 255, rand() % 255, rand() % 255, rand() % 255));
+        memcpy(it.rawData(), color.data(), cs->pixelSize());
+    }
+
+    QScopedPointer<KisFilterStrategy> filter(createFilterStrategy(filterId));
+
+    QBENCHMARK_ONCE {
+        KisTransformWorker worker(dev, scale, scale,
+                                  0.0, 0.0, 0.0, 0.0, 0.0, 0, 0,
+                                  0, filter.data());
+        worker.run();
+    }
+}
+
+QTEST_MAIN(KisScalingBenchmark)
@@ -27,6 +27,9 @@ inline double drand48()
 #endif
 
 #include <QTest>
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QImage>
 
 #include "kis_stroke_benchmark.h"
 #include "kis_benchmark_values.h"
@@ -43,6 +46,7 @@ inline double drand48()
 
 #include <brushengine/kis_paint_information.h>
 #include <brushengine/kis_paintop_preset.h>
+#include <brushengine/kis_paintop_settings.h>
 
 #define GMP_IMAGE_WIDTH 3274
 #define GMP_IMAGE_HEIGHT 2067
@@ -229,6 +233,19 @@ void KisStrokeBenchmark::softbrushFullFeatures30RL()
     benchmarkRandomLines(presetFileName);
 }
 
+void KisStrokeBenchmark::softbrushTexture30()
+{
+    QString presetFileName = "softbrush_30px.kpp";
+    benchmarkStroke(presetFileName, true);
+}
+
+
+void KisStrokeBenchmark::softbrushTexture30RL()
+{
+    QString presetFileName = "softbrush_30px.kpp";
+    benchmarkRandomLines(presetFileName, true);
+}
+
 void KisStrokeBenchmark::hairy30pxDefault()
 {
     QString presetFileName = "hairybrush_thesis30px1.kpp";
@@ -435,7 +452,41 @@ QBENCHMARK{
 
 
 
-void KisStrokeBenchmark::benchmarkRandomLines(QString presetFileName)
+/**
+ * Embeds a generated noise pattern into the preset and enables the
+ * texture option, so that the same preset can be benchmarked with and
+ * without texturing
+ */
+static void enableTexture(KisPaintOpPresetSP preset)
+{
+    QImage image(256, 256, QImage::Format_ARGB32);
+
+    srand48(0);
+    for (int y = 0; y < image.height(); y++) {
+        QRgb *line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < image.width(); x++) {
+            const int value = drand48() * 255;
+            line[x] = qRgb(value, value, value);
+        }
+    }
+
+    QByteArray ba;
+    QBuffer buffer(&ba);
+    buffer.open(QBuffer::WriteOnly);
+    image.save(&buffer, "PNG");
+
+    KisPaintOpSettingsSP settings = preset->settings();
+    settings->setProperty("Texture/Pattern/PatternMD5", QCryptographicHash::hash(ba, QCryptographicHash::Md5).toBase64());
+    settings->setProperty("Texture/Pattern/PatternFileName", "benchmark_noise.png");
+    settings->setProperty("Texture/Pattern/Name", "benchmark_noise");
+    settings->setProperty("Texture/Pattern/Pattern", ba.toBase64());
+    settings->setProperty("Texture/Pattern/Enabled", true);
+    settings->setProperty("Texture/Pattern/Scale", 1.0);
+    settings->setProperty("Texture/Pattern/OffsetX", 17);
+    settings->setProperty("Texture/Pattern/OffsetY", 31);
+}
+
+void KisStrokeBenchmark::benchmarkRandomLines(QString presetFileName, bool useTexture)
 {
     KisPaintOpPresetSP preset = new KisPaintOpPreset(m_dataPath + presetFileName);
     bool loadedOk = preset->load();
@@ -446,6 +497,10 @@ void KisStrokeBenchmark::benchmarkRandomLines(QString presetFileName)
         dbgKrita << "preset : " << presetFileName;
     }
 
+    if (useTexture) {
+        enableTexture(preset);
+    }
+
     m_painter->setPaintOpPreset(preset, m_layer, m_image);
 
     QBENCHMARK{
@@ -462,7 +517,7 @@ void KisStrokeBenchmark::benchmarkRandomLines(QString presetFileName)
 #endif
 }
 
-void KisStrokeBenchmark::benchmarkStroke(QString presetFileName)
+void KisStrokeBenchmark::benchmarkStroke(QString presetFileName, bool useTexture)
 {
     KisPaintOpPresetSP preset = new KisPaintOpPreset(m_dataPath + presetFileName);
     bool loadedOk = preset->load();
@@ -473,6 +528,10 @@ void KisStrokeBenchmark::benchmarkStroke(QString presetFileName)
         dbgKrita << "preset : " << presetFileName;
     }
 
+    if (useTexture) {
+        enableTexture(preset);
+    }
+
     m_painter->setPaintOpPreset(preset, m_layer, m_image);
 
     QBENCHMARK{
@@ -58,8 +58,8 @@ private:
     QString m_outputPath;
 
     private:
-        inline void benchmarkRandomLines(QString presetFileName);
-        inline void benchmarkStroke(QString presetFileName);
+        inline void benchmarkRandomLines(QString presetFileName, bool useTexture = false);
+        inline void benchmarkStroke(QString presetFileName, bool useTexture = false);
         inline void benchmarkLine(QString presetFileName);
         inline void benchmarkCircle(QString presetFileName);
 
@@ -80,6 +80,9 @@ private Q_SLOTS:
     void softbrushFullFeatures30();
     void softbrushFullFeatures30RL();
 
+    void softbrushTexture30();
+    void softbrushTexture30RL();
+
     void softbrushSoftness();
     void softbrushOpacity();
 
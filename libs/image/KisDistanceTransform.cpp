@@ -0,0 +1,538 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisDistanceTransform.h"
+
+#include <QRect>
+#include <QVector>
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "kis_global.h"
+#include "kis_assert.h"
+#include "kis_paint_device.h"
+#include "krita_utils.h"
+#include "KisSharedWorkerPool.h"
+
+
+namespace {
+
+/**
+ * Number of columns/rows processed by a single concurrent job
+ */
+const int linesPerJob = 64;
+
+/**
+ * The patches and bands the masks are processed in are aligned to the
+ * tile grid, so that they could be written concurrently
+ */
+const int tileSize = 64;
+
+struct LineBuffers
+{
+    LineBuffers(int size)
+        : f(size), d(size), v(size), z(size + 1)
+    {
+    }
+
+    QVector<float> f;
+    QVector<float> d;
+    QVector<int> v;
+    QVector<double> z;
+};
+
+/**
+ * One-dimensional pass: d(q) = min_p (w * (q - p))^2 + f(p)
+ *
+ * The lower envelope of the parabolas rooted at every sample is built
+ * in a single sweep and then sampled in a second one.
+ */
+void transformLine(LineBuffers &buf, int n, double w2)
+{
+    const float *f = buf.f.constData();
+    float *d = buf.d.data();
+    int *v = buf.v.data();
+    double *z = buf.z.data();
+
+    bool isUniform = true;
+    for (int q = 1; q < n; q++) {
+        if (f[q] != f[0]) {
+            isUniform = false;
+            break;
+        }
+    }
+
+    if (isUniform) {
+        std::copy(f, f + n, d);
+        return;
+    }
+
+    int k = 0;
+    v[0] = 0;
+    z[0] = -std::numeric_limits<double>::infinity();
+    z[1] = std::numeric_limits<double>::infinity();
+
+    for (int q = 1; q < n; q++) {
+        const double fq = f[q] + w2 * q * q;
+        double s;
+
+        forever {
+            const int p = v[k];
+            s = (fq - (f[p] + w2 * p * p)) / (2.0 * w2 * (q - p));
+            if (s > z[k]) break;
+            k--;
+        }
+
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = std::numeric_limits<double>::infinity();
+    }
+
+    k = 0;
+    for (int q = 0; q < n; q++) {
+        while (z[k + 1] < q) {
+            k++;
+        }
+        const int p = v[k];
+        d[q] = w2 * pow2(q - p) + f[p];
+    }
+}
+
+int alignedPatchSize(int margin)
+{
+    /**
+     * Every patch reads \p margin extra pixels on each side, so we keep
+     * the patch at least twice as big as the margin to limit the overhead
+     */
+    const int minPatchSize = 256;
+    const int size = qMax(minPatchSize, 2 * margin);
+    return (size + tileSize - 1) / tileSize * tileSize;
+}
+
+/**
+ * A mask is "hard" if all its soft (neither unset nor fully set) pixels
+ * lie on the border of a hard area, like the antialiased edge of a
+ * shape. Such a mask is fully defined by its 50% threshold, the distance
+ * transform restores the antialiased edge afterwards. The masks with wider
+ * soft areas (feathered or semi-transparent ones) need the grayscale
+ * morphology to keep their values.
+ */
+bool isHardMask(KisPaintDeviceSP device, const QRect &rect)
+{
+    const int width = rect.width();
+    const int stride = width + 2;
+
+    // three rows with one pixel of padding on each side, the padding and
+    // the rows beyond the rect are considered unset
+    QVector<quint8> buffer(3 * stride, 0);
+    quint8 *rows[3] = {buffer.data(), buffer.data() + stride, buffer.data() + 2 * stride};
+
+    device->readBytes(rows[1] + 1, rect.x(), rect.y(), width, 1);
+
+    for (int y = 0; y < rect.height(); y++) {
+        if (y + 1 < rect.height()) {
+            device->readBytes(rows[2] + 1, rect.x(), rect.y() + y + 1, width, 1);
+        } else {
+            memset(rows[2] + 1, 0, width);
+        }
+
+        for (int x = 1; x <= width; x++) {
+            const quint8 value = rows[1][x];
+            if (value == 0 || value == 255) continue;
+
+            bool hasHardNeighbour = false;
+
+            for (int j = 0; j < 3 && !hasHardNeighbour; j++) {
+                for (int i = x - 1; i <= x + 1; i++) {
+                    if (rows[j][i] == 0 || rows[j][i] == 255) {
+                        hasHardNeighbour = true;
+                        break;
+                    }
+                }
+            }
+
+            if (!hasHardNeighbour) return false;
+        }
+
+        std::rotate(rows, rows + 1, rows + 3);
+    }
+
+    return true;
+}
+
+/**
+ * Calculates the distance transform of \p window of the mask, which is
+ * enough for the pixels lying deeper than the clamping distance from the
+ * border of the window (or on the border of the whole rect).
+ */
+template <class IsFeaturePolicy>
+void calculateWindowDistance(KisPaintDeviceSP src, const QRect &window,
+                             float maxDistance, qreal xScale, qreal yScale,
+                             IsFeaturePolicy isFeature,
+                             QVector<quint8> &mask, QVector<float> &distance)
+{
+    const int numPixels = window.width() * window.height();
+
+    mask.resize(numPixels);
+    src->readBytes(mask.data(), window);
+
+    distance.resize(numPixels);
+    for (int i = 0; i < numPixels; i++) {
+        distance[i] = isFeature(mask[i]) ? 0.0f : maxDistance;
+    }
+
+    KisDistanceTransform::squaredDistance(distance.data(), window.width(), window.height(),
+                                          xScale, yScale);
+}
+
+/**
+ * Splits \p rect into patches aligned to the tile grid and calls \p func
+ * for every patch concurrently. The patches are written in place, so the
+ * surroundings of a patch should be read from a snapshot of the device.
+ */
+template <class Func>
+void processPatches(const QRect &rect, const QPoint &margin, Func func)
+{
+    QVector<QRect> patches =
+        KritaUtils::splitRectIntoPatches(rect,
+                                         QSize(alignedPatchSize(margin.x()),
+                                               alignedPatchSize(margin.y())));
+
+    KisSharedWorkerPool::blockingMap(patches, func);
+}
+
+KisPaintDeviceSP snapshotForPatches(KisPaintDeviceSP device, const QRect &rect, const QPoint &margin)
+{
+    const QSize patchSize(alignedPatchSize(margin.x()), alignedPatchSize(margin.y()));
+    const bool hasSinglePatch =
+        KritaUtils::splitRectIntoPatches(rect, patchSize).size() <= 1;
+
+    return hasSinglePatch ? device : KisPaintDeviceSP(new KisPaintDevice(*device));
+}
+
+struct MaxPolicy {
+    static const quint8 absorbingValue = 255;
+    static quint8 apply(quint8 a, quint8 b) {
+        return qMax(a, b);
+    }
+};
+
+struct MinPolicy {
+    static const quint8 absorbingValue = 0;
+    static quint8 apply(quint8 a, quint8 b) {
+        return qMin(a, b);
+    }
+};
+
+/**
+ * Max (min) filter over an elliptical structuring element. The filter
+ * first finds the extremum of every column over all the vertical
+ * half-sizes of the element and then combines the columns along the
+ * row, so the cost is linear in the radius.
+ *
+ * The pixels outside \p rect are treated as unset, unless \p edgeLock is
+ * set, in which case they are equal to the nearest pixel of the rect.
+ */
+template <class Policy>
+void grayscaleMorphologyBand(KisPaintDeviceSP src, KisPaintDeviceSP dst,
+                             const QRect &rect, const QRect &band,
+                             const QVector<int> &halfHeights,
+                             int xRadius, int yRadius, bool edgeLock)
+{
+    const int width = rect.width();
+    const QRect window = band.adjusted(0, -yRadius, 0, yRadius) & rect;
+
+    QVector<quint8> windowData(width * window.height());
+    src->readBytes(windowData.data(), window);
+
+    const QVector<quint8> unsetRow(width, 0);
+
+    auto row = [&] (int y) -> const quint8* {
+        if (edgeLock) {
+            y = qBound(rect.top(), y, rect.bottom());
+        } else if (y < rect.top() || y > rect.bottom()) {
+            return unsetRow.constData();
+        }
+
+        return windowData.constData() + (y - window.top()) * width;
+    };
+
+    // every line is padded with xRadius pixels on each side
+    const int stride = width + 2 * xRadius;
+    QVector<quint8> columnExtremums((yRadius + 1) * stride);
+    QVector<quint8> result(width * band.height());
+
+    for (int y = band.top(); y <= band.bottom(); y++) {
+        for (int h = 0; h <= yRadius; h++) {
+            quint8 *line = columnExtremums.data() + h * stride + xRadius;
+
+            if (!h) {
+                memcpy(line, row(y), width);
+            } else {
+                const quint8 *prevLine = line - stride;
+                const quint8 *top = row(y - h);
+                const quint8 *bottom = row(y + h);
+
+                for (int x = 0; x < width; x++) {
+                    line[x] = Policy::apply(prevLine[x], Policy::apply(top[x], bottom[x]));
+                }
+            }
+
+            std::fill(line - xRadius, line, edgeLock ? line[0] : 0);
+            std::fill(line + width, line + width + xRadius, edgeLock ? line[width - 1] : 0);
+        }
+
+        quint8 *dstPtr = result.data() + (y - band.top()) * width;
+
+        for (int x = 0; x < width; x++) {
+            quint8 value = 255 - Policy::absorbingValue;
+
+            for (int i = -xRadius; i <= xRadius; i++) {
+                const quint8 *line = columnExtremums.constData() + halfHeights[i + xRadius] * stride + xRadius;
+                value = Policy::apply(value, line[x + i]);
+
+                if (value == Policy::absorbingValue) break;
+            }
+
+            dstPtr[x] = value;
+        }
+    }
+
+    dst->writeBytes(result.constData(), band);
+}
+
+template <class Policy>
+void grayscaleMorphology(KisPaintDeviceSP device, const QRect &rect,
+                         qreal xRadius, qreal yRadius, bool edgeLock)
+{
+    const int xr = qMax(1, qRound(xRadius));
+    const int yr = qMax(1, qRound(yRadius));
+
+    // the vertical half-size of the ellipse at every horizontal offset
+    QVector<int> halfHeights(2 * xr + 1);
+    for (int i = -xr; i <= xr; i++) {
+        const qreal dx = i ? qAbs(i) - 0.5 : 0.0;
+        halfHeights[i + xr] = qRound(qreal(yr) / xr * std::sqrt(pow2(xr) - pow2(dx)));
+    }
+
+    const int bandHeight = alignedPatchSize(yr);
+
+    QVector<QRect> bands;
+    for (int y = rect.top(); y <= rect.bottom();) {
+        const int bandTop = y - (y % bandHeight + bandHeight) % bandHeight;
+        const int bottom = qMin(rect.bottom(), bandTop + bandHeight - 1);
+        bands << QRect(rect.left(), y, rect.width(), bottom - y + 1);
+        y = bottom + 1;
+    }
+
+    KisPaintDeviceSP src = bands.size() > 1 ? KisPaintDeviceSP(new KisPaintDevice(*device)) : device;
+
+    KisSharedWorkerPool::blockingMap(bands,
+        [&] (const QRect &band) {
+            grayscaleMorphologyBand<Policy>(src, device, rect, band,
+                                            halfHeights, xr, yr, edgeLock);
+        });
+}
+
+}
+
+void KisDistanceTransform::squaredDistance(float *data, int width, int height,
+                                           qreal xScale, qreal yScale)
+{
+    if (width <= 0 || height <= 0) return;
+
+    const double yW2 = pow2(yScale);
+    const double xW2 = pow2(xScale);
+
+    const int numColumnJobs = (width + linesPerJob - 1) / linesPerJob;
+    const int numRowJobs = (height + linesPerJob - 1) / linesPerJob;
+
+    KisSharedWorkerPool::parallelFor(numColumnJobs,
+        [data, width, height, yW2] (int job) {
+            LineBuffers buf(height);
+            const int firstColumn = job * linesPerJob;
+            const int lastColumn = qMin(firstColumn + linesPerJob, width);
+
+            for (int x = firstColumn; x < lastColumn; x++) {
+                for (int y = 0; y < height; y++) {
+                    buf.f[y] = data[y * width + x];
+                }
+
+                transformLine(buf, height, yW2);
+
+                for (int y = 0; y < height; y++) {
+                    data[y * width + x] = buf.d[y];
+                }
+            }
+        });
+
+    KisSharedWorkerPool::parallelFor(numRowJobs,
+        [data, width, height, xW2] (int job) {
+            LineBuffers buf(width);
+            const int firstRow = job * linesPerJob;
+            const int lastRow = qMin(firstRow + linesPerJob, height);
+
+            for (int y = firstRow; y < lastRow; y++) {
+                float *row = data + y * width;
+
+                std::copy(row, row + width, buf.f.begin());
+                transformLine(buf, width, xW2);
+                std::copy(buf.d.constBegin(), buf.d.constBegin() + width, row);
+            }
+        });
+}
+
+void KisDistanceTransform::dilateU8(KisPaintDeviceSP device, const QRect &rect,
+                                    qreal xRadius, qreal yRadius)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(device->pixelSize() == 1);
+    if (rect.isEmpty() || xRadius <= 0 || yRadius <= 0) return;
+
+    if (!isHardMask(device, rect)) {
+        grayscaleMorphology<MaxPolicy>(device, rect, xRadius, yRadius, false);
+        return;
+    }
+
+    /**
+     * The distance is measured in the units of the bigger radius, so
+     * that the antialiased rim is one pixel wide along that axis
+     */
+    const qreal radius = qMax(xRadius, yRadius);
+    const qreal xScale = radius / xRadius;
+    const qreal yScale = radius / yRadius;
+    const float maxDistance = pow2(radius + 1.0);
+    const float innerDistance = pow2(radius);
+
+    // no feature farther than the margin can be closer than maxDistance
+    const QPoint margin(qCeil((radius + 1.0) / xScale), qCeil((radius + 1.0) / yScale));
+
+    KisPaintDeviceSP src = snapshotForPatches(device, rect, margin);
+
+    processPatches(rect, margin,
+        [&] (const QRect &patch) {
+            const QRect window = patch.adjusted(-margin.x(), -margin.y(), margin.x(), margin.y()) & rect;
+
+            QVector<quint8> mask;
+            QVector<float> distance;
+
+            calculateWindowDistance(src, window, maxDistance, xScale, yScale,
+                                    [] (quint8 value) { return value >= 128; },
+                                    mask, distance);
+
+            QVector<quint8> result(patch.width() * patch.height());
+            quint8 *dstPtr = result.data();
+
+            for (int y = patch.top(); y <= patch.bottom(); y++) {
+                const int offset = (y - window.top()) * window.width() + patch.left() - window.left();
+
+                for (int x = 0; x < patch.width(); x++) {
+                    const float d2 = distance[offset + x];
+                    const quint8 value = mask[offset + x];
+
+                    if (d2 <= innerDistance) {
+                        *dstPtr = 255;
+                    } else if (d2 < maxDistance) {
+                        const int rimValue = qRound(255.0 * (radius + 1.0 - std::sqrt(d2)));
+                        *dstPtr = qMax(int(value), qBound(0, rimValue, 255));
+                    } else {
+                        *dstPtr = value;
+                    }
+
+                    dstPtr++;
+                }
+            }
+
+            device->writeBytes(result.constData(), patch);
+        });
+}
+
+void KisDistanceTransform::erodeU8(KisPaintDeviceSP device, const QRect &rect,
+                                   qreal xRadius, qreal yRadius, bool edgeLock)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(device->pixelSize() == 1);
+    if (rect.isEmpty() || xRadius <= 0 || yRadius <= 0) return;
+
+    if (!isHardMask(device, rect)) {
+        grayscaleMorphology<MinPolicy>(device, rect, xRadius, yRadius, edgeLock);
+        return;
+    }
+
+    const qreal radius = qMax(xRadius, yRadius);
+    const qreal xScale = radius / xRadius;
+    const qreal yScale = radius / yRadius;
+    const float maxDistance = pow2(radius + 1.0);
+    const float innerDistance = pow2(radius);
+
+    const QPoint margin(qCeil((radius + 1.0) / xScale), qCeil((radius + 1.0) / yScale));
+
+    KisPaintDeviceSP src = snapshotForPatches(device, rect, margin);
+
+    processPatches(rect, margin,
+        [&] (const QRect &patch) {
+            const QRect window = patch.adjusted(-margin.x(), -margin.y(), margin.x(), margin.y()) & rect;
+
+            QVector<quint8> mask;
+            QVector<float> distance;
+
+            calculateWindowDistance(src, window, maxDistance, xScale, yScale,
+                                    [] (quint8 value) { return value < 128; },
+                                    mask, distance);
+
+            QVector<quint8> result(patch.width() * patch.height());
+            quint8 *dstPtr = result.data();
+
+            for (int y = patch.top(); y <= patch.bottom(); y++) {
+                const int offset = (y - window.top()) * window.width() + patch.left() - window.left();
+
+                /**
+                 * Without the edge lock everything outside the rect is
+                 * unset, so the nearest unset pixel may lie just beyond
+                 * the border of the rect
+                 */
+                const float yBorder = pow2(yScale * qMin(y - rect.top() + 1, rect.bottom() - y + 1));
+
+                for (int x = 0; x < patch.width(); x++) {
+                    float d2 = distance[offset + x];
+                    const quint8 value = mask[offset + x];
+
+                    if (!edgeLock) {
+                        const int rectX = patch.left() + x;
+                        const float xBorder = pow2(xScale * qMin(rectX - rect.left() + 1, rect.right() - rectX + 1));
+                        d2 = qMin(d2, qMin(xBorder, yBorder));
+                    }
+
+                    if (d2 <= innerDistance) {
+                        *dstPtr = 0;
+                    } else if (d2 < maxDistance) {
+                        const int rimValue = qRound(255.0 * (std::sqrt(d2) - radius));
+                        *dstPtr = qMin(int(value), qBound(0, rimValue, 255));
+                    } else {
+                        *dstPtr = value;
+                    }
+
+                    dstPtr++;
+                }
+            }
+
+            device->writeBytes(result.constData(), patch);
+        });
+}
@@ -0,0 +1,88 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISDISTANCETRANSFORM_H
+#define KISDISTANCETRANSFORM_H
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+
+class QRect;
+
+/**
+ * Exact Euclidean distance transform and the morphological operations
+ * built on top of it.
+ *
+ * The transform is the separable lower-envelope-of-parabolas algorithm by
+ * Felzenszwalb and Huttenlocher, so its cost is linear in the number of
+ * pixels and does not depend on the distance (radius) the caller is
+ * interested in. Columns and rows are processed in parallel.
+ *
+ * The morphological operations process the rect in patches aligned to the
+ * tile grid, each patch reading only the surroundings that can affect it.
+ */
+class KRITAIMAGE_EXPORT KisDistanceTransform
+{
+public:
+    /**
+     * Computes squared distances in-place over a row-major \p width x
+     * \p height buffer.
+     *
+     * On input every "feature" pixel should contain 0 and all the other
+     * pixels should contain the largest squared distance the caller cares
+     * about. On output each pixel contains the squared distance to the
+     * nearest feature pixel, clamped to that initial value.
+     *
+     * \p xScale and \p yScale define the distance of a one pixel step
+     * along each axis, which allows elliptical metrics.
+     */
+    static void squaredDistance(float *data, int width, int height,
+                                qreal xScale = 1.0, qreal yScale = 1.0);
+
+    /**
+     * Grows an 8-bit mask by an elliptical structuring element. Pixels
+     * outside \p rect are treated as unset.
+     *
+     * If the soft pixels of the mask form only the antialiased edges of
+     * the hard areas, pixels with value >= 128 are considered set, the
+     * boundary of the result is antialiased, and the original values are
+     * never decreased. Otherwise (e.g. for feathered selections) every
+     * pixel gets the maximum of the values under the structuring element,
+     * which costs linearly in the radius.
+     */
+    static void dilateU8(KisPaintDeviceSP device, const QRect &rect,
+                         qreal xRadius, qreal yRadius);
+
+    /**
+     * Shrinks an 8-bit mask by an elliptical structuring element.
+     *
+     * If the soft pixels of the mask form only the antialiased edges of
+     * the hard areas, pixels with value < 128 are considered unset, the
+     * boundary of the result is antialiased, and the original values are
+     * never increased. Otherwise every pixel gets the minimum of the values
+     * under the structuring element.
+     *
+     * If \p edgeLock is true, pixels outside \p rect are assumed to be
+     * identical to the nearest edge pixel, otherwise they are treated as
+     * unset.
+     */
+    static void erodeU8(KisPaintDeviceSP device, const QRect &rect,
+                        qreal xRadius, qreal yRadius, bool edgeLock);
+};
+
+#endif // KISDISTANCETRANSFORM_H
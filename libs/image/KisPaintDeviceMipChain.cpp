@@ -0,0 +1,247 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisPaintDeviceMipChain.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegion>
+#include <QVector>
+
+#include <KoColorSpace.h>
+#include <KoMixColorsOp.h>
+
+#include "kis_assert.h"
+#include "kis_paint_device.h"
+#include "krita_utils.h"
+#include "KisSharedWorkerPool.h"
+
+
+namespace {
+
+/**
+ * The size of a patch of a level that is downsampled by a single
+ * concurrent job
+ */
+const int patchSize = 128;
+
+QRect downscaledRect(const QRect &rc)
+{
+    if (rc.isEmpty()) return QRect();
+
+    /**
+     * A destination pixel depends on the 2x2 block of source pixels,
+     * so the rect should include all the blocks touched by \p rc
+     */
+    return QRect(QPoint(rc.left() >> 1, rc.top() >> 1),
+                 QPoint(rc.right() >> 1, rc.bottom() >> 1));
+}
+
+struct DownsampleJob
+{
+    KisPaintDeviceSP src;
+    KisPaintDeviceSP dst;
+    QRect srcBounds;
+    QRect dstRect;
+};
+
+void downsample(const DownsampleJob &job)
+{
+    const KoColorSpace *cs = job.dst->colorSpace();
+    const KoMixColorsOp *mixOp = cs->mixColorsOp();
+    const int pixelSize = cs->pixelSize();
+
+    const QRect &dstRect = job.dstRect;
+    const QRect srcRect(dstRect.topLeft() * 2, dstRect.size() * 2);
+    const int srcRowStride = srcRect.width() * pixelSize;
+
+    QVector<quint8> srcBuffer(srcRect.width() * srcRect.height() * pixelSize);
+    QVector<quint8> dstBuffer(dstRect.width() * dstRect.height() * pixelSize);
+
+    job.src->readBytes(srcBuffer.data(), srcRect);
+
+    /**
+     * When the source level has an odd size, the last block of a row
+     * (or column) is cut by its bounds. Such blocks are averaged over
+     * the pixels inside the bounds only, otherwise the edges of the
+     * level would get blended with transparent pixels.
+     */
+    const QRect &srcBounds = job.srcBounds;
+
+    const quint8 *srcRow = srcBuffer.constData();
+    quint8 *dstPtr = dstBuffer.data();
+    const quint8 *block[4];
+
+    for (int y = 0; y < dstRect.height(); y++) {
+        const quint8 *srcPtr = srcRow;
+
+        const int srcY = srcRect.y() + 2 * y;
+        const bool hasTopRow = srcY >= srcBounds.top();
+        const bool hasBottomRow = srcY + 1 <= srcBounds.bottom();
+
+        for (int x = 0; x < dstRect.width(); x++) {
+            const int srcX = srcRect.x() + 2 * x;
+            const bool hasLeftColumn = srcX >= srcBounds.left();
+            const bool hasRightColumn = srcX + 1 <= srcBounds.right();
+
+            int numPixels = 0;
+
+            if (hasTopRow && hasLeftColumn) {
+                block[numPixels++] = srcPtr;
+            }
+            if (hasTopRow && hasRightColumn) {
+                block[numPixels++] = srcPtr + pixelSize;
+            }
+            if (hasBottomRow && hasLeftColumn) {
+                block[numPixels++] = srcPtr + srcRowStride;
+            }
+            if (hasBottomRow && hasRightColumn) {
+                block[numPixels++] = srcPtr + srcRowStride + pixelSize;
+            }
+
+            mixOp->mixColors(block, numPixels, dstPtr);
+
+            srcPtr += 2 * pixelSize;
+            dstPtr += pixelSize;
+        }
+
+        srcRow += 2 * srcRowStride;
+    }
+
+    job.dst->writeBytes(dstBuffer.constData(), dstRect);
+}
+
+}
+
+struct KisPaintDeviceMipChain::Private
+{
+    KisPaintDeviceSP source;
+    QVector<KisPaintDeviceSP> levels;
+    QVector<QRect> levelBounds;
+
+    QMutex dirtyLock;
+    QRegion dirtyRegion;
+
+    void createLevels();
+};
+
+void KisPaintDeviceMipChain::Private::createLevels()
+{
+    const KoColorSpace *cs = source->colorSpace();
+
+    for (int i = 1; i < levels.size(); i++) {
+        levels[i] = new KisPaintDevice(cs);
+    }
+}
+
+KisPaintDeviceMipChain::KisPaintDeviceMipChain(KisPaintDeviceSP source, const QRect &bounds, int minLevelSize)
+    : m_d(new Private)
+{
+    m_d->source = source;
+
+    QRect rc = bounds;
+    m_d->levels << source;
+    m_d->levelBounds << rc;
+
+    while (qMax(rc.width(), rc.height()) >= 2 * minLevelSize) {
+        rc = downscaledRect(rc);
+        m_d->levels << KisPaintDeviceSP();
+        m_d->levelBounds << rc;
+    }
+
+    m_d->createLevels();
+    m_d->dirtyRegion = bounds;
+}
+
+KisPaintDeviceMipChain::~KisPaintDeviceMipChain()
+{
+}
+
+void KisPaintDeviceMipChain::setDirty(const QRect &rc)
+{
+    QMutexLocker l(&m_d->dirtyLock);
+    m_d->dirtyRegion += rc & m_d->levelBounds.first();
+}
+
+void KisPaintDeviceMipChain::update()
+{
+    QRegion dirtyRegion;
+
+    {
+        QMutexLocker l(&m_d->dirtyLock);
+        std::swap(dirtyRegion, m_d->dirtyRegion);
+    }
+
+    if (m_d->levels.size() < 2) return;
+
+    if (!(*m_d->levels[1]->colorSpace() == *m_d->source->colorSpace())) {
+        m_d->createLevels();
+        dirtyRegion = m_d->levelBounds.first();
+    }
+
+    for (int i = 1; i < m_d->levels.size() && !dirtyRegion.isEmpty(); i++) {
+        QRegion levelRegion;
+        Q_FOREACH (const QRect &rc, dirtyRegion.rects()) {
+            levelRegion += downscaledRect(rc) & m_d->levelBounds[i];
+        }
+
+        QVector<DownsampleJob> jobs;
+        Q_FOREACH (const QRect &rc, KritaUtils::splitRegionIntoPatches(levelRegion, QSize(patchSize, patchSize))) {
+            jobs.append({m_d->levels[i - 1], m_d->levels[i], m_d->levelBounds[i - 1], rc});
+        }
+
+        KisSharedWorkerPool::blockingMap(jobs, downsample);
+
+        dirtyRegion = levelRegion;
+    }
+}
+
+KisPaintDeviceSP KisPaintDeviceMipChain::source() const
+{
+    return m_d->source;
+}
+
+int KisPaintDeviceMipChain::numLevels() const
+{
+    return m_d->levels.size();
+}
+
+KisPaintDeviceSP KisPaintDeviceMipChain::level(int index) const
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(index >= 0 && index < m_d->levels.size(), m_d->source);
+    return m_d->levels[index];
+}
+
+QRect KisPaintDeviceMipChain::levelBounds(int index) const
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(index >= 0 && index < m_d->levelBounds.size(), QRect());
+    return m_d->levelBounds[index];
+}
+
+int KisPaintDeviceMipChain::levelForScale(qreal scale) const
+{
+    int index = 0;
+
+    while (index + 1 < m_d->levels.size() &&
+           qreal(1.0) / (1 << (index + 1)) >= scale) {
+
+        index++;
+    }
+
+    return index;
+}
@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISPAINTDEVICEMIPCHAIN_H
+#define KISPAINTDEVICEMIPCHAIN_H
+
+#include <QScopedPointer>
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+
+class QRect;
+
+/**
+ * KisPaintDeviceMipChain keeps a chain of 2x downscaled copies of a paint
+ * device (usually, the image projection), so that a zoomed-out view of it
+ * can be sampled from a small level instead of the full resolution data.
+ *
+ * The chain is updated incrementally: the owner reports the changed areas
+ * of the source with setDirty() (this is thread-safe and cheap, so it may
+ * be called right from the image update signal), and update() re-downsamples
+ * only the tiles of every level that are covered by these areas. The
+ * downsampling uses a 2x2 box filter of the color space's own mixing
+ * operation and processes the tiles of a level in parallel.
+ *
+ * Level 0 is the source device itself.
+ */
+class KRITAIMAGE_EXPORT KisPaintDeviceMipChain
+{
+public:
+    /**
+     * Creates a chain for \p source covering \p bounds. The levels are
+     * added until the bigger dimension of the smallest one gets below
+     * \p minLevelSize pixels.
+     */
+    KisPaintDeviceMipChain(KisPaintDeviceSP source, const QRect &bounds, int minLevelSize = 64);
+    ~KisPaintDeviceMipChain();
+
+    /**
+     * Marks \p rc (in source coordinates) as changed. The levels are not
+     * touched until the next call to update().
+     */
+    void setDirty(const QRect &rc);
+
+    /**
+     * Brings all the levels up to date with the source
+     */
+    void update();
+
+    KisPaintDeviceSP source() const;
+    int numLevels() const;
+
+    KisPaintDeviceSP level(int index) const;
+    QRect levelBounds(int index) const;
+
+    /**
+     * \return the smallest level that has at least \p scale resolution
+     *         of the source
+     */
+    int levelForScale(qreal scale) const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISPAINTDEVICEMIPCHAIN_H
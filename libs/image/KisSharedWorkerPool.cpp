@@ -0,0 +1,206 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisSharedWorkerPool.h"
+
+#include <QGlobalStatic>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QThreadStorage>
+
+#include "kis_image_config.h"
+
+
+namespace {
+
+struct SharedPool
+{
+    SharedPool()
+    {
+        const int limit = qMax(1, KisImageConfig(true).maxNumberOfThreads());
+        threadsLimit = limit;
+        pool.setMaxThreadCount(limit);
+    }
+
+    QThreadPool pool;
+    QAtomicInt threadsLimit;
+    QAtomicInt busyWorkers;
+    QAtomicInt activeHelpers;
+
+    /**
+     * Set for the threads that are already accounted in either
+     * busyWorkers or activeHelpers
+     */
+    QThreadStorage<bool> isCountedThread;
+
+    bool currentThreadIsCounted() {
+        return isCountedThread.hasLocalData() && isCountedThread.localData();
+    }
+};
+
+Q_GLOBAL_STATIC(SharedPool, s_pool)
+
+/**
+ * The job lives on the stack of the calling thread, which doesn't
+ * return until all the recruited helpers have finished.
+ */
+struct Job
+{
+    Job(int _numItems,
+        const std::function<void(int)> &_func,
+        const KisSharedWorkerPool::CancelFunc &_isCancelled)
+        : numItems(_numItems),
+          func(_func),
+          isCancelled(_isCancelled)
+    {
+    }
+
+    void processItems() {
+        int i;
+        while ((i = nextItem.fetchAndAddOrdered(1)) < numItems) {
+            if (isCancelled && isCancelled()) {
+                nextItem.fetchAndStoreOrdered(numItems);
+                break;
+            }
+
+            func(i);
+        }
+    }
+
+    const int numItems;
+    const std::function<void(int)> &func;
+    const KisSharedWorkerPool::CancelFunc &isCancelled;
+
+    QAtomicInt nextItem;
+
+    QMutex mutex;
+    QWaitCondition helpersFinished;
+    int runningHelpers = 0;
+};
+
+class Helper : public QRunnable
+{
+public:
+    Helper(Job *job) : m_job(job) {}
+
+    void run() override {
+        s_pool->isCountedThread.setLocalData(true);
+        m_job->processItems();
+        s_pool->isCountedThread.setLocalData(false);
+
+        s_pool->activeHelpers.deref();
+
+        QMutexLocker l(&m_job->mutex);
+        if (--m_job->runningHelpers == 0) {
+            m_job->helpersFinished.wakeAll();
+        }
+    }
+
+private:
+    Job *m_job;
+};
+
+}
+
+void KisSharedWorkerPool::parallelFor(int numItems,
+                                      const std::function<void(int)> &func,
+                                      const CancelFunc &isCancelled)
+{
+    if (numItems <= 0) return;
+
+    if (numItems == 1) {
+        if (!isCancelled || !isCancelled()) {
+            func(0);
+        }
+        return;
+    }
+
+    SharedPool *p = s_pool;
+    Job job(numItems, func, isCancelled);
+
+    /**
+     * The calling thread processes the items itself, so we need at most
+     * numItems - 1 helpers. The helpers are started only if there is a
+     * free thread right now, they are never queued.
+     *
+     * The caller takes one slot of the limit, unless it is an updater
+     * thread or a helper, which are already counted.
+     */
+    const int callerSlot = p->currentThreadIsCounted() ? 0 : 1;
+
+    for (int i = 0; i < numItems - 1; i++) {
+        const int helpers = p->activeHelpers.fetchAndAddOrdered(1);
+
+        if (helpers + p->busyWorkers.load() + callerSlot >= p->threadsLimit.load()) {
+            p->activeHelpers.deref();
+            break;
+        }
+
+        {
+            QMutexLocker l(&job.mutex);
+            job.runningHelpers++;
+        }
+
+        Helper *helper = new Helper(&job);
+
+        if (!p->pool.tryStart(helper)) {
+            delete helper;
+            p->activeHelpers.deref();
+
+            QMutexLocker l(&job.mutex);
+            job.runningHelpers--;
+            break;
+        }
+    }
+
+    job.processItems();
+
+    QMutexLocker l(&job.mutex);
+    while (job.runningHelpers > 0) {
+        job.helpersFinished.wait(&job.mutex);
+    }
+}
+
+void KisSharedWorkerPool::setThreadsLimit(int value)
+{
+    value = qMax(1, value);
+
+    s_pool->threadsLimit = value;
+    s_pool->pool.setMaxThreadCount(value);
+}
+
+int KisSharedWorkerPool::threadsLimit()
+{
+    return s_pool->threadsLimit.load();
+}
+
+KisSharedWorkerPool::BusyWorkerGuard::BusyWorkerGuard()
+{
+    s_pool->busyWorkers.ref();
+    s_pool->isCountedThread.setLocalData(true);
+}
+
+KisSharedWorkerPool::BusyWorkerGuard::~BusyWorkerGuard()
+{
+    s_pool->isCountedThread.setLocalData(false);
+    s_pool->busyWorkers.deref();
+}
@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISSHAREDWORKERPOOL_H
+#define KISSHAREDWORKERPOOL_H
+
+#include <functional>
+#include "kritaimage_export.h"
+
+/**
+ * KisSharedWorkerPool is a replacement for QtConcurrent::blockingMap()
+ * for the algorithms that are executed by the updater threads of the
+ * image (strokes, filters, transformations) or by the GUI thread.
+ *
+ * QtConcurrent uses the global QThreadPool, which knows nothing about
+ * the updater threads of the image. Calling blockingMap() from an
+ * updater thread makes it sleep until the global pool processes all the
+ * items, which may be busy with other jobs, and the total number of
+ * running threads becomes higher than the limit set by the user.
+ *
+ * The pool solves both problems:
+ *
+ * 1) The calling thread takes part in processing the items. Helper
+ *    threads are recruited with QThreadPool::tryStart() only, that is,
+ *    only if there is a free thread right now. Therefore, the caller
+ *    never waits for the items that have not been started yet and
+ *    nested calls cannot deadlock: without free threads the items are
+ *    just processed inline.
+ *
+ * 2) The number of helper threads is limited by the "max number of
+ *    threads" option of the image minus the number of updater threads
+ *    that are busy at the moment (see BusyWorkerGuard).
+ *
+ * 3) The processing can be cancelled: as soon as \p isCancelled returns
+ *    true, no more items are started.
+ */
+class KRITAIMAGE_EXPORT KisSharedWorkerPool
+{
+public:
+    typedef std::function<bool()> CancelFunc;
+
+    /**
+     * Calls \p func for every index in range [0, numItems) and waits
+     * until all the calls are finished. The calls may happen in
+     * arbitrary order and in parallel.
+     */
+    static void parallelFor(int numItems,
+                            const std::function<void(int)> &func,
+                            const CancelFunc &isCancelled = CancelFunc());
+
+    /**
+     * A drop-in replacement for QtConcurrent::blockingMap(). The container
+     * should provide random access iterators.
+     */
+    template <class Container, class Func>
+    static void blockingMap(Container &container, Func func,
+                            const CancelFunc &isCancelled = CancelFunc())
+    {
+        // detach the container in the calling thread only
+        auto begin = container.begin();
+
+        parallelFor(int(container.end() - begin),
+                    [begin, &func] (int i) { func(*(begin + i)); },
+                    isCancelled);
+    }
+
+    /**
+     * Sets the maximum number of threads that may process the
+     * items at the same time, including the updater threads of the
+     * images. Called by the update scheduler when the settings change.
+     */
+    static void setThreadsLimit(int value);
+    static int threadsLimit();
+
+    /**
+     * The updater threads of the image register themselves as busy
+     * while executing a job, so that the pool doesn't recruit helpers
+     * when all the cores are already loaded with updates.
+     */
+    struct KRITAIMAGE_EXPORT BusyWorkerGuard {
+        BusyWorkerGuard();
+        ~BusyWorkerGuard();
+    };
+};
+
+#endif // KISSHAREDWORKERPOOL_H
@@ -21,6 +21,7 @@
 #include <KoAlwaysInline.h>
 
 #include <QStack>
+#include "KisSharedWorkerPool.h"
 #include <KoColor.h>
 #include <KoColorSpace.h>
 #include <KoCompositeOpRegistry.h>
@@ -345,6 +346,177 @@ private:
 
 
 
+/**
+ * A horizontal run of fillable pixels inside a tile of the parallel
+ * fill. The runs are stored row by row, left to right.
+ */
+struct ParallelFillRun
+{
+    int row;
+    int start;
+    int end;
+    int component;
+};
+
+/**
+ * A tile of the parallel fill. The runs of the tile are split into
+ * 4-connected components, which are merged with the components of the
+ * neighbouring tiles via the runs touching the tile's border.
+ */
+struct ParallelFillTile
+{
+    ParallelFillTile() : isLabeled(false) {}
+
+    bool isLabeled;
+    QRect rect;
+
+    QVector<ParallelFillRun> runs;
+
+    /// index of the first run of every row, rect.height() + 1 elements
+    QVector<int> rowOffsets;
+
+    /// the runs touching the border grouped by component, CSR-style
+    QVector<int> borderRunOffsets;
+    QVector<int> borderRuns;
+
+    QVector<bool> reachedComponents;
+
+    template <class T>
+    void label(T &pixelPolicy, int pixelSize);
+};
+
+template <class T>
+void ParallelFillTile::label(T &pixelPolicy, int pixelSize)
+{
+    QVector<int> parent;
+
+    auto findRoot = [&parent] (int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+
+    rowOffsets.resize(rect.height() + 1);
+
+    int prevRowBegin = 0;
+
+    for (int y = rect.top(); y <= rect.bottom(); y++) {
+        const int rowBegin = runs.size();
+        rowOffsets[y - rect.top()] = rowBegin;
+
+        ParallelFillRun run;
+        run.row = y;
+        run.component = -1;
+        bool runStarted = false;
+
+        int numPixelsLeft = 0;
+        quint8 *dataPtr = 0;
+
+        for (int x = rect.left(); x <= rect.right(); x++) {
+            if (numPixelsLeft <= 0) {
+                pixelPolicy.m_srcIt->moveTo(x, y);
+                numPixelsLeft = pixelPolicy.m_srcIt->numContiguousColumns(x) - 1;
+                dataPtr = const_cast<quint8*>(pixelPolicy.m_srcIt->rawDataConst());
+            } else {
+                numPixelsLeft--;
+                dataPtr += pixelSize;
+            }
+
+            if (pixelPolicy.calculateOpacity(dataPtr)) {
+                if (!runStarted) {
+                    run.start = x;
+                    runStarted = true;
+                }
+                run.end = x;
+            } else if (runStarted) {
+                runs.append(run);
+                runStarted = false;
+            }
+        }
+
+        if (runStarted) {
+            runs.append(run);
+        }
+
+        const int rowEnd = runs.size();
+
+        for (int i = rowBegin; i < rowEnd; i++) {
+            parent.append(i);
+        }
+
+        // merge with the overlapping runs of the previous row
+        int j = prevRowBegin;
+        for (int i = rowBegin; i < rowEnd; i++) {
+            while (j < rowBegin && runs[j].end < runs[i].start) j++;
+
+            for (int k = j; k < rowBegin && runs[k].start <= runs[i].end; k++) {
+                const int rootI = findRoot(i);
+                const int rootK = findRoot(k);
+                if (rootI != rootK) {
+                    parent[qMax(rootI, rootK)] = qMin(rootI, rootK);
+                }
+            }
+        }
+
+        prevRowBegin = rowBegin;
+    }
+
+    rowOffsets[rect.height()] = runs.size();
+
+    int numComponents = 0;
+    QVector<int> rootComponent(runs.size(), -1);
+
+    for (int i = 0; i < runs.size(); i++) {
+        const int root = findRoot(i);
+        if (rootComponent[root] < 0) {
+            rootComponent[root] = numComponents++;
+        }
+        runs[i].component = rootComponent[root];
+    }
+
+    reachedComponents.fill(false, numComponents);
+
+    auto isBorderRun = [this] (const ParallelFillRun &run) {
+        return run.row == rect.top() || run.row == rect.bottom() ||
+            run.start == rect.left() || run.end == rect.right();
+    };
+
+    borderRunOffsets.fill(0, numComponents + 1);
+    for (int i = 0; i < runs.size(); i++) {
+        if (isBorderRun(runs[i])) {
+            borderRunOffsets[runs[i].component + 1]++;
+        }
+    }
+
+    for (int i = 0; i < numComponents; i++) {
+        borderRunOffsets[i + 1] += borderRunOffsets[i];
+    }
+
+    borderRuns.resize(borderRunOffsets[numComponents]);
+    QVector<int> fillPos(borderRunOffsets);
+
+    for (int i = 0; i < runs.size(); i++) {
+        if (isBorderRun(runs[i])) {
+            borderRuns[fillPos[runs[i].component]++] = i;
+        }
+    }
+}
+
+/**
+ * A request to fill the components of a tile overlapping the
+ * interval [start, end] of \p row
+ */
+struct ParallelFillSeed
+{
+    int tileIndex;
+    int row;
+    int start;
+    int end;
+};
+
+
 struct Q_DECL_HIDDEN KisScanlineFill::Private
 {
     KisPaintDeviceSP device;
@@ -352,6 +524,7 @@ struct Q_DECL_HIDDEN KisScanlineFill::Private
     QPoint startPoint;
     QRect boundingRect;
     int threshold;
+    bool useParallelFill;
 
     int rowIncrement;
     KisFillIntervalMap backwardMap;
@@ -381,6 +554,7 @@ KisScanlineFill::KisScanlineFill(KisPaintDeviceSP device, const QPoint &startPoi
     m_d->rowIncrement = 1;
 
     m_d->threshold = 0;
+    m_d->useParallelFill = false;
 }
 
 KisScanlineFill::~KisScanlineFill()
@@ -392,6 +566,11 @@ void KisScanlineFill::setThreshold(int threshold)
     m_d->threshold = threshold;
 }
 
+void KisScanlineFill::setUseParallelFill(bool value)
+{
+    m_d->useParallelFill = value;
+}
+
 template <class T>
 void KisScanlineFill::extendedPass(KisFillInterval *currentInterval, int srcRow, bool extendRight, T &pixelPolicy)
 {
@@ -549,6 +728,142 @@ void KisScanlineFill::runImpl(T &pixelPolicy)
     }
 }
 
+template <class PolicyFactory>
+void KisScanlineFill::runParallelImpl(PolicyFactory createPolicy)
+{
+    const int tileSize = 64;
+    const QRect &bounds = m_d->boundingRect;
+    const int pixelSize = m_d->device->pixelSize();
+
+    if (!bounds.contains(m_d->startPoint)) return;
+
+    const int originX = bounds.left() & ~(tileSize - 1);
+    const int originY = bounds.top() & ~(tileSize - 1);
+    const int numCols = (bounds.right() - originX) / tileSize + 1;
+    const int numRows = (bounds.bottom() - originY) / tileSize + 1;
+
+    QVector<ParallelFillTile> tiles(numCols * numRows);
+    ParallelFillTile *tilesPtr = tiles.data();
+
+    auto tileIndex = [=] (int x, int y) {
+        return ((y - originY) / tileSize) * numCols + (x - originX) / tileSize;
+    };
+
+    for (int row = 0; row < numRows; row++) {
+        for (int col = 0; col < numCols; col++) {
+            tilesPtr[row * numCols + col].rect =
+                QRect(originX + col * tileSize, originY + row * tileSize,
+                      tileSize, tileSize) & bounds;
+        }
+    }
+
+    auto labelTile = [&] (int index) {
+        auto policy = createPolicy();
+        tilesPtr[index].label(policy, pixelSize);
+    };
+
+    QVector<ParallelFillSeed> seeds;
+    seeds.append({tileIndex(m_d->startPoint.x(), m_d->startPoint.y()),
+                  m_d->startPoint.y(), m_d->startPoint.x(), m_d->startPoint.x()});
+
+    QVector<int> touchedTiles;
+
+    /**
+     * Grow the region wave by wave: the tiles hit by the seeds for
+     * the first time are labeled in parallel, then the seeds are
+     * applied and the newly reached components emit the seeds for
+     * the neighbouring tiles.
+     */
+    while (!seeds.isEmpty()) {
+        QVector<int> newTiles;
+
+        Q_FOREACH (const ParallelFillSeed &seed, seeds) {
+            ParallelFillTile &tile = tilesPtr[seed.tileIndex];
+            if (!tile.isLabeled) {
+                // the tile is labeled by the end of the wave
+                tile.isLabeled = true;
+                newTiles << seed.tileIndex;
+            }
+        }
+
+        KisSharedWorkerPool::blockingMap(newTiles, labelTile);
+        touchedTiles += newTiles;
+
+        QVector<ParallelFillSeed> nextSeeds;
+
+        Q_FOREACH (const ParallelFillSeed &seed, seeds) {
+            ParallelFillTile &tile = tilesPtr[seed.tileIndex];
+            const int rowIndex = seed.row - tile.rect.top();
+
+            for (int i = tile.rowOffsets[rowIndex]; i < tile.rowOffsets[rowIndex + 1]; i++) {
+                const ParallelFillRun &run = tile.runs[i];
+
+                if (run.end < seed.start) continue;
+                if (run.start > seed.end) break;
+                if (tile.reachedComponents[run.component]) continue;
+
+                tile.reachedComponents[run.component] = true;
+
+                for (int j = tile.borderRunOffsets[run.component];
+                     j < tile.borderRunOffsets[run.component + 1]; j++) {
+
+                    const ParallelFillRun &borderRun = tile.runs[tile.borderRuns[j]];
+
+                    if (borderRun.start == tile.rect.left() && borderRun.start > bounds.left()) {
+                        const int x = borderRun.start - 1;
+                        nextSeeds.append({tileIndex(x, borderRun.row), borderRun.row, x, x});
+                    }
+
+                    if (borderRun.end == tile.rect.right() && borderRun.end < bounds.right()) {
+                        const int x = borderRun.end + 1;
+                        nextSeeds.append({tileIndex(x, borderRun.row), borderRun.row, x, x});
+                    }
+
+                    if (borderRun.row == tile.rect.top() && borderRun.row > bounds.top()) {
+                        const int y = borderRun.row - 1;
+                        nextSeeds.append({tileIndex(borderRun.start, y), y, borderRun.start, borderRun.end});
+                    }
+
+                    if (borderRun.row == tile.rect.bottom() && borderRun.row < bounds.bottom()) {
+                        const int y = borderRun.row + 1;
+                        nextSeeds.append({tileIndex(borderRun.start, y), y, borderRun.start, borderRun.end});
+                    }
+                }
+            }
+        }
+
+        seeds.swap(nextSeeds);
+    }
+
+    auto fillTile = [&] (int index) {
+        const ParallelFillTile &tile = tilesPtr[index];
+
+        auto policy = createPolicy();
+
+        Q_FOREACH (const ParallelFillRun &run, tile.runs) {
+            if (!tile.reachedComponents[run.component]) continue;
+
+            int numPixelsLeft = 0;
+            quint8 *dataPtr = 0;
+
+            for (int x = run.start; x <= run.end; x++) {
+                if (numPixelsLeft <= 0) {
+                    policy.m_srcIt->moveTo(x, run.row);
+                    numPixelsLeft = policy.m_srcIt->numContiguousColumns(x) - 1;
+                    dataPtr = const_cast<quint8*>(policy.m_srcIt->rawDataConst());
+                } else {
+                    numPixelsLeft--;
+                    dataPtr += pixelSize;
+                }
+
+                policy.fillPixel(dataPtr, policy.calculateOpacity(dataPtr), x, run.row);
+            }
+        }
+    };
+
+    KisSharedWorkerPool::blockingMap(touchedTiles, fillTile);
+}
+
 void KisScanlineFill::fillColor(const KoColor &fillColor)
 {
     KisRandomConstAccessorSP it = m_d->device->createRandomConstAccessorNG(m_d->startPoint.x(), m_d->startPoint.y());
@@ -632,28 +947,34 @@ void KisScanlineFill::fillSelection(KisPixelSelectionSP pixelSelection)
     const int pixelSize = m_d->device->pixelSize();
 
     if (pixelSize == 1) {
-        SelectionPolicy<true, DifferencePolicyOptimized<quint8>, CopyToSelection>
-            policy(m_d->device, srcColor, m_d->threshold);
-        policy.setDestinationSelection(pixelSelection);
-        runImpl(policy);
+        fillSelectionImpl<DifferencePolicyOptimized<quint8>>(srcColor, pixelSelection);
     } else if (pixelSize == 2) {
-        SelectionPolicy<true, DifferencePolicyOptimized<quint16>, CopyToSelection>
-            policy(m_d->device, srcColor, m_d->threshold);
-        policy.setDestinationSelection(pixelSelection);
-        runImpl(policy);
+        fillSelectionImpl<DifferencePolicyOptimized<quint16>>(srcColor, pixelSelection);
     } else if (pixelSize == 4) {
-        SelectionPolicy<true, DifferencePolicyOptimized<quint32>, CopyToSelection>
-            policy(m_d->device, srcColor, m_d->threshold);
-        policy.setDestinationSelection(pixelSelection);
-        runImpl(policy);
+        fillSelectionImpl<DifferencePolicyOptimized<quint32>>(srcColor, pixelSelection);
     } else if (pixelSize == 8) {
-        SelectionPolicy<true, DifferencePolicyOptimized<quint64>, CopyToSelection>
-              policy(m_d->device, srcColor, m_d->threshold);
-        policy.setDestinationSelection(pixelSelection);
-        runImpl(policy);
+        fillSelectionImpl<DifferencePolicyOptimized<quint64>>(srcColor, pixelSelection);
     } else {
-        SelectionPolicy<true, DifferencePolicySlow, CopyToSelection>
-              policy(m_d->device, srcColor, m_d->threshold);
+        fillSelectionImpl<DifferencePolicySlow>(srcColor, pixelSelection);
+    }
+}
+
+template <class DifferencePolicy>
+void KisScanlineFill::fillSelectionImpl(const KoColor &srcColor, KisPixelSelectionSP pixelSelection)
+{
+    typedef SelectionPolicy<true, DifferencePolicy, CopyToSelection> Policy;
+
+    if (m_d->useParallelFill) {
+        // every thread needs its own accessors
+        auto createPolicy = [this, &srcColor, pixelSelection] () {
+            Policy policy(m_d->device, srcColor, m_d->threshold);
+            policy.setDestinationSelection(pixelSelection);
+            return policy;
+        };
+
+        runParallelImpl(createPolicy);
+    } else {
+        Policy policy(m_d->device, srcColor, m_d->threshold);
         policy.setDestinationSelection(pixelSelection);
         runImpl(policy);
     }
@@ -74,6 +74,17 @@ public:
      */
     void setThreshold(int threshold);
 
+    /**
+     * Use the tile-parallel algorithm in fillSelection(). The area is
+     * split into 64x64 tiles that are labeled concurrently, and the
+     * contiguous components are merged across the tile borders. The
+     * result is exactly the same as the one of the sequential fill.
+     *
+     * The parallel fill needs to label every tile the filled area
+     * touches, so it pays off on big areas only.
+     */
+    void setUseParallelFill(bool value);
+
 private:
     friend class KisScanlineFillTest;
     Q_DISABLE_COPY(KisScanlineFill)
@@ -88,6 +99,12 @@ private:
     template <class T>
     void runImpl(T &pixelPolicy);
 
+    template <class PolicyFactory>
+    void runParallelImpl(PolicyFactory createPolicy);
+
+    template <class DifferencePolicy>
+    void fillSelectionImpl(const KoColor &srcColor, KisPixelSelectionSP pixelSelection);
+
 private:
     void testingProcessLine(const KisFillInterval &processInterval);
     QVector<KisFillInterval> testingGetForwardIntervals() const;
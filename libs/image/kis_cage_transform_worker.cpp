@@ -22,12 +22,15 @@
 #include "kis_green_coordinates_math.h"
 
 #include <QPainter>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include "KoColor.h"
 #include "kis_selection.h"
 #include "kis_painter.h"
 #include "kis_image.h"
 #include "krita_utils.h"
+#include "KisSharedWorkerPool.h"
 
 #include <qnumeric.h>
 
@@ -67,6 +70,8 @@ struct Q_DECL_HIDDEN KisCageTransformWorker::Private
 
     QSize gridSize;
 
+    PreparedGridCacheSP gridCache;
+
     bool isGridEmpty() const {
         return allSrcPoints.isEmpty();
     }
@@ -75,9 +80,9 @@ struct Q_DECL_HIDDEN KisCageTransformWorker::Private
     QVector<QPointF> calculateTransformedPoints();
 
     inline QVector<int> calculateMappedIndexes(int col, int row,
-                                               int *numExistingPoints);
+                                               int *numExistingPoints) const;
 
-    int tryGetValidIndex(const QPoint &cellPt);
+    int tryGetValidIndex(const QPoint &cellPt) const;
 
     struct MapIndexesOp;
 };
@@ -110,6 +115,115 @@ void KisCageTransformWorker::setTransformedCage(const QVector<QPointF> &transfor
     m_d->transfCage = transformedCage;
 }
 
+namespace {
+
+/**
+ * The grid and its Green coordinates depend on the original cage and
+ * the source bounds only. While the user drags the handles of the
+ * cage, the tool creates a new worker for every update, but the
+ * original cage stays the same, so the prepared grid can be reused
+ * through the cache passed by the tool.
+ */
+struct PreparedCageGrid
+{
+    QVector<QPointF> origCage;
+    QRect srcBounds;
+    int pixelPrecision;
+
+    QSize gridSize;
+    QVector<QPointF> allSrcPoints;
+    QVector<int> allToValidPointsMap;
+    QVector<QPointF> validPoints;
+    KisGreenCoordinatesMath cage;
+};
+
+qint64 gridMemorySize(const PreparedCageGrid &grid)
+{
+    /**
+     * The Green coordinates take (2 * numCagePoints * sizeof(qreal))
+     * bytes per valid grid point, which is by far the biggest part
+     */
+    return qint64(grid.allSrcPoints.size()) * (sizeof(QPointF) + sizeof(int)) +
+        qint64(grid.validPoints.size()) * (sizeof(QPointF) + 2 * grid.origCage.size() * sizeof(qreal));
+}
+
+}
+
+struct KisCageTransformWorker::PreparedGridCache::Private
+{
+    Private(qint64 _maxMemory) : maxMemory(_maxMemory) {}
+
+    QMutex mutex;
+    QList<PreparedCageGrid> grids;
+    qint64 usedMemory = 0;
+    const qint64 maxMemory;
+
+    bool fetch(const QVector<QPointF> &origCage,
+               const QRect &srcBounds,
+               int pixelPrecision,
+               PreparedCageGrid *grid) {
+
+        QMutexLocker l(&mutex);
+
+        for (int i = 0; i < grids.size(); i++) {
+            const PreparedCageGrid &cached = grids[i];
+
+            if (cached.pixelPrecision == pixelPrecision &&
+                cached.srcBounds == srcBounds &&
+                cached.origCage == origCage) {
+
+                *grid = cached;
+                grids.move(i, 0);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void store(const PreparedCageGrid &grid) {
+        const qint64 size = gridMemorySize(grid);
+        if (size > maxMemory) return;
+
+        QMutexLocker l(&mutex);
+
+        grids.prepend(grid);
+        usedMemory += size;
+
+        while (usedMemory > maxMemory) {
+            usedMemory -= gridMemorySize(grids.last());
+            grids.removeLast();
+        }
+    }
+};
+
+KisCageTransformWorker::PreparedGridCache::PreparedGridCache(qint64 maxMemory)
+    : m_d(new Private(maxMemory))
+{
+}
+
+KisCageTransformWorker::PreparedGridCache::~PreparedGridCache()
+{
+}
+
+void KisCageTransformWorker::PreparedGridCache::clear()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->grids.clear();
+    m_d->usedMemory = 0;
+}
+
+qint64 KisCageTransformWorker::PreparedGridCache::memoryUsage() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->usedMemory;
+}
+
+void KisCageTransformWorker::setPreparedGridCache(PreparedGridCacheSP cache)
+{
+    m_d->gridCache = cache;
+}
+
 struct PointsFetcherOp
 {
     PointsFetcherOp(const QPolygonF &cagePolygon)
@@ -165,6 +279,19 @@ void KisCageTransformWorker::prepareTransform()
     // no need to process empty devices
     if (srcBounds.isEmpty()) return;
 
+    PreparedCageGrid grid;
+    if (m_d->gridCache &&
+        m_d->gridCache->m_d->fetch(m_d->origCage, srcBounds,
+                                   m_d->pixelPrecision, &grid)) {
+
+        m_d->gridSize = grid.gridSize;
+        m_d->allSrcPoints = grid.allSrcPoints;
+        m_d->allToValidPointsMap = grid.allToValidPointsMap;
+        m_d->validPoints = grid.validPoints;
+        m_d->cage = grid.cage;
+        return;
+    }
+
     m_d->gridSize =
         GridIterationTools::calcGridSize(srcBounds, m_d->pixelPrecision);
 
@@ -197,6 +324,19 @@ void KisCageTransformWorker::prepareTransform()
     }
 
     m_d->cage.precalculateGreenCoordinates(m_d->origCage, m_d->validPoints);
+
+    if (!m_d->gridCache) return;
+
+    grid.origCage = m_d->origCage;
+    grid.srcBounds = srcBounds;
+    grid.pixelPrecision = m_d->pixelPrecision;
+    grid.gridSize = m_d->gridSize;
+    grid.allSrcPoints = m_d->allSrcPoints;
+    grid.allToValidPointsMap = m_d->allToValidPointsMap;
+    grid.validPoints = m_d->validPoints;
+    grid.cage = m_d->cage;
+
+    m_d->gridCache->m_d->store(grid);
 }
 
 QVector<QPointF> KisCageTransformWorker::Private::calculateTransformedPoints()
@@ -205,24 +345,37 @@ QVector<QPointF> KisCageTransformWorker::Private::calculateTransformedPoints()
 
     const int numValidPoints = validPoints.size();
     QVector<QPointF> transformedPoints(numValidPoints);
+    QPointF *dstPoints = transformedPoints.data();
 
-    for (int i = 0; i < numValidPoints; i++) {
-        transformedPoints[i] = cage.transformedPoint(i, transfCage);
+    const int chunkSize = 1024;
 
-        if (qIsNaN(transformedPoints[i].x()) ||
-            qIsNaN(transformedPoints[i].y())) {
-            warnKrita << "WARNING: One grid point has been removed from consideration" << validPoints[i];
-            transformedPoints[i] = validPoints[i];
+    QVector<int> chunks;
+    for (int i = 0; i < numValidPoints; i += chunkSize) {
+        chunks << i;
+    }
+
+    auto processChunk = [&] (int chunkStart) {
+        const int chunkEnd = qMin(chunkStart + chunkSize, numValidPoints);
+
+        for (int i = chunkStart; i < chunkEnd; i++) {
+            dstPoints[i] = cage.transformedPoint(i, transfCage);
+
+            if (qIsNaN(dstPoints[i].x()) ||
+                qIsNaN(dstPoints[i].y())) {
+                warnKrita << "WARNING: One grid point has been removed from consideration" << validPoints.at(i);
+                dstPoints[i] = validPoints.at(i);
+            }
         }
+    };
 
-    }
+    KisSharedWorkerPool::blockingMap(chunks, processChunk);
 
     return transformedPoints;
 }
 
 inline QVector<int> KisCageTransformWorker::Private::
 calculateMappedIndexes(int col, int row,
-                       int *numExistingPoints)
+                       int *numExistingPoints) const
 {
     *numExistingPoints = 0;
     QVector<int> cellIndexes =
@@ -239,7 +392,7 @@ calculateMappedIndexes(int col, int row,
 
 
 int KisCageTransformWorker::Private::
-tryGetValidIndex(const QPoint &cellPt)
+tryGetValidIndex(const QPoint &cellPt) const
 {
     int index = -1;
     if (cellPt.x() >= 0 &&
@@ -256,7 +409,7 @@ tryGetValidIndex(const QPoint &cellPt)
 
 struct KisCageTransformWorker::Private::MapIndexesOp {
 
-    MapIndexesOp(KisCageTransformWorker::Private *d)
+    MapIndexesOp(const KisCageTransformWorker::Private *d)
         : m_d(d),
           m_srcCagePolygon(QPolygonF(m_d->origCage))
     {
@@ -280,7 +433,7 @@ struct KisCageTransformWorker::Private::MapIndexesOp {
         return m_srcCagePolygon;
     }
 
-    KisCageTransformWorker::Private *m_d;
+    const KisCageTransformWorker::Private *m_d;
     QPolygonF m_srcCagePolygon;
 };
 
@@ -369,10 +522,15 @@ void KisCageTransformWorker::run()
         m_d->dev->clearSelection(selection);
     }
 
-    GridIterationTools::PaintDevicePolygonOp polygonOp(srcDev, tempDevice);
+    auto createBandOp = [srcDev, tempDevice] (const QRect &bandRect) {
+        GridIterationTools::PaintDevicePolygonOp polygonOp(srcDev, tempDevice);
+        polygonOp.setDstClipRect(bandRect);
+        return polygonOp;
+    };
+
     Private::MapIndexesOp indexesOp(m_d.data());
-    GridIterationTools::iterateThroughGrid
-        <GridIterationTools::IncompletePolygonPolicy>(polygonOp, indexesOp,
+    GridIterationTools::iterateThroughGridInBands
+        <GridIterationTools::IncompletePolygonPolicy>(createBandOp, indexesOp,
                                                       m_d->gridSize,
                                                       m_d->validPoints,
                                                       transformedPoints);
@@ -431,10 +589,15 @@ QImage KisCageTransformWorker::runOnQImage(QPointF *newOffset)
         gc.end();
     }
 
-    GridIterationTools::QImagePolygonOp polygonOp(m_d->srcImage, tempImage, m_d->srcImageOffset, dstQImageOffset);
+    auto createBandOp = [this, &tempImage, dstQImageOffset] (const QRect &bandRect) {
+        GridIterationTools::QImagePolygonOp polygonOp(m_d->srcImage, tempImage, m_d->srcImageOffset, dstQImageOffset);
+        polygonOp.setDstClipRect(bandRect);
+        return polygonOp;
+    };
+
     Private::MapIndexesOp indexesOp(m_d.data());
-    GridIterationTools::iterateThroughGrid
-        <GridIterationTools::IncompletePolygonPolicy>(polygonOp, indexesOp,
+    GridIterationTools::iterateThroughGridInBands
+        <GridIterationTools::IncompletePolygonPolicy>(createBandOp, indexesOp,
                                                       m_d->gridSize,
                                                       m_d->validPoints,
                                                       transformedPoints);
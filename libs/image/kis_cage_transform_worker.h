@@ -20,6 +20,7 @@
 #define __KIS_CAGE_TRANSFORM_WORKER_H
 
 #include <QScopedPointer>
+#include <QSharedPointer>
 #include <kritaimage_export.h>
 #include <kis_types.h>
 
@@ -27,6 +28,31 @@ class QImage;
 
 class KRITAIMAGE_EXPORT KisCageTransformWorker
 {
+public:
+    /**
+     * Keeps the grids prepared by prepareTransform() for reuse by
+     * the next workers with the same original cage. The cache is
+     * owned by the client (e.g. the transform tool), which should
+     * clear it when the stroke is finished.
+     */
+    class KRITAIMAGE_EXPORT PreparedGridCache
+    {
+    public:
+        PreparedGridCache(qint64 maxMemory = 64 * 1024 * 1024);
+        ~PreparedGridCache();
+
+        void clear();
+        qint64 memoryUsage() const;
+
+    private:
+        friend class KisCageTransformWorker;
+
+        struct Private;
+        const QScopedPointer<Private> m_d;
+    };
+
+    typedef QSharedPointer<PreparedGridCache> PreparedGridCacheSP;
+
 public:
     KisCageTransformWorker(KisPaintDeviceSP dev,
                            const QVector<QPointF> &origCage,
@@ -50,6 +76,12 @@ public:
 
     QImage runOnQImage(QPointF *newOffset);
 
+    /**
+     * Sets the cache for the prepared grids. By default the worker
+     * doesn't cache anything.
+     */
+    void setPreparedGridCache(PreparedGridCacheSP cache);
+
 private:
     struct Private;
     const QScopedPointer<Private> m_d;
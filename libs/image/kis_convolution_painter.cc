@@ -63,13 +63,19 @@ bool KisConvolutionPainter::useFFTImplemenation(const KisConvolutionKernelSP ker
     bool result = false;
 
 #ifdef HAVE_FFTW3
-    #define THRESHOLD_SIZE 5
+    /**
+     * The spatial engine does one multiply-add per kernel item for every
+     * pixel, the FFT engine's cost per pixel depends on the block size only,
+     * so we just compare the two estimations.
+     */
+    const qreal spatialCostPerPixel = qreal(kernel->width()) * kernel->height();
+    const qreal fftCostPerPixel =
+        KisConvolutionWorkerFFTUtils::costPerPixel(kernel->width(), kernel->height());
 
     result =
         m_enginePreference == FFTW ||
         (m_enginePreference == NONE &&
-         kernel->width() > THRESHOLD_SIZE &&
-         kernel->height() > THRESHOLD_SIZE);
+         fftCostPerPixel < spatialCostPerPixel);
 #else
     Q_UNUSED(kernel);
 #endif
@@ -171,5 +177,11 @@ void KisConvolutionPainter::applyMatrix(const KisConvolutionKernelSP kernel, con
 
 bool KisConvolutionPainter::needsTransaction(const KisConvolutionKernelSP kernel) const
 {
-    return !useFFTImplemenation(kernel);
+    /**
+     * Both engines read the source device in chunks while writing the
+     * result (the FFT engine processes the area block-by-block), so
+     * in-place convolution always needs the old data to be preserved.
+     */
+    Q_UNUSED(kernel);
+    return true;
 }
@@ -26,9 +26,14 @@
 
 #include "kis_convolution_worker.h"
 #include "kis_math_toolbox.h"
+#include "KisSharedWorkerPool.h"
 
 #include <QMutex>
+#include <QMutexLocker>
 #include <QVector>
+#include <QSharedPointer>
+
+#include <cmath>
 #include <QTextStream>
 #include <QFile>
 #include <QDir>
@@ -41,10 +46,150 @@ class KisConvolutionWorkerFFTLock
 private:
     static QMutex fftwMutex;
     template<class _IteratorFactory_> friend class KisConvolutionWorkerFFT;
+    friend class KisConvolutionWorkerFFTPlanCache;
 };
 
 QMutex KisConvolutionWorkerFFTLock::fftwMutex;
 
+/**
+ * A pair of forward and backward in-place plans for a block of the
+ * specified size. The plans are executed with the new-array execute
+ * functions of FFTW, which are thread-safe, so one pair of plans can be
+ * shared by all the threads processing blocks of the same size.
+ */
+struct KisConvolutionWorkerFFTPlans
+{
+    KisConvolutionWorkerFFTPlans(int width, int height)
+    {
+        const int length = height * (width / 2 + 1);
+        fftw_complex *buffer = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * length);
+
+        forward = fftw_plan_dft_r2c_2d(height, width, (double*)buffer, buffer, FFTW_ESTIMATE);
+        backward = fftw_plan_dft_c2r_2d(height, width, buffer, (double*)buffer, FFTW_ESTIMATE);
+
+        fftw_free(buffer);
+    }
+
+    ~KisConvolutionWorkerFFTPlans()
+    {
+        fftw_destroy_plan(forward);
+        fftw_destroy_plan(backward);
+    }
+
+    fftw_plan forward;
+    fftw_plan backward;
+};
+
+typedef QSharedPointer<KisConvolutionWorkerFFTPlans> KisConvolutionWorkerFFTPlansSP;
+
+/**
+ * Keeps the plans for the recently used block sizes. Planning in FFTW
+ * is not thread-safe, so all the plans are created and destroyed under
+ * the global FFTW lock.
+ */
+class KisConvolutionWorkerFFTPlanCache
+{
+public:
+    static KisConvolutionWorkerFFTPlansSP fetchPlans(const QSize &size) {
+        QMutexLocker locker(&KisConvolutionWorkerFFTLock::fftwMutex);
+
+        static QList<QPair<QSize, KisConvolutionWorkerFFTPlansSP>> cache;
+        static const int maxCachedPlans = 8;
+
+        for (auto it = cache.begin(); it != cache.end(); ++it) {
+            if (it->first == size) {
+                return it->second;
+            }
+        }
+
+        KisConvolutionWorkerFFTPlansSP plans = createPlansUnlocked(size);
+
+        cache.prepend(qMakePair(size, plans));
+
+        /**
+         * The evicted plans may still be used by other threads, so we only
+         * drop our reference here. The plans will be destroyed together with
+         * the last reference to them.
+         */
+        QList<KisConvolutionWorkerFFTPlansSP> evicted;
+        while (cache.size() > maxCachedPlans) {
+            evicted << cache.takeLast().second;
+        }
+
+        locker.unlock();
+        evicted.clear();
+
+        return plans;
+    }
+
+    /**
+     * Creates plans that are not stored in the cache, e.g. for the
+     * areas that are small enough to be convolved in one go
+     */
+    static KisConvolutionWorkerFFTPlansSP createPlans(const QSize &size) {
+        QMutexLocker locker(&KisConvolutionWorkerFFTLock::fftwMutex);
+        return createPlansUnlocked(size);
+    }
+
+private:
+    static KisConvolutionWorkerFFTPlansSP createPlansUnlocked(const QSize &size) {
+        return KisConvolutionWorkerFFTPlansSP(
+            new KisConvolutionWorkerFFTPlans(size.width(), size.height()),
+            &KisConvolutionWorkerFFTPlanCache::destroyPlans);
+    }
+
+    static void destroyPlans(KisConvolutionWorkerFFTPlans *plans) {
+        QMutexLocker locker(&KisConvolutionWorkerFFTLock::fftwMutex);
+        delete plans;
+    }
+};
+
+/**
+ * Helpers for the overlap-save convolution: the area is split into
+ * blocks, each block is convolved separately and only the part of the
+ * block unaffected by the circular wrapping is written back.
+ */
+namespace KisConvolutionWorkerFFTUtils
+{
+    /**
+     * The size of the FFT block for the kernel dimension. The block is at
+     * least twice as big as the kernel, so that at least a half of every
+     * block produces useful output.
+     */
+    inline int blockDimension(int kernelDimension) {
+        const int minBlockDimension = 256;
+
+        int dimension = minBlockDimension;
+        while (dimension < 2 * (kernelDimension - 1)) {
+            dimension *= 2;
+        }
+        return dimension;
+    }
+
+    inline QSize blockSize(int kernelWidth, int kernelHeight) {
+        return QSize(blockDimension(kernelWidth), blockDimension(kernelHeight));
+    }
+
+    /**
+     * Approximate cost of convolving one output pixel with the FFT engine
+     * measured in "multiply-add operations" of the spatial engine. The cost
+     * consists of the forward and backward transforms of the block (which
+     * are amortized over the useful part of the block) plus some constant
+     * overhead for filling the block and writing the result back.
+     */
+    inline qreal costPerPixel(int kernelWidth, int kernelHeight) {
+        const QSize block = blockSize(kernelWidth, kernelHeight);
+        const qreal blockArea = qreal(block.width()) * block.height();
+        const qreal usefulArea =
+            qreal(block.width() - kernelWidth + 1) * (block.height() - kernelHeight + 1);
+
+        const qreal transformsCost = 2.0 * std::log2(blockArea);
+        const qreal constantOverhead = 8.0;
+
+        return transformsCost * blockArea / usefulArea + constantOverhead;
+    }
+}
+
 
 template<class _IteratorFactory_>
 class KisConvolutionWorkerFFT : public KisConvolutionWorker<_IteratorFactory_>
@@ -82,15 +227,40 @@ public:
         const quint32 halfKernelWidth = (kernel->width() - 1) / 2;
         const quint32 halfKernelHeight = (kernel->height() - 1) / 2;
 
-        m_fftWidth = areaSize.width() + 4 * halfKernelWidth;
-        m_fftHeight = areaSize.height() + 2 * halfKernelHeight;
+        /**
+         * For even-sized kernels the center is shifted, so the block should
+         * have one more pixel of the source data on the left/top side
+         */
+        const int leftPadding = kernel->width() - 1 - halfKernelWidth;
+        const int topPadding = kernel->height() - 1 - halfKernelHeight;
 
         /**
-         * FIXME: check whether this "optimization" is needed to
-         * be uncommented. My tests showed about 30% better performance
-         * when the line is commented out (DK).
+         * We use overlap-save method: the area is split into blocks of
+         * fixed size, which are convolved independently and in parallel.
+         * It keeps the memory consumption bounded for big areas and lets
+         * us reuse the FFTW plans, since all the blocks have the same size.
+         *
+         * If the whole area fits into a single block, we just convolve
+         * it in one go.
          */
-        //optimumDimensions(m_fftWidth, m_fftHeight);
+        const QSize blockSize = KisConvolutionWorkerFFTUtils::blockSize(kernel->width(), kernel->height());
+        const QSize paddedAreaSize(areaSize.width() + kernel->width() - 1,
+                                   areaSize.height() + kernel->height() - 1);
+
+        KisConvolutionWorkerFFTPlansSP plans;
+
+        if (paddedAreaSize.width() <= blockSize.width() &&
+            paddedAreaSize.height() <= blockSize.height()) {
+
+            m_fftWidth = paddedAreaSize.width();
+            m_fftHeight = paddedAreaSize.height();
+
+            plans = KisConvolutionWorkerFFTPlanCache::createPlans(paddedAreaSize);
+        } else {
+            m_fftWidth = blockSize.width();
+            m_fftHeight = blockSize.height();
+            plans = KisConvolutionWorkerFFTPlanCache::fetchPlans(blockSize);
+        }
 
         m_fftLength = m_fftHeight * (m_fftWidth / 2 + 1);
         m_extraMem = (m_fftWidth % 2) ? 1 : 2;
@@ -100,68 +270,78 @@ public:
         memset(m_kernelFFT, 0, sizeof(fftw_complex) * m_fftLength);
         fftFillKernelMatrix(kernel, m_kernelFFT);
 
+        fftw_execute_dft_r2c(plans->forward, (double*)m_kernelFFT, m_kernelFFT);
+
+        addToProgress(10);
+        if (isInterrupted()) return;
+
         // find out which channels need convolving
         QList<KoChannelInfo*> convChannelList = this->convolvableChannelList(src);
 
-        m_channelFFT.resize(convChannelList.count());
-        for (auto i = m_channelFFT.begin(); i != m_channelFFT.end(); ++i) {
-            *i = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * m_fftLength);
-        }
-
         const double kernelFactor = kernel->factor() ? kernel->factor() : 1;
         const double fftScale = 1.0 / (m_fftHeight * m_fftWidth) / kernelFactor;
 
         FFTInfo info (fftScale, convChannelList, kernel, this->m_painter->device()->colorSpace());
-        int cacheRowStride = m_fftWidth + m_extraMem;
 
-        fillCacheFromDevice(src,
-                            QRect(srcPos.x() - halfKernelWidth,
-                                  srcPos.y() - halfKernelHeight,
-                                  m_fftWidth,
-                                  m_fftHeight),
-                            cacheRowStride,
-                            info, dataRect);
+        const int usefulBlockWidth = m_fftWidth - kernel->width() + 1;
+        const int usefulBlockHeight = m_fftHeight - kernel->height() + 1;
 
-        addToProgress(10);
-        if (isInterrupted()) return;
+        QVector<QRect> blocks;
+        for (int y = 0; y < areaSize.height(); y += usefulBlockHeight) {
+            for (int x = 0; x < areaSize.width(); x += usefulBlockWidth) {
+                blocks << QRect(x, y,
+                                qMin(usefulBlockWidth, areaSize.width() - x),
+                                qMin(usefulBlockHeight, areaSize.height() - y));
+            }
+        }
 
-        // calculate number off fft operations required for progress reporting
-        const float progressPerFFT = (100 - 30) / (double)(convChannelList.count() * 2 + 1);
+        const qreal progressPerBlock = (100 - 30) / qreal(blocks.size());
+        QMutex progressMutex;
 
-        // perform FFT
-        fftw_plan fftwPlanForward, fftwPlanBackward;
+        auto processBlock = [&] (const QRect &block) {
+            if (this->m_progress && this->m_progress->interrupted()) return;
 
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
-        fftwPlanForward = fftw_plan_dft_r2c_2d(m_fftHeight, m_fftWidth, (double*)m_kernelFFT, m_kernelFFT, FFTW_ESTIMATE);
-        fftwPlanBackward = fftw_plan_dft_c2r_2d(m_fftHeight, m_fftWidth, m_kernelFFT, (double*)m_kernelFFT, FFTW_ESTIMATE);
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
+            QVector<fftw_complex*> channelFFT(info.numChannels());
+            for (auto it = channelFFT.begin(); it != channelFFT.end(); ++it) {
+                *it = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * m_fftLength);
+                memset(*it, 0, sizeof(fftw_complex) * m_fftLength);
+            }
 
-        fftw_execute(fftwPlanForward);
-        addToProgress(progressPerFFT);
-        if (isInterrupted()) return;
+            const int cacheRowStride = m_fftWidth + m_extraMem;
 
-        for (auto k = m_channelFFT.begin(); k != m_channelFFT.end(); ++k)
-        {
-            fftw_execute_dft_r2c(fftwPlanForward, (double*)(*k), *k);
-            addToProgress(progressPerFFT);
-            if (isInterrupted()) return;
+            fillCacheFromDevice(src,
+                                QRect(srcPos.x() + block.x() - leftPadding,
+                                      srcPos.y() + block.y() - topPadding,
+                                      block.width() + kernel->width() - 1,
+                                      block.height() + kernel->height() - 1),
+                                cacheRowStride,
+                                info, dataRect, channelFFT);
 
-            fftMultiply(*k, m_kernelFFT);
+            Q_FOREACH (fftw_complex *channel, channelFFT) {
+                fftw_execute_dft_r2c(plans->forward, (double*)channel, channel);
+                fftMultiply(channel, m_kernelFFT);
+                fftw_execute_dft_c2r(plans->backward, channel, (double*)channel);
+            }
 
-            fftw_execute_dft_c2r(fftwPlanBackward, *k, (double*)*k);
-            addToProgress(progressPerFFT);
-            if (isInterrupted()) return;
-        }
+            writeResultToDevice(QRect(dstPos + block.topLeft(), block.size()),
+                                cacheRowStride, leftPadding, topPadding,
+                                info, dataRect, channelFFT);
 
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
-        fftw_destroy_plan(fftwPlanForward);
-        fftw_destroy_plan(fftwPlanBackward);
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
+            Q_FOREACH (fftw_complex *channel, channelFFT) {
+                fftw_free(channel);
+            }
 
+            QMutexLocker locker(&progressMutex);
+            addToProgress(progressPerBlock);
+        };
 
-        writeResultToDevice(QRect(dstPos.x(), dstPos.y(), areaSize.width(), areaSize.height()),
-                            cacheRowStride, halfKernelWidth, halfKernelHeight,
-                            info, dataRect);
+        KisSharedWorkerPool::blockingMap(blocks, processBlock,
+                                         [this] () {
+                                             return this->m_progress &&
+                                                 this->m_progress->interrupted();
+                                         });
+
+        if (isInterrupted()) return;
 
         addToProgress(20);
         cleanUp();
@@ -222,7 +402,8 @@ public:
                              const QRect &rect,
                              const int cacheRowStride,
                              const FFTInfo &info,
-                             const QRect &dataRect) {
+                             const QRect &dataRect,
+                             const QVector<fftw_complex*> &channelFFT) {
 
         typename _IteratorFactory_::HLineConstIterator hitSrc =
             _IteratorFactory_::createHLineConstIterator(src,
@@ -234,7 +415,7 @@ public:
         const auto channelPtrBegin = channelPtr.begin();
         const auto channelPtrEnd = channelPtr.end();
 
-        auto iFFt = m_channelFFT.constBegin();
+        auto iFFt = channelFFT.constBegin();
         for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++iFFt) {
             *i = (double*)*iFFt;
         }
@@ -310,24 +491,25 @@ public:
 
     void writeResultToDevice(const QRect &rect,
                              const int cacheRowStride,
-                             const int halfKernelWidth,
-                             const int halfKernelHeight,
+                             const int leftPadding,
+                             const int topPadding,
                              const FFTInfo &info,
-                             const QRect &dataRect) {
+                             const QRect &dataRect,
+                             const QVector<fftw_complex*> &channelFFT) {
 
         typename _IteratorFactory_::HLineIterator hitDst =
             _IteratorFactory_::createHLineIterator(this->m_painter->device(),
                                                    rect.x(), rect.y(), rect.width(),
                                                    dataRect);
 
-        int initialOffset = cacheRowStride * halfKernelHeight + halfKernelWidth;
+        int initialOffset = cacheRowStride * topPadding + leftPadding;
 
         const int channelCount = info.numChannels();
         QVector<double*> channelPtr(channelCount);
         const auto channelPtrBegin = channelPtr.begin();
         const auto channelPtrEnd = channelPtr.end();
 
-        auto iFFt = m_channelFFT.constBegin();
+        auto iFFt = channelFFT.constBegin();
         for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++iFFt) {
             *i = (double*)*iFFt + initialOffset;
         }
@@ -523,19 +705,15 @@ private:
         // free kernel fft data
         if (m_kernelFFT) {
             fftw_free(m_kernelFFT);
+            m_kernelFFT = 0;
         }
-
-        Q_FOREACH (fftw_complex *channel, m_channelFFT) {
-            fftw_free(channel);
-        }
-        m_channelFFT.clear();
     }
+
 private:
     quint32 m_fftWidth, m_fftHeight, m_fftLength, m_extraMem;
     float m_currentProgress;
 
     fftw_complex* m_kernelFFT;
-    QVector<fftw_complex*> m_channelFFT;
 };
 
 #endif
@@ -49,6 +49,7 @@
 #include "kis_paint_device.h"
 #include <resources/KoPattern.h>
 #include "KoColorSpace.h"
+#include <KoColor.h>
 #include "kis_transaction.h"
 #include "kis_pixel_selection.h"
 #include <KoCompositeOpRegistry.h>
@@ -303,8 +304,35 @@ KisSelectionSP KisFillPainter::createFloodSelection(int startX, int startY, KisP
         return selection;
     }
 
+    /**
+     * The parallel fill has to label every tile the filled area
+     * touches, so it is used for big areas only. The area cannot spread
+     * beyond the fill bounds and, unless it can leak into the default
+     * pixels of the device, beyond its extent.
+     */
+    QRect maxFilledRect = fillBoundsRect;
+
+    const QRect extent = sourceDevice->extent();
+    if (extent.contains(startPoint)) {
+        KoColor startColor;
+        sourceDevice->pixel(startX, startY, &startColor);
+        const KoColor defaultColor = sourceDevice->defaultPixel();
+
+        const quint8 difference =
+            sourceDevice->colorSpace()->difference(startColor.data(), defaultColor.data());
+
+        if (difference > m_threshold) {
+            maxFilledRect &= extent;
+        }
+    }
+
+    const qint64 parallelFillAreaThreshold = 512 * 512;
+    const bool useParallelFill =
+        qint64(maxFilledRect.width()) * maxFilledRect.height() >= parallelFillAreaThreshold;
+
     KisScanlineFill gc(sourceDevice, startPoint, fillBoundsRect);
     gc.setThreshold(m_threshold);
+    gc.setUseParallelFill(useParallelFill);
     gc.fillSelection(pixelSelection);
 
     if (m_sizemod > 0) {
@@ -22,7 +22,20 @@
 #include "kis_convolution_kernel.h"
 #include <kis_convolution_painter.h>
 #include <kis_transaction.h>
+#include <kis_paint_device.h>
+#include <kis_default_bounds_base.h>
+#include <kis_iterator_ng.h>
+#include <kis_repeat_iterators_pixel.h>
+#include <kis_math_toolbox.h>
+#include <KoColorSpace.h>
+#include <KoChannelInfo.h>
+#include <KoUpdater.h>
 #include <QRect>
+#include <QBitArray>
+#include <QVarLengthArray>
+
+#include <cmath>
+#include <limits>
 
 
 qreal KisGaussianKernel::sigmaFromRadius(qreal radius)
@@ -100,6 +113,284 @@ KisGaussianKernel::createVerticalKernel(qreal radius)
     return KisConvolutionKernel::fromMatrix(matrix, 0, matrix.sum());
 }
 
+
+namespace {
+
+/**
+ * Above this radius the gaussian is approximated with a cascade of
+ * box blurs. The reference kernel is still used for smaller radii,
+ * where it is cheap enough and its exact shape is well visible.
+ */
+const qreal boxCascadeRadiusThreshold = 32.0;
+
+/**
+ * Returns the radii of three box blurs, whose composition has the
+ * same variance as a gaussian with \p sigma
+ */
+QVector<int> boxRadiiForGaussian(qreal sigma)
+{
+    const int numBoxes = 3;
+    const qreal variance12 = 12.0 * sigma * sigma;
+
+    int lowerWidth = std::floor(std::sqrt(variance12 / numBoxes + 1.0));
+    if (!(lowerWidth & 0x1)) {
+        lowerWidth--;
+    }
+    const int upperWidth = lowerWidth + 2;
+
+    const int numLower =
+        qRound((variance12 - numBoxes * lowerWidth * lowerWidth
+                - 4 * numBoxes * lowerWidth - 3 * numBoxes) /
+               (-4.0 * lowerWidth - 4.0));
+
+    QVector<int> radii;
+    for (int i = 0; i < numBoxes; i++) {
+        radii << ((i < numLower ? lowerWidth : upperWidth) - 1) / 2;
+    }
+    return radii;
+}
+
+/**
+ * Box blur of \p length steps of \p stepSize floats each. When a step
+ * is a pixel, all its channels are averaged in the same inner loop;
+ * when a step is a whole row, the line is blurred vertically. Either
+ * way the running sum makes the cost independent of \p radius.
+ *
+ * The edge steps are repeated, the callers keep enough margins in the
+ * buffer for the edge values not to reach the result.
+ */
+void boxBlurLine(const float *src, float *dst, int length, int stepSize, int radius)
+{
+    const float scale = 1.0f / (2 * radius + 1);
+    QVarLengthArray<double, 16> sum(stepSize);
+
+    for (int c = 0; c < stepSize; c++) {
+        sum[c] = (radius + 1) * src[c];
+    }
+
+    for (int i = 1; i <= radius; i++) {
+        const float *ptr = src + qMin(i, length - 1) * stepSize;
+        for (int c = 0; c < stepSize; c++) {
+            sum[c] += ptr[c];
+        }
+    }
+
+    for (int i = 0; i < length; i++) {
+        float *dstPtr = dst + i * stepSize;
+        for (int c = 0; c < stepSize; c++) {
+            dstPtr[c] = sum[c] * scale;
+        }
+
+        const float *addPtr = src + qMin(i + radius + 1, length - 1) * stepSize;
+        const float *subPtr = src + qMax(i - radius, 0) * stepSize;
+        for (int c = 0; c < stepSize; c++) {
+            sum[c] += addPtr[c] - subPtr[c];
+        }
+    }
+}
+
+/**
+ * Gaussian blur which takes constant time per pixel. Every pass is
+ * done with three box blurs over a float buffer holding premultiplied
+ * channels, selected by the channel flags, interleaved per pixel.
+ * The edges are handled the same way as BORDER_REPEAT of
+ * KisConvolutionPainter.
+ */
+class BoxCascadeBlur
+{
+public:
+    BoxCascadeBlur(const KoColorSpace *cs, const QBitArray &channelFlags)
+        : m_alphaCachePos(-1)
+    {
+        const QList<KoChannelInfo*> channels = cs->channels();
+        for (int i = 0; i < channels.size(); i++) {
+            if (channelFlags.isEmpty() || channelFlags.testBit(i)) {
+                if (channels[i]->channelType() == KoChannelInfo::ALPHA) {
+                    m_alphaCachePos = m_channels.size();
+                }
+                m_channels.append(channels[i]);
+            }
+        }
+
+        KisMathToolbox mathToolbox;
+        m_toDouble.resize(m_channels.size());
+        m_fromDouble.resize(m_channels.size());
+        bool result = mathToolbox.getToDoubleChannelPtr(m_channels, m_toDouble);
+        result &= mathToolbox.getFromDoubleChannelPtr(m_channels, m_fromDouble);
+        KIS_ASSERT_RECOVER_NOOP(result);
+
+        for (int i = 0; i < m_channels.size(); i++) {
+            m_minClamp.append(mathToolbox.minChannelValue(m_channels[i]));
+            m_maxClamp.append(mathToolbox.maxChannelValue(m_channels[i]));
+        }
+    }
+
+    /**
+     * Blurs every row of \p rect of \p src horizontally and writes
+     * it into \p dst. The rows are read completely before writing, so
+     * \p src and \p dst may be the same device.
+     */
+    void blurHorizontal(KisPaintDeviceSP src, KisPaintDeviceSP dst,
+                        const QRect &rect, qreal radius,
+                        KoUpdater *progressUpdater)
+    {
+        const QVector<int> radii = boxRadiiForGaussian(KisGaussianKernel::sigmaFromRadius(radius));
+        const int padding = totalRadius(radii);
+        const int numChannels = m_channels.size();
+        const int length = rect.width() + 2 * padding;
+        const QRect dataRect = rect | src->exactBounds();
+
+        QVector<float> buffer(length * numChannels);
+        QVector<float> temp(length * numChannels);
+
+        KisRepeatHLineConstIteratorSP srcIt =
+            src->createRepeatHLineConstIterator(rect.x() - padding, rect.y(), length, dataRect);
+        KisHLineIteratorSP dstIt =
+            dst->createHLineIteratorNG(rect.x(), rect.y(), rect.width());
+
+        for (int y = 0; y < rect.height(); y++) {
+            float *bufferPtr = buffer.data();
+            for (int x = 0; x < length; x++) {
+                readPixel(srcIt->oldRawData(), bufferPtr);
+                bufferPtr += numChannels;
+                srcIt->nextPixel();
+            }
+
+            boxBlurCascade(buffer, temp, length, numChannels, radii);
+
+            bufferPtr = buffer.data() + padding * numChannels;
+            do {
+                writePixel(bufferPtr, dstIt->rawData());
+                bufferPtr += numChannels;
+            } while (dstIt->nextPixel());
+
+            srcIt->nextRow();
+            dstIt->nextRow();
+
+            if (!reportProgress(progressUpdater, y + 1, rect.height())) break;
+        }
+    }
+
+    /**
+     * Blurs \p rect of \p src vertically and writes it into \p dst.
+     * The rect is processed in column strips to keep the buffer small.
+     */
+    void blurVertical(KisPaintDeviceSP src, KisPaintDeviceSP dst,
+                      const QRect &rect, qreal radius,
+                      KoUpdater *progressUpdater)
+    {
+        const QVector<int> radii = boxRadiiForGaussian(KisGaussianKernel::sigmaFromRadius(radius));
+        const int padding = totalRadius(radii);
+        const int numChannels = m_channels.size();
+        const int length = rect.height() + 2 * padding;
+        const QRect dataRect = rect | src->exactBounds();
+        const int stripWidth = 64;
+
+        QVector<float> buffer(length * stripWidth * numChannels);
+        QVector<float> temp(length * stripWidth * numChannels);
+
+        for (int stripX = rect.x(); stripX <= rect.right(); stripX += stripWidth) {
+            const int width = qMin(stripWidth, rect.right() - stripX + 1);
+            const int rowSize = width * numChannels;
+
+            KisRepeatHLineConstIteratorSP srcIt =
+                src->createRepeatHLineConstIterator(stripX, rect.y() - padding, width, dataRect);
+
+            float *bufferPtr = buffer.data();
+            for (int y = 0; y < length; y++) {
+                for (int x = 0; x < width; x++) {
+                    readPixel(srcIt->oldRawData(), bufferPtr);
+                    bufferPtr += numChannels;
+                    srcIt->nextPixel();
+                }
+                srcIt->nextRow();
+            }
+
+            boxBlurCascade(buffer, temp, length, rowSize, radii);
+
+            KisHLineIteratorSP dstIt = dst->createHLineIteratorNG(stripX, rect.y(), width);
+
+            bufferPtr = buffer.data() + padding * rowSize;
+            for (int y = 0; y < rect.height(); y++) {
+                do {
+                    writePixel(bufferPtr, dstIt->rawData());
+                    bufferPtr += numChannels;
+                } while (dstIt->nextPixel());
+                dstIt->nextRow();
+            }
+
+            if (!reportProgress(progressUpdater, stripX + width - rect.x(), rect.width())) break;
+        }
+    }
+
+private:
+    static int totalRadius(const QVector<int> &radii) {
+        int result = 0;
+        Q_FOREACH (int radius, radii) {
+            result += radius;
+        }
+        return result;
+    }
+
+    static void boxBlurCascade(QVector<float> &buffer, QVector<float> &temp,
+                               int length, int stepSize,
+                               const QVector<int> &radii)
+    {
+        Q_FOREACH (int radius, radii) {
+            if (radius <= 0) continue;
+            boxBlurLine(buffer.constData(), temp.data(), length, stepSize, radius);
+            buffer.swap(temp);
+        }
+    }
+
+    static bool reportProgress(KoUpdater *progressUpdater, int done, int total) {
+        if (!progressUpdater) return true;
+
+        progressUpdater->setProgress(100 * done / total);
+        return !progressUpdater->interrupted();
+    }
+
+    inline void readPixel(const quint8 *src, float *dst) const {
+        const float alpha = m_alphaCachePos >= 0 ?
+            m_toDouble[m_alphaCachePos](src, m_channels[m_alphaCachePos]->pos()) : 1.0;
+
+        for (int k = 0; k < m_channels.size(); k++) {
+            dst[k] = k != m_alphaCachePos ?
+                m_toDouble[k](src, m_channels[k]->pos()) * alpha : alpha;
+        }
+    }
+
+    inline void writePixel(const float *src, quint8 *dst) const {
+        qreal alphaInv = 1.0;
+
+        if (m_alphaCachePos >= 0) {
+            const qreal alpha = qBound(m_minClamp[m_alphaCachePos],
+                                       qreal(src[m_alphaCachePos]),
+                                       m_maxClamp[m_alphaCachePos]);
+            m_fromDouble[m_alphaCachePos](dst, m_channels[m_alphaCachePos]->pos(), alpha);
+
+            alphaInv = alpha > std::numeric_limits<qreal>::epsilon() ? 1.0 / alpha : 0.0;
+        }
+
+        for (int k = 0; k < m_channels.size(); k++) {
+            if (k == m_alphaCachePos) continue;
+
+            const qreal value = qBound(m_minClamp[k], src[k] * alphaInv, m_maxClamp[k]);
+            m_fromDouble[k](dst, m_channels[k]->pos(), value);
+        }
+    }
+
+private:
+    QList<KoChannelInfo*> m_channels;
+    int m_alphaCachePos;
+    QVector<PtrToDouble> m_toDouble;
+    QVector<PtrFromDouble> m_fromDouble;
+    QVector<qreal> m_minClamp;
+    QVector<qreal> m_maxClamp;
+};
+
+}
+
 void KisGaussianKernel::applyGaussian(KisPaintDeviceSP device,
                                       const QRect& rect,
                                       qreal xRadius, qreal yRadius,
@@ -109,7 +400,47 @@ void KisGaussianKernel::applyGaussian(KisPaintDeviceSP device,
 {
     QPoint srcTopLeft = rect.topLeft();
 
-    if (xRadius > 0.0 && yRadius > 0.0) {
+    /**
+     * The box cascade reads the pixels through repeat iterators, which
+     * clamp the coordinates to the data rect. In wrap-around mode the
+     * edges should see the pixels of the opposite side, which only the
+     * convolution painter handles.
+     */
+    const bool useBoxCascade =
+        !device->defaultBounds()->wrapAroundMode() &&
+        (xRadius > 0.0 || yRadius > 0.0) &&
+        (xRadius <= 0.0 || xRadius > boxCascadeRadiusThreshold) &&
+        (yRadius <= 0.0 || yRadius > boxCascadeRadiusThreshold);
+
+    if (useBoxCascade) {
+        BoxCascadeBlur blur(device->colorSpace(), channelFlags);
+
+        if (xRadius > 0.0 && yRadius > 0.0) {
+            const int verticalPadding = std::ceil(qreal(kernelSizeFromRadius(yRadius)) / 2.0);
+            const QRect intermRect = rect.adjusted(0, -verticalPadding, 0, verticalPadding);
+
+            KisPaintDeviceSP interm = new KisPaintDevice(device->colorSpace());
+            blur.blurHorizontal(device, interm, intermRect, xRadius, progressUpdater);
+            blur.blurVertical(interm, device, rect, yRadius, progressUpdater);
+        } else {
+            /**
+             * The neighbouring pixels are read with oldRawData(), so an
+             * in-place pass needs a transaction, like the convolution
+             * painter does
+             */
+            QScopedPointer<KisTransaction> transaction;
+            if (createTransaction) {
+                transaction.reset(new KisTransaction(device));
+            }
+
+            if (xRadius > 0.0) {
+                blur.blurHorizontal(device, device, rect, xRadius, progressUpdater);
+            } else {
+                blur.blurVertical(device, device, rect, yRadius, progressUpdater);
+            }
+        }
+
+    } else if (xRadius > 0.0 && yRadius > 0.0) {
         KisPaintDeviceSP interm = new KisPaintDevice(device->colorSpace());
 
         KisConvolutionKernelSP kernelHoriz = KisGaussianKernel::createHorizontalKernel(xRadius);
@@ -21,6 +21,7 @@
 #include <cmath>
 #include <kis_global.h>
 #include <kis_algebra_2d.h>
+#include <KisSharedWorkerPool.h>
 using namespace KisAlgebra2D;
 
 
@@ -133,6 +134,17 @@ KisGreenCoordinatesMath::~KisGreenCoordinatesMath()
 {
 }
 
+KisGreenCoordinatesMath::KisGreenCoordinatesMath(const KisGreenCoordinatesMath &rhs)
+    : m_d(new Private(*rhs.m_d))
+{
+}
+
+KisGreenCoordinatesMath& KisGreenCoordinatesMath::operator=(const KisGreenCoordinatesMath &rhs)
+{
+    *m_d = *rhs.m_d;
+    return *this;
+}
+
 void KisGreenCoordinatesMath::precalculateGreenCoordinates(const QVector<QPointF> &originalCage, const QVector<QPointF> &points)
 {
     const int cageDirection = polygonDirection(originalCage);
@@ -150,16 +162,34 @@ void KisGreenCoordinatesMath::precalculateGreenCoordinates(const QVector<QPointF
     }
 
     m_d->precalculatedCoords.resize(numPoints);
+    PrecalculatedCoords *coords = m_d->precalculatedCoords.data();
 
-    for (int i = 0; i < numPoints; i++) {
-        m_d->precalculatedCoords[i].psi.resize(numCagePoints);
-        m_d->precalculatedCoords[i].phi.resize(numCagePoints);
+    /**
+     * The coordinates of every point depend on the cage only, so the
+     * points are processed in parallel chunks
+     */
+    const int chunkSize = 256;
 
-        m_d->precalculateOnePoint(originalCage,
-                                  &m_d->precalculatedCoords[i],
-                                  points[i],
-                                  cageDirection);
+    QVector<int> chunks;
+    for (int i = 0; i < numPoints; i += chunkSize) {
+        chunks << i;
     }
+
+    auto processChunk = [&] (int chunkStart) {
+        const int chunkEnd = qMin(chunkStart + chunkSize, numPoints);
+
+        for (int i = chunkStart; i < chunkEnd; i++) {
+            coords[i].psi.resize(numCagePoints);
+            coords[i].phi.resize(numCagePoints);
+
+            m_d->precalculateOnePoint(originalCage,
+                                      &coords[i],
+                                      points[i],
+                                      cageDirection);
+        }
+    };
+
+    KisSharedWorkerPool::blockingMap(chunks, processChunk);
 }
 
 void KisGreenCoordinatesMath::generateTransformedCageNormals(const QVector<QPointF> &transformedCage)
@@ -184,18 +214,19 @@ void KisGreenCoordinatesMath::generateTransformedCageNormals(const QVector<QPoin
     }
 }
 
-QPointF KisGreenCoordinatesMath::transformedPoint(int pointIndex, const QVector<QPointF> &transformedCage)
+QPointF KisGreenCoordinatesMath::transformedPoint(int pointIndex, const QVector<QPointF> &transformedCage) const
 {
     QPointF result;
 
     const int numCagePoints = transformedCage.size();
 
-
-    PrecalculatedCoords *coords = &m_d->precalculatedCoords[pointIndex];
+    // use const access only, the data may be shared with other copies
+    const PrecalculatedCoords &coords = m_d->precalculatedCoords.at(pointIndex);
+    const QVector<QPointF> &normals = m_d->transformedCageNormals;
 
     for (int i = 0; i < numCagePoints; i++) {
-        result += coords->phi[i] * transformedCage[i];
-        result += coords->psi[i] * m_d->transformedCageNormals[i];
+        result += coords.phi.at(i) * transformedCage.at(i);
+        result += coords.psi.at(i) * normals.at(i);
     }
 
     return result;
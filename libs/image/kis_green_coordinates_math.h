@@ -31,6 +31,13 @@ public:
     KisGreenCoordinatesMath();
     ~KisGreenCoordinatesMath();
 
+    /**
+     * The precalculated coordinates are implicitly shared between
+     * the copies, so copying a prepared object is cheap
+     */
+    KisGreenCoordinatesMath(const KisGreenCoordinatesMath &rhs);
+    KisGreenCoordinatesMath& operator=(const KisGreenCoordinatesMath &rhs);
+
     /**
      * Prepare the transformation framework by computing internal
      * coordinates of the points in cage.
@@ -47,9 +54,10 @@ public:
     void generateTransformedCageNormals(const QVector<QPointF> &transformedCage);
 
     /**
-     * Transform one point according to its index
+     * Transform one point according to its index. Can be called from
+     * several threads at the same time.
      */
-    QPointF transformedPoint(int pointIndex, const QVector<QPointF> &transformedCage);
+    QPointF transformedPoint(int pointIndex, const QVector<QPointF> &transformedCage) const;
 
 private:
     struct Private;
@@ -21,8 +21,11 @@
 
 #include <limits>
 #include <algorithm>
+#include <vector>
 
 #include <QImage>
+#include <QMap>
+#include "KisSharedWorkerPool.h"
 
 #include "kis_algebra_2d.h"
 #include "kis_four_point_interpolator_forward.h"
@@ -185,6 +188,9 @@ struct PaintDevicePolygonOp
 
     void operator() (const QPolygonF &srcPolygon, const QPolygonF &dstPolygon, const QPolygonF &clipDstPolygon) {
         QRect boundRect = clipDstPolygon.boundingRect().toAlignedRect();
+        if (!m_dstClipRect.isNull()) {
+            boundRect &= m_dstClipRect;
+        }
         if (boundRect.isEmpty()) return;
 
         KisSequentialIterator dstIt(m_dstDev, boundRect);
@@ -225,8 +231,17 @@ struct PaintDevicePolygonOp
 
     }
 
+    /**
+     * Limits the written pixels to \p rc (in destination
+     * coordinates). A null rect means no limit.
+     */
+    void setDstClipRect(const QRect &rc) {
+        m_dstClipRect = rc;
+    }
+
     KisPaintDeviceSP m_srcDev;
     KisPaintDeviceSP m_dstDev;
+    QRect m_dstClipRect;
 };
 
 struct QImagePolygonOp
@@ -238,8 +253,18 @@ struct QImagePolygonOp
           m_srcImageOffset(srcImageOffset),
           m_dstImageOffset(dstImageOffset),
           m_srcImageRect(m_srcImage.rect()),
-          m_dstImageRect(m_dstImage.rect())
+          m_dstImageRect(m_dstImage.rect()),
+          m_srcBits(reinterpret_cast<const QRgb*>(m_srcImage.constBits())),
+          m_dstBits(reinterpret_cast<QRgb*>(m_dstImage.bits())),
+          m_srcStride(m_srcImage.bytesPerLine() / sizeof(QRgb)),
+          m_dstStride(m_dstImage.bytesPerLine() / sizeof(QRgb))
     {
+        /**
+         * The pixels are accessed directly, so that several ops could
+         * write into different areas of the same image concurrently
+         * (QImage::setPixel() detaches the image on every call).
+         */
+        KIS_ASSERT_RECOVER_NOOP(m_srcImage.depth() == 32 && m_dstImage.depth() == 32);
     }
 
     void operator() (const QPolygonF &srcPolygon, const QPolygonF &dstPolygon) {
@@ -248,6 +273,9 @@ struct QImagePolygonOp
 
     void operator() (const QPolygonF &srcPolygon, const QPolygonF &dstPolygon, const QPolygonF &clipDstPolygon) {
         QRect boundRect = clipDstPolygon.boundingRect().toAlignedRect();
+        if (!m_dstClipRect.isNull()) {
+            boundRect &= m_dstClipRect;
+        }
         KisFourPointInterpolatorBackward interp(srcPolygon, dstPolygon);
 
         for (int y = boundRect.top(); y <= boundRect.bottom(); y++) {
@@ -272,7 +300,8 @@ struct QImagePolygonOp
                     if (!m_dstImageRect.contains(srcPointI)) continue;
                     if (!m_srcImageRect.contains(dstPointI)) continue;
 
-                    m_dstImage.setPixel(srcPointI, m_srcImage.pixel(dstPointI));
+                    m_dstBits[srcPointI.y() * m_dstStride + srcPointI.x()] =
+                        m_srcBits[dstPointI.y() * m_srcStride + dstPointI.x()];
                 }
             }
         }
@@ -292,6 +321,15 @@ struct QImagePolygonOp
 
     }
 
+    /**
+     * Limits the written pixels to \p rc (in destination
+     * coordinates, before subtracting the image offset). A null
+     * rect means no limit.
+     */
+    void setDstClipRect(const QRect &rc) {
+        m_dstClipRect = rc;
+    }
+
     const QImage &m_srcImage;
     QImage &m_dstImage;
     QPointF m_srcImageOffset;
@@ -299,6 +337,30 @@ struct QImagePolygonOp
 
     QRect m_srcImageRect;
     QRect m_dstImageRect;
+    QRect m_dstClipRect;
+
+    const QRgb *m_srcBits;
+    QRgb *m_dstBits;
+    int m_srcStride;
+    int m_dstStride;
+};
+
+/**
+ * Records the destination area touched by the polygons passed to it
+ */
+struct PolygonBoundsOp
+{
+    void operator() (const QPolygonF &srcPolygon, const QPolygonF &dstPolygon) {
+        this->operator() (srcPolygon, dstPolygon, dstPolygon);
+    }
+
+    void operator() (const QPolygonF &srcPolygon, const QPolygonF &dstPolygon, const QPolygonF &clipDstPolygon) {
+        Q_UNUSED(srcPolygon);
+        Q_UNUSED(dstPolygon);
+        bounds |= clipDstPolygon.boundingRect().toAlignedRect();
+    }
+
+    QRect bounds;
 };
 
 /*************************************************************/
@@ -336,13 +398,8 @@ inline int pointToIndex(const QPoint &cellPt, const QSize &gridSize)
 namespace Private {
     inline QPoint pointPolygonIndexToColRow(QPoint baseColRow, int index)
     {
-        static QVector<QPoint> pointOffsets;
-        if (pointOffsets.isEmpty()) {
-            pointOffsets << QPoint(0,0);
-            pointOffsets << QPoint(1,0);
-            pointOffsets << QPoint(1,1);
-            pointOffsets << QPoint(0,1);
-        }
+        static const QPoint pointOffsets[] = {QPoint(0,0), QPoint(1,0),
+                                              QPoint(1,1), QPoint(0,1)};
 
         return baseColRow + pointOffsets[index];
     }
@@ -551,6 +608,45 @@ inline void adjustAlignedPolygon(QPolygonF &polygon)
     polygon[3] += p3;
 }
 
+template <template <class PolygonOp, class IndexesOp> class IncompletePolygonPolicy,
+          class PolygonOp,
+          class IndexesOp>
+inline void processGridCell(int col, int row,
+                            PolygonOp &polygonOp,
+                            IndexesOp &indexesOp,
+                            const QVector<QPointF> &originalPoints,
+                            const QVector<QPointF> &transformedPoints)
+{
+    int numExistingPoints = 0;
+
+    QVector<int> polygonPoints =
+        indexesOp.calculateMappedIndexes(col, row, &numExistingPoints);
+
+    if (!IncompletePolygonPolicy<PolygonOp, IndexesOp>::
+         tryProcessPolygon(col, row,
+                           numExistingPoints,
+                           polygonOp,
+                           indexesOp,
+                           polygonPoints,
+                           originalPoints,
+                           transformedPoints)) {
+
+        QPolygonF srcPolygon;
+        QPolygonF dstPolygon;
+
+        for (int i = 0; i < 4; i++) {
+            const int index = polygonPoints[i];
+            srcPolygon << originalPoints[index];
+            dstPolygon << transformedPoints[index];
+        }
+
+        adjustAlignedPolygon(srcPolygon);
+        adjustAlignedPolygon(dstPolygon);
+
+        polygonOp(srcPolygon, dstPolygon);
+    }
+}
+
 template <template <class PolygonOp, class IndexesOp> class IncompletePolygonPolicy,
           class PolygonOp,
           class IndexesOp>
@@ -560,39 +656,87 @@ void iterateThroughGrid(PolygonOp &polygonOp,
                         const QVector<QPointF> &originalPoints,
                         const QVector<QPointF> &transformedPoints)
 {
-    QVector<int> polygonPoints(4);
+    for (int row = 0; row < gridSize.height() - 1; row++) {
+        for (int col = 0; col < gridSize.width() - 1; col++) {
+            processGridCell<IncompletePolygonPolicy>(col, row,
+                                                     polygonOp, indexesOp,
+                                                     originalPoints,
+                                                     transformedPoints);
+        }
+    }
+}
+
+/**
+ * Does the same as iterateThroughGrid(), but splits the destination
+ * into horizontal bands of \p bandHeight pixels and rasterizes the
+ * bands concurrently.
+ *
+ * \p createBandOp is called in the calling thread for every band and
+ * should return a polygon op that writes into the passed rect only
+ * (see setDstClipRect()). Inside a band the cells are processed in the
+ * grid order, so overlapping cells are painted exactly the same way as
+ * in the sequential version.
+ *
+ * \p indexesOp is shared by all the threads, so it must not change
+ * its state.
+ */
+template <template <class PolygonOp, class IndexesOp> class IncompletePolygonPolicy,
+          class BandOpFactory,
+          class IndexesOp>
+void iterateThroughGridInBands(BandOpFactory createBandOp,
+                               IndexesOp &indexesOp,
+                               const QSize &gridSize,
+                               const QVector<QPointF> &originalPoints,
+                               const QVector<QPointF> &transformedPoints,
+                               int bandHeight = 64)
+{
+    typedef decltype(createBandOp(QRect())) PolygonOp;
+
+    QMap<int, QVector<QPoint>> bandCells;
+    QRect totalBounds;
 
     for (int row = 0; row < gridSize.height() - 1; row++) {
         for (int col = 0; col < gridSize.width() - 1; col++) {
-            int numExistingPoints = 0;
-
-            polygonPoints = indexesOp.calculateMappedIndexes(col, row, &numExistingPoints);
-
-            if (!IncompletePolygonPolicy<PolygonOp, IndexesOp>::
-                 tryProcessPolygon(col, row,
-                                   numExistingPoints,
-                                   polygonOp,
-                                   indexesOp,
-                                   polygonPoints,
-                                   originalPoints,
-                                   transformedPoints)) {
-
-                QPolygonF srcPolygon;
-                QPolygonF dstPolygon;
-
-                for (int i = 0; i < 4; i++) {
-                    const int index = polygonPoints[i];
-                    srcPolygon << originalPoints[index];
-                    dstPolygon << transformedPoints[index];
-                }
+            PolygonBoundsOp boundsOp;
+            processGridCell<IncompletePolygonPolicy>(col, row,
+                                                     boundsOp, indexesOp,
+                                                     originalPoints,
+                                                     transformedPoints);
+
+            if (boundsOp.bounds.isEmpty()) continue;
+            totalBounds |= boundsOp.bounds;
 
-                adjustAlignedPolygon(srcPolygon);
-                adjustAlignedPolygon(dstPolygon);
+            const int firstBand = std::floor(qreal(boundsOp.bounds.top()) / bandHeight);
+            const int lastBand = std::floor(qreal(boundsOp.bounds.bottom()) / bandHeight);
 
-                polygonOp(srcPolygon, dstPolygon);
+            for (int band = firstBand; band <= lastBand; band++) {
+                bandCells[band].append(QPoint(col, row));
             }
         }
     }
+
+    const QList<int> bands = bandCells.keys();
+
+    std::vector<PolygonOp> bandOps;
+    bandOps.reserve(bands.size());
+
+    Q_FOREACH (int band, bands) {
+        bandOps.push_back(createBandOp(QRect(totalBounds.x(), band * bandHeight,
+                                             totalBounds.width(), bandHeight)));
+    }
+
+    auto processBand = [&] (int jobIndex) {
+        PolygonOp &polygonOp = bandOps[jobIndex];
+
+        Q_FOREACH (const QPoint &cell, bandCells.value(bands[jobIndex])) {
+            processGridCell<IncompletePolygonPolicy>(cell.x(), cell.y(),
+                                                     polygonOp, indexesOp,
+                                                     originalPoints,
+                                                     transformedPoints);
+        }
+    };
+
+    KisSharedWorkerPool::parallelFor(bands.size(), processBand);
 }
 
 }
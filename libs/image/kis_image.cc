@@ -1854,6 +1854,19 @@ void KisImage::setLevelOfDetailBlocked(bool value)
 
     if (value && !m_d->blockLevelOfDetail) {
         m_d->scheduler.setDesiredLevelOfDetail(0);
+
+        /**
+         * The lod planes will not be synced until instant preview is
+         * enabled again, so don't keep the copy-on-write snapshots of
+         * the last sync: they hold old versions of every tile changed
+         * since then. The image is locked, so no sync can be running.
+         */
+        KisLayerUtils::recursiveApplyNodes(root(),
+            [] (KisNodeSP node) {
+                Q_FOREACH (KisPaintDeviceSP dev, node->getLodCapableDevices()) {
+                    dev->dropLodSyncSnapshots();
+                }
+            });
     }
 
     m_d->blockLevelOfDetail = value;
@@ -588,6 +588,36 @@ void KisImageConfig::setAnimationCacheRegionOfInterestMargin(qreal value)
     m_config.writeEntry("animationCacheRegionOfInterestMargin", value);
 }
 
+int KisImageConfig::animationCachePrefetchFrames(bool defaultValue) const
+{
+    return defaultValue ? 8 : m_config.readEntry("animationCachePrefetchFrames", 8);
+}
+
+void KisImageConfig::setAnimationCachePrefetchFrames(int value)
+{
+    m_config.writeEntry("animationCachePrefetchFrames", value);
+}
+
+int KisImageConfig::animationCachePrefetchMemoryLimit(bool defaultValue) const
+{
+    return defaultValue ? 256 : m_config.readEntry("animationCachePrefetchMemoryLimit", 256);
+}
+
+void KisImageConfig::setAnimationCachePrefetchMemoryLimit(int value)
+{
+    m_config.writeEntry("animationCachePrefetchMemoryLimit", value);
+}
+
+int KisImageConfig::canvasUpdatesMergeOverhead(bool defaultValue) const
+{
+    return defaultValue ? 30 : m_config.readEntry("canvasUpdatesMergeOverhead", 30);
+}
+
+void KisImageConfig::setCanvasUpdatesMergeOverhead(int value)
+{
+    m_config.writeEntry("canvasUpdatesMergeOverhead", value);
+}
+
 QColor KisImageConfig::selectionOverlayMaskColor(bool defaultValue) const
 {
     QColor def(255, 0, 0, 128);
@@ -138,6 +138,15 @@ public:
     qreal animationCacheRegionOfInterestMargin(bool defaultValue = false) const;
     void setAnimationCacheRegionOfInterestMargin(qreal value);
 
+    int animationCachePrefetchFrames(bool defaultValue = false) const;
+    void setAnimationCachePrefetchFrames(int value);
+
+    int animationCachePrefetchMemoryLimit(bool defaultValue = false) const;
+    void setAnimationCachePrefetchMemoryLimit(int value);
+
+    int canvasUpdatesMergeOverhead(bool defaultValue = false) const;
+    void setCanvasUpdatesMergeOverhead(int value);
+
     QColor selectionOverlayMaskColor(bool defaultValue = false) const;
     void setSelectionOverlayMaskColor(const QColor &color);
 
@@ -804,6 +804,15 @@ QRect KisLayer::updateProjection(const QRect& rect, KisNodeSP filthyNode)
 
             updatedRect = applyMasks(originalDevice, projection,
                                      updatedRect, filthyNode, 0);
+
+            /**
+             * The projection may be regenerated bypassing the projection
+             * plane (e.g. by the transform mask's static image update), so
+             * the layer style should drop its caches of the source here.
+             */
+            if (m_d->layerStyleProjectionPlane) {
+                m_d->layerStyleProjectionPlane->invalidateSourceCache(updatedRect);
+            }
         }
     }
 
@@ -22,6 +22,8 @@
 #include "kis_dom_utils.h"
 #include "krita_utils.h"
 
+#include <QTransform>
+
 
 struct Q_DECL_HIDDEN KisLiquifyTransformWorker::Private
 {
@@ -43,8 +45,36 @@ struct Q_DECL_HIDDEN KisLiquifyTransformWorker::Private
     int pixelPrecision;
     QSize gridSize;
 
+    /**
+     * The result of the last runOnQImage() call. While the user paints
+     * with the liquify brush, only the cells around the moved points
+     * are rasterized again on top of it.
+     */
+    struct PreviewCache {
+        PreviewCache() : srcImageKey(0) {}
+
+        qint64 srcImageKey;
+        QPointF srcImageOffset;
+        QTransform imageToThumbTransform;
+        QVector<QPointF> originalPoints;
+        QVector<QPointF> transformedPoints;
+        QImage dstImage;
+        QPointF dstImageOffset;
+    };
+
+    PreviewCache previewCache;
+
     void preparePoints();
 
+    void cellPolygons(int topLeftIndex,
+                      const QVector<QPointF> &originalPoints,
+                      const QVector<QPointF> &transformedPoints,
+                      QPolygonF *srcPolygon,
+                      QPolygonF *dstPolygon) const;
+
+    void updatePreviewIncrementally(const QImage &srcImage,
+                                    const QVector<QPointF> &transformedPoints);
+
     struct MapIndexesOp;
 
     template <class ProcessOp>
@@ -80,6 +110,11 @@ KisLiquifyTransformWorker::KisLiquifyTransformWorker(const QRect &srcBounds,
 KisLiquifyTransformWorker::KisLiquifyTransformWorker(const KisLiquifyTransformWorker &rhs)
     : m_d(new Private(*rhs.m_d.data()))
 {
+    /**
+     * The copies are stored in the undo history, don't let them pin
+     * and share the preview buffer of the active worker
+     */
+    m_d->previewCache = Private::PreviewCache();
 }
 
 KisLiquifyTransformWorker::~KisLiquifyTransformWorker()
@@ -430,6 +465,29 @@ struct KisLiquifyTransformWorker::Private::MapIndexesOp {
 };
 
 
+void KisLiquifyTransformWorker::Private::cellPolygons(int topLeftIndex,
+                                                     const QVector<QPointF> &originalPoints,
+                                                     const QVector<QPointF> &transformedPoints,
+                                                     QPolygonF *srcPolygon,
+                                                     QPolygonF *dstPolygon) const
+{
+    const int tl = topLeftIndex;
+    const int tr = tl + 1;
+    const int bl = tl + gridSize.width();
+    const int br = bl + 1;
+
+    *srcPolygon = QPolygonF();
+    *srcPolygon << originalPoints[tl] << originalPoints[tr]
+                << originalPoints[br] << originalPoints[bl];
+
+    *dstPolygon = QPolygonF();
+    *dstPolygon << transformedPoints[tl] << transformedPoints[tr]
+                << transformedPoints[br] << transformedPoints[bl];
+
+    GridIterationTools::adjustAlignedPolygon(*srcPolygon);
+    GridIterationTools::adjustAlignedPolygon(*dstPolygon);
+}
+
 void KisLiquifyTransformWorker::run(KisPaintDeviceSP device)
 {
     KisPaintDeviceSP srcDev = new KisPaintDevice(*device.data());
@@ -437,12 +495,17 @@ void KisLiquifyTransformWorker::run(KisPaintDeviceSP device)
 
     using namespace GridIterationTools;
 
-    PaintDevicePolygonOp polygonOp(srcDev, device);
+    auto createBandOp = [srcDev, device] (const QRect &bandRect) {
+        PaintDevicePolygonOp polygonOp(srcDev, device);
+        polygonOp.setDstClipRect(bandRect);
+        return polygonOp;
+    };
+
     Private::MapIndexesOp indexesOp(m_d.data());
-    iterateThroughGrid<AlwaysCompletePolygonPolicy>(polygonOp, indexesOp,
-                                                    m_d->gridSize,
-                                                    m_d->originalPoints,
-                                                    m_d->transformedPoints);
+    iterateThroughGridInBands<AlwaysCompletePolygonPolicy>(createBandOp, indexesOp,
+                                                           m_d->gridSize,
+                                                           m_d->originalPoints,
+                                                           m_d->transformedPoints);
 }
 
 QRect KisLiquifyTransformWorker::approxChangeRect(const QRect &rc)
@@ -473,7 +536,6 @@ QRect KisLiquifyTransformWorker::approxNeedRect(const QRect &rc, const QRect &fu
 }
 
 #include <functional>
-#include <QTransform>
 
 using PointMapFunction = std::function<QPointF (const QPointF&)>;
 
@@ -521,12 +583,42 @@ QImage KisLiquifyTransformWorker::runOnQImage(const QImage &srcImage,
     const QRectF srcBounds(srcImageOffset, srcImage.size());
     dstBounds |= srcBounds;
 
+    Private::PreviewCache &cache = m_d->previewCache;
+
+    const bool canUpdateIncrementally =
+        cache.srcImageKey == srcImage.cacheKey() &&
+        cache.srcImageOffset == srcImageOffset &&
+        cache.imageToThumbTransform == imageToThumbTransform &&
+        cache.originalPoints == originalPointsLocal &&
+        cache.transformedPoints.size() == transformedPointsLocal.size() &&
+        QRectF(cache.dstImageOffset, cache.dstImage.size()).contains(dstBounds);
+
+    if (canUpdateIncrementally) {
+        m_d->updatePreviewIncrementally(srcImage, transformedPointsLocal);
+        cache.transformedPoints = transformedPointsLocal;
+
+        *newOffset = cache.dstImageOffset;
+        return cache.dstImage;
+    }
+
     QPointF dstQImageOffset = dstBounds.topLeft();
     *newOffset = dstQImageOffset;
 
     QRect dstBoundsI = dstBounds.toAlignedRect();
 
-    QImage dstImage(dstBoundsI.size(), srcImage.format());
+    /**
+     * Reuse the buffer of the previous preview if nobody else holds it
+     */
+    QImage dstImage;
+    if (cache.dstImage.size() == dstBoundsI.size() &&
+        cache.dstImage.format() == srcImage.format() &&
+        cache.dstImage.isDetached()) {
+
+        dstImage.swap(cache.dstImage);
+    } else {
+        cache.dstImage = QImage();
+        dstImage = QImage(dstBoundsI.size(), srcImage.format());
+    }
     dstImage.fill(0);
 
     GridIterationTools::QImagePolygonOp polygonOp(srcImage, dstImage, srcImageOffset, dstQImageOffset);
@@ -536,9 +628,104 @@ QImage KisLiquifyTransformWorker::runOnQImage(const QImage &srcImage,
                                                           m_d->gridSize,
                                                           originalPointsLocal,
                                                           transformedPointsLocal);
+
+    cache.srcImageKey = srcImage.cacheKey();
+    cache.srcImageOffset = srcImageOffset;
+    cache.imageToThumbTransform = imageToThumbTransform;
+    cache.originalPoints = originalPointsLocal;
+    cache.transformedPoints = transformedPointsLocal;
+    cache.dstImage = dstImage;
+    cache.dstImageOffset = dstQImageOffset;
+
     return dstImage;
 }
 
+void KisLiquifyTransformWorker::Private::updatePreviewIncrementally(const QImage &srcImage,
+                                                                   const QVector<QPointF> &transformedPoints)
+{
+    const int numCols = gridSize.width() - 1;
+    const int numRows = gridSize.height() - 1;
+
+    /**
+     * Collect the old and the new positions of all the cells touching
+     * the moved points. Everything inside this area will be painted
+     * from scratch.
+     */
+    QRectF dirtyRect;
+
+    for (int i = 0; i < transformedPoints.size(); i++) {
+        if (transformedPoints[i] == previewCache.transformedPoints[i]) continue;
+
+        const int col = i % gridSize.width();
+        const int row = i / gridSize.width();
+
+        for (int cellRow = qMax(0, row - 1); cellRow <= qMin(numRows - 1, row); cellRow++) {
+            for (int cellCol = qMax(0, col - 1); cellCol <= qMin(numCols - 1, col); cellCol++) {
+                QPolygonF srcPolygon;
+                QPolygonF oldDstPolygon;
+                QPolygonF newDstPolygon;
+
+                const int cell = GridIterationTools::pointToIndex(QPoint(cellCol, cellRow), gridSize);
+
+                cellPolygons(cell, previewCache.originalPoints, previewCache.transformedPoints,
+                             &srcPolygon, &oldDstPolygon);
+                cellPolygons(cell, previewCache.originalPoints, transformedPoints,
+                             &srcPolygon, &newDstPolygon);
+
+                dirtyRect |= oldDstPolygon.boundingRect();
+                dirtyRect |= newDstPolygon.boundingRect();
+            }
+        }
+    }
+
+    if (dirtyRect.isEmpty()) return;
+
+    QImage &dstImage = previewCache.dstImage;
+    const QPointF &dstImageOffset = previewCache.dstImageOffset;
+
+    const QRect dirtyRectI = dirtyRect.toAlignedRect().adjusted(-1, -1, 1, 1);
+
+    /**
+     * QImagePolygonOp rounds the position of every pixel after
+     * subtracting the image offset, do the same for the erased area
+     */
+    const QRect imageDirtyRect =
+        QRect((QPointF(dirtyRectI.topLeft()) - dstImageOffset).toPoint(),
+              dirtyRectI.size()) & dstImage.rect();
+
+    /**
+     * Only the dirty rect is written. If the caller has released the
+     * previous result, the cache is the only owner of the buffer and
+     * nothing is copied.
+     */
+    QRgb *bits = reinterpret_cast<QRgb*>(dstImage.bits());
+    const int stride = dstImage.bytesPerLine() / sizeof(QRgb);
+
+    for (int y = imageDirtyRect.top(); y <= imageDirtyRect.bottom(); y++) {
+        memset(bits + y * stride + imageDirtyRect.left(), 0, imageDirtyRect.width() * sizeof(QRgb));
+    }
+
+    GridIterationTools::QImagePolygonOp polygonOp(srcImage, dstImage,
+                                                  previewCache.srcImageOffset,
+                                                  dstImageOffset);
+    polygonOp.setDstClipRect(dirtyRectI);
+
+    QPolygonF srcPolygon;
+    QPolygonF dstPolygon;
+
+    for (int row = 0; row < numRows; row++) {
+        for (int col = 0; col < numCols; col++) {
+            const int cell = GridIterationTools::pointToIndex(QPoint(col, row), gridSize);
+            cellPolygons(cell, previewCache.originalPoints, transformedPoints,
+                         &srcPolygon, &dstPolygon);
+
+            if (!dstPolygon.boundingRect().toAlignedRect().intersects(dirtyRectI)) continue;
+
+            polygonOp(srcPolygon, dstPolygon);
+        }
+    }
+}
+
 void KisLiquifyTransformWorker::toXML(QDomElement *e) const
 {
     QDomDocument doc = e->ownerDocument();
@@ -74,6 +74,17 @@ public:
     QVector<QPointF>& transformedPoints();
 
     void run(KisPaintDeviceSP device);
+
+    /**
+     * Renders the preview of the transformation of \p srcImage.
+     *
+     * The worker keeps the returned image and, while only the
+     * transformed points change, repaints only the area around the
+     * moved points in place. The returned image shares its pixels with
+     * the worker, so the caller should release the previous result
+     * before calling the method again, otherwise the whole image is
+     * copied on the first write.
+     */
     QImage runOnQImage(const QImage &srcImage,
                        const QPointF &srcImageOffset,
                        const QTransform &imageToThumbTransform,
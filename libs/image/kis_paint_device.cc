@@ -151,6 +151,7 @@ public:
     {
 
         m_lodData.reset();
+        resetLodSyncSnapshots();
         m_externalFrameData.reset();
 
         if (!m_frames.isEmpty()) {
@@ -406,6 +407,9 @@ public:
     void updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect);
     void uploadLodDataStruct(LodDataStruct *dst);
     QRegion regionForLodSyncing() const;
+    QRegion regionForLodSyncing(LodDataStruct *dst) const;
+    bool canSyncLodIncrementally(Data *srcData, int lod) const;
+    void resetLodSyncSnapshots();
 
     void updateLodDataManager(KisDataManager *srcDataManager,
                               KisDataManager *dstDataManager, const QPoint &srcOffset, const QPoint &dstOffset,
@@ -565,6 +569,16 @@ private:
 private:
     DataSP m_data;
     mutable QScopedPointer<Data> m_lodData;
+
+    /**
+     * Copy-on-write clones of the source and the lod data managers
+     * as they were at the moment of the last lod sync. They let the
+     * next sync regenerate only the tiles that changed meanwhile.
+     */
+    KisDataManagerSP m_lodSyncSourceSnapshot;
+    QPoint m_lodSyncSourceOffset;
+    KisDataManagerSP m_lodSyncLodSnapshot;
+
     mutable QScopedPointer<Data> m_externalFrameData;
     mutable QMutex m_dataSwitchLock;
 
@@ -646,6 +660,9 @@ struct KisPaintDevice::Private::StrategyPolicy {
 struct KisPaintDevice::Private::LodDataStructImpl : public KisPaintDevice::LodDataStruct {
     LodDataStructImpl(Data *_lodData) : lodData(_lodData) {}
     QScopedPointer<Data> lodData;
+    QRegion syncRegion;
+    KisDataManagerSP sourceSnapshot;
+    QPoint sourceOffset;
 };
 
 QRegion KisPaintDevice::Private::regionForLodSyncing() const
@@ -654,39 +671,117 @@ QRegion KisPaintDevice::Private::regionForLodSyncing() const
     return srcData->dataManager()->region().translated(srcData->x(), srcData->y());
 }
 
-KisPaintDevice::LodDataStruct* KisPaintDevice::Private::createLodDataStruct(int newLod)
+QRegion KisPaintDevice::Private::regionForLodSyncing(LodDataStruct *_dst) const
 {
-    KIS_SAFE_ASSERT_RECOVER_NOOP(newLod > 0);
+    LodDataStructImpl *dst = dynamic_cast<LodDataStructImpl*>(_dst);
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(dst, regionForLodSyncing());
 
-    Data *srcData = currentNonLodData();
+    return dst->syncRegion;
+}
 
-    Data *lodData = new Data(srcData, false);
-    LodDataStruct *lodStruct = new LodDataStructImpl(lodData);
+bool KisPaintDevice::Private::canSyncLodIncrementally(Data *srcData, int lod) const
+{
+    if (!m_lodData || !m_lodSyncSourceSnapshot || !m_lodSyncLodSnapshot) return false;
 
-    int expectedX = KisLodTransform::coordToLodCoord(srcData->x(), newLod);
-    int expectedY = KisLodTransform::coordToLodCoord(srcData->y(), newLod);
+    const KisDataManager *srcDataManager = srcData->dataManager().data();
+    const KisDataManager *lodDataManager = m_lodData->dataManager().data();
+    const int pixelSize = srcDataManager->pixelSize();
 
     /**
      * We compare color spaces as pure pointers, because they must be
      * exactly the same, since they come from the common source.
      */
-    if (lodData->levelOfDetail() != newLod ||
-        lodData->colorSpace() != srcData->colorSpace() ||
-        lodData->x() != expectedX ||
-        lodData->y() != expectedY) {
+    return m_lodData->levelOfDetail() == lod &&
+        m_lodData->colorSpace() == srcData->colorSpace() &&
+        m_lodData->x() == KisLodTransform::coordToLodCoord(srcData->x(), lod) &&
+        m_lodData->y() == KisLodTransform::coordToLodCoord(srcData->y(), lod) &&
+        m_lodSyncSourceOffset == QPoint(srcData->x(), srcData->y()) &&
+        int(m_lodSyncSourceSnapshot->pixelSize()) == pixelSize &&
+        int(lodDataManager->pixelSize()) == pixelSize &&
+        !memcmp(m_lodSyncSourceSnapshot->defaultPixel(), srcDataManager->defaultPixel(), pixelSize) &&
+        !memcmp(m_lodSyncLodSnapshot->defaultPixel(), lodDataManager->defaultPixel(), pixelSize);
+}
 
+void KisPaintDevice::Private::resetLodSyncSnapshots()
+{
+    m_lodSyncSourceSnapshot = 0;
+    m_lodSyncLodSnapshot = 0;
+}
 
-        lodData->prepareClone(srcData);
+KisPaintDevice::LodDataStruct* KisPaintDevice::Private::createLodDataStruct(int newLod)
+{
+    KIS_SAFE_ASSERT_RECOVER_NOOP(newLod > 0);
 
-        lodData->setLevelOfDetail(newLod);
-        lodData->setX(expectedX);
-        lodData->setY(expectedY);
+    Data *srcData = currentNonLodData();
+    LodDataStructImpl *lodStruct = 0;
+
+    /**
+     * Projections are always regenerated as a whole. Their tiles are
+     * rewritten by the updates of every child, so the snapshots would
+     * keep old copies of most of the projection alive between the syncs,
+     * and their data is switched to an external frame while rendering
+     * animation.
+     */
+    const bool trackChanges = !isProjectionDevice;
+
+    if (trackChanges && canSyncLodIncrementally(srcData, newLod)) {
+        /**
+         * Start from a copy-on-write clone of the current lod data and
+         * regenerate only the parts that changed since the last sync:
+         * the tiles written in the source device and the tiles written
+         * in the lod device itself by the lod strokes.
+         */
+        lodStruct = new LodDataStructImpl(new Data(m_lodData.data(), true));
+
+        QRegion dirtyRegion =
+            srcData->dataManager()->differenceRegion(m_lodSyncSourceSnapshot.data())
+                .translated(srcData->x(), srcData->y());
+
+        const QRegion lodDirtyRegion =
+            m_lodData->dataManager()->differenceRegion(m_lodSyncLodSnapshot.data())
+                .translated(m_lodData->x(), m_lodData->y());
+
+        Q_FOREACH (const QRect &rc, lodDirtyRegion.rects()) {
+            dirtyRegion += KisLodTransform::upscaledRect(rc, newLod);
+        }
 
-        // FIXME: different kind of synchronization
+        lodStruct->syncRegion = dirtyRegion;
+
+    } else {
+        Data *lodData = new Data(srcData, false);
+        lodStruct = new LodDataStructImpl(lodData);
+
+        int expectedX = KisLodTransform::coordToLodCoord(srcData->x(), newLod);
+        int expectedY = KisLodTransform::coordToLodCoord(srcData->y(), newLod);
+
+        /**
+         * We compare color spaces as pure pointers, because they must be
+         * exactly the same, since they come from the common source.
+         */
+        if (lodData->levelOfDetail() != newLod ||
+            lodData->colorSpace() != srcData->colorSpace() ||
+            lodData->x() != expectedX ||
+            lodData->y() != expectedY) {
+
+
+            lodData->prepareClone(srcData);
+
+            lodData->setLevelOfDetail(newLod);
+            lodData->setX(expectedX);
+            lodData->setY(expectedY);
+
+            // FIXME: different kind of synchronization
+        }
+
+        lodStruct->syncRegion = regionForLodSyncing();
     }
 
-    //QRegion dirtyRegion = syncWholeDevice(srcData);
-    lodData->cache()->invalidate();
+    if (trackChanges) {
+        lodStruct->sourceSnapshot = new KisDataManager(*srcData->dataManager());
+        lodStruct->sourceOffset = QPoint(srcData->x(), srcData->y());
+    }
+
+    lodStruct->lodData->cache()->invalidate();
 
     return lodStruct;
 }
@@ -825,6 +920,14 @@ void KisPaintDevice::Private::uploadLodDataStruct(LodDataStruct *_dst)
 
     m_lodData->prepareClone(dst->lodData.data());
     m_lodData->dataManager()->bitBltRough(dst->lodData->dataManager(), dst->lodData->dataManager()->extent());
+
+    if (dst->sourceSnapshot) {
+        m_lodSyncSourceSnapshot = dst->sourceSnapshot;
+        m_lodSyncSourceOffset = dst->sourceOffset;
+        m_lodSyncLodSnapshot = new KisDataManager(*m_lodData->dataManager());
+    } else {
+        resetLodSyncSnapshots();
+    }
 }
 
 void KisPaintDevice::Private::transferFromData(Data *data, KisPaintDeviceSP targetDevice)
@@ -2043,6 +2146,11 @@ QRegion KisPaintDevice::regionForLodSyncing() const
     return m_d->regionForLodSyncing();
 }
 
+QRegion KisPaintDevice::regionForLodSyncing(LodDataStruct *dst) const
+{
+    return m_d->regionForLodSyncing(dst);
+}
+
 KisPaintDevice::LodDataStruct* KisPaintDevice::createLodDataStruct(int lod)
 {
     return m_d->createLodDataStruct(lod);
@@ -2058,6 +2166,11 @@ void KisPaintDevice::uploadLodDataStruct(LodDataStruct *dst)
     m_d->uploadLodDataStruct(dst);
 }
 
+void KisPaintDevice::dropLodSyncSnapshots()
+{
+    m_d->resetLodSyncSnapshots();
+}
+
 void KisPaintDevice::generateLodCloneDevice(KisPaintDeviceSP dst, const QRect &originalRect, int lod)
 {
     m_d->generateLodCloneDevice(dst, originalRect, lod);
@@ -838,10 +838,27 @@ public:
     };
 
     QRegion regionForLodSyncing() const;
+
+    /**
+     * \return the region that should be passed to updateLodDataStruct()
+     * to bring \p dst up to date. If only a part of the device has changed
+     * since the last sync, the region covers only the changed tiles.
+     */
+    QRegion regionForLodSyncing(LodDataStruct *dst) const;
+
     LodDataStruct* createLodDataStruct(int lod);
     void updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect);
     void uploadLodDataStruct(LodDataStruct *dst);
 
+    /**
+     * Releases the copy-on-write snapshots of the device kept since the
+     * last lod sync. The next sync will regenerate the whole device.
+     * Should be called when the lod plane is not going to be synced
+     * any time soon, e.g. when instant preview is disabled or the sync
+     * has been cancelled.
+     */
+    void dropLodSyncSnapshots();
+
     void generateLodCloneDevice(KisPaintDeviceSP dst, const QRect &originalRect, int lod);
 
     void setProjectionDevice(bool value);
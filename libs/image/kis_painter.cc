@@ -2582,6 +2582,11 @@ void KisPainter::setAverageOpacity(qreal averageOpacity)
     d->paramInfo.setOpacityAndAverage(d->paramInfo.opacity, averageOpacity);
 }
 
+qreal KisPainter::averageOpacity() const
+{
+    return *d->paramInfo.lastOpacity;
+}
+
 qreal KisPainter::blendAverageOpacity(qreal opacity, qreal averageOpacity)
 {
     const float exponent = 0.1;
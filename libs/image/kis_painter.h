@@ -752,6 +752,12 @@ public:
      */
     void setAverageOpacity(qreal averageOpacity);
 
+    /**
+     * @return the average opacity of the stroke, as set by
+     * setOpacityUpdateAverage() or setAverageOpacity()
+     */
+    qreal averageOpacity() const;
+
     /**
      * Calculate average opacity value after painting a single dab with \p opacity
      */
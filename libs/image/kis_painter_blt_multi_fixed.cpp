@@ -24,127 +24,58 @@
 #include "kis_random_accessor_ng.h"
 #include "KisRenderedDab.h"
 
-void KisPainter::Private::applyDevice(const QRect &applyRect,
-                                      const KisRenderedDab &dab,
-                                      KisRandomAccessorSP dstIt,
-                                      const KoColorSpace *srcColorSpace,
-                                      KoCompositeOp::ParameterInfo &localParamInfo)
+void KisPainter::Private::applyDabsToChunk(const QRect &chunkRect,
+                                           const QList<KisRenderedDab> &dabs,
+                                           quint8 *dstChunkStart,
+                                           qint32 dstRowStride,
+                                           const quint8 *maskChunkStart,
+                                           qint32 maskRowStride,
+                                           qint32 maskPixelSize,
+                                           const KoColorSpace *srcColorSpace,
+                                           KoCompositeOp::ParameterInfo &localParamInfo)
 {
-    const QRect dabRect = dab.realBounds();
-    const QRect rc = applyRect & dabRect;
-
     const int srcPixelSize = srcColorSpace->pixelSize();
-    const int dabRowStride = srcPixelSize * dabRect.width();
-
-
-    qint32 dstY = rc.y();
-    qint32 rowsRemaining = rc.height();
+    const int dstPixelSize = colorSpace->pixelSize();
 
-    while (rowsRemaining > 0) {
-        qint32 dstX = rc.x();
-
-        qint32 numContiguousDstRows = dstIt->numContiguousRows(dstY);
-        qint32 rows = qMin(rowsRemaining, numContiguousDstRows);
-
-        qint32 columnsRemaining = rc.width();
+    /**
+     * All the dabs are composited into the same contiguous chunk of the
+     * destination before we move to the next one, so the tile data stays
+     * hot in cache and the accessor is repositioned only once per chunk,
+     * not once per dab.
+     */
+    Q_FOREACH (const KisRenderedDab &dab, dabs) {
+        const QRect dabRect = dab.realBounds();
+        const QRect rc = chunkRect & dabRect;
+        if (rc.isEmpty()) continue;
 
-        while (columnsRemaining > 0) {
+        const int dabRowStride = srcPixelSize * dabRect.width();
 
-            qint32 numContiguousDstColumns = dstIt->numContiguousColumns(dstX);
-            qint32 columns = qMin(numContiguousDstColumns, columnsRemaining);
+        const int dstOffsetX = rc.x() - chunkRect.x();
+        const int dstOffsetY = rc.y() - chunkRect.y();
 
-            qint32 dstRowStride = dstIt->rowStride(dstX, dstY);
-            dstIt->moveTo(dstX, dstY);
+        localParamInfo.dstRowStart   = dstChunkStart + dstOffsetX * dstPixelSize + dstOffsetY * dstRowStride;
+        localParamInfo.dstRowStride  = dstRowStride;
 
-            localParamInfo.dstRowStart   = dstIt->rawData();
-            localParamInfo.dstRowStride  = dstRowStride;
+        if (maskChunkStart) {
+            localParamInfo.maskRowStart  = maskChunkStart + dstOffsetX * maskPixelSize + dstOffsetY * maskRowStride;
+            localParamInfo.maskRowStride = maskRowStride;
+        } else {
             localParamInfo.maskRowStart  = 0;
             localParamInfo.maskRowStride = 0;
-            localParamInfo.rows          = rows;
-            localParamInfo.cols          = columns;
-
-
-            const int dabX = dstX - dabRect.x();
-            const int dabY = dstY - dabRect.y();
-
-            localParamInfo.srcRowStart   = dab.device->constData() + dabX * srcPixelSize + dabY * dabRowStride;
-            localParamInfo.srcRowStride  = dabRowStride;
-            localParamInfo.setOpacityAndAverage(dab.opacity, dab.averageOpacity);
-            localParamInfo.flow = dab.flow;
-            colorSpace->bitBlt(srcColorSpace, localParamInfo, compositeOp, renderingIntent, conversionFlags);
-
-            dstX += columns;
-            columnsRemaining -= columns;
         }
 
-        dstY += rows;
-        rowsRemaining -= rows;
-    }
-
-}
-
-void KisPainter::Private::applyDeviceWithSelection(const QRect &applyRect,
-                                                   const KisRenderedDab &dab,
-                                                   KisRandomAccessorSP dstIt,
-                                                   KisRandomConstAccessorSP maskIt,
-                                                   const KoColorSpace *srcColorSpace,
-                                                   KoCompositeOp::ParameterInfo &localParamInfo)
-{
-    const QRect dabRect = dab.realBounds();
-    const QRect rc = applyRect & dabRect;
-
-    const int srcPixelSize = srcColorSpace->pixelSize();
-    const int dabRowStride = srcPixelSize * dabRect.width();
-
-
-    qint32 dstY = rc.y();
-    qint32 rowsRemaining = rc.height();
-
-    while (rowsRemaining > 0) {
-        qint32 dstX = rc.x();
-
-        qint32 numContiguousDstRows = dstIt->numContiguousRows(dstY);
-        qint32 numContiguousMaskRows = maskIt->numContiguousRows(dstY);
-        qint32 rows = qMin(rowsRemaining, qMin(numContiguousDstRows, numContiguousMaskRows));
-
-        qint32 columnsRemaining = rc.width();
-
-        while (columnsRemaining > 0) {
-
-            qint32 numContiguousDstColumns = dstIt->numContiguousColumns(dstX);
-            qint32 numContiguousMaskColumns = maskIt->numContiguousColumns(dstX);
-            qint32 columns = qMin(columnsRemaining, qMin(numContiguousDstColumns, numContiguousMaskColumns));
-
-            qint32 dstRowStride = dstIt->rowStride(dstX, dstY);
-            qint32 maskRowStride = maskIt->rowStride(dstX, dstY);
-            dstIt->moveTo(dstX, dstY);
-            maskIt->moveTo(dstX, dstY);
-
-            localParamInfo.dstRowStart   = dstIt->rawData();
-            localParamInfo.dstRowStride  = dstRowStride;
-            localParamInfo.maskRowStart  = maskIt->rawDataConst();
-            localParamInfo.maskRowStride = maskRowStride;
-            localParamInfo.rows          = rows;
-            localParamInfo.cols          = columns;
-
-
-            const int dabX = dstX - dabRect.x();
-            const int dabY = dstY - dabRect.y();
-
-            localParamInfo.srcRowStart   = dab.device->constData() + dabX * srcPixelSize + dabY * dabRowStride;
-            localParamInfo.srcRowStride  = dabRowStride;
-            localParamInfo.setOpacityAndAverage(dab.opacity, dab.averageOpacity);
-            localParamInfo.flow = dab.flow;
-            colorSpace->bitBlt(srcColorSpace, localParamInfo, compositeOp, renderingIntent, conversionFlags);
+        localParamInfo.rows          = rc.height();
+        localParamInfo.cols          = rc.width();
 
-            dstX += columns;
-            columnsRemaining -= columns;
-        }
+        const int dabX = rc.x() - dabRect.x();
+        const int dabY = rc.y() - dabRect.y();
 
-        dstY += rows;
-        rowsRemaining -= rows;
+        localParamInfo.srcRowStart   = dab.device->constData() + dabX * srcPixelSize + dabY * dabRowStride;
+        localParamInfo.srcRowStride  = dabRowStride;
+        localParamInfo.setOpacityAndAverage(dab.opacity, dab.averageOpacity);
+        localParamInfo.flow = dab.flow;
+        colorSpace->bitBlt(srcColorSpace, localParamInfo, compositeOp, renderingIntent, conversionFlags);
     }
-
 }
 
 void KisPainter::bltFixed(const QRect &applyRect, const QList<KisRenderedDab> allSrcDevices)
@@ -180,14 +111,58 @@ void KisPainter::bltFixed(const QRect &applyRect, const QList<KisRenderedDab> al
     KisRandomAccessorSP dstIt = d->device->createRandomAccessorNG(rc.left(), rc.top());
     KisRandomConstAccessorSP maskIt = d->selection ? d->selection->projection()->createRandomConstAccessorNG(rc.left(), rc.top()) : 0;
 
-    if (maskIt) {
-        Q_FOREACH (const KisRenderedDab &dab, devices) {
-            d->applyDeviceWithSelection(rc, dab, dstIt, maskIt, srcColorSpace, localParamInfo);
+    const qint32 maskPixelSize = d->selection ? d->selection->projection()->pixelSize() : 0;
+
+    /**
+     * Walk the destination in the chunks of contiguous memory (that is,
+     * in tiles) and apply all the dabs intersecting the chunk in one
+     * sweep. With dense spacing the dabs overlap heavily, so compositing
+     * them tile-by-tile touches every tile only once.
+     */
+    qint32 dstY = rc.y();
+    qint32 rowsRemaining = rc.height();
+
+    while (rowsRemaining > 0) {
+        qint32 dstX = rc.x();
+
+        qint32 rows = qMin(rowsRemaining, dstIt->numContiguousRows(dstY));
+        if (maskIt) {
+            rows = qMin(rows, maskIt->numContiguousRows(dstY));
         }
-    } else {
-        Q_FOREACH (const KisRenderedDab &dab, devices) {
-            d->applyDevice(rc, dab, dstIt, srcColorSpace, localParamInfo);
+
+        qint32 columnsRemaining = rc.width();
+
+        while (columnsRemaining > 0) {
+            qint32 columns = qMin(columnsRemaining, dstIt->numContiguousColumns(dstX));
+            if (maskIt) {
+                columns = qMin(columns, maskIt->numContiguousColumns(dstX));
+            }
+
+            const QRect chunkRect(dstX, dstY, columns, rows);
+
+            const qint32 dstRowStride = dstIt->rowStride(dstX, dstY);
+            dstIt->moveTo(dstX, dstY);
+
+            const quint8 *maskChunkStart = 0;
+            qint32 maskRowStride = 0;
+
+            if (maskIt) {
+                maskRowStride = maskIt->rowStride(dstX, dstY);
+                maskIt->moveTo(dstX, dstY);
+                maskChunkStart = maskIt->rawDataConst();
+            }
+
+            d->applyDabsToChunk(chunkRect, devices,
+                                dstIt->rawData(), dstRowStride,
+                                maskChunkStart, maskRowStride, maskPixelSize,
+                                srcColorSpace, localParamInfo);
+
+            dstX += columns;
+            columnsRemaining -= columns;
         }
+
+        dstY += rows;
+        rowsRemaining -= rows;
     }
 
 
@@ -87,18 +87,15 @@ struct Q_DECL_HIDDEN KisPainter::Private {
 
     void fillPainterPathImpl(const QPainterPath& path, const QRect &requestedRect);
 
-    void applyDevice(const QRect &applyRect,
-                     const KisRenderedDab &dab,
-                     KisRandomAccessorSP dstIt,
-                     const KoColorSpace *srcColorSpace,
-                     KoCompositeOp::ParameterInfo &localParamInfo);
-
-    void applyDeviceWithSelection(const QRect &applyRect,
-                                  const KisRenderedDab &dab,
-                                  KisRandomAccessorSP dstIt,
-                                  KisRandomConstAccessorSP maskIt,
-                                  const KoColorSpace *srcColorSpace,
-                                  KoCompositeOp::ParameterInfo &localParamInfo);
+    void applyDabsToChunk(const QRect &chunkRect,
+                          const QList<KisRenderedDab> &dabs,
+                          quint8 *dstChunkStart,
+                          qint32 dstRowStride,
+                          const quint8 *maskChunkStart,
+                          qint32 maskRowStride,
+                          qint32 maskPixelSize,
+                          const KoColorSpace *srcColorSpace,
+                          KoCompositeOp::ParameterInfo &localParamInfo);
 
 };
 
@@ -18,6 +18,9 @@
 
 #include "kis_sync_lod_cache_stroke_strategy.h"
 
+#include <QMutex>
+#include <QMutexLocker>
+
 #include <kis_image.h>
 #include <kundo2magicstring.h>
 #include "krita_utils.h"
@@ -28,6 +31,7 @@ struct KisSyncLodCacheStrokeStrategy::Private
 {
     KisImageWSP image;
     QHash<KisPaintDeviceSP, KisPaintDevice::LodDataStruct*> dataObjects;
+    QMutex dataObjectsLock;
 
     ~Private() {
         qDeleteAll(dataObjects);
@@ -37,7 +41,7 @@ struct KisSyncLodCacheStrokeStrategy::Private
     class InitData : public KisStrokeJobData {
     public:
         InitData(KisPaintDeviceSP _device)
-            : KisStrokeJobData(SEQUENTIAL),
+            : KisStrokeJobData(CONCURRENT),
               device(_device)
             {}
 
@@ -46,12 +50,13 @@ struct KisSyncLodCacheStrokeStrategy::Private
 
     class ProcessData : public KisStrokeJobData {
     public:
-        ProcessData(KisPaintDeviceSP _device, const QRect &_rect)
+        ProcessData(KisPaintDeviceSP _device, KisPaintDevice::LodDataStruct *_data, const QRect &_rect)
             : KisStrokeJobData(CONCURRENT),
-              device(_device), rect(_rect)
+              device(_device), data(_data), rect(_rect)
             {}
 
         KisPaintDeviceSP device;
+        KisPaintDevice::LodDataStruct *data;
         QRect rect;
     };
 
@@ -97,15 +102,38 @@ void KisSyncLodCacheStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
     Private::AdditionalProcessNode *additionalProcessNode = dynamic_cast<Private::AdditionalProcessNode*>(data);
 
     if (initData) {
+        using KritaUtils::splitRegionIntoPatches;
+        using KritaUtils::optimalPatchSize;
+
         KisPaintDeviceSP dev = initData->device;
         const int lod = dev->defaultBounds()->currentLevelOfDetail();
-        m_d->dataObjects.insert(dev, dev->createLodDataStruct(lod));
+
+        KisPaintDevice::LodDataStruct *lodData = dev->createLodDataStruct(lod);
+
+        {
+            QMutexLocker l(&m_d->dataObjectsLock);
+            m_d->dataObjects.insert(dev, lodData);
+        }
+
+        /**
+         * The region is calculated only now, after the initial barrier,
+         * so that all the updates issued before the sync are taken
+         * into account. If the device has been synced before, only the
+         * tiles changed since then are regenerated.
+         */
+        const QRegion region = dev->regionForLodSyncing(lodData);
+        const QVector<QRect> rects = splitRegionIntoPatches(region, optimalPatchSize());
+
+        QVector<KisStrokeJobData*> jobs;
+        Q_FOREACH (const QRect &rc, rects) {
+            jobs << new Private::ProcessData(dev, lodData, rc);
+        }
+
+        addMutatedJobs(jobs);
+
     } else if (processData) {
         KisPaintDeviceSP dev = processData->device;
-        KIS_ASSERT(m_d->dataObjects.contains(dev));
-
-        KisPaintDevice::LodDataStruct *data = m_d->dataObjects.value(dev);
-        dev->updateLodDataStruct(data, processData->rect);
+        dev->updateLodDataStruct(processData->data, processData->rect);
     } else if (additionalProcessNode) {
         additionalProcessNode->node->syncLodCache();
     }
@@ -127,6 +155,16 @@ void KisSyncLodCacheStrokeStrategy::finishStrokeCallback()
 
 void KisSyncLodCacheStrokeStrategy::cancelStrokeCallback()
 {
+    /**
+     * A cancelled sync is usually forgotten because of a legacy stroke,
+     * which may rewrite a lot of tiles before the next sync happens (if
+     * ever). Don't let the snapshots of the previous sync keep the old
+     * versions of all those tiles alive.
+     */
+    Q_FOREACH (KisPaintDeviceSP dev, m_d->dataObjects.keys()) {
+        dev->dropLodSyncSnapshots();
+    }
+
     qDeleteAll(m_d->dataObjects);
     m_d->dataObjects.clear();
 }
@@ -134,8 +172,6 @@ void KisSyncLodCacheStrokeStrategy::cancelStrokeCallback()
 QList<KisStrokeJobData*> KisSyncLodCacheStrokeStrategy::createJobsData(KisImageWSP _image)
 {
     using KisLayerUtils::recursiveApplyNodes;
-    using KritaUtils::splitRegionIntoPatches;
-    using KritaUtils::optimalPatchSize;
 
     KisImageSP image = _image;
 
@@ -149,19 +185,16 @@ QList<KisStrokeJobData*> KisSyncLodCacheStrokeStrategy::createJobsData(KisImageW
 
     KritaUtils::makeContainerUnique(deviceList);
 
+    /**
+     * The devices are initialized concurrently. Each init job spawns
+     * the concurrent jobs regenerating the dirty patches of its device,
+     * which are guaranteed to finish before the first sequential job
+     * below.
+     */
     Q_FOREACH (KisPaintDeviceSP device, deviceList) {
         jobsData << new Private::InitData(device);
     }
 
-    Q_FOREACH (KisPaintDeviceSP device, deviceList) {
-        QRegion region = device->regionForLodSyncing();
-        QVector<QRect> rects = splitRegionIntoPatches(region, optimalPatchSize());
-
-        Q_FOREACH (const QRect &rc, rects) {
-            jobsData << new Private::ProcessData(device, rc);
-        }
-    }
-
     recursiveApplyNodes(image->root(),
                         [&jobsData](KisNodeSP node) {
                             jobsData << new Private::AdditionalProcessNode(node);
@@ -26,6 +26,7 @@
 #include <klocalizedstring.h>
 
 #include <QTransform>
+#include <QMutex>
 
 #include <KoColorSpace.h>
 #include <KoCompositeOpRegistry.h>
@@ -42,6 +43,7 @@
 #include "kis_progress_update_helper.h"
 #include "kis_pixel_selection.h"
 #include "kis_image.h"
+#include "KisSharedWorkerPool.h"
 
 
 KisTransformWorker::KisTransformWorker(KisPaintDeviceSP dev,
@@ -210,16 +212,43 @@ void KisTransformWorker::transformPass(KisPaintDevice *src, KisPaintDevice *dst,
     KisFilterWeightsBuffer buf(filterStrategy, qAbs(floatscale));
     KisFilterWeightsApplicator applicator(src, dst, floatscale, shear, dx, clampToEdge);
 
-    KisFilterWeightsApplicator::LinePos dstBounds;
+    /**
+     * Every line is transformed independently of the others, so the
+     * lines are split into strips and the strips are processed in
+     * parallel. The strips are aligned to the tiles (64 px), so the
+     * threads never write into the same tile.
+     */
+    const int stripSize = 64;
+    QVector<QPair<int, int>> strips;
+
+    for (int stripStart = firstLine; stripStart < firstLine + numLines;) {
+        const int stripEnd = qMin(firstLine + numLines,
+                                  (stripStart & ~(stripSize - 1)) + stripSize);
+        strips.append(qMakePair(stripStart, stripEnd));
+        stripStart = stripEnd;
+    }
+
+    QVector<KisFilterWeightsApplicator::LinePos> lineBounds(numLines);
+    KisFilterWeightsApplicator::LinePos *lineBoundsPtr = lineBounds.data();
+    QMutex progressMutex;
 
-    for (int i = firstLine; i < firstLine + numLines; i++) {
-        KisFilterWeightsApplicator::LinePos dstPos;
-        KisFilterWeightsApplicator::LinePos srcPos(srcStart, srcLen);
+    auto processStrip = [&] (const QPair<int, int> &strip) {
+        for (int i = strip.first; i < strip.second; i++) {
+            KisFilterWeightsApplicator::LinePos srcPos(srcStart, srcLen);
+            lineBoundsPtr[i - firstLine] = applicator.processLine<T>(srcPos, i, &buf, filterStrategy->support());
+        }
 
-        dstPos = applicator.processLine<T>(srcPos, i, &buf, filterStrategy->support());
-        dstBounds.unite(dstPos);
+        QMutexLocker l(&progressMutex);
+        for (int i = strip.first; i < strip.second; i++) {
+            progressHelper.step();
+        }
+    };
 
-        progressHelper.step();
+    KisSharedWorkerPool::blockingMap(strips, processStrip);
+
+    KisFilterWeightsApplicator::LinePos dstBounds;
+    Q_FOREACH (const KisFilterWeightsApplicator::LinePos &pos, lineBounds) {
+        dstBounds.unite(pos);
     }
 
     updateBounds<T>(m_boundRect, dstBounds);
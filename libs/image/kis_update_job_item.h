@@ -29,6 +29,7 @@
 #include "kis_base_rects_walker.h"
 #include "kis_async_merger.h"
 #include "kis_updater_context.h"
+#include "KisSharedWorkerPool.h"
 
 
 class KisUpdateJobItem :  public QObject, public QRunnable
@@ -60,6 +61,9 @@ public:
     void run() override {
         if (!isRunning()) return;
 
+        // let the parallel algorithms know this core is already loaded
+        KisSharedWorkerPool::BusyWorkerGuard busyGuard;
+
         /**
          * Here we break the idea of QThreadPool a bit. Ideally, we should split the
          * jobs into distinct QRunnable objects and pass all of them to QThreadPool.
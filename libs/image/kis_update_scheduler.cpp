@@ -29,6 +29,7 @@
 
 #include "kis_queues_progress_updater.h"
 #include "KisImageConfigNotifier.h"
+#include "KisSharedWorkerPool.h"
 
 #include <QReadWriteLock>
 #include "kis_lazy_wait_condition.h"
@@ -307,6 +308,7 @@ void KisUpdateScheduler::updateSettings()
     KisImageConfig config(true);
     m_d->defaultBalancingRatio = config.schedulerBalancingRatio();
     setThreadsLimit(config.maxNumberOfThreads());
+    KisSharedWorkerPool::setThreadsLimit(config.maxNumberOfThreads());
 }
 
 void KisUpdateScheduler::lock()
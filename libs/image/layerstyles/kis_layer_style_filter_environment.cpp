@@ -19,6 +19,9 @@
 #include "kis_layer_style_filter_environment.h"
 
 #include <QBitArray>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include "kis_layer.h"
 #include "kis_ls_utils.h"
@@ -28,6 +31,8 @@
 #include "kis_painter.h"
 #include "kis_image.h"
 
+#include "kis_default_bounds.h"
+#include "kis_cached_paint_device.h"
 #include "krita_utils.h"
 
 #include <boost/random/mersenne_twister.hpp>
@@ -40,9 +45,81 @@ struct Q_DECL_HIDDEN KisLayerStyleFilterEnvironment::Private
     KisLayer *sourceLayer;
     KisPixelSelectionSP cachedRandomSelection;
 
+    /**
+     * The alpha channel of the source device. For every tile of the
+     * cache we store the part of it that is known to be up-to-date.
+     * The update jobs running concurrently never have intersecting access
+     * rects, so a tile may be converted partially by one job and
+     * invalidated partially by another one.
+     */
+    QMutex sourceAlphaLock;
+    KisPixelSelectionSP sourceAlpha;
+    /**
+     * The device is tracked by a weak pointer, so a new device allocated
+     * at the address of the deleted one is never mistaken for it.
+     */
+    KisPaintDeviceWSP sourceAlphaDevice;
+    int sourceAlphaLevelOfDetail = 0;
+    QHash<QPair<int, int>, QRect> validSourceAlpha;
+
+    KisCachedSelection cachedSelections;
+    KisCachedPaintDevice cachedDevices;
+
+    static const int cacheTileSize = 64;
+
+    static int tileIndex(int coordinate) {
+        return coordinate >= 0 ?
+            coordinate / cacheTileSize :
+            (coordinate + 1) / cacheTileSize - 1;
+    }
+
+    static QRect mergeValidRects(const QRect &valid, const QRect &rc);
+    static QRect subtractValidRect(const QRect &valid, const QRect &rc);
+
     static KisPixelSelectionSP generateRandomSelection(const QRect &rc);
 };
 
+QRect KisLayerStyleFilterEnvironment::Private::mergeValidRects(const QRect &valid, const QRect &rc)
+{
+    if (valid.contains(rc)) return valid;
+    if (rc.contains(valid)) return rc;
+
+    const bool sameRows = valid.top() == rc.top() && valid.bottom() == rc.bottom();
+    const bool sameColumns = valid.left() == rc.left() && valid.right() == rc.right();
+
+    if ((sameRows && valid.left() <= rc.right() + 1 && rc.left() <= valid.right() + 1) ||
+        (sameColumns && valid.top() <= rc.bottom() + 1 && rc.top() <= valid.bottom() + 1)) {
+
+        return valid | rc;
+    }
+
+    // the union is not a rect, so just keep the biggest known part
+    return valid.width() * valid.height() >= rc.width() * rc.height() ? valid : rc;
+}
+
+QRect KisLayerStyleFilterEnvironment::Private::subtractValidRect(const QRect &valid, const QRect &rc)
+{
+    if (!valid.intersects(rc)) return valid;
+    if (rc.contains(valid)) return QRect();
+
+    if (rc.top() <= valid.top() && rc.bottom() >= valid.bottom()) {
+        if (rc.left() <= valid.left()) {
+            return QRect(QPoint(rc.right() + 1, valid.top()), valid.bottomRight());
+        } else if (rc.right() >= valid.right()) {
+            return QRect(valid.topLeft(), QPoint(rc.left() - 1, valid.bottom()));
+        }
+    } else if (rc.left() <= valid.left() && rc.right() >= valid.right()) {
+        if (rc.top() <= valid.top()) {
+            return QRect(QPoint(valid.left(), rc.bottom() + 1), valid.bottomRight());
+        } else if (rc.bottom() >= valid.bottom()) {
+            return QRect(valid.topLeft(), QPoint(valid.right(), rc.top() - 1));
+        }
+    }
+
+    // the rest is not a rect, so drop the whole tile
+    return QRect();
+}
+
 
 KisPixelSelectionSP
 KisLayerStyleFilterEnvironment::Private::
@@ -131,3 +208,112 @@ KisPixelSelectionSP KisLayerStyleFilterEnvironment::cachedRandomSelection(const
 
     return m_d->cachedRandomSelection;
 }
+
+KisPixelSelectionSP KisLayerStyleFilterEnvironment::cachedSourceAlpha(KisPaintDeviceSP source, const QRect &requestedRect) const
+{
+    const int levelOfDetail = currentLevelOfDetail();
+
+    KisPixelSelectionSP cache;
+    QVector<QRect> missingRects;
+
+    {
+        QMutexLocker l(&m_d->sourceAlphaLock);
+
+        if (!m_d->sourceAlpha ||
+            !m_d->sourceAlphaDevice.isValid() ||
+            m_d->sourceAlphaDevice != source.data() ||
+            m_d->sourceAlphaLevelOfDetail != levelOfDetail) {
+
+            m_d->sourceAlpha = new KisPixelSelection(new KisSelectionEmptyBounds(0));
+            m_d->sourceAlphaDevice = source;
+            m_d->sourceAlphaLevelOfDetail = levelOfDetail;
+            m_d->validSourceAlpha.clear();
+        }
+
+        cache = m_d->sourceAlpha;
+
+        if (requestedRect.isEmpty()) return cache;
+
+        const int tileSize = Private::cacheTileSize;
+
+        for (int row = Private::tileIndex(requestedRect.top()); row <= Private::tileIndex(requestedRect.bottom()); row++) {
+            for (int col = Private::tileIndex(requestedRect.left()); col <= Private::tileIndex(requestedRect.right()); col++) {
+                const QRect tileRect(col * tileSize, row * tileSize, tileSize, tileSize);
+                const QRect requestedPart = tileRect & requestedRect;
+
+                if (!m_d->validSourceAlpha.value(qMakePair(col, row)).contains(requestedPart)) {
+                    missingRects << requestedPart;
+                }
+            }
+        }
+    }
+
+    if (missingRects.isEmpty()) return cache;
+
+    Q_FOREACH (const QRect &rc, missingRects) {
+        KisLsUtils::convertAlphaToSelection(source, cache, rc);
+    }
+
+    {
+        QMutexLocker l(&m_d->sourceAlphaLock);
+
+        // the cache might have been reset while we were converting
+        if (m_d->sourceAlpha == cache) {
+            Q_FOREACH (const QRect &rc, missingRects) {
+                QRect &validPart =
+                    m_d->validSourceAlpha[qMakePair(Private::tileIndex(rc.left()),
+                                                    Private::tileIndex(rc.top()))];
+
+                validPart = validPart.isEmpty() ? rc : Private::mergeValidRects(validPart, rc);
+            }
+        }
+    }
+
+    return cache;
+}
+
+void KisLayerStyleFilterEnvironment::invalidateSourceAlpha(const QRect &rect)
+{
+    if (rect.isEmpty()) return;
+
+    QMutexLocker l(&m_d->sourceAlphaLock);
+
+    for (int row = Private::tileIndex(rect.top()); row <= Private::tileIndex(rect.bottom()); row++) {
+        for (int col = Private::tileIndex(rect.left()); col <= Private::tileIndex(rect.right()); col++) {
+            auto it = m_d->validSourceAlpha.find(qMakePair(col, row));
+            if (it == m_d->validSourceAlpha.end()) continue;
+
+            *it = Private::subtractValidRect(*it, rect);
+
+            if (it->isEmpty()) {
+                m_d->validSourceAlpha.erase(it);
+            }
+        }
+    }
+}
+
+KisSelectionSP KisLayerStyleFilterEnvironment::fetchTemporarySelection() const
+{
+    KisSelectionSP selection = m_d->cachedSelections.getSelection();
+    selection->setDefaultBounds(new KisSelectionEmptyBounds(0));
+    return selection;
+}
+
+void KisLayerStyleFilterEnvironment::releaseTemporarySelection(KisSelectionSP selection) const
+{
+    // some of the filters move the selection to apply the effect offset
+    selection->setX(0);
+    selection->setY(0);
+
+    m_d->cachedSelections.putSelection(selection);
+}
+
+KisPaintDeviceSP KisLayerStyleFilterEnvironment::fetchTemporaryDevice(KisPaintDeviceSP prototype) const
+{
+    return m_d->cachedDevices.getDevice(prototype);
+}
+
+void KisLayerStyleFilterEnvironment::releaseTemporaryDevice(KisPaintDeviceSP device) const
+{
+    m_d->cachedDevices.putDevice(device);
+}
@@ -20,6 +20,7 @@
 #define __KIS_LAYER_STYLE_FILTER_ENVIRONMENT_H
 
 #include <QScopedPointer>
+#include <QSharedPointer>
 #include <QRect>
 
 #include <kritaimage_export.h>
@@ -47,9 +48,37 @@ public:
 
     KisPixelSelectionSP cachedRandomSelection(const QRect &requestedRect) const;
 
+    /**
+     * Returns a selection holding the alpha channel of \p source, which
+     * is guaranteed to be up-to-date inside \p requestedRect. The cache is
+     * kept per tile and is shared by all the style filters of the layer, so
+     * only the parts that have been invalidated since the last request are
+     * converted again. The returned device must not be modified.
+     */
+    KisPixelSelectionSP cachedSourceAlpha(KisPaintDeviceSP source, const QRect &requestedRect) const;
+
+    /**
+     * Marks the cached source alpha inside \p rect as outdated. Must be
+     * called for every rect where the source device has been changed.
+     */
+    void invalidateSourceAlpha(const QRect &rect);
+
+    /**
+     * Temporary selections and devices used by the style filters are
+     * pooled to avoid reallocation of the devices on every update. The
+     * fetched objects should be released back after use.
+     */
+    KisSelectionSP fetchTemporarySelection() const;
+    void releaseTemporarySelection(KisSelectionSP selection) const;
+
+    KisPaintDeviceSP fetchTemporaryDevice(KisPaintDeviceSP prototype) const;
+    void releaseTemporaryDevice(KisPaintDeviceSP device) const;
+
 private:
     struct Private;
     const QScopedPointer<Private> m_d;
 };
 
+typedef QSharedPointer<KisLayerStyleFilterEnvironment> KisLayerStyleFilterEnvironmentSP;
+
 #endif /* __KIS_LAYER_STYLE_FILTER_ENVIRONMENT_H */
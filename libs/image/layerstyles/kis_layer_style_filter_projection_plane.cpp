@@ -24,6 +24,7 @@
 #include "kis_layer_style_filter.h"
 #include "kis_layer_style_filter_environment.h"
 #include "kis_psd_layer_style.h"
+#include "kis_pointer_utils.h"
 
 
 #include "kis_painter.h"
@@ -32,18 +33,21 @@
 
 struct KisLayerStyleFilterProjectionPlane::Private
 {
-    Private(KisLayer *_sourceLayer)
+    Private(KisLayer *_sourceLayer, KisLayerStyleFilterEnvironmentSP _environment)
         : sourceLayer(_sourceLayer),
-          environment(new KisLayerStyleFilterEnvironment(_sourceLayer))
+          environment(_environment ? _environment :
+                      toQShared(new KisLayerStyleFilterEnvironment(_sourceLayer)))
     {
         KIS_SAFE_ASSERT_RECOVER_NOOP(_sourceLayer);
     }
 
-    Private(const Private &rhs, KisLayer *_sourceLayer, KisPSDLayerStyleSP clonedStyle)
+    Private(const Private &rhs, KisLayer *_sourceLayer, KisPSDLayerStyleSP clonedStyle,
+            KisLayerStyleFilterEnvironmentSP _environment)
         : sourceLayer(_sourceLayer),
           filter(rhs.filter ? rhs.filter->clone() : 0),
           style(clonedStyle),
-          environment(new KisLayerStyleFilterEnvironment(_sourceLayer)),
+          environment(_environment ? _environment :
+                      toQShared(new KisLayerStyleFilterEnvironment(_sourceLayer))),
           projection(rhs.projection)
     {
         KIS_SAFE_ASSERT_RECOVER_NOOP(_sourceLayer);
@@ -54,19 +58,19 @@ struct KisLayerStyleFilterProjectionPlane::Private
 
     QScopedPointer<KisLayerStyleFilter> filter;
     KisPSDLayerStyleSP style;
-    QScopedPointer<KisLayerStyleFilterEnvironment> environment;
+    KisLayerStyleFilterEnvironmentSP environment;
 
     KisMultipleProjection projection;
 };
 
 KisLayerStyleFilterProjectionPlane::
-KisLayerStyleFilterProjectionPlane(KisLayer *sourceLayer)
-    : m_d(new Private(sourceLayer))
+KisLayerStyleFilterProjectionPlane(KisLayer *sourceLayer, KisLayerStyleFilterEnvironmentSP environment)
+    : m_d(new Private(sourceLayer, environment))
 {
 }
 
-KisLayerStyleFilterProjectionPlane::KisLayerStyleFilterProjectionPlane(const KisLayerStyleFilterProjectionPlane &rhs, KisLayer *sourceLayer, KisPSDLayerStyleSP clonedStyle)
-    : m_d(new Private(*rhs.m_d, sourceLayer, clonedStyle))
+KisLayerStyleFilterProjectionPlane::KisLayerStyleFilterProjectionPlane(const KisLayerStyleFilterProjectionPlane &rhs, KisLayer *sourceLayer, KisPSDLayerStyleSP clonedStyle, KisLayerStyleFilterEnvironmentSP environment)
+    : m_d(new Private(*rhs.m_d, sourceLayer, clonedStyle, environment))
 {
 }
 
@@ -24,13 +24,23 @@
 #include <QScopedPointer>
 
 #include "kis_types.h"
+#include "kis_layer_style_filter_environment.h"
 
 
 class KisLayerStyleFilterProjectionPlane : public KisAbstractProjectionPlane
 {
 public:
-    KisLayerStyleFilterProjectionPlane(KisLayer *sourceLayer);
-    KisLayerStyleFilterProjectionPlane(const KisLayerStyleFilterProjectionPlane &rhs, KisLayer *sourceLayer, KisPSDLayerStyleSP clonedStyle);
+    /**
+     * \p environment may be shared between all the style filters of the
+     * layer to let them reuse the cached source data. If it is null, the
+     * plane creates its own environment.
+     */
+    KisLayerStyleFilterProjectionPlane(KisLayer *sourceLayer,
+                                       KisLayerStyleFilterEnvironmentSP environment = KisLayerStyleFilterEnvironmentSP());
+    KisLayerStyleFilterProjectionPlane(const KisLayerStyleFilterProjectionPlane &rhs,
+                                       KisLayer *sourceLayer,
+                                       KisPSDLayerStyleSP clonedStyle,
+                                       KisLayerStyleFilterEnvironmentSP environment = KisLayerStyleFilterEnvironmentSP());
     ~KisLayerStyleFilterProjectionPlane() override;
 
     void setStyle(KisLayerStyleFilter *filter, KisPSDLayerStyleSP style);
@@ -20,6 +20,7 @@
 
 #include "kis_global.h"
 #include "kis_layer_style_filter_projection_plane.h"
+#include "kis_layer_style_filter_environment.h"
 #include "kis_psd_layer_style.h"
 
 #include "kis_ls_drop_shadow_filter.h"
@@ -38,6 +39,7 @@ struct Q_DECL_HIDDEN KisLayerStyleProjectionPlane::Private
     QVector<KisLayerStyleFilterProjectionPlaneSP> stylesAfter;
 
     KisPSDLayerStyleSP style;
+    KisLayerStyleFilterEnvironmentSP environment;
     bool canHaveChildNodes = false;
     bool dependsOnLowerNodes = false;
 
@@ -66,17 +68,18 @@ KisLayerStyleProjectionPlane::KisLayerStyleProjectionPlane(const KisLayerStylePr
 {
     m_d->initSourcePlane(sourceLayer);
     m_d->style = clonedStyle;
+    m_d->environment = toQShared(new KisLayerStyleFilterEnvironment(sourceLayer));
 
     KIS_SAFE_ASSERT_RECOVER(m_d->style) {
         m_d->style = toQShared(new KisPSDLayerStyle());
     }
 
     Q_FOREACH (KisLayerStyleFilterProjectionPlaneSP plane, rhs.m_d->stylesBefore) {
-        m_d->stylesBefore << toQShared(new KisLayerStyleFilterProjectionPlane(*plane, sourceLayer, m_d->style));
+        m_d->stylesBefore << toQShared(new KisLayerStyleFilterProjectionPlane(*plane, sourceLayer, m_d->style, m_d->environment));
     }
 
     Q_FOREACH (KisLayerStyleFilterProjectionPlaneSP plane, rhs.m_d->stylesAfter) {
-        m_d->stylesAfter << toQShared(new KisLayerStyleFilterProjectionPlane(*plane, sourceLayer, m_d->style));
+        m_d->stylesAfter << toQShared(new KisLayerStyleFilterProjectionPlane(*plane, sourceLayer, m_d->style, m_d->environment));
     }
 }
 
@@ -93,72 +96,78 @@ void KisLayerStyleProjectionPlane::init(KisLayer *sourceLayer, KisPSDLayerStyleS
     m_d->initSourcePlane(sourceLayer);
     m_d->style = style;
 
+    /**
+     * All the style filters of the layer share the same environment, so
+     * they can reuse the cached source alpha and the temporary devices.
+     */
+    m_d->environment = toQShared(new KisLayerStyleFilterEnvironment(sourceLayer));
+
     {
         KisLayerStyleFilterProjectionPlane *dropShadow =
-            new KisLayerStyleFilterProjectionPlane(sourceLayer);
+            new KisLayerStyleFilterProjectionPlane(sourceLayer, m_d->environment);
         dropShadow->setStyle(new KisLsDropShadowFilter(KisLsDropShadowFilter::DropShadow), style);
         m_d->stylesBefore << toQShared(dropShadow);
     }
 
     {
         KisLayerStyleFilterProjectionPlane *innerShadow =
-            new KisLayerStyleFilterProjectionPlane(sourceLayer);
+            new KisLayerStyleFilterProjectionPlane(sourceLayer, m_d->environment);
         innerShadow->setStyle(new KisLsDropShadowFilter(KisLsDropShadowFilter::InnerShadow), style);
         m_d->stylesAfter << toQShared(innerShadow);
     }
 
     {
         KisLayerStyleFilterProjectionPlane *outerGlow =
-            new KisLayerStyleFilterProjectionPlane(sourceLayer);
+            new KisLayerStyleFilterProjectionPlane(sourceLayer, m_d->environment);
         outerGlow->setStyle(new KisLsDropShadowFilter(KisLsDropShadowFilter::OuterGlow), style);
         m_d->stylesAfter << toQShared(outerGlow);
     }
 
     {
         KisLayerStyleFilterProjectionPlane *innerGlow =
-            new KisLayerStyleFilterProjectionPlane(sourceLayer);
+            new KisLayerStyleFilterProjectionPlane(sourceLayer, m_d->environment);
         innerGlow->setStyle(new KisLsDropShadowFilter(KisLsDropShadowFilter::InnerGlow), style);
         m_d->stylesAfter << toQShared(innerGlow);
     }
 
     {
         KisLayerStyleFilterProjectionPlane *satin =
-            new KisLayerStyleFilterProjectionPlane(sourceLayer);
+            new KisLayerStyleFilterProjectionPlane(sourceLayer, m_d->environment);
         satin->setStyle(new KisLsSatinFilter(), style);
         m_d->stylesAfter << toQShared(satin);
     }
 
     {
         KisLayerStyleFilterProjectionPlane *colorOverlay =
-            new KisLayerStyleFilterProjectionPlane(sourceLayer);
+            new KisLayerStyleFilterProjectionPlane(sourceLayer, m_d->environment);
         colorOverlay->setStyle(new KisLsOverlayFilter(KisLsOverlayFilter::Color), style);
         m_d->stylesAfter << toQShared(colorOverlay);
     }
 
     {
         KisLayerStyleFilterProjectionPlane *gradientOverlay =
-            new KisLayerStyleFilterProjectionPlane(sourceLayer);
+            new KisLayerStyleFilterProjectionPlane(sourceLayer, m_d->environment);
         gradientOverlay->setStyle(new KisLsOverlayFilter(KisLsOverlayFilter::Gradient), style);
         m_d->stylesAfter << toQShared(gradientOverlay);
     }
 
     {
         KisLayerStyleFilterProjectionPlane *patternOverlay =
-            new KisLayerStyleFilterProjectionPlane(sourceLayer);
+            new KisLayerStyleFilterProjectionPlane(sourceLayer, m_d->environment);
         patternOverlay->setStyle(new KisLsOverlayFilter(KisLsOverlayFilter::Pattern), style);
         m_d->stylesAfter << toQShared(patternOverlay);
     }
 
     {
         KisLayerStyleFilterProjectionPlane *stroke =
-            new KisLayerStyleFilterProjectionPlane(sourceLayer);
+            new KisLayerStyleFilterProjectionPlane(sourceLayer, m_d->environment);
         stroke->setStyle(new KisLsStrokeFilter(), style);
         m_d->stylesAfter << toQShared(stroke);
     }
 
     {
         KisLayerStyleFilterProjectionPlane *bevelEmboss =
-            new KisLayerStyleFilterProjectionPlane(sourceLayer);
+            new KisLayerStyleFilterProjectionPlane(sourceLayer, m_d->environment);
         bevelEmboss->setStyle(new KisLsBevelEmbossFilter(), style);
         m_d->stylesAfter << toQShared(bevelEmboss);
     }
@@ -174,11 +183,19 @@ KisAbstractProjectionPlaneSP KisLayerStyleProjectionPlane::factoryObject(KisLaye
     return toQShared(new KisLayerStyleProjectionPlane(sourceLayer));
 }
 
+void KisLayerStyleProjectionPlane::invalidateSourceCache(const QRect &rect)
+{
+    m_d->environment->invalidateSourceAlpha(rect);
+}
+
 QRect KisLayerStyleProjectionPlane::recalculate(const QRect& rect, KisNodeSP filthyNode)
 {
     KisAbstractProjectionPlaneSP sourcePlane = m_d->sourceProjectionPlane.toStrongRef();
     QRect result = sourcePlane->recalculate(rect, filthyNode);
 
+    // the source has changed in this rect, so its cached alpha is outdated
+    m_d->environment->invalidateSourceAlpha(rect);
+
     if (m_d->style->isEnabled()) {
         Q_FOREACH (const KisAbstractProjectionPlaneSP plane, m_d->stylesBefore) {
             plane->recalculate(rect, filthyNode);
@@ -45,6 +45,13 @@ public:
 
     KisPaintDeviceList getLodCapableDevices() const override;
 
+    /**
+     * Notifies the style filters that the projection of the source
+     * layer has changed in \p rect. Must be called for every change
+     * of the projection that doesn't go through recalculate().
+     */
+    void invalidateSourceCache(const QRect &rect);
+
 
     // a method for registering on KisLayerStyleProjectionPlaneFactory
     static KisAbstractProjectionPlaneSP factoryObject(KisLayer *sourceLayer);
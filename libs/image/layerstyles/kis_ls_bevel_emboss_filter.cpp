@@ -276,7 +276,7 @@ void KisLsBevelEmbossFilter::applyBevelEmboss(KisPaintDeviceSP srcDevice,
 
     BevelEmbossRectCalculator d(applyRect, config);
 
-    KisSelectionSP baseSelection = KisLsUtils::selectionFromAlphaChannel(srcDevice, d.initialFetchRect);
+    KisSelectionSP baseSelection = KisLsUtils::selectionFromAlphaChannel(srcDevice, d.initialFetchRect, env);
     KisPixelSelectionSP selection = baseSelection->pixelSelection();
 
     //selection->convertToQImage(0, QRect(0,0,300,300)).save("0_selection_initial.png");
@@ -284,7 +284,8 @@ void KisLsBevelEmbossFilter::applyBevelEmboss(KisPaintDeviceSP srcDevice,
     const int size = config->size();
 
     int limitingGrowSize = 0;
-    KisPixelSelectionSP bumpmapSelection = new KisPixelSelection(new KisSelectionEmptyBounds(0));
+    KisSelectionSP bumpmapBaseSelection = env->fetchTemporarySelection();
+    KisPixelSelectionSP bumpmapSelection = bumpmapBaseSelection->pixelSelection();
 
     switch (config->style()) {
     case psd_bevel_outer_bevel:
@@ -312,10 +313,14 @@ void KisLsBevelEmbossFilter::applyBevelEmboss(KisPaintDeviceSP srcDevice,
     }
     case psd_bevel_stroke_emboss:
         warnKrita << "WARNING: Stroke Emboss style is not implemented yet!";
+        env->releaseTemporarySelection(bumpmapBaseSelection);
+        env->releaseTemporarySelection(baseSelection);
         return;
     }
 
-    KisPixelSelectionSP limitingSelection = new KisPixelSelection(*selection);
+    KisSelectionSP limitingBaseSelection = env->fetchTemporarySelection();
+    KisPixelSelectionSP limitingSelection = limitingBaseSelection->pixelSelection();
+    limitingSelection->makeCloneFromRough(selection, d.initialFetchRect);
     {
         QRect changeRectUnused =
             KisLsUtils::growSelectionUniform(limitingSelection,
@@ -461,6 +466,10 @@ void KisLsBevelEmbossFilter::applyBevelEmboss(KisPaintDeviceSP srcDevice,
 
         KisPainter::copyAreaOptimized(fillRect.topLeft(), fillDevice, dstDevice, fillRect, baseSelection);
     }
+
+    env->releaseTemporarySelection(limitingBaseSelection);
+    env->releaseTemporarySelection(bumpmapBaseSelection);
+    env->releaseTemporarySelection(baseSelection);
 }
 
 void KisLsBevelEmbossFilter::processDirectly(KisPaintDeviceSP src,
@@ -90,7 +90,7 @@ struct ShadowRectsData
             KisLsUtils::growRectFromRadius(noiseNeedRect, blur_size) : noiseNeedRect;
 
         spreadNeedRect = spread_size ?
-            KisLsUtils::growRectFromRadius(blurNeedRect, spread_size) : blurNeedRect;
+            kisGrowRect(blurNeedRect, spread_size) : blurNeedRect;
 
         // dbgKrita << ppVar(dstRect);
         // dbgKrita << ppVar(srcRect);
@@ -131,7 +131,7 @@ void applyDropShadow(KisPaintDeviceSP srcDevice,
     ShadowRectsData d(applyRect, context, shadow, ShadowRectsData::NEED_RECT);
 
     KisSelectionSP baseSelection =
-        KisLsUtils::selectionFromAlphaChannel(srcDevice, d.spreadNeedRect);
+        KisLsUtils::selectionFromAlphaChannel(srcDevice, d.spreadNeedRect, env);
 
     KisPixelSelectionSP selection = baseSelection->pixelSelection();
 
@@ -144,9 +144,12 @@ void applyDropShadow(KisPaintDeviceSP srcDevice,
     /**
      * Copy selection which will be erased from the original later
      */
+    KisSelectionSP knockOutBaseSelection;
     KisPixelSelectionSP knockOutSelection;
     if (shadow->knocksOut()) {
-        knockOutSelection = new KisPixelSelection(*selection);
+        knockOutBaseSelection = env->fetchTemporarySelection();
+        knockOutSelection = knockOutBaseSelection->pixelSelection();
+        knockOutSelection->makeCloneFromRough(selection, d.spreadNeedRect);
     }
 
     if (shadow->technique() == psd_technique_precise) {
@@ -157,11 +160,12 @@ void applyDropShadow(KisPaintDeviceSP srcDevice,
      * Spread and blur the selection
      */
     if (d.spread_size) {
-        KisLsUtils::applyGaussianWithTransaction(selection, d.blurNeedRect, d.spread_size);
-
-        // TODO: find out why in libpsd we pass false here. If we do so,
-        //       the result is fully black, which is not expected
-        KisLsUtils::findEdge(selection, d.blurNeedRect, true /*shadow->edgeHidden()*/);
+        /**
+         * libpsd approximated spread with a blur followed by edge
+         * detection. The distance transform gives an exact hard grow
+         * and costs the same for any spread size.
+         */
+        KisLsUtils::growSelectionUniform(selection, d.spread_size, d.spreadNeedRect);
     }
 
     //selection->convertToQImage(0, QRect(0,0,300,300)).save("1_selection_spread.png");
@@ -225,6 +229,9 @@ void applyDropShadow(KisPaintDeviceSP srcDevice,
         KisPainter gc(selection);
         gc.setCompositeOp(COMPOSITE_ERASE);
         gc.bitBlt(knockOutRect.topLeft(), knockOutSelection, knockOutRect);
+        gc.end();
+
+        env->releaseTemporarySelection(knockOutBaseSelection);
     }
     //selection->convertToQImage(0, QRect(0,0,300,300)).save("5_selection_knockout.png");
 
@@ -237,6 +244,8 @@ void applyDropShadow(KisPaintDeviceSP srcDevice,
                                     context,
                                     shadow,
                                     env);
+
+    env->releaseTemporarySelection(baseSelection);
 }
 
 const psd_layer_effects_shadow_base*
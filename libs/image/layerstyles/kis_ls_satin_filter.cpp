@@ -141,18 +141,22 @@ void applySatin(KisPaintDeviceSP srcDevice,
     SatinRectsData d(applyRect, context, config, SatinRectsData::NEED_RECT);
 
     KisSelectionSP baseSelection =
-        KisLsUtils::selectionFromAlphaChannel(srcDevice, d.blurNeedRect);
+        KisLsUtils::selectionFromAlphaChannel(srcDevice, d.blurNeedRect, env);
 
     KisPixelSelectionSP selection = baseSelection->pixelSelection();
 
     //selection->convertToQImage(0, QRect(0,0,300,300)).save("0_selection_initial.png");
 
-    KisPixelSelectionSP knockOutSelection = new KisPixelSelection(*selection);
+    KisSelectionSP knockOutBaseSelection = env->fetchTemporarySelection();
+    KisPixelSelectionSP knockOutSelection = knockOutBaseSelection->pixelSelection();
+    knockOutSelection->makeCloneFromRough(selection, d.blurNeedRect);
     knockOutSelection->invert();
 
     //knockOutSelection->convertToQImage(0, QRect(0,0,300,300)).save("1_saved_knockout_selection.png");
 
-    KisPixelSelectionSP tempSelection = new KisPixelSelection(*selection);
+    KisSelectionSP tempBaseSelection = env->fetchTemporarySelection();
+    KisPixelSelectionSP tempSelection = tempBaseSelection->pixelSelection();
+    tempSelection->makeCloneFromRough(selection, d.blurNeedRect);
 
     KisLsUtils::applyGaussianWithTransaction(tempSelection, d.satinNeedRect, d.blur_size);
 
@@ -175,6 +179,8 @@ void applySatin(KisPaintDeviceSP srcDevice,
                                  d.offset,
                                  d.dstRect);
 
+    env->releaseTemporarySelection(tempBaseSelection);
+
     //selection->convertToQImage(0, QRect(0,0,300,300)).save("3_selection_satin_applied.png");
 
     /**
@@ -188,6 +194,8 @@ void applySatin(KisPaintDeviceSP srcDevice,
                                       d.finalNeedRect(),
                                       config->invertsSelection());
     }
+
+    env->releaseTemporarySelection(knockOutBaseSelection);
     //selection->convertToQImage(0, QRect(0,0,300,300)).save("5_selection_knocked_out.png");
 
     KisLsUtils::applyFinalSelection(KisMultipleProjection::defaultProjectionId(),
@@ -200,6 +208,8 @@ void applySatin(KisPaintDeviceSP srcDevice,
                                     config,
                                     env);
 
+    env->releaseTemporarySelection(baseSelection);
+
     //dstDevice->convertToQImage(0, QRect(0,0,300,300)).save("6_dst_final.png");
 }
 
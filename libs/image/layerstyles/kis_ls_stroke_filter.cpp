@@ -30,7 +30,7 @@
 
 #include "kis_convolution_kernel.h"
 #include "kis_convolution_painter.h"
-#include "kis_gaussian_kernel.h"
+#include "KisDistanceTransform.h"
 
 #include "kis_pixel_selection.h"
 #include "kis_fill_painter.h"
@@ -93,29 +93,34 @@ void KisLsStrokeFilter::applyStroke(KisPaintDeviceSP srcDevice,
 
     const QRect needRect = kisGrowRect(applyRect, borderSize(config->position(), config->size()));
 
-    KisSelectionSP baseSelection = KisLsUtils::selectionFromAlphaChannel(srcDevice, needRect);
+    KisSelectionSP baseSelection = KisLsUtils::selectionFromAlphaChannel(srcDevice, needRect, env);
     KisPixelSelectionSP selection = baseSelection->pixelSelection();
 
     {
-        KisPixelSelectionSP knockOutSelection = new KisPixelSelection(new KisSelectionEmptyBounds(0));
+        KisSelectionSP knockOutBaseSelection = env->fetchTemporarySelection();
+        KisPixelSelectionSP knockOutSelection = knockOutBaseSelection->pixelSelection();
         knockOutSelection->makeCloneFromRough(selection, needRect);
 
+        const int radius = config->position() == psd_stroke_center ? config->size() : 2 * config->size();
+
         if (config->position() == psd_stroke_outside) {
-            KisGaussianKernel::applyDilate(selection, needRect, 2 * config->size(), QBitArray(), 0, true);
+            KisDistanceTransform::dilateU8(selection, needRect, radius, radius);
         } else if (config->position() == psd_stroke_inside) {
-            KisGaussianKernel::applyErodeU8(knockOutSelection, needRect, 2 * config->size(), QBitArray(), 0, true);
+            KisDistanceTransform::erodeU8(knockOutSelection, needRect, radius, radius, true);
         } else if (config->position() == psd_stroke_center) {
-            KisGaussianKernel::applyDilate(selection, needRect, config->size(), QBitArray(), 0, true);
-            KisGaussianKernel::applyErodeU8(knockOutSelection, needRect, config->size(), QBitArray(), 0, true);
+            KisDistanceTransform::dilateU8(selection, needRect, radius, radius);
+            KisDistanceTransform::erodeU8(knockOutSelection, needRect, radius, radius, true);
         }
 
         KisPainter gc(selection);
         gc.setCompositeOp(COMPOSITE_ERASE);
         gc.bitBlt(needRect.topLeft(), knockOutSelection, needRect);
         gc.end();
+
+        env->releaseTemporarySelection(knockOutBaseSelection);
     }
 
-    KisPaintDeviceSP fillDevice = new KisPaintDevice(srcDevice->colorSpace());
+    KisPaintDeviceSP fillDevice = env->fetchTemporaryDevice(srcDevice);
     KisLsUtils::fillOverlayDevice(fillDevice, applyRect, config, env);
 
 
@@ -128,6 +133,9 @@ void KisLsStrokeFilter::applyStroke(KisPaintDeviceSP srcDevice,
                                                     srcDevice);
 
     KisPainter::copyAreaOptimized(applyRect.topLeft(), fillDevice, dstDevice, applyRect, baseSelection);
+
+    env->releaseTemporaryDevice(fillDevice);
+    env->releaseTemporarySelection(baseSelection);
 }
 
 void KisLsStrokeFilter::processDirectly(KisPaintDeviceSP src,
@@ -61,22 +61,31 @@ namespace KisLsUtils
         return changeRect;
     }
 
-    KisSelectionSP selectionFromAlphaChannel(KisPaintDeviceSP device,
-                                             const QRect &srcRect)
+    void convertAlphaToSelection(KisPaintDeviceSP device,
+                                 KisPixelSelectionSP selection,
+                                 const QRect &rect)
     {
         const KoColorSpace *cs = device->colorSpace();
 
-        KisSelectionSP baseSelection = new KisSelection(new KisSelectionEmptyBounds(0));
-        KisPixelSelectionSP selection = baseSelection->pixelSelection();
-
-        KisSequentialConstIterator srcIt(device, srcRect);
-        KisSequentialIterator dstIt(selection, srcRect);
+        KisSequentialConstIterator srcIt(device, rect);
+        KisSequentialIterator dstIt(selection, rect);
 
         while (srcIt.nextPixel() && dstIt.nextPixel()) {
             quint8 *dstPtr = dstIt.rawData();
             const quint8* srcPtr = srcIt.rawDataConst();
             *dstPtr = cs->opacityU8(srcPtr);
         }
+    }
+
+    KisSelectionSP selectionFromAlphaChannel(KisPaintDeviceSP device,
+                                             const QRect &srcRect,
+                                             const KisLayerStyleFilterEnvironment *env)
+    {
+        KisSelectionSP baseSelection = env->fetchTemporarySelection();
+        KisPixelSelectionSP selection = baseSelection->pixelSelection();
+
+        KisPixelSelectionSP sourceAlpha = env->cachedSourceAlpha(device, srcRect);
+        KisPainter::copyAreaOptimized(srcRect.topLeft(), sourceAlpha, selection, srcRect);
 
         return baseSelection;
     }
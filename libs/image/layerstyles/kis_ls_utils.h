@@ -37,8 +37,18 @@ namespace KisLsUtils
 
     QRect growSelectionUniform(KisPixelSelectionSP selection, int growSize, const QRect &applyRect);
 
+    void convertAlphaToSelection(KisPaintDeviceSP device,
+                                 KisPixelSelectionSP selection,
+                                 const QRect &rect);
+
+    /**
+     * Returns a temporary selection with the alpha channel of \p device
+     * in \p srcRect. The selection is fetched from the pool of \p env and
+     * should be released with releaseTemporarySelection() after use.
+     */
     KisSelectionSP selectionFromAlphaChannel(KisPaintDeviceSP device,
-                                             const QRect &srcRect);
+                                             const QRect &srcRect,
+                                             const KisLayerStyleFilterEnvironment *env);
 
     void findEdge(KisPixelSelectionSP selection, const QRect &applyRect, const bool edgeHidden);
     QRect growRectFromRadius(const QRect &rc, int radius);
@@ -34,7 +34,9 @@
 
 #include "kis_random_accessor_ng.h"
 
-#include <boost/heap/fibonacci_heap.hpp>
+#include "KisSharedWorkerPool.h"
+
+#include <algorithm>
 #include <set>
 
 using namespace KisLazyFillTools;
@@ -134,13 +136,6 @@ struct TaskPoint {
     quint8 level = 0;
 };
 
-struct CompareTaskPoints {
-    bool operator()(const TaskPoint &pt1, const TaskPoint &pt2) const {
-        return
-            pt1.level > pt2.level || (pt1.level == pt2.level && pt1.distance > pt2.distance);
-    }
-};
-
 /**
  * Adjusts the stroke device in a way that all the stroke's pixels
  * are set to the range 1...255, according to the height of this pixel
@@ -166,14 +161,11 @@ void mergeHeightmapOntoStroke(KisPaintDeviceSP stroke, KisPaintDeviceSP heightMa
 
 void parseColorIntoGroups(QVector<FillGroup> &groups,
                           KisPaintDeviceSP groupMap,
-                          KisPaintDeviceSP heightMap,
                           int colorIndex,
                           KisPaintDeviceSP stroke,
+                          const QRect &strokeRect,
                           const QRect &boundingRect)
 {
-    const QRect strokeRect = stroke->exactBounds();
-    mergeHeightmapOntoStroke(stroke, heightMap, strokeRect);
-
     KisSequentialIterator dstIt(stroke, strokeRect);
 
     while (dstIt.nextPixel()) {
@@ -196,8 +188,98 @@ void parseColorIntoGroups(QVector<FillGroup> &groups,
     }
 }
 
-using PointsPriorityQueue = boost::heap::fibonacci_heap<TaskPoint, boost::heap::compare<CompareTaskPoints>>;
+/**
+ * Splits \p rc into horizontal bands aligned to the tile grid. The bands
+ * never share a tile, so they can be written concurrently, and they keep
+ * the scanline order of the rect when processed one after another.
+ */
+QVector<QRect> splitIntoTileRowBands(const QRect &rc)
+{
+    const int tileHeight = 64;
+
+    QVector<QRect> bands;
+
+    int y = rc.top();
+    while (y <= rc.bottom()) {
+        const int tileTop = y - (y % tileHeight + tileHeight) % tileHeight;
+        const int bottom = qMin(rc.bottom(), tileTop + tileHeight - 1);
+
+        bands << QRect(rc.left(), y, rc.width(), bottom - y + 1);
+        y = bottom + 1;
+    }
 
+    return bands;
+}
+
+/**
+ * A hierarchical (bucket) queue of the task points. Since the levels
+ * of the heightmap are quint8, every level gets its own bucket and the
+ * lowest non-empty level is tracked with a cursor, so that we don't pay
+ * for the comparison of the levels on every push/pop. Inside a bucket the
+ * points are ordered by distance and, for equal distances, in the
+ * first-in-first-out order, which is the classic flooding order of the
+ * watershed and makes the result independent of the heap implementation.
+ */
+class PointsPriorityQueue
+{
+    struct QueuedPoint {
+        TaskPoint pt;
+        quint64 order;
+    };
+
+    struct CompareQueuedPoints {
+        bool operator()(const QueuedPoint &pt1, const QueuedPoint &pt2) const {
+            return
+                pt1.pt.distance > pt2.pt.distance ||
+                (pt1.pt.distance == pt2.pt.distance && pt1.order > pt2.order);
+        }
+    };
+
+public:
+    bool empty() const {
+        return !m_size;
+    }
+
+    void push(const TaskPoint &pt) {
+        m_size++;
+
+        std::vector<QueuedPoint> &bucket = m_buckets[pt.level];
+        bucket.push_back({pt, m_nextOrder++});
+        std::push_heap(bucket.begin(), bucket.end(), CompareQueuedPoints());
+
+        m_minLevel = qMin(m_minLevel, int(pt.level));
+    }
+
+    const TaskPoint& top() const {
+        KIS_SAFE_ASSERT_RECOVER(m_size) {
+            static const TaskPoint emptyPoint;
+            return emptyPoint;
+        }
+
+        return m_buckets[m_minLevel].front().pt;
+    }
+
+    void pop() {
+        KIS_SAFE_ASSERT_RECOVER_RETURN(m_size);
+
+        std::vector<QueuedPoint> &bucket = m_buckets[m_minLevel];
+        std::pop_heap(bucket.begin(), bucket.end(), CompareQueuedPoints());
+        bucket.pop_back();
+        m_size--;
+
+        while (m_minLevel < numLevels && m_buckets[m_minLevel].empty()) {
+            m_minLevel++;
+        }
+    }
+
+private:
+    static const int numLevels = 256;
+
+    std::vector<QueuedPoint> m_buckets[numLevels];
+    int m_minLevel = numLevels;
+    quint64 m_nextOrder = 0;
+    int m_size = 0;
+};
 }
 
 /***********************************************************************/
@@ -206,8 +288,6 @@ using PointsPriorityQueue = boost::heap::fibonacci_heap<TaskPoint, boost::heap::
 
 struct KisWatershedWorker::Private
 {
-    Private() : pointsQueue(pointsComparator) {}
-
     KisPaintDeviceSP heightMap;
     KisPaintDeviceSP dstDevice;
 
@@ -217,7 +297,6 @@ struct KisWatershedWorker::Private
     QVector<FillGroup> groups;
     KisPaintDeviceSP groupsMap;
 
-    CompareTaskPoints pointsComparator;
     PointsPriorityQueue pointsQueue;
 
     // temporary "global" variables for the processing routines
@@ -312,10 +391,26 @@ void KisWatershedWorker::run(qreal cleanUpAmount)
 
     m_d->groups << FillGroup(-1);
 
+    /**
+     * Every stroke has its own device, so the heightmap can be merged into
+     * all of them concurrently. Splitting the strokes into groups writes
+     * into the shared group map and the group list, so it stays sequential.
+     */
+    QVector<QRect> strokeRects(m_d->keyStrokes.size());
+    QRect *strokeRectsPtr = strokeRects.data();
+
+    KisSharedWorkerPool::parallelFor(m_d->keyStrokes.size(),
+        [this, strokeRectsPtr] (int index) {
+            KisPaintDeviceSP stroke = m_d->keyStrokes.at(index).dev;
+            const QRect strokeRect = stroke->exactBounds();
+            mergeHeightmapOntoStroke(stroke, m_d->heightMap, strokeRect);
+            strokeRectsPtr[index] = strokeRect;
+        });
+
     for (int i = 0; i < m_d->keyStrokes.size(); i++) {
         parseColorIntoGroups(m_d->groups, m_d->groupsMap,
-                             m_d->heightMap,
                              i, m_d->keyStrokes[i].dev,
+                             strokeRects[i],
                              m_d->boundingRect);
     }
 
@@ -383,28 +478,49 @@ void KisWatershedWorker::testingTryRemoveGroup(qint32 group, quint8 levelIndex)
 
 void KisWatershedWorker::Private::initializeQueueFromGroupMap(const QRect &rc)
 {
-    KisSequentialIterator groupMapIt(groupsMap, rc);
-    KisSequentialConstIterator heightMapIt(heightMap, rc);
+    /**
+     * The group map is scanned in parallel tile-row bands. The found points
+     * are pushed into the queue afterwards in the order of the bands, so the
+     * queue gets exactly the same sequence as with a plain sequential scan.
+     */
+    const QVector<QRect> bands = splitIntoTileRowBands(rc);
 
-    while (groupMapIt.nextPixel() &&
-           heightMapIt.nextPixel()) {
+    QVector<QVector<TaskPoint>> bandPoints(bands.size());
+    QVector<TaskPoint> *bandPointsPtr = bandPoints.data();
 
-        qint32 *groupPtr = reinterpret_cast<qint32*>(groupMapIt.rawData());
-        const quint8 *heightPtr = heightMapIt.rawDataConst();
+    KisSharedWorkerPool::parallelFor(bands.size(),
+        [this, &bands, bandPointsPtr] (int index) {
+            const QRect &bandRect = bands.at(index);
+            QVector<TaskPoint> &points = bandPointsPtr[index];
 
-        if (*groupPtr > 0) {
-            TaskPoint pt;
-            pt.x = groupMapIt.x();
-            pt.y = groupMapIt.y();
-            pt.group = *groupPtr;
-            pt.level = *heightPtr;
+            KisSequentialIterator groupMapIt(groupsMap, bandRect);
+            KisSequentialConstIterator heightMapIt(heightMap, bandRect);
 
-            pointsQueue.push(pt);
+            while (groupMapIt.nextPixel() &&
+                   heightMapIt.nextPixel()) {
 
-            // we must clear the pixel to make sure foreign metric is calculated correctly
-            *groupPtr = 0;
-        }
+                qint32 *groupPtr = reinterpret_cast<qint32*>(groupMapIt.rawData());
+                const quint8 *heightPtr = heightMapIt.rawDataConst();
+
+                if (*groupPtr > 0) {
+                    TaskPoint pt;
+                    pt.x = groupMapIt.x();
+                    pt.y = groupMapIt.y();
+                    pt.group = *groupPtr;
+                    pt.level = *heightPtr;
 
+                    points.append(pt);
+
+                    // we must clear the pixel to make sure foreign metric is calculated correctly
+                    *groupPtr = 0;
+                }
+            }
+        });
+
+    Q_FOREACH (const QVector<TaskPoint> &points, bandPoints) {
+        Q_FOREACH (const TaskPoint &pt, points) {
+            pointsQueue.push(pt);
+        }
     }
 }
 
@@ -631,6 +747,16 @@ void KisWatershedWorker::Private::visitNeighbour(const QPoint &currPt, const QPo
 
 #include <QElapsedTimer>
 
+/**
+ * NOTE: the flood itself is sequential on purpose. The edge counters and
+ *       the conflict sets of the groups are updated incrementally, pixel by
+ *       pixel, in the order of the queue, and cleanupForeignEdgeGroups()
+ *       and tryRemoveConflictingPlane() rely on them being exact. A flood
+ *       partitioned into tiles would let the fronts of the same group meet
+ *       on the tile borders in a different order, so every border would
+ *       have to be re-flooded to recalculate the counters, which costs as
+ *       much as the flood itself on line art with big flat areas.
+ */
 void KisWatershedWorker::Private::processQueue(qint32 _backgroundGroupId)
 {
     QElapsedTimer tt; tt.start();
@@ -718,9 +844,6 @@ void KisWatershedWorker::Private::processQueue(qint32 _backgroundGroupId)
 
 void KisWatershedWorker::Private::writeColoring()
 {
-    KisSequentialConstIterator srcIt(groupsMap, boundingRect);
-    KisSequentialIterator dstIt(dstDevice, boundingRect);
-
     QVector<KoColor> colors;
     for (auto it = keyStrokes.begin(); it != keyStrokes.end(); ++it) {
         KoColor color = it->color;
@@ -729,16 +852,23 @@ void KisWatershedWorker::Private::writeColoring()
     }
     const int colorPixelSize = dstDevice->pixelSize();
 
+    // the bands never share a tile, so they can be written concurrently
+    QVector<QRect> bands = splitIntoTileRowBands(boundingRect);
 
-    while (srcIt.nextPixel() && dstIt.nextPixel()) {
-        const qint32 *srcPtr = reinterpret_cast<const qint32*>(srcIt.rawDataConst());
+    KisSharedWorkerPool::blockingMap(bands,
+        [this, &colors, colorPixelSize] (const QRect &bandRect) {
+            KisSequentialConstIterator srcIt(groupsMap, bandRect);
+            KisSequentialIterator dstIt(dstDevice, bandRect);
 
-        const int colorIndex = groups[*srcPtr].colorIndex;
-        if (colorIndex >= 0) {
-            memcpy(dstIt.rawData(), colors[colorIndex].data(), colorPixelSize);
-        }
+            while (srcIt.nextPixel() && dstIt.nextPixel()) {
+                const qint32 *srcPtr = reinterpret_cast<const qint32*>(srcIt.rawDataConst());
 
-    }
+                const int colorIndex = groups.at(*srcPtr).colorIndex;
+                if (colorIndex >= 0) {
+                    memcpy(dstIt.rawData(), colors.at(colorIndex).data(), colorPixelSize);
+                }
+            }
+        });
 }
 
 QVector<TaskPoint> KisWatershedWorker::Private::tryRemoveConflictingPlane(qint32 group, quint8 level)
@@ -128,6 +128,8 @@ struct KisColorizeMask::Private
 
     bool limitToDeviceBounds = false;
 
+    RegenerationTimings lastRegenerationTimings;
+
     bool filteredSourceValid(KisPaintDeviceSP parentDevice) {
         return !filteringDirty && originalSequenceNumber == parentDevice->sequenceNumber();
     }
@@ -368,6 +370,7 @@ void KisColorizeMask::slotUpdateRegenerateFilling(bool prefilterOnly)
 
         m_d->extentBeforeUpdateStart.push(extent());
 
+        connect(strategy, SIGNAL(sigTimingsReported(int,int,int)), SLOT(slotRegenerationTimingsReported(int,int,int)));
         connect(strategy, SIGNAL(sigFinished(bool)), SLOT(slotRegenerationFinished(bool)));
         connect(strategy, SIGNAL(sigCancelled()), SLOT(slotRegenerationCancelled()));
         KisStrokeId id = image->startStroke(strategy);
@@ -420,6 +423,15 @@ void KisColorizeMask::slotRegenerationCancelled()
     slotRegenerationFinished(true);
 }
 
+void KisColorizeMask::slotRegenerationTimingsReported(int prefilteringTime, int watershedTime, int totalTime)
+{
+    m_d->lastRegenerationTimings.prefilteringTime = prefilteringTime;
+    m_d->lastRegenerationTimings.watershedTime = watershedTime;
+    m_d->lastRegenerationTimings.totalTime = totalTime;
+
+    baseNodeChangedCallback();
+}
+
 KisBaseNode::PropertyList KisColorizeMask::sectionModelProperties() const
 {
     KisBaseNode::PropertyList l = KisMask::sectionModelProperties();
@@ -1053,6 +1065,11 @@ bool KisColorizeMask::limitToDeviceBounds() const
     return m_d->limitToDeviceBounds;
 }
 
+KisColorizeMask::RegenerationTimings KisColorizeMask::lastRegenerationTimings() const
+{
+    return m_d->lastRegenerationTimings;
+}
+
 void KisColorizeMask::rerenderFakePaintDevice()
 {
     m_d->fakePaintDevice->clear();
@@ -43,6 +43,16 @@ public:
         int transparentIndex = -1;
     };
 
+    /**
+     * The time spent on the last regeneration of the mask, in milliseconds.
+     * The fields are -1 if the corresponding step was skipped.
+     */
+    struct RegenerationTimings {
+        int prefilteringTime = -1;
+        int watershedTime = -1;
+        int totalTime = -1;
+    };
+
 public:
     KisColorizeMask();
     ~KisColorizeMask() override;
@@ -119,6 +129,8 @@ public:
     void setLimitToDeviceBounds(bool value);
     bool limitToDeviceBounds() const;
 
+    RegenerationTimings lastRegenerationTimings() const;
+
     void testingAddKeyStroke(KisPaintDeviceSP dev, const KoColor &color, bool isTransparent = false);
     void testingRegenerateMask();
     KisPaintDeviceSP testingFilteredSource() const;
@@ -139,6 +151,7 @@ private Q_SLOTS:
     void slotUpdateRegenerateFilling(bool prefilterOnly = false);
     void slotRegenerationFinished(bool prefilterOnly);
     void slotRegenerationCancelled();
+    void slotRegenerationTimingsReported(int prefilteringTime, int watershedTime, int totalTime);
 
     void slotUpdateOnDirtyParent();
     void slotRecalculatePrefilteredImage();
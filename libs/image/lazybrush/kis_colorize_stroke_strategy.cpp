@@ -19,6 +19,7 @@
 #include "kis_colorize_stroke_strategy.h"
 
 #include <QBitArray>
+#include <QElapsedTimer>
 
 #include "krita_utils.h"
 #include "kis_paint_device.h"
@@ -33,6 +34,7 @@
 #include "kis_processing_visitor.h"
 
 #include "kis_transaction.h"
+#include "kis_debug.h"
 
 #include <KisRunnableStrokeJobData.h>
 #include <KisRunnableStrokeJobUtils.h>
@@ -73,6 +75,10 @@ struct KisColorizeStrokeStrategy::Private
 
     // default values: disabled
     FilteringOptions filteringOptions;
+
+    QElapsedTimer strokeTime;
+    int prefilteringTime = -1;
+    int watershedTime = -1;
 };
 
 KisColorizeStrokeStrategy::KisColorizeStrokeStrategy(KisPaintDeviceSP src,
@@ -135,6 +141,8 @@ void KisColorizeStrokeStrategy::initStrokeCallback()
 
     QVector<KisRunnableStrokeJobData*> jobs;
 
+    m_d->strokeTime.start();
+
     const QVector<QRect> patchRects =
         splitRectIntoPatches(m_d->boundingRect, optimalPatchSize());
 
@@ -228,6 +236,8 @@ void KisColorizeStrokeStrategy::initStrokeCallback()
             m_d->filteredSource->makeCloneFrom(state->filteredMainDev, m_d->boundingRect);
             m_d->filteredSource->setDefaultBounds(oldBounds);
             m_d->filteredSourceValid = true;
+
+            m_d->prefilteringTime = m_d->strokeTime.elapsed();
         });
     }
 
@@ -246,6 +256,9 @@ void KisColorizeStrokeStrategy::initStrokeCallback()
         }
 
         addJobSequential(jobs, [this] () {
+            QElapsedTimer watershedTime;
+            watershedTime.start();
+
             KisProcessingVisitor::ProgressHelper helper(m_d->progressNode);
 
             KisWatershedWorker worker(m_d->heightMap, m_d->dst, m_d->boundingRect, helper.updater());
@@ -257,10 +270,20 @@ void KisColorizeStrokeStrategy::initStrokeCallback()
                 worker.addKeyStroke(stroke.dev, color);
             }
             worker.run(m_d->filteringOptions.cleanUpAmount);
+
+            m_d->watershedTime = watershedTime.elapsed();
         });
     }
 
     addJobSequential(jobs, [this] () {
+        const int totalTime = m_d->strokeTime.elapsed();
+
+        dbgImage << "Colorize: prefiltering took" << m_d->prefilteringTime << "ms,"
+                 << "watershed took" << m_d->watershedTime << "ms,"
+                 << "the whole stroke took" << totalTime << "ms"
+                 << "for" << m_d->keyStrokes.size() << "key strokes in" << m_d->boundingRect;
+
+        emit sigTimingsReported(m_d->prefilteringTime, m_d->watershedTime, totalTime);
         emit sigFinished(m_d->prefilterOnly);
     });
 
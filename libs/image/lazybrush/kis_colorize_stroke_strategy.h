@@ -59,6 +59,13 @@ public:
     KisStrokeStrategy *createLodClone(int levelOfDetail) override;
 
 Q_SIGNALS:
+    /**
+     * Reports the time spent on the stroke right before sigFinished() is
+     * emitted. The times are in milliseconds, \p prefilteringTime is -1 if
+     * the prefiltered source was reused and \p watershedTime is -1 for the
+     * prefiltering-only strokes.
+     */
+    void sigTimingsReported(int prefilteringTime, int watershedTime, int totalTime);
     void sigFinished(bool prefilterOnly);
     void sigCancelled();
 
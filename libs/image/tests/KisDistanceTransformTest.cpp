@@ -0,0 +1,155 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisDistanceTransformTest.h"
+
+#include <QTest>
+
+#include "kis_global.h"
+#include "kis_pixel_selection.h"
+#include "kis_selection_filters.h"
+#include "KisDistanceTransform.h"
+
+
+void KisDistanceTransformTest::testSquaredDistance()
+{
+    const int width = 37;
+    const int height = 23;
+    const qreal xScale = 1.0;
+    const qreal yScale = 2.5;
+    const float maxDistance = 1e9;
+
+    QVector<QPoint> features;
+    features << QPoint(3, 4) << QPoint(30, 2) << QPoint(17, 20) << QPoint(36, 22);
+
+    QVector<float> data(width * height, maxDistance);
+    Q_FOREACH (const QPoint &pt, features) {
+        data[pt.y() * width + pt.x()] = 0.0f;
+    }
+
+    KisDistanceTransform::squaredDistance(data.data(), width, height, xScale, yScale);
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            qreal expected = maxDistance;
+
+            Q_FOREACH (const QPoint &pt, features) {
+                expected = qMin(expected,
+                                pow2(xScale * (x - pt.x())) +
+                                pow2(yScale * (y - pt.y())));
+            }
+
+            QVERIFY(qAbs(data[y * width + x] - expected) < 1e-3);
+        }
+    }
+}
+
+inline quint8 pixelValue(KisPixelSelectionSP selection, int x, int y)
+{
+    quint8 value = 0;
+    selection->readBytes(&value, x, y, 1, 1);
+    return value;
+}
+
+void KisDistanceTransformTest::testGrowSelection()
+{
+    KisPixelSelectionSP selection = new KisPixelSelection();
+    selection->select(QRect(40, 40, 20, 20), MAX_SELECTED);
+
+    KisGrowSelectionFilter filter(10, 10);
+    filter.process(selection, filter.changeRect(selection->selectedExactRect()));
+
+    QCOMPARE(selection->selectedExactRect(), QRect(30, 30, 40, 40));
+    QCOMPARE(pixelValue(selection, 30, 45), MAX_SELECTED);
+    QCOMPARE(pixelValue(selection, 31, 31), MIN_SELECTED);
+
+    /**
+     * The cost of a huge radius is the same, so we can check it as well
+     */
+    selection->clear();
+    selection->select(QRect(0, 0, 1, 1), MAX_SELECTED);
+
+    KisGrowSelectionFilter bigFilter(300, 300);
+    bigFilter.process(selection, bigFilter.changeRect(selection->selectedExactRect()));
+
+    QCOMPARE(pixelValue(selection, 210, 210), MAX_SELECTED);
+    QCOMPARE(pixelValue(selection, 215, 215), MIN_SELECTED);
+    QCOMPARE(pixelValue(selection, -300, 0), MAX_SELECTED);
+    QCOMPARE(selection->selectedExactRect(), QRect(-300, -300, 601, 601));
+}
+
+void KisDistanceTransformTest::testShrinkSelection()
+{
+    const QRect selectedRect(0, 0, 50, 50);
+
+    KisPixelSelectionSP selection = new KisPixelSelection();
+    selection->select(selectedRect, MAX_SELECTED);
+
+    KisShrinkSelectionFilter lockedFilter(5, 5, true);
+    lockedFilter.process(selection, selectedRect);
+    QCOMPARE(selection->selectedExactRect(), selectedRect);
+
+    KisShrinkSelectionFilter filter(5, 5, false);
+    filter.process(selection, selectedRect);
+    QCOMPARE(selection->selectedExactRect(), QRect(5, 5, 40, 40));
+    QCOMPARE(pixelValue(selection, 4, 25), MIN_SELECTED);
+    QCOMPARE(pixelValue(selection, 5, 25), MAX_SELECTED);
+}
+
+void KisDistanceTransformTest::testGrowSoftSelection()
+{
+    const quint8 softValue = 100;
+
+    KisPixelSelectionSP selection = new KisPixelSelection();
+    selection->select(QRect(40, 40, 20, 20), softValue);
+
+    KisGrowSelectionFilter filter(5, 5);
+    filter.process(selection, filter.changeRect(selection->selectedExactRect()));
+
+    /**
+     * The soft area should grow keeping its value, not be thresholded
+     * away or promoted to a hard one
+     */
+    QCOMPARE(selection->selectedExactRect(), QRect(35, 35, 30, 30));
+    QCOMPARE(pixelValue(selection, 35, 50), softValue);
+    QCOMPARE(pixelValue(selection, 50, 50), softValue);
+    QCOMPARE(pixelValue(selection, 50, 64), softValue);
+    QCOMPARE(pixelValue(selection, 35, 35), MIN_SELECTED);
+}
+
+void KisDistanceTransformTest::testShrinkSoftSelection()
+{
+    const quint8 softValue = 100;
+    const QRect selectedRect(0, 0, 50, 50);
+
+    KisPixelSelectionSP selection = new KisPixelSelection();
+    selection->select(selectedRect, softValue);
+
+    KisShrinkSelectionFilter lockedFilter(5, 5, true);
+    lockedFilter.process(selection, selectedRect);
+    QCOMPARE(selection->selectedExactRect(), selectedRect);
+    QCOMPARE(pixelValue(selection, 0, 0), softValue);
+
+    KisShrinkSelectionFilter filter(5, 5, false);
+    filter.process(selection, selectedRect);
+    QCOMPARE(selection->selectedExactRect(), QRect(5, 5, 40, 40));
+    QCOMPARE(pixelValue(selection, 4, 25), MIN_SELECTED);
+    QCOMPARE(pixelValue(selection, 5, 25), softValue);
+}
+
+QTEST_MAIN(KisDistanceTransformTest)
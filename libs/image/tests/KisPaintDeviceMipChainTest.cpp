@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisPaintDeviceMipChainTest.h"
+
+#include <QTest>
+
+#include <KoColor.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_paint_device.h"
+#include "KisPaintDeviceMipChain.h"
+
+
+inline QColor pixelColor(KisPaintDeviceSP dev, int x, int y)
+{
+    QColor color;
+    dev->pixel(x, y, &color);
+    return color;
+}
+
+void KisPaintDeviceMipChainTest::testLevels()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect bounds(0, 0, 512, 300);
+    dev->fill(bounds, KoColor(Qt::red, cs));
+
+    KisPaintDeviceMipChain chain(dev, bounds, 64);
+
+    QCOMPARE(chain.numLevels(), 4);
+    QCOMPARE(chain.level(0), dev);
+    QCOMPARE(chain.levelBounds(1), QRect(0, 0, 256, 150));
+    QCOMPARE(chain.levelBounds(2), QRect(0, 0, 128, 75));
+    QCOMPARE(chain.levelBounds(3), QRect(0, 0, 64, 38));
+
+    QCOMPARE(chain.levelForScale(1.0), 0);
+    QCOMPARE(chain.levelForScale(0.5), 1);
+    QCOMPARE(chain.levelForScale(0.3), 1);
+    QCOMPARE(chain.levelForScale(0.25), 2);
+    QCOMPARE(chain.levelForScale(0.01), 3);
+
+    chain.update();
+
+    for (int i = 1; i < chain.numLevels(); i++) {
+        const QRect rc = chain.levelBounds(i);
+        QCOMPARE(chain.level(i)->exactBounds(), rc);
+        QCOMPARE(pixelColor(chain.level(i), rc.center().x(), rc.center().y()), QColor(Qt::red));
+
+        // the blocks cut by the odd size of the previous level are not blended with transparency
+        QCOMPARE(pixelColor(chain.level(i), rc.left(), rc.bottom()), QColor(Qt::red));
+        QCOMPARE(pixelColor(chain.level(i), rc.right(), rc.bottom()), QColor(Qt::red));
+    }
+}
+
+void KisPaintDeviceMipChainTest::testIncrementalUpdate()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect bounds(0, 0, 512, 512);
+    dev->fill(bounds, KoColor(Qt::red, cs));
+
+    KisPaintDeviceMipChain chain(dev, bounds, 64);
+    chain.update();
+
+    const QRect dirtyRect(0, 0, 16, 16);
+    dev->fill(dirtyRect, KoColor(Qt::blue, cs));
+    chain.setDirty(dirtyRect);
+
+    // the change is not reported, so it should not get into the chain
+    dev->fill(QRect(400, 400, 16, 16), KoColor(Qt::green, cs));
+
+    chain.update();
+
+    QCOMPARE(pixelColor(chain.level(1), 2, 2), QColor(Qt::blue));
+    QCOMPARE(pixelColor(chain.level(2), 3, 3), QColor(Qt::blue));
+    QCOMPARE(pixelColor(chain.level(3), 1, 1), QColor(Qt::blue));
+    QCOMPARE(pixelColor(chain.level(1), 100, 100), QColor(Qt::red));
+
+    QCOMPARE(pixelColor(chain.level(1), 204, 204), QColor(Qt::red));
+    QCOMPARE(pixelColor(chain.level(3), 51, 51), QColor(Qt::red));
+}
+
+QTEST_MAIN(KisPaintDeviceMipChainTest)
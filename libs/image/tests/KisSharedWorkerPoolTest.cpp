@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisSharedWorkerPoolTest.h"
+
+#include <QTest>
+#include <QThread>
+#include <QAtomicInt>
+
+#include "KisSharedWorkerPool.h"
+
+
+void KisSharedWorkerPoolTest::testBlockingMap()
+{
+    QVector<int> values(1000);
+    for (int i = 0; i < values.size(); i++) {
+        values[i] = i;
+    }
+
+    KisSharedWorkerPool::blockingMap(values, [] (int &value) { value *= 2; });
+
+    for (int i = 0; i < values.size(); i++) {
+        QCOMPARE(values[i], 2 * i);
+    }
+
+    QList<int> emptyList;
+    KisSharedWorkerPool::blockingMap(emptyList, [] (int &) { QFAIL("should not be called"); });
+}
+
+void KisSharedWorkerPoolTest::testNestedCalls()
+{
+    QAtomicInt counter;
+
+    /**
+     * The nested calls should not deadlock even when all the threads
+     * of the pool are busy with the outer items
+     */
+    KisSharedWorkerPool::parallelFor(64,
+        [&counter] (int) {
+            KisSharedWorkerPool::parallelFor(100,
+                [&counter] (int) {
+                    counter.ref();
+                });
+        });
+
+    QCOMPARE(counter.load(), 6400);
+}
+
+void KisSharedWorkerPoolTest::testThreadsLimit()
+{
+    const int oldLimit = KisSharedWorkerPool::threadsLimit();
+
+    for (int limit = 1; limit <= 3; limit++) {
+        KisSharedWorkerPool::setThreadsLimit(limit);
+
+        QAtomicInt running;
+        QAtomicInt maxRunning;
+
+        KisSharedWorkerPool::parallelFor(32,
+            [&] (int) {
+                const int value = running.fetchAndAddOrdered(1) + 1;
+
+                int oldMax = maxRunning.load();
+                while (value > oldMax && !maxRunning.testAndSetOrdered(oldMax, value)) {
+                    oldMax = maxRunning.load();
+                }
+
+                QThread::msleep(2);
+                running.deref();
+            });
+
+        QVERIFY(maxRunning.load() >= 1);
+        QVERIFY(maxRunning.load() <= limit);
+    }
+
+    KisSharedWorkerPool::setThreadsLimit(oldLimit);
+}
+
+void KisSharedWorkerPoolTest::testCancel()
+{
+    QAtomicInt counter;
+
+    KisSharedWorkerPool::parallelFor(1000,
+        [&counter] (int) {
+            counter.ref();
+        },
+        [&counter] () {
+            return counter.load() >= 10;
+        });
+
+    // the items that have already been started are not interrupted
+    QVERIFY(counter.load() >= 10);
+    QVERIFY(counter.load() < 1000);
+}
+
+QTEST_MAIN(KisSharedWorkerPoolTest)
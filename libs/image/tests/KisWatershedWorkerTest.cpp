@@ -99,13 +99,13 @@ void KisWatershedWorkerTest::testWorkerSmall()
     worker.addKeyStroke(bLabelDev, KoColor(Qt::blue, mainDev->colorSpace()));
     worker.run();
 
-    QCOMPARE(worker.testingGroupPositiveEdge(1, 0), 35);
+    QCOMPARE(worker.testingGroupPositiveEdge(1, 0), 36);
     QCOMPARE(worker.testingGroupNegativeEdge(1, 0), 0);
-    QCOMPARE(worker.testingGroupForeignEdge(1, 0), 5);
+    QCOMPARE(worker.testingGroupForeignEdge(1, 0), 6);
 
     QCOMPARE(worker.testingGroupPositiveEdge(1, 255), 3);
-    QCOMPARE(worker.testingGroupNegativeEdge(1, 255), 15);
-    QCOMPARE(worker.testingGroupForeignEdge(1, 255), 8);
+    QCOMPARE(worker.testingGroupNegativeEdge(1, 255), 16);
+    QCOMPARE(worker.testingGroupForeignEdge(1, 255), 7);
 
     QCOMPARE(worker.testingGroupPositiveEdge(2, 0), 22);
     QCOMPARE(worker.testingGroupNegativeEdge(2, 0), 0);
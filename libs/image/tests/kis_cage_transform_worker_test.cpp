@@ -157,6 +157,62 @@ void KisCageTransformWorkerTest::testCageCounterclockwiseUnity()
     testCage(false, true);
 }
 
+void KisCageTransformWorkerTest::testPreparedGridCache()
+{
+    QImage image(TestUtil::fetchDataFileLazy("test_cage_transform.png"));
+    image = image.convertToFormat(QImage::Format_ARGB32);
+
+    const QRectF bounds(QPointF(), image.size());
+
+    QVector<QPointF> origPoints;
+    origPoints << bounds.topLeft();
+    origPoints << bounds.topRight();
+    origPoints << bounds.bottomRight();
+    origPoints << bounds.bottomLeft();
+
+    QVector<QPointF> transfPoints = origPoints;
+    transfPoints[2] += QPointF(30, 40);
+
+    auto runWorker = [&] (KisCageTransformWorker::PreparedGridCacheSP cache, QPointF *offset) {
+        KisCageTransformWorker worker(image, QPointF(), origPoints, 0, 16);
+        worker.setPreparedGridCache(cache);
+        worker.prepareTransform();
+        worker.setTransformedCage(transfPoints);
+        return worker.runOnQImage(offset);
+    };
+
+    QPointF refOffset;
+    const QImage reference = runWorker(KisCageTransformWorker::PreparedGridCacheSP(), &refOffset);
+
+    KisCageTransformWorker::PreparedGridCacheSP cache(new KisCageTransformWorker::PreparedGridCache());
+    QCOMPARE(cache->memoryUsage(), qint64(0));
+
+    QPointF offset;
+    QImage result = runWorker(cache, &offset);
+    QVERIFY(cache->memoryUsage() > 0);
+    QCOMPARE(offset, refOffset);
+    QCOMPARE(result, reference);
+
+    const qint64 usedMemory = cache->memoryUsage();
+
+    // the second run reuses the prepared grid
+    result = runWorker(cache, &offset);
+    QCOMPARE(cache->memoryUsage(), usedMemory);
+    QCOMPARE(offset, refOffset);
+    QCOMPARE(result, reference);
+
+    cache->clear();
+    QCOMPARE(cache->memoryUsage(), qint64(0));
+
+    // the grid that doesn't fit into the budget is not cached
+    KisCageTransformWorker::PreparedGridCacheSP smallCache(
+        new KisCageTransformWorker::PreparedGridCache(usedMemory - 1));
+
+    result = runWorker(smallCache, &offset);
+    QCOMPARE(smallCache->memoryUsage(), qint64(0));
+    QCOMPARE(result, reference);
+}
+
 #include <QtGlobal>
 
 
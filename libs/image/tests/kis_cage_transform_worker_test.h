@@ -32,6 +32,7 @@ private Q_SLOTS:
     void testCageCounterclockwise();
     void testCageClockwiseUnity();
     void testCageCounterclockwiseUnity();
+    void testPreparedGridCache();
 
     void stressTestRandomCages();
 
@@ -29,11 +29,13 @@
 #include <KoColorSpaceTraits.h>
 
 #include "kis_paint_device.h"
+#include "kis_default_bounds_base.h"
 #include "kis_convolution_painter.h"
 #include "kis_convolution_kernel.h"
 #include <kis_gaussian_kernel.h>
 #include <kis_mask_generator.h>
 #include "testutil.h"
+#include "kis_sequential_iterator.h"
 
 KisPaintDeviceSP initAsymTestDevice(QRect &imageRect, int &pixelSize, QByteArray &initialData)
 {
@@ -439,6 +441,195 @@ void KisConvolutionPainterTest::testGaussianDetailsFFTW()
 
 #include "kis_transaction.h"
 
+void KisConvolutionPainterTest::testFFTBlocksMatchSpatial()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    // the area is big enough to be split into several FFT blocks
+    const QRect applyRect(0, 0, 600, 400);
+
+    QImage referenceImage(QString(FILES_DATA_DIR) + QDir::separator() + "hakonepa.png");
+    KisPaintDeviceSP src = new KisPaintDevice(cs);
+    src->convertFromQImage(referenceImage, 0, 0, 0);
+
+    // both kernels fit into 256x256 blocks, so the area is split into a grid
+    QList<int> kernelSizes;
+    kernelSizes << 21 << 61;
+
+    Q_FOREACH (int size, kernelSizes) {
+        Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> matrix(size, size);
+        matrix.fill(1.0);
+        KisConvolutionKernelSP kernel =
+            KisConvolutionKernel::fromMatrix(matrix, 0, matrix.sum());
+
+        KisPaintDeviceSP spatialDst = new KisPaintDevice(cs);
+        KisConvolutionPainter spatialPainter(spatialDst, KisConvolutionPainter::SPATIAL);
+        spatialPainter.applyMatrix(kernel, src, applyRect.topLeft(), applyRect.topLeft(),
+                                   applyRect.size(), BORDER_REPEAT);
+
+        KisPaintDeviceSP fftwDst = new KisPaintDevice(cs);
+        KisConvolutionPainter fftwPainter(fftwDst, KisConvolutionPainter::FFTW);
+        fftwPainter.applyMatrix(kernel, src, applyRect.topLeft(), applyRect.topLeft(),
+                                applyRect.size(), BORDER_REPEAT);
+
+        QImage spatialImage = spatialDst->convertToQImage(0, applyRect);
+        QImage fftwImage = fftwDst->convertToQImage(0, applyRect);
+
+        QPoint errorPoint;
+        if (!TestUtil::compareQImages(errorPoint, spatialImage, fftwImage, 1, 1)) {
+            QFAIL(QString("FFT result differs from the spatial one, kernel size %1, first different pixel: %2,%3")
+                  .arg(size).arg(errorPoint.x()).arg(errorPoint.y()).toLatin1());
+        }
+    }
+}
+
+void KisConvolutionPainterTest::testGaussianWrapAround()
+{
+    struct TestingDefaultBounds : public KisDefaultBoundsBase {
+        QRect bounds() const override {
+            return QRect(0, 0, 200, 200);
+        }
+        bool wrapAroundMode() const override {
+            return true;
+        }
+        int currentLevelOfDetail() const override {
+            return 0;
+        }
+        int currentTime() const override {
+            return 0;
+        }
+        bool externalFrameActive() const override {
+            return false;
+        }
+    };
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisDefaultBoundsBaseSP bounds = new TestingDefaultBounds();
+    const QRect rect = bounds->bounds();
+
+    // big enough for the box cascade to be used without wrap-around
+    const qreal radius = 40.0;
+
+    KisPaintDeviceSP src = new KisPaintDevice(cs);
+    src->setDefaultBounds(bounds);
+    src->fill(QRect(0, 0, 10, 200), KoColor(Qt::red, cs));
+
+    KisPaintDeviceSP dev = new KisPaintDevice(*src);
+    KisGaussianKernel::applyGaussian(dev, rect, radius, radius, QBitArray(), 0);
+
+    // the reference is the two-pass convolution over the wrapped device
+    KisConvolutionKernelSP kernelHoriz = KisGaussianKernel::createHorizontalKernel(radius);
+    KisConvolutionKernelSP kernelVertical = KisGaussianKernel::createVerticalKernel(radius);
+    const int verticalCenter = std::ceil(qreal(kernelVertical->height()) / 2.0);
+
+    KisPaintDeviceSP interm = new KisPaintDevice(cs);
+    KisConvolutionPainter horizPainter(interm);
+    horizPainter.applyMatrix(kernelHoriz, src,
+                             rect.topLeft() - QPoint(0, verticalCenter),
+                             rect.topLeft() - QPoint(0, verticalCenter),
+                             rect.size() + QSize(0, 2 * verticalCenter), BORDER_REPEAT);
+
+    KisPaintDeviceSP reference = new KisPaintDevice(cs);
+    reference->setDefaultBounds(bounds);
+    KisConvolutionPainter verticalPainter(reference);
+    verticalPainter.applyMatrix(kernelVertical, interm, rect.topLeft(), rect.topLeft(),
+                                rect.size(), BORDER_REPEAT);
+
+    // the stripe at the left edge should bleed over the right edge
+    KoColor pixel(cs);
+    dev->pixel(rect.right(), 100, &pixel);
+    QVERIFY(pixel.opacityU8() > 0);
+
+    QImage resultImage = dev->convertToQImage(0, rect);
+    QImage referenceImage = reference->convertToQImage(0, rect);
+
+    QPoint errorPoint;
+    if (!TestUtil::compareQImages(errorPoint, referenceImage, resultImage, 1, 1)) {
+        QFAIL(QString("Wrapped gaussian differs from the convolution, first different pixel: %1,%2")
+              .arg(errorPoint.x()).arg(errorPoint.y()).toLatin1());
+    }
+}
+
+void KisConvolutionPainterTest::testGaussianBoxCascadeAccuracy_data()
+{
+    QTest::addColumn<qreal>("radius");
+    QTest::addColumn<int>("squareSize");
+
+    QTest::newRow("radius-33") << 33.0 << 40;
+    QTest::newRow("radius-48") << 48.0 << 20;
+    QTest::newRow("radius-64") << 64.0 << 30;
+    QTest::newRow("radius-100") << 100.0 << 60;
+}
+
+void KisConvolutionPainterTest::testGaussianBoxCascadeAccuracy()
+{
+    QFETCH(qreal, radius);
+    QFETCH(int, squareSize);
+
+    /**
+     * The box cascade only approximates the gaussian. For a sharp
+     * edge, the pixel values can differ from the convolution by a few
+     * units, so check the worst pixel and the average error separately.
+     */
+    const int maxAllowedDifference = 8;
+    const qreal maxAllowedMeanDifference = 0.5;
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect rect(0, 0, 320, 320);
+
+    KisPaintDeviceSP src = new KisPaintDevice(cs);
+    src->fill(rect, KoColor(Qt::white, cs));
+    src->fill(QRect(120, 100, squareSize, squareSize), KoColor(Qt::black, cs));
+    src->fill(QRect(200, 180, squareSize, 2 * squareSize), KoColor(Qt::red, cs));
+
+    QVERIFY(radius > 32.0);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(*src);
+    KisGaussianKernel::applyGaussian(dev, rect, radius, radius, QBitArray(), 0);
+
+    KisConvolutionKernelSP kernelHoriz = KisGaussianKernel::createHorizontalKernel(radius);
+    KisConvolutionKernelSP kernelVertical = KisGaussianKernel::createVerticalKernel(radius);
+    const int verticalCenter = std::ceil(qreal(kernelVertical->height()) / 2.0);
+
+    KisPaintDeviceSP interm = new KisPaintDevice(cs);
+    KisConvolutionPainter horizPainter(interm);
+    horizPainter.applyMatrix(kernelHoriz, src,
+                             rect.topLeft() - QPoint(0, verticalCenter),
+                             rect.topLeft() - QPoint(0, verticalCenter),
+                             rect.size() + QSize(0, 2 * verticalCenter), BORDER_REPEAT);
+
+    KisPaintDeviceSP reference = new KisPaintDevice(cs);
+    KisConvolutionPainter verticalPainter(reference);
+    verticalPainter.applyMatrix(kernelVertical, interm, rect.topLeft(), rect.topLeft(),
+                                rect.size(), BORDER_REPEAT);
+
+    KisSequentialConstIterator it(dev, rect);
+    KisSequentialConstIterator refIt(reference, rect);
+
+    int maxDifference = 0;
+    qint64 totalDifference = 0;
+    qint64 numSamples = 0;
+
+    while (it.nextPixel() && refIt.nextPixel()) {
+        const quint8 *pixel = it.rawDataConst();
+        const quint8 *refPixel = refIt.rawDataConst();
+
+        for (int i = 0; i < cs->pixelSize(); i++) {
+            const int difference = qAbs(int(pixel[i]) - int(refPixel[i]));
+            maxDifference = qMax(maxDifference, difference);
+            totalDifference += difference;
+            numSamples++;
+        }
+    }
+
+    const qreal meanDifference = qreal(totalDifference) / numSamples;
+
+    QVERIFY2(maxDifference <= maxAllowedDifference,
+             QString("max difference %1 > %2").arg(maxDifference).arg(maxAllowedDifference).toLatin1());
+    QVERIFY2(meanDifference <= maxAllowedMeanDifference,
+             QString("mean difference %1 > %2").arg(meanDifference).arg(maxAllowedMeanDifference).toLatin1());
+}
+
 void KisConvolutionPainterTest::testDilate()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->alpha8();
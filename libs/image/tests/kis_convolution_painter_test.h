@@ -57,6 +57,11 @@ private Q_SLOTS:
     void testGaussianDetailsSpatial();
     void testGaussianDetailsFFTW();
 
+    void testFFTBlocksMatchSpatial();
+    void testGaussianWrapAround();
+    void testGaussianBoxCascadeAccuracy_data();
+    void testGaussianBoxCascadeAccuracy();
+
     void testDilate();
     void testErode();
 };
@@ -20,6 +20,8 @@
 
 #include "layerstyles/kis_layer_style_filter_environment.h"
 #include "kis_pixel_selection.h"
+#include "kis_paint_layer.h"
+#include <KoColor.h>
 #include "testutil.h"
 
 
@@ -58,4 +60,35 @@ void KisLayerStyleFilterEnvironmentTest::benchmarkRandomSelectionGeneration()
     }
 }
 
+void KisLayerStyleFilterEnvironmentTest::testSourceAlphaCaching()
+{
+    TestUtil::MaskParent p;
+    KisLayerStyleFilterEnvironment env(p.layer.data());
+
+    KisPaintDeviceSP dev = p.layer->paintDevice();
+    const KoColor color(Qt::red, dev->colorSpace());
+
+    const QRect requestedRect(0,0,200,200);
+    const QRect r1(10,10,100,100);
+    const QRect r2(150,150,20,20);
+
+    dev->fill(r1, color);
+
+    KisPixelSelectionSP alpha1 = env.cachedSourceAlpha(dev, requestedRect);
+    QCOMPARE(alpha1->selectedExactRect(), r1);
+
+    // the source has changed, but the cache is not invalidated yet
+    dev->fill(r2, color);
+
+    KisPixelSelectionSP alpha2 = env.cachedSourceAlpha(dev, requestedRect);
+    QVERIFY(alpha1 == alpha2);
+    QCOMPARE(alpha2->selectedExactRect(), r1);
+
+    env.invalidateSourceAlpha(r2);
+
+    KisPixelSelectionSP alpha3 = env.cachedSourceAlpha(dev, requestedRect);
+    QVERIFY(alpha1 == alpha3);
+    QCOMPARE(alpha3->selectedExactRect(), r1 | r2);
+}
+
 QTEST_MAIN(KisLayerStyleFilterEnvironmentTest)
@@ -154,4 +154,42 @@ void KisLiquifyTransformWorkerTest::testIdentityTransform()
     TestUtil::checkQImage(result, "liquify_transform_test", "liquify_dev", "identity");
 }
 
+void KisLiquifyTransformWorkerTest::testIncrementalQImage()
+{
+    QImage image(TestUtil::fetchDataFileLazy("test_transform_quality_second.png"));
+    image = image.convertToFormat(QImage::Format_ARGB32);
+
+    const QRect srcBounds(QPoint(), image.size());
+    const QTransform imageToThumbTransform = QTransform::fromScale(0.5, 0.5);
+    const int pixelPrecision = 8;
+
+    KisLiquifyTransformWorker worker(srcBounds, 0, pixelPrecision);
+    KisLiquifyTransformWorker referenceWorker(srcBounds, 0, pixelPrecision);
+
+    QPointF offset;
+    QPointF referenceOffset;
+
+    // fill the preview cache of the incremental worker
+    const uchar *previewBits =
+        worker.runOnQImage(image, QPointF(), imageToThumbTransform, &offset).constBits();
+
+    const QPointF bases[] = {QPointF(100, 100), QPointF(300, 200), QPointF(120, 110)};
+
+    for (int i = 0; i < 3; i++) {
+        worker.translatePoints(bases[i], QPointF(10, -5), 20, false, 0.5);
+        referenceWorker.translatePoints(bases[i], QPointF(10, -5), 20, false, 0.5);
+
+        QImage result = worker.runOnQImage(image, QPointF(), imageToThumbTransform, &offset);
+
+        KisLiquifyTransformWorker freshWorker(referenceWorker);
+        QImage reference = freshWorker.runOnQImage(image, QPointF(), imageToThumbTransform, &referenceOffset);
+
+        QCOMPARE(offset, referenceOffset);
+        QCOMPARE(result, reference);
+
+        // the previous result has been released, so the preview is updated in place
+        QCOMPARE(result.constBits(), previewBits);
+    }
+}
+
 QTEST_MAIN(KisLiquifyTransformWorkerTest)
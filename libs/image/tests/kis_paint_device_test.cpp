@@ -1529,6 +1529,75 @@ void KisPaintDeviceTest::testLodDevice()
                                   "lod", "lod1-offset-6-14"));
 }
 
+QRegion syncLodCacheIncrementally(KisPaintDeviceSP dev, int levelOfDetail)
+{
+    KisPaintDevice::LodDataStruct* s = dev->createLodDataStruct(levelOfDetail);
+
+    const QRegion region = dev->regionForLodSyncing(s);
+    Q_FOREACH(QRect rect2, KritaUtils::splitRegionIntoPatches(region, KritaUtils::optimalPatchSize())) {
+        dev->updateLodDataStruct(s, rect2);
+    }
+
+    dev->uploadLodDataStruct(s);
+    delete s;
+
+    return region;
+}
+
+void KisPaintDeviceTest::testLodIncrementalSync()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect rect(0,0,512,512);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    TestingLodDefaultBounds *bounds = new TestingLodDefaultBounds(rect);
+    dev->setDefaultBounds(bounds);
+    fillGradientDevice(dev, rect);
+
+    bounds->testingSetLevelOfDetail(1);
+
+    // the first sync regenerates the whole device
+    QCOMPARE(syncLodCacheIncrementally(dev, 1), QRegion(rect));
+
+    // nothing has changed since then
+    QCOMPARE(syncLodCacheIncrementally(dev, 1), QRegion());
+
+    // only the changed tile of the original device is regenerated
+    bounds->testingSetLevelOfDetail(0);
+    dev->fill(QRect(300,300,10,10), KoColor(Qt::blue, cs));
+    bounds->testingSetLevelOfDetail(1);
+
+    QCOMPARE(syncLodCacheIncrementally(dev, 1), QRegion(QRect(256,256,64,64)));
+
+    // the tiles painted directly on the lod plane are regenerated as well
+    dev->fill(QRect(10,10,5,5), KoColor(Qt::green, cs));
+
+    QCOMPARE(syncLodCacheIncrementally(dev, 1), QRegion(QRect(0,0,128,128)));
+
+    // the result should be the same as the one of a full regeneration
+    KisPaintDeviceSP refDev = new KisPaintDevice(cs);
+    TestingLodDefaultBounds *refBounds = new TestingLodDefaultBounds(rect);
+    refDev->setDefaultBounds(refBounds);
+    fillGradientDevice(refDev, rect);
+    refDev->fill(QRect(300,300,10,10), KoColor(Qt::blue, cs));
+
+    refBounds->testingSetLevelOfDetail(1);
+    syncLodCache(refDev, 1);
+
+    QCOMPARE(dev->convertToQImage(0, 0, 0, 256, 256),
+             refDev->convertToQImage(0, 0, 0, 256, 256));
+
+    // without the snapshots the device is regenerated as a whole
+    dev->dropLodSyncSnapshots();
+    QCOMPARE(syncLodCacheIncrementally(dev, 1), QRegion(rect));
+    QCOMPARE(syncLodCacheIncrementally(dev, 1), QRegion());
+
+    // projections are never synced incrementally
+    dev->setProjectionDevice(true);
+    QCOMPARE(syncLodCacheIncrementally(dev, 1), QRegion(rect));
+    QCOMPARE(syncLodCacheIncrementally(dev, 1), QRegion(rect));
+}
+
 void KisPaintDeviceTest::benchmarkLod1Generation()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
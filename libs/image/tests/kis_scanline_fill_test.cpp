@@ -30,6 +30,7 @@
 #include <KoColorSpaceRegistry.h>
 #include "kis_types.h"
 #include "kis_paint_device.h"
+#include "kis_pixel_selection.h"
 
 
 void KisScanlineFillTest::testFillGeneral(const QVector<KisFillInterval> &initialBackwardIntervals,
@@ -295,4 +296,48 @@ void KisScanlineFillTest::testExternalFill()
     QCOMPARE(c, QColor(Qt::blue));
 }
 
+void KisScanlineFillTest::testParallelFillSelection()
+{
+    const QRect boundingRect(-70, -30, 400, 300);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8());
+
+    // a maze of the regions of slightly different colors
+    for (int y = boundingRect.top(); y <= boundingRect.bottom(); y++) {
+        for (int x = boundingRect.left(); x <= boundingRect.right(); x++) {
+            const int value = ((x * 7) ^ (y * 13)) % 23 < 17 ? 100 + (x + y) % 5 : 200;
+            dev->setPixel(x, y, QColor(value, value, value));
+        }
+    }
+
+    const int thresholds[] = {1, 3, 8, 40};
+
+    Q_FOREACH (int threshold, thresholds) {
+        KisPixelSelectionSP serialSelection = new KisPixelSelection();
+        KisPixelSelectionSP parallelSelection = new KisPixelSelection();
+
+        {
+            KisScanlineFill fill(dev, QPoint(10, 10), boundingRect);
+            fill.setThreshold(threshold);
+            fill.fillSelection(serialSelection);
+        }
+
+        {
+            KisScanlineFill fill(dev, QPoint(10, 10), boundingRect);
+            fill.setThreshold(threshold);
+            fill.setUseParallelFill(true);
+            fill.fillSelection(parallelSelection);
+        }
+
+        QVERIFY(!serialSelection->exactBounds().isEmpty());
+        QCOMPARE(parallelSelection->exactBounds(), serialSelection->exactBounds());
+
+        const QRect rc = serialSelection->exactBounds();
+        QImage serialImage = serialSelection->convertToQImage(0, rc.x(), rc.y(), rc.width(), rc.height());
+        QImage parallelImage = parallelSelection->convertToQImage(0, rc.x(), rc.y(), rc.width(), rc.height());
+
+        QCOMPARE(parallelImage, serialImage);
+    }
+}
+
 QTEST_MAIN(KisScanlineFillTest)
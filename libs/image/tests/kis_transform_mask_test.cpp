@@ -33,6 +33,7 @@
 #include "kis_clone_layer.h"
 #include "kis_group_layer.h"
 #include "kis_paint_device_debug_utils.h"
+#include "kis_psd_layer_style.h"
 
 
 
@@ -986,4 +987,55 @@ void KisTransformMaskTest::testTransformHiddenPartsOfTheGroup()
     //KIS_DUMP_DEVICE_2(p.image->projection(), imageRect, "image_proj_mask", "dd");
 }
 
+KisPSDLayerStyleSP createShadowStyle()
+{
+    KisPSDLayerStyleSP style(new KisPSDLayerStyle());
+    style->dropShadow()->setSize(10);
+    style->dropShadow()->setDistance(10);
+    style->dropShadow()->setOpacity(70);
+    style->dropShadow()->setEffectEnabled(true);
+    return style;
+}
+
+void KisTransformMaskTest::testMaskWithLayerStyle()
+{
+    const QRect imageRect(0,0,256,256);
+    const QRect fillRect(20,20,60,60);
+    const QPoint offset(100,100);
+
+    TestUtil::MaskParent p(imageRect);
+    p.layer->paintDevice()->fill(fillRect, KoColor(Qt::red, p.layer->colorSpace()));
+    p.layer->setLayerStyle(createShadowStyle());
+
+    KisTransformMaskSP mask = new KisTransformMask();
+    p.image->addNode(mask, p.layer);
+
+    // the style filters cache the alpha of the non-transformed projection
+    p.layer->setDirty(imageRect);
+    p.waitForImageAndShapeLayers();
+
+    /**
+     * The static image of the mask is regenerated by a direct call to
+     * layer's updateProjection(), which doesn't go through the layer
+     * style's projection plane.
+     */
+    mask->setTransformParams(KisTransformMaskParamsInterfaceSP(
+                                 new KisDumbTransformMaskParams(
+                                     QTransform::fromTranslate(offset.x(), offset.y()))));
+    mask->setDirty(imageRect);
+    p.waitForImageAndShapeLayers();
+
+    TestUtil::MaskParent ref(imageRect);
+    ref.layer->paintDevice()->fill(fillRect.translated(offset), KoColor(Qt::red, ref.layer->colorSpace()));
+    ref.layer->setLayerStyle(createShadowStyle());
+    ref.layer->setDirty(imageRect);
+    ref.image->waitForDone();
+
+    QPoint errorPoint;
+    QVERIFY(TestUtil::compareQImages(errorPoint,
+                                     ref.image->projection()->convertToQImage(0, imageRect),
+                                     p.image->projection()->convertToQImage(0, imageRect),
+                                     1, 1));
+}
+
 QTEST_MAIN(KisTransformMaskTest)
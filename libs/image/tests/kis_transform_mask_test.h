@@ -37,6 +37,8 @@ private Q_SLOTS:
 
     void testWeirdFullUpdates();
     void testTransformHiddenPartsOfTheGroup();
+
+    void testMaskWithLayerStyle();
 };
 
 #endif /* __KIS_TRANSFORM_MASK_TEST_H */
@@ -20,6 +20,8 @@
 
 #include <QRect>
 #include <QVector>
+#include <QHash>
+#include <QPair>
 
 #include "kis_tile.h"
 #include "kis_tiled_data_manager.h"
@@ -680,6 +682,54 @@ QRegion KisTiledDataManager::region() const
     return region;
 }
 
+QRegion KisTiledDataManager::differenceRegion(const KisTiledDataManager *other) const
+{
+    if (other == this) return QRegion();
+
+    typedef QPair<qint32, qint32> TileIndex;
+    QHash<TileIndex, KisTileData*> otherTiles;
+
+    {
+        KisTileHashTableConstIterator iter(other->m_hashTable);
+        KisTileSP tile;
+
+        while ((tile = iter.tile())) {
+            otherTiles.insert(TileIndex(tile->col(), tile->row()), tile->tileData());
+            iter.next();
+        }
+    }
+
+    QRegion region;
+
+    {
+        KisTileHashTableConstIterator iter(m_hashTable);
+        KisTileSP tile;
+
+        while ((tile = iter.tile())) {
+            auto it = otherTiles.find(TileIndex(tile->col(), tile->row()));
+
+            if (it == otherTiles.end()) {
+                region += tile->extent();
+            } else {
+                if (it.value() != tile->tileData()) {
+                    region += tile->extent();
+                }
+                otherTiles.erase(it);
+            }
+
+            iter.next();
+        }
+    }
+
+    for (auto it = otherTiles.constBegin(); it != otherTiles.constEnd(); ++it) {
+        region += QRect(it.key().first * KisTileData::WIDTH,
+                        it.key().second * KisTileData::HEIGHT,
+                        KisTileData::WIDTH, KisTileData::HEIGHT);
+    }
+
+    return region;
+}
+
 void KisTiledDataManager::setPixel(qint32 x, qint32 y, const quint8 * data)
 {
     KisTileDataWrapper tw(this, x, y, KisTileDataWrapper::WRITE);
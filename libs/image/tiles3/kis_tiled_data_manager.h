@@ -228,6 +228,15 @@ public:
 
     QRegion region() const;
 
+    /**
+     * \return the region covered by the tiles that are different in
+     * this data manager and \p other. The tiles are compared by the
+     * identity of their tile data, so the result is exact only when
+     * one of the managers is a copy-on-write clone of the other one:
+     * every write into a shared tile detaches its data.
+     */
+    QRegion differenceRegion(const KisTiledDataManager *other) const;
+
     void clear(QRect clearRect, quint8 clearValue);
     void clear(QRect clearRect, const quint8 *clearPixel);
     void clear(qint32 x, qint32 y, qint32 w, qint32 h, quint8 clearValue);
@@ -155,10 +155,14 @@ private:
 
             weightsWrapper.premultiplyAlphaWithWeight(alphaTimesWeight);
 
+            /**
+             * The alpha channel is accumulated as well, its total is
+             * just never used. Without a branch inside the loop the
+             * compiler can unroll and vectorize it for every channel
+             * type.
+             */
             for (int i = 0; i < (int)_CSTrait::channels_nb; i++) {
-                if (i != _CSTrait::alpha_pos) {
-                    totals[i] += color[i] * alphaTimesWeight;
-                }
+                totals[i] += color[i] * alphaTimesWeight;
             }
 
             totalAlpha += alphaTimesWeight;
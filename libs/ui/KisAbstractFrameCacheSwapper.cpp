@@ -17,6 +17,13 @@
  */
 #include "KisAbstractFrameCacheSwapper.h"
 
+#include <QVector>
+
 KisAbstractFrameCacheSwapper::~KisAbstractFrameCacheSwapper()
 {
 }
+
+void KisAbstractFrameCacheSwapper::prefetchFrames(const QVector<int> &frameIds)
+{
+    Q_UNUSED(frameIds);
+}
@@ -22,6 +22,9 @@
 
 class QRect;
 
+template <typename T>
+class QVector;
+
 template<class T>
 class KisSharedPtr;
 
@@ -45,6 +48,15 @@ public:
 
     virtual int frameLevelOfDetail(int frameId) const = 0;
     virtual QRect frameDirtyRect(int frameId) const = 0;
+
+    /**
+     * Hints the swapper that the frames \p frameIds are going to be
+     * requested soon, in the order they are listed. The swapper may
+     * prepare them in background. The new list replaces the previous one.
+     *
+     * The default implementation does nothing.
+     */
+    virtual void prefetchFrames(const QVector<int> &frameIds);
 };
 
 #endif // KISABSTRACTFRAMECACHESWAPPER_H
@@ -26,6 +26,8 @@
 #include "kis_time_range.h"
 #include "kis_paint_layer.h"
 
+#include <QFile>
+
 
 struct KisAsyncAnimationFramesSavingRenderer::Private
 {
@@ -106,16 +108,42 @@ void KisAsyncAnimationFramesSavingRenderer::frameCompletedCallback(int frame, co
 
     KisTimeRange range(frame, 1);
 
+    /**
+     * The dialog skips the frames identical to the rendered one,
+     * so we should save all of them here
+     */
+    const KisTimeRange stillFrameRange =
+        KisTimeRange::calculateIdenticalFramesRecursive(image->root(), frame);
+
+    if (stillFrameRange.isValid()) {
+        const int lastFrame =
+            stillFrameRange.isInfinite() ?
+            m_d->range.end() : qMin(stillFrameRange.end(), m_d->range.end());
+
+        range = KisTimeRange::fromTime(frame, qMax(frame, lastFrame));
+    }
+
     KisImportExportFilter::ConversionStatus status = KisImportExportFilter::OK;
 
+    QString firstFilename;
+
     for (int i = range.start(); i <= range.end(); i++) {
         QString frameNumber = QString("%1").arg(i + m_d->sequenceNumberingOffset, 4, 10, QChar('0'));
         QString filename = m_d->filenamePrefix + frameNumber + m_d->filenameSuffix;
 
-        if (!m_d->savingDoc->exportDocumentSync(QUrl::fromLocalFile(filename), m_d->outputMimeType, m_d->exportConfiguration)) {
+        // the held frames are byte-identical, no need to encode them again
+        const bool result = firstFilename.isEmpty() ?
+            m_d->savingDoc->exportDocumentSync(QUrl::fromLocalFile(filename), m_d->outputMimeType, m_d->exportConfiguration) :
+            QFile::copy(firstFilename, filename);
+
+        if (!result) {
             status = KisImportExportFilter::InternalError;
             break;
         }
+
+        if (firstFilename.isEmpty()) {
+            firstFilename = filename;
+        }
     }
 
     if (status == KisImportExportFilter::OK) {
@@ -45,6 +45,10 @@ typedef KisSharedPtr<KisOpenGLUpdateInfo> KisOpenGLUpdateInfoSP;
  *
  * 4) The in-memory cache of the keyframes is stored in serializable
  *    KisFrameDataSerializer::Frame format.
+ *
+ * 5) The restored frames share the pool buffers with the in-memory cache
+ *    of the keyframes, so copy frames and the unchanged tiles of
+ *    difference frames are uploaded without any intermediate copy.
  */
 
 class KRITAUI_EXPORT KisFrameCacheStore
@@ -17,23 +17,127 @@
  */
 #include "KisFrameCacheSwapper.h"
 
+#include <QMutex>
+#include <QMutexLocker>
+#include <QMap>
+#include <QVector>
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+
 #include "KisFrameCacheStore.h"
 
 #include "kis_update_info.h"
 #include "opengl/KisOpenGLUpdateInfoBuilder.h"
 
+namespace {
+qint64 frameMemorySize(KisOpenGLUpdateInfoSP info)
+{
+    qint64 size = 0;
+    Q_FOREACH (KisTextureTileUpdateInfoSP tile, info->tileList) {
+        size += tile->patchPixelsLength();
+    }
+    return size;
+}
+}
+
 struct KisFrameCacheSwapper::Private
 {
     Private(const KisOpenGLUpdateInfoBuilder &_builder, const QString &frameCachePath)
         : frameStore(frameCachePath),
           builder(_builder)
     {
+        /**
+         * Frames are prefetched one by one anyway (see storeLock), so a
+         * single thread is enough. Using our own pool guarantees that
+         * a long prefetching job never occupies the global thread pool
+         * used by the rest of Krita.
+         */
+        prefetchThreadPool.setMaxThreadCount(1);
     }
 
     KisFrameCacheStore frameStore;
     const KisOpenGLUpdateInfoBuilder &builder;
+
+    /**
+     * The lock order is: storeLock -> prefetchLock
+     *
+     * storeLock guards frameStore: the store keeps the last loaded base
+     * frame internally, so it cannot load two frames concurrently.
+     * prefetchLock guards all the prefetching state below.
+     */
+    QMutex storeLock;
+    QMutex prefetchLock;
+
+    QVector<int> pendingFrames;
+    QMap<int, KisOpenGLUpdateInfoSP> prefetchedFrames;
+    QMap<int, qint64> prefetchedFrameSizes;
+    qint64 prefetchedMemory = 0;
+    qint64 prefetchMemoryLimit = 0;
+
+    bool prefetchJobRunning = false;
+    QFuture<void> prefetchJob;
+    QThreadPool prefetchThreadPool;
+
+    // called with prefetchLock held
+    bool canPrefetchMore() const {
+        return !pendingFrames.isEmpty() && prefetchedMemory < prefetchMemoryLimit;
+    }
+
+    // called with prefetchLock held
+    void startPrefetchJob() {
+        if (prefetchJobRunning || !canPrefetchMore()) return;
+
+        prefetchJobRunning = true;
+        prefetchJob = QtConcurrent::run(&prefetchThreadPool, [this] () { processPrefetchQueue(); });
+    }
+
+    // called with prefetchLock held
+    KisOpenGLUpdateInfoSP takePrefetchedFrame(int frameId) {
+        KisOpenGLUpdateInfoSP info = prefetchedFrames.take(frameId);
+        prefetchedMemory -= prefetchedFrameSizes.take(frameId);
+        return info;
+    }
+
+    // called with storeLock held
+    void dropPrefetchedFrame(int frameId) {
+        QMutexLocker l(&prefetchLock);
+        takePrefetchedFrame(frameId);
+        pendingFrames.removeAll(frameId);
+    }
+
+    void processPrefetchQueue();
 };
 
+void KisFrameCacheSwapper::Private::processPrefetchQueue()
+{
+    forever {
+        QMutexLocker storeLocker(&storeLock);
+        QMutexLocker prefetchLocker(&prefetchLock);
+
+        if (!canPrefetchMore()) {
+            prefetchJobRunning = false;
+            return;
+        }
+
+        const int frameId = pendingFrames.takeFirst();
+        if (prefetchedFrames.contains(frameId) || !frameStore.hasFrame(frameId)) continue;
+
+        /**
+         * The store lock is kept while loading, so the frame cannot be
+         * forgotten or moved until it is put into the prefetched list
+         */
+        prefetchLocker.unlock();
+        KisOpenGLUpdateInfoSP info = frameStore.loadFrame(frameId, builder);
+        prefetchLocker.relock();
+
+        const qint64 size = frameMemorySize(info);
+        prefetchedFrames.insert(frameId, info);
+        prefetchedFrameSizes.insert(frameId, size);
+        prefetchedMemory += size;
+    }
+}
+
 KisFrameCacheSwapper::KisFrameCacheSwapper(const KisOpenGLUpdateInfoBuilder &builder)
     : KisFrameCacheSwapper(builder, "")
 {
@@ -46,25 +150,61 @@ KisFrameCacheSwapper::KisFrameCacheSwapper(const KisOpenGLUpdateInfoBuilder &bui
 
 KisFrameCacheSwapper::~KisFrameCacheSwapper()
 {
+    {
+        QMutexLocker l(&m_d->prefetchLock);
+        m_d->pendingFrames.clear();
+    }
+
+    m_d->prefetchJob.waitForFinished();
 }
 
 void KisFrameCacheSwapper::saveFrame(int frameId, KisOpenGLUpdateInfoSP info, const QRect &imageBounds)
 {
+    QMutexLocker l(&m_d->storeLock);
+    m_d->dropPrefetchedFrame(frameId);
     m_d->frameStore.saveFrame(frameId, info, imageBounds);
 }
 
 KisOpenGLUpdateInfoSP KisFrameCacheSwapper::loadFrame(int frameId)
 {
+    {
+        QMutexLocker l(&m_d->prefetchLock);
+
+        if (m_d->prefetchedFrames.contains(frameId)) {
+            KisOpenGLUpdateInfoSP info = m_d->takePrefetchedFrame(frameId);
+            m_d->startPrefetchJob();
+            return info;
+        }
+    }
+
+    // the frame might be being prefetched right now, so wait for the store
+    QMutexLocker storeLocker(&m_d->storeLock);
+
+    {
+        QMutexLocker l(&m_d->prefetchLock);
+
+        m_d->pendingFrames.removeAll(frameId);
+
+        if (m_d->prefetchedFrames.contains(frameId)) {
+            return m_d->takePrefetchedFrame(frameId);
+        }
+    }
+
     return m_d->frameStore.loadFrame(frameId, m_d->builder);
 }
 
 void KisFrameCacheSwapper::moveFrame(int srcFrameId, int dstFrameId)
 {
+    QMutexLocker l(&m_d->storeLock);
+    m_d->dropPrefetchedFrame(srcFrameId);
+    m_d->dropPrefetchedFrame(dstFrameId);
     m_d->frameStore.moveFrame(srcFrameId, dstFrameId);
 }
 
 void KisFrameCacheSwapper::forgetFrame(int frameId)
 {
+    QMutexLocker l(&m_d->storeLock);
+    m_d->dropPrefetchedFrame(frameId);
     m_d->frameStore.forgetFrame(frameId);
 }
 
@@ -82,3 +222,45 @@ QRect KisFrameCacheSwapper::frameDirtyRect(int frameId) const
 {
     return m_d->frameStore.frameDirtyRect(frameId);
 }
+
+void KisFrameCacheSwapper::prefetchFrames(const QVector<int> &frameIds)
+{
+    QMutexLocker l(&m_d->prefetchLock);
+
+    // the frames that are not expected anymore are behind the playhead
+    Q_FOREACH (int frameId, m_d->prefetchedFrames.keys()) {
+        if (!frameIds.contains(frameId)) {
+            m_d->takePrefetchedFrame(frameId);
+        }
+    }
+
+    m_d->pendingFrames.clear();
+    Q_FOREACH (int frameId, frameIds) {
+        if (!m_d->prefetchedFrames.contains(frameId)) {
+            m_d->pendingFrames.append(frameId);
+        }
+    }
+
+    m_d->startPrefetchJob();
+}
+
+void KisFrameCacheSwapper::setPrefetchMemoryLimit(qint64 value)
+{
+    QMutexLocker l(&m_d->prefetchLock);
+    m_d->prefetchMemoryLimit = value;
+}
+
+QList<int> KisFrameCacheSwapper::testingPrefetchedFrames() const
+{
+    QFuture<void> job;
+
+    {
+        QMutexLocker l(&m_d->prefetchLock);
+        job = m_d->prefetchJob;
+    }
+
+    job.waitForFinished();
+
+    QMutexLocker l(&m_d->prefetchLock);
+    return m_d->prefetchedFrames.keys();
+}
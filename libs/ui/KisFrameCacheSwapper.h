@@ -19,6 +19,7 @@
 #define KISFRAMECACHESWAPPER_H
 
 #include <QScopedPointer>
+#include <QList>
 
 #include "KisAbstractFrameCacheSwapper.h"
 
@@ -31,7 +32,9 @@ class KisOpenGLUpdateInfoBuilder;
  *
  * 1) Asynchronously predict and prefetch the pending frames from disk
  *    and maintain a short in-memory cache of these frames (already
- *    converted into KisOpenGLUpdateInfo)
+ *    converted into KisOpenGLUpdateInfo). The frames are loaded one by
+ *    one in a worker thread, in the order passed to prefetchFrames(),
+ *    until the memory limit is reached.
  *
  * 2) Pass all the other requests to the lower-level API,
  *    like KisFrameCacheStore
@@ -57,6 +60,20 @@ public:
 
     QRect frameDirtyRect(int frameId) const override;
 
+    void prefetchFrames(const QVector<int> &frameIds) override;
+
+    /**
+     * Sets the maximum amount of memory (in bytes) the prefetched
+     * frames may occupy. Zero disables prefetching.
+     */
+    void setPrefetchMemoryLimit(qint64 value);
+
+    /**
+     * Waits until the prefetching job is finished and returns the
+     * ids of the frames kept in the prefetched cache
+     */
+    QList<int> testingPrefetchedFrames() const;
+
 private:
     struct Private;
     const QScopedPointer<Private> m_d;
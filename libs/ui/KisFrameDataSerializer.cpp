@@ -18,6 +18,8 @@
 #include "KisFrameDataSerializer.h"
 
 #include <cstring>
+#include <functional>
+#include <type_traits>
 
 #include <QTemporaryDir>
 #include <QElapsedTimer>
@@ -123,6 +125,14 @@ int KisFrameDataSerializer::saveFrame(const KisFrameDataSerializer::Frame &frame
         stream << tile.row;
         stream << tile.rect;
 
+        // an unchanged tile of a difference frame has no data at all, it
+        // must not be confused with a valid tile with an empty rect, which
+        // has zero bytes of data
+        const bool hasData = tile.isValid();
+        stream << hasData;
+
+        if (!hasData) continue;
+
         const int frameByteSize = frame.pixelSize * tile.rect.width() * tile.rect.height();
         const int maxBufferSize = compression.outputBufferSize(frameByteSize);
         quint8 *buffer = m_d->getCompressionBuffer(maxBufferSize);
@@ -188,6 +198,15 @@ KisFrameDataSerializer::Frame KisFrameDataSerializer::loadFrame(int frameId, Kis
         KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(frameByteSize <= pool->chunkSize(frame.pixelSize),
                                              KisFrameDataSerializer::Frame());
 
+        bool hasData = false;
+        stream >> hasData;
+
+        if (!hasData) {
+            // unchanged tile, leave it unallocated
+            frame.frameTiles.push_back(std::move(tile));
+            continue;
+        }
+
         bool isCompressed = false;
         int inputSize = -1;
 
@@ -275,6 +294,8 @@ boost::optional<qreal> KisFrameDataSerializer::estimateFrameUniqueness(const Kis
         }
 
         if (sampleStep > 0) {
+            if (!lhsTile.isValid() || !rhsTile.isValid()) return boost::none;
+
             const int numPixels = lhsTile.rect.width() * lhsTile.rect.height();
             for (int j = 0; j < numPixels; j += sampleStep) {
                 quint8 *lhsDataPtr = lhsTile.data.data() + j * pixelSize;
@@ -313,7 +334,7 @@ bool processData(T *dst, const T *src, int numUnits)
 
 
 template<template <typename U> class OpPolicy>
-bool KisFrameDataSerializer::processFrames(KisFrameDataSerializer::Frame &dst, const KisFrameDataSerializer::Frame &src)
+bool KisFrameDataSerializer::processFrames(KisFrameDataSerializer::Frame &dst, const KisFrameDataSerializer::Frame &src, bool dropSameTiles)
 {
     bool framesAreSame = true;
 
@@ -323,20 +344,43 @@ bool KisFrameDataSerializer::processFrames(KisFrameDataSerializer::Frame &dst, c
         const FrameTile &srcTile = src.frameTiles[i];
         FrameTile &dstTile = dst.frameTiles[i];
 
+        KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(srcTile.isValid(), false);
+
         const int numBytes = srcTile.rect.width() * srcTile.rect.height() * src.pixelSize;
         const int numQWords = numBytes / 8;
 
+        if (!dstTile.isValid()) {
+            // an unchanged tile of a diff frame is equivalent to a zeroed one,
+            // so adding it to the base frame just results in the base data
+            if (std::is_same<OpPolicy<quint8>, std::plus<quint8>>::value) {
+                dstTile.data = srcTile.data.share();
+                continue;
+            }
+
+            dstTile.data.allocate(src.pixelSize);
+            std::memset(dstTile.data.data(), 0, numBytes);
+        } else {
+            dstTile.data.detach();
+        }
+
         const quint64 *srcDataPtr = reinterpret_cast<const quint64*>(srcTile.data.data());
         quint64 *dstDataPtr = reinterpret_cast<quint64*>(dstTile.data.data());
 
-        framesAreSame &= processData<OpPolicy>(dstDataPtr, srcDataPtr, numQWords);
+        bool tilesAreSame = processData<OpPolicy>(dstDataPtr, srcDataPtr, numQWords);
 
 
         const int tailBytes = numBytes % 8;
         const quint8 *srcTailDataPtr = srcTile.data.data() + numBytes - tailBytes;
         quint8 *dstTailDataPtr = dstTile.data.data() + numBytes - tailBytes;
 
-        framesAreSame &= processData<OpPolicy>(dstTailDataPtr, srcTailDataPtr, tailBytes);
+        tilesAreSame &= processData<OpPolicy>(dstTailDataPtr, srcTailDataPtr, tailBytes);
+
+        if (tilesAreSame && dropSameTiles) {
+            DataBuffer emptyBuffer(dstTile.data.pool());
+            dstTile.data.swap(emptyBuffer);
+        }
+
+        framesAreSame &= tilesAreSame;
     }
 
     return framesAreSame;
@@ -344,11 +388,11 @@ bool KisFrameDataSerializer::processFrames(KisFrameDataSerializer::Frame &dst, c
 
 bool KisFrameDataSerializer::subtractFrames(KisFrameDataSerializer::Frame &dst, const KisFrameDataSerializer::Frame &src)
 {
-    return processFrames<std::minus>(dst, src);
+    return processFrames<std::minus>(dst, src, true);
 }
 
 void KisFrameDataSerializer::addFrames(KisFrameDataSerializer::Frame &dst, const KisFrameDataSerializer::Frame &src)
 {
     // TODO: don't spend time on calculation of "framesAreSame" in this case
-    (void) processFrames<std::plus>(dst, src);
+    (void) processFrames<std::plus>(dst, src, false);
 }
@@ -40,6 +40,13 @@ class QString;
  *    but a preprocessed pixel differences)
  *
  * 2) Compress this data and save it on disk
+ *
+ * A tile without any data (FrameTile::isValid() returns false) is a tile of
+ * a difference frame that is identical to the corresponding tile of the base
+ * frame. Such tiles are not written to disk at all and are loaded back as
+ * empty tiles, so only the changed parts of a frame cost any space and time.
+ * Please note that a valid tile with an empty rect is still a valid tile:
+ * it is saved and loaded back with its data chunk allocated.
  */
 
 class KRITAUI_EXPORT KisFrameDataSerializer
@@ -59,15 +66,16 @@ public:
             return data.data();
         }
 
-        FrameTile clone() const{
+        /**
+         * The clone shares the pixel data with the original tile, the
+         * data is copied only when one of them calls data.detach()
+         */
+        FrameTile clone() const {
             FrameTile tile(data.pool());
             tile.col = col;
             tile.row = row;
             tile.rect = rect;
-            tile.data.allocate(data.pixelSize());
-
-            const int bufferSize = data.pixelSize() * rect.width() * rect.height();
-            memcpy(tile.data.data(), data.data(), bufferSize);
+            tile.data = data.share();
 
             return tile;
         }
@@ -120,12 +128,25 @@ public:
     void forgetFrame(int frameId);
 
     static boost::optional<qreal> estimateFrameUniqueness(const Frame &lhs, const Frame &rhs, qreal portion);
+
+    /**
+     * Replaces \p dst with its difference against \p src. Tiles that turn
+     * out to be identical in both frames lose their data and become empty
+     * (unchanged) tiles.
+     *
+     * \return true if the frames are identical
+     */
     static bool subtractFrames(Frame &dst, const Frame &src);
+
+    /**
+     * Restores the frame from its difference \p dst and the base frame
+     * \p src. Empty (unchanged) tiles of \p dst get a copy of the base tile.
+     */
     static void addFrames(Frame &dst, const Frame &src);
 
 private:
     template<template <typename U> class OpPolicy>
-    static bool processFrames(KisFrameDataSerializer::Frame &dst, const KisFrameDataSerializer::Frame &src);
+    static bool processFrames(KisFrameDataSerializer::Frame &dst, const KisFrameDataSerializer::Frame &src, bool dropSameTiles);
 
 private:
     Q_DISABLE_COPY(KisFrameDataSerializer)
@@ -66,6 +66,8 @@ public:
           expectedFrame(0),
           lastTimerInterval(0),
           lastPaintedFrame(0),
+          numDroppedFrames(0),
+          numPrefetchedFrames(0),
           playbackStatisticsCompressor(1000, KisSignalCompressor::FIRST_INACTIVE),
           stopAudioOnScrubbingCompressor(100, KisSignalCompressor::POSTPONE),
           audioOffsetTolerance(-1)
@@ -101,6 +103,8 @@ public:
     int expectedFrame;
     int lastTimerInterval;
     int lastPaintedFrame;
+    int numDroppedFrames;
+    int numPrefetchedFrames;
 
     KisSignalCompressor playbackStatisticsCompressor;
 
@@ -368,6 +372,8 @@ void KisAnimationPlayer::play()
             }
 
             m_d->canvas->setRenderingLimit(regionOfInterest);
+
+            m_d->numPrefetchedFrames = cfg.animationCachePrefetchFrames();
         }
     }
 
@@ -376,6 +382,7 @@ void KisAnimationPlayer::play()
     slotUpdatePlaybackTimer();
     m_d->expectedFrame = m_d->firstFrame;
     m_d->lastPaintedFrame = -1;
+    m_d->numDroppedFrames = 0;
 
     connectCancelSignals();
 
@@ -470,6 +477,17 @@ void KisAnimationPlayer::uploadFrame(int frame)
         m_d->timer->start(m_d->lastTimerInterval);
 
         m_d->playbackStatisticsCompressor.start();
+
+        if (m_d->canvas->frameCache() && m_d->numPrefetchedFrames > 0) {
+            /**
+             * When playing faster than the native framerate the playhead
+             * advances by several frames per tick, so look further ahead
+             */
+            const int lookAhead = qCeil(m_d->numPrefetchedFrames * qMax(1.0, m_d->playbackSpeed));
+
+            m_d->canvas->frameCache()->prefetchFrames(m_d->expectedFrame, lookAhead,
+                                                      KisTimeRange::fromTime(m_d->firstFrame, m_d->lastFrame));
+        }
     }
 
     if (m_d->syncedAudio) {
@@ -520,6 +538,7 @@ void KisAnimationPlayer::uploadFrame(int frame)
             }
 
             m_d->droppedFramesPortion(qreal(int(numFrames != 1)));
+            m_d->numDroppedFrames += qMax(0, numFrames - 1);
 
             if (numFrames > 0) {
                 m_d->droppedFpsAccumulator(qreal(elapsed) / numFrames);
@@ -551,6 +570,11 @@ qreal KisAnimationPlayer::framesDroppedPortion() const
     return m_d->droppedFramesPortion.rollingMean();
 }
 
+int KisAnimationPlayer::droppedFramesCount() const
+{
+    return m_d->numDroppedFrames;
+}
+
 void KisAnimationPlayer::slotCancelPlayback()
 {
     stop();
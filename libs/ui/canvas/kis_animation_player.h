@@ -50,6 +50,11 @@ public:
     qreal realFps() const;
     qreal framesDroppedPortion() const;
 
+    /**
+     * \return the number of frames skipped since the playback started
+     */
+    int droppedFramesCount() const;
+
 public Q_SLOTS:
     void slotUpdate();
     void slotCancelPlayback();
@@ -31,6 +31,9 @@
 #include <QLabel>
 #include <QMouseEvent>
 #include <QDesktopWidget>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QWindow>
 
 #include <kis_debug.h>
 
@@ -158,6 +161,7 @@ public:
     }
 
     void setActiveShapeManager(KoShapeManager *shapeManager);
+    void updateFramePacing();
 };
 
 namespace {
@@ -199,13 +203,9 @@ KisCanvas2::KisCanvas2(KisCoordinatesConverter *coordConverter, KoCanvasResource
     m_d->bootstrapLodBlocked = true;
     connect(view->mainWindow(), SIGNAL(guiLoadingFinished()), SLOT(bootstrapFinished()));
 
-    KisImageConfig config(false);
-
-    m_d->canvasUpdateCompressor.setDelay(1000 / config.fpsLimit());
     m_d->canvasUpdateCompressor.setMode(KisSignalCompressor::FIRST_ACTIVE);
-
-    m_d->frameRenderStartCompressor.setDelay(1000 / config.fpsLimit());
     m_d->frameRenderStartCompressor.setMode(KisSignalCompressor::FIRST_ACTIVE);
+    m_d->updateFramePacing();
 }
 
 void KisCanvas2::setup()
@@ -388,6 +388,29 @@ void KisCanvas2::addCommand(KUndo2Command *command)
     m_d->view->document()->addCommand(command);
 }
 
+void KisCanvas2::KisCanvas2Private::updateFramePacing()
+{
+    int fps = KisImageConfig(true).fpsLimit();
+
+    /**
+     * There is no use in uploading textures more often than the display
+     * can show them, so the uploads are paced by the refresh rate of the
+     * screen the view lives on. The updates arriving in between are
+     * merged by projectionUpdatesCompressor meanwhile.
+     */
+    QWindow *window = view && view->window() ? view->window()->windowHandle() : 0;
+    QScreen *screen = window ? window->screen() : QGuiApplication::primaryScreen();
+
+    if (screen && screen->refreshRate() >= 1.0) {
+        fps = qMin(fps, qRound(screen->refreshRate()));
+    }
+
+    const int delay = 1000 / qMax(1, fps);
+
+    canvasUpdateCompressor.setDelay(delay);
+    frameRenderStartCompressor.setDelay(delay);
+}
+
 void KisCanvas2::KisCanvas2Private::setActiveShapeManager(KoShapeManager *shapeManager)
 {
     if (shapeManager != currentlyActiveShapeManager) {
@@ -1040,6 +1063,8 @@ void KisCanvas2::slotConfigChanged()
     m_d->vastScrolling = cfg.vastScrolling();
 
     resetCanvas(cfg.useOpenGL());
+    m_d->updateFramePacing();
+    m_d->projectionUpdatesCompressor.setMaxMergeOverhead(KisImageConfig(true).canvasUpdatesMergeOverhead());
     slotSetDisplayProfile(cfg.displayProfile(QApplication::desktop()->screenNumber(this->canvasWidget())));
 
     initializeFpsDecoration();
@@ -18,6 +18,92 @@
 
 #include "kis_canvas_updates_compressor.h"
 
+#include <QHash>
+
+#include "kis_image_config.h"
+
+namespace {
+
+inline qint64 rectArea(const QRect &rc)
+{
+    return qint64(rc.width()) * rc.height();
+}
+
+inline quint64 tileKey(const KisTextureTileUpdateInfoSP &tile)
+{
+    return (quint64(quint32(tile->tileCol())) << 32) | quint32(tile->tileRow());
+}
+
+/**
+ * Drops the tiles of \p dst that are going to be completely overwritten
+ * by the tiles of \p src, so that the merged update would not upload the
+ * same texture data twice
+ */
+void removeOverriddenTiles(KisOpenGLUpdateInfo *dst, const KisOpenGLUpdateInfo *src)
+{
+    QHash<quint64, QRect> newPatches;
+    Q_FOREACH (const KisTextureTileUpdateInfoSP &tile, src->tileList) {
+        newPatches.insert(tileKey(tile), tile->realPatchRect());
+    }
+
+    KisTextureTileUpdateInfoSPList::iterator it = dst->tileList.begin();
+    while (it != dst->tileList.end()) {
+        QHash<quint64, QRect>::const_iterator patchIt = newPatches.constFind(tileKey(*it));
+
+        if (patchIt != newPatches.constEnd() &&
+            patchIt->contains((*it)->realPatchRect())) {
+
+            it = dst->tileList.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+}
+
+KisCanvasUpdatesCompressor::KisCanvasUpdatesCompressor()
+    : m_maxMergeOverhead(KisImageConfig(true).canvasUpdatesMergeOverhead())
+{
+}
+
+void KisCanvasUpdatesCompressor::setMaxMergeOverhead(int value)
+{
+    QMutexLocker l(&m_mutex);
+    m_maxMergeOverhead = value;
+}
+
+bool KisCanvasUpdatesCompressor::tryMergeWithLastUpdate(KisUpdateInfoSP info)
+{
+    if (m_maxMergeOverhead < 0 || m_updatesList.isEmpty()) return false;
+
+    /**
+     * Only the last update in the queue can be extended, otherwise the
+     * tiles of the merged update might be uploaded before the older data
+     * queued in between and the canvas would show outdated content
+     */
+    KisOpenGLUpdateInfo *lastInfo = dynamic_cast<KisOpenGLUpdateInfo*>(m_updatesList.last().data());
+    KisOpenGLUpdateInfo *newInfo = dynamic_cast<KisOpenGLUpdateInfo*>(info.data());
+
+    if (!lastInfo || !newInfo ||
+        lastInfo->levelOfDetail() != newInfo->levelOfDetail()) {
+
+        return false;
+    }
+
+    const QRect lastRect = lastInfo->dirtyImageRect();
+    const QRect newRect = newInfo->dirtyImageRect();
+
+    const qint64 coveredArea =
+        rectArea(lastRect) + rectArea(newRect) - rectArea(lastRect & newRect);
+    const qint64 mergedArea = rectArea(lastRect | newRect);
+
+    if (mergedArea * 100 > coveredArea * (100 + m_maxMergeOverhead)) return false;
+
+    removeOverriddenTiles(lastInfo, newInfo);
+    return lastInfo->tryMergeWith(*newInfo);
+}
+
 bool KisCanvasUpdatesCompressor::putUpdateInfo(KisUpdateInfoSP info)
 {
     const int levelOfDetail = info->levelOfDetail();
@@ -42,7 +128,9 @@ bool KisCanvasUpdatesCompressor::putUpdateInfo(KisUpdateInfoSP info)
         }
     }
 
-    m_updatesList.append(info);
+    if (!tryMergeWithLastUpdate(info)) {
+        m_updatesList.append(info);
+    }
 
     return m_updatesList.size() <= 1;
 }
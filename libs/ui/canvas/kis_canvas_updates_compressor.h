@@ -24,19 +24,35 @@
 #include <QMutexLocker>
 
 #include "kis_update_info.h"
+#include "kritaui_export.h"
 
 
-class KisCanvasUpdatesCompressor
+class KRITAUI_EXPORT KisCanvasUpdatesCompressor
 {
     typedef QList<KisUpdateInfoSP> UpdateInfoList;
 
 public:
+    KisCanvasUpdatesCompressor();
+
     bool putUpdateInfo(KisUpdateInfoSP info);
     KisUpdateInfoSP takeUpdateInfo();
 
+    /**
+     * Two consecutive openGL updates of the same level of detail are
+     * merged into a single one if the bounding rect of the merged update
+     * is at most \p value percent bigger than the area actually covered
+     * by the two updates. Negative value disables merging. The value
+     * is reread by KisCanvas2 on every config change.
+     */
+    void setMaxMergeOverhead(int value);
+
+private:
+    bool tryMergeWithLastUpdate(KisUpdateInfoSP info);
+
 private:
     QMutex m_mutex;
     UpdateInfoList m_updatesList;
+    int m_maxMergeOverhead;
 };
 
 #endif /* __KIS_CANVAS_UPDATES_COMPRESSOR_H */
@@ -32,6 +32,8 @@
 #include "kis_debug.h"
 #include "kis_config.h"
 #include "kis_image_config.h"
+#include "krita_utils.h"
+#include "KisSharedWorkerPool.h"
 
 //#define DEBUG_PYRAMID
 
@@ -53,9 +55,20 @@
 #include <half.h>
 #endif
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #define ceiledSize(sz) QSize(ceil((sz).width()), ceil((sz).height()))
 #define isOdd(x) ((x) & 0x01)
 
+/**
+ * The size of the patches the pyramid planes are processed in
+ * concurrently. Must be even to keep the patches aligned for
+ * downsampling.
+ */
+const int pyramidPatchSize = 512;
+
 /**
  * Aligns @value to the lowest integer not smaller than @value and
  * that is a divident of alignment
@@ -187,8 +200,18 @@ void KisImagePyramid::setImage(KisImageWSP newImage)
         int patchWidth = config.updatePatchWidth();
         int patchHeight = config.updatePatchHeight();
 
+        /**
+         * retrieveImageData() may reset the channel flags if they don't
+         * fit the projection, do that before going concurrent
+         */
+        if (m_channelFlags.size() != m_originalImage->projection()->colorSpace()->channels().size()) {
+            setChannelFlags(QBitArray());
+        }
+
+        QVector<QRect> patches;
+
         if (rc.width() * rc.height() <= patchWidth * patchHeight) {
-            retrieveImageData(rc);
+            patches << rc;
         }
         else {
             qint32 firstCol = rc.x() / patchWidth;
@@ -203,12 +226,21 @@ void KisImagePyramid::setImage(KisImageWSP newImage)
                                        i * patchHeight,
                                        patchWidth, patchHeight);
                     QRect patchRect = rc & maxPatchRect;
-                    retrieveImageData(patchRect);
+
+                    if (!patchRect.isEmpty()) {
+                        patches << patchRect;
+                    }
                 }
             }
 
         }
-        //TODO: check whether there is needed recalculateCache()
+
+        KisSharedWorkerPool::blockingMap(patches,
+            [this] (const QRect &patchRect) {
+                retrieveImageData(patchRect);
+            });
+
+        updatePyramidPlanes(rc);
     }
 }
 
@@ -334,17 +366,7 @@ void KisImagePyramid::retrieveImageData(const QRect &rect)
 
 void KisImagePyramid::recalculateCache(KisPPUpdateInfoSP info)
 {
-    KisPaintDevice *src;
-    KisPaintDevice *dst;
-    QRect currentSrcRect = info->dirtyImageRectVar;
-
-    for (int i = FIRST_NOT_ORIGINAL_INDEX; i < m_pyramidHeight; i++) {
-        src = m_pyramid[i-1].data();
-        dst = m_pyramid[i].data();
-        if (!currentSrcRect.isEmpty()) {
-            currentSrcRect = downsampleByFactor2(currentSrcRect, src, dst);
-        }
-    }
+    updatePyramidPlanes(info->dirtyImageRectVar);
 
 #ifdef DEBUG_PYRAMID
     QImage image = m_pyramid[ORIGINAL_INDEX]->convertToQImage(m_monitorProfile, m_renderingIntent, m_conversionFlags);
@@ -360,6 +382,21 @@ void KisImagePyramid::recalculateCache(KisPPUpdateInfoSP info)
 #endif
 }
 
+void KisImagePyramid::updatePyramidPlanes(const QRect &dirtyRect)
+{
+    KisPaintDevice *src;
+    KisPaintDevice *dst;
+    QRect currentSrcRect = dirtyRect;
+
+    for (int i = FIRST_NOT_ORIGINAL_INDEX; i < m_pyramidHeight; i++) {
+        src = m_pyramid[i-1].data();
+        dst = m_pyramid[i].data();
+        if (!currentSrcRect.isEmpty()) {
+            currentSrcRect = downsampleByFactor2(currentSrcRect, src, dst);
+        }
+    }
+}
+
 QRect KisImagePyramid::downsampleByFactor2(const QRect& srcRect,
         KisPaintDevice* src,
         KisPaintDevice* dst)
@@ -372,6 +409,36 @@ QRect KisImagePyramid::downsampleByFactor2(const QRect& srcRect,
     if (srcWidth < 1) return QRect();
     if (srcHeight < 1) return QRect();
 
+    const QRect alignedSrcRect(srcX, srcY, srcWidth, srcHeight);
+
+    /**
+     * The aligned rect starts at even coordinates and the patch size
+     * is even, so every patch is aligned by 2 as well and the patches
+     * write into non-overlapping areas of @dst
+     */
+    QVector<QRect> patches =
+        KritaUtils::splitRectIntoPatches(alignedSrcRect,
+                                         QSize(pyramidPatchSize, pyramidPatchSize));
+
+    if (patches.size() > 1) {
+        KisSharedWorkerPool::blockingMap(patches,
+            [src, dst] (const QRect &patch) {
+                downsamplePatch(patch, src, dst);
+            });
+    } else {
+        downsamplePatch(alignedSrcRect, src, dst);
+    }
+
+    return QRect(srcX / 2, srcY / 2, srcWidth / 2, srcHeight / 2);
+}
+
+void KisImagePyramid::downsamplePatch(const QRect &alignedSrcRect,
+                                      KisPaintDevice* src,
+                                      KisPaintDevice* dst)
+{
+    qint32 srcX, srcY, srcWidth, srcHeight;
+    alignedSrcRect.getRect(&srcX, &srcY, &srcWidth, &srcHeight);
+
     qint32 dstX = srcX / 2;
     qint32 dstY = srcY / 2;
     qint32 dstWidth = srcWidth / 2;
@@ -403,7 +470,6 @@ QRect KisImagePyramid::downsampleByFactor2(const QRect& srcRect,
         srcIt1->nextRow();
         dstIt->nextRow();
     }
-    return QRect(dstX, dstY, dstWidth, dstHeight);
 }
 
 void  KisImagePyramid::downsamplePixels(const quint8 *srcRow0,
@@ -411,10 +477,54 @@ void  KisImagePyramid::downsamplePixels(const quint8 *srcRow0,
                                         quint8 *dstRow,
                                         qint32 numSrcPixels)
 {
+    qint32 numDstPixels = numSrcPixels / 2;
+
+#if defined(__SSE2__)
+    static const qint32 pixelSize = 4; // This is preview argb8 mode
+
     /**
-     * FIXME (mandatory): Use SSE and friends here.
+     * Process 4 destination pixels (two 16-byte registers of every
+     * source row) per iteration. The channels are summed up in 16-bit
+     * lanes and divided with truncation, exactly like in
+     * downsamplePixelsScalar().
      */
+    const __m128i zero = _mm_setzero_si128();
+
+    auto sumPairs = [zero] (__m128i row0, __m128i row1) {
+        // vertical sums of pixels 0,1 and 2,3 of the register
+        const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero), _mm_unpacklo_epi8(row1, zero));
+        const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(row0, zero), _mm_unpackhi_epi8(row1, zero));
+
+        // horizontal sums: the lower 64 bits get (pixel 0 + pixel 1) and (pixel 2 + pixel 3)
+        const __m128i sumLo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+        const __m128i sumHi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+
+        return _mm_srli_epi16(_mm_unpacklo_epi64(sumLo, sumHi), 2);
+    };
+
+    for (; numDstPixels >= 4; numDstPixels -= 4) {
+        const __m128i src00 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcRow0));
+        const __m128i src01 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcRow0 + 16));
+        const __m128i src10 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcRow1));
+        const __m128i src11 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcRow1 + 16));
+
+        const __m128i result = _mm_packus_epi16(sumPairs(src00, src10), sumPairs(src01, src11));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dstRow), result);
 
+        dstRow += 4 * pixelSize;
+        srcRow0 += 8 * pixelSize;
+        srcRow1 += 8 * pixelSize;
+    }
+#endif
+
+    downsamplePixelsScalar(srcRow0, srcRow1, dstRow, 2 * numDstPixels);
+}
+
+void  KisImagePyramid::downsamplePixelsScalar(const quint8 *srcRow0,
+                                              const quint8 *srcRow1,
+                                              quint8 *dstRow,
+                                              qint32 numSrcPixels)
+{
     qint16 b = 0;
     qint16 g = 0;
     qint16 r = 0;
@@ -422,7 +532,9 @@ void  KisImagePyramid::downsamplePixels(const quint8 *srcRow0,
 
     static const qint32 pixelSize = 4; // This is preview argb8 mode
 
-    for (qint32 i = 0; i < numSrcPixels / 2; i++) {
+    qint32 numDstPixels = numSrcPixels / 2;
+
+    for (qint32 i = 0; i < numDstPixels; i++) {
         b = srcRow0[0] + srcRow1[0] + srcRow0[4] + srcRow1[4];
         g = srcRow0[1] + srcRow1[1] + srcRow0[5] + srcRow1[5];
         r = srcRow0[2] + srcRow1[2] + srcRow0[6] + srcRow1[6];
@@ -27,9 +27,10 @@
 #include <kis_image.h>
 #include <kis_paint_device.h>
 #include "kis_projection_backend.h"
+#include "kritaui_export.h"
 
 
-class KisImagePyramid : QObject, public KisProjectionBackend
+class KRITAUI_EXPORT KisImagePyramid : QObject, public KisProjectionBackend
 {
     Q_OBJECT
 
@@ -75,25 +76,50 @@ public:
 
 private:
 
+    friend class KisImagePyramidTest;
+
     void retrieveImageData(const QRect &rect);
     void rebuildPyramid();
     void clearPyramid();
 
+    /**
+     * Propagates changes of @dirtyRect of the original plane
+     * to all the downscaled planes
+     */
+    void updatePyramidPlanes(const QRect &dirtyRect);
+
     /**
      * Downsamples @srcRect from @src paint device and writes
-     * result into proper place of @dst paint device
+     * result into proper place of @dst paint device. Big rects
+     * are split into patches processed concurrently.
      * Returns modified rect of @dst paintDevice
      */
-    QRect downsampleByFactor2(const QRect& srcRect,
-                              KisPaintDevice* src, KisPaintDevice* dst);
+    static QRect downsampleByFactor2(const QRect& srcRect,
+                                     KisPaintDevice* src, KisPaintDevice* dst);
+
+    /**
+     * Downsamples a single patch. @alignedSrcRect must be
+     * aligned by 2
+     */
+    static void downsamplePatch(const QRect& alignedSrcRect,
+                                KisPaintDevice* src, KisPaintDevice* dst);
 
     /**
      * Auxiliary function. Downsamples two lines in @srcRow0
      * and @srcRow1 into one line @dstRow
      * Note: @numSrcPixels must be EVEN
      */
-    void downsamplePixels(const quint8 *srcRow0, const quint8 *srcRow1,
-                          quint8 *dstRow, qint32 numSrcPixels);
+    static void downsamplePixels(const quint8 *srcRow0, const quint8 *srcRow1,
+                                 quint8 *dstRow, qint32 numSrcPixels);
+
+    /**
+     * Plain per-pixel version of downsamplePixels(). It processes
+     * the tail the vectorized loop cannot handle and serves as a
+     * reference for it in the tests.
+     * Note: @numSrcPixels must be EVEN
+     */
+    static void downsamplePixelsScalar(const quint8 *srcRow0, const quint8 *srcRow1,
+                                       quint8 *dstRow, qint32 numSrcPixels);
 
     /**
      * Searches for the last pyramid plane that can cover
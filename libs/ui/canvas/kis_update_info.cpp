@@ -89,7 +89,11 @@ bool KisOpenGLUpdateInfo::tryMergeWith(const KisOpenGLUpdateInfo &rhs)
 {
     if (m_levelOfDetail != rhs.m_levelOfDetail) return false;
 
-    // TODO: that makes the algorithm of updates compressor incorrect!
+    /**
+     * The merged rect may be bigger than the area actually covered by the
+     * tiles. It is still safe for KisCanvasUpdatesCompressor, because any
+     * newer update containing this rect would contain all these tiles too.
+     */
     m_dirtyImageRect |= rhs.m_dirtyImageRect;
 
     tileList.append(rhs.tileList);
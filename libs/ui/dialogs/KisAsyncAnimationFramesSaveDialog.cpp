@@ -156,10 +156,24 @@ KisAsyncAnimationRenderDialogBase::Result KisAsyncAnimationFramesSaveDialog::reg
 
 QList<int> KisAsyncAnimationFramesSaveDialog::calcDirtyFrames() const
 {
-    // TODO: optimize!
     QList<int> result;
-    for (int i = m_d->range.start(); i <= m_d->range.end(); i++) {
-        result.append(i);
+    for (int frame = m_d->range.start(); frame <= m_d->range.end(); frame++) {
+        result.append(frame);
+
+        /**
+         * Held frames are rendered only once, the renderer saves
+         * the whole still range at the end of the regeneration
+         */
+        const KisTimeRange stillFrameRange =
+            KisTimeRange::calculateIdenticalFramesRecursive(m_d->originalImage->root(), frame);
+
+        if (!stillFrameRange.isValid()) continue;
+
+        if (stillFrameRange.isInfinite()) {
+            break;
+        } else {
+            frame = qMax(frame, stillFrameRange.end());
+        }
     }
     return result;
 }
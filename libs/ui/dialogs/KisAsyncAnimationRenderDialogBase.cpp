@@ -52,9 +52,15 @@ struct RendererPair {
     }
     RendererPair(RendererPair &&rhs)
         : renderer(std::move(rhs.renderer)),
-          image(rhs.image)
+          image(rhs.image),
+          pendingFrames(rhs.pendingFrames)
     {
     }
+
+    /**
+     * A contiguous chunk of the timeline assigned to this clone
+     */
+    QList<int> pendingFrames;
 };
 
 int calculateNumberMemoryAllowedClones(KisImageSP image)
@@ -93,16 +99,26 @@ struct KisAsyncAnimationRenderDialogBase::Private
     QScopedPointer<QProgressDialog> progressDialog;
     QEventLoop waitLoop;
 
-    QList<int> stillDirtyFrames;
     QList<int> framesInProgress;
     int dirtyFramesCount = 0;
     Result result = RenderComplete;
     QRegion regionOfInterest;
 
+    int numPendingFrames() const {
+        int result = 0;
+        for (auto &pair : asyncRenderers) {
+            result += pair.pendingFrames.size();
+        }
+        return result;
+    }
+
     int numDirtyFramesLeft() const {
-        return stillDirtyFrames.size() + framesInProgress.size();
+        return numPendingFrames() + framesInProgress.size();
     }
 
+    void distributeFrames(const QList<int> &frames, bool contiguous);
+    bool stealFrames(RendererPair *thief);
+
 };
 
 KisAsyncAnimationRenderDialogBase::KisAsyncAnimationRenderDialogBase(const QString &actionTitle, KisImageSP image, int busyWait)
@@ -141,10 +157,10 @@ KisAsyncAnimationRenderDialogBase::regenerateRange(KisViewManager *viewManager)
         }
     }
 
-    m_d->stillDirtyFrames = calcDirtyFrames();
+    const QList<int> dirtyFrames = calcDirtyFrames();
     m_d->framesInProgress.clear();
     m_d->result = RenderComplete;
-    m_d->dirtyFramesCount = m_d->stillDirtyFrames.size();
+    m_d->dirtyFramesCount = dirtyFrames.size();
 
     if (!m_d->isBatchMode) {
         QWidget *parentWidget = viewManager ? viewManager->mainWindow() : 0;
@@ -187,6 +203,8 @@ KisAsyncAnimationRenderDialogBase::regenerateRange(KisViewManager *viewManager)
         m_d->asyncRenderers.push_back(RendererPair(renderer, image));
     }
 
+    m_d->distributeFrames(dirtyFrames, useContiguousFrameRanges());
+
     ENTER_FUNCTION() << "Copying done in" << m_d->processingTime.elapsed();
 
     tryInitiateFrameRegeneration();
@@ -265,32 +283,72 @@ void KisAsyncAnimationRenderDialogBase::cancelProcessingImpl(bool isUserCancelle
         KIS_SAFE_ASSERT_RECOVER_NOOP(!pair.renderer->isActive());
     }
 
-    m_d->stillDirtyFrames.clear();
+    for (auto &pair : m_d->asyncRenderers) {
+        pair.pendingFrames.clear();
+    }
     m_d->framesInProgress.clear();
     m_d->result = isUserCancelled ? RenderCancelled : RenderFailed;
     updateProgressLabel();
 }
 
 
-void KisAsyncAnimationRenderDialogBase::tryInitiateFrameRegeneration()
+void KisAsyncAnimationRenderDialogBase::Private::distributeFrames(const QList<int> &frames, bool contiguous)
 {
-    bool hadWorkOnPreviousCycle = false;
-
-    while (!m_d->stillDirtyFrames.isEmpty()) {
-        for (auto &pair : m_d->asyncRenderers) {
-            if (!pair.renderer->isActive()) {
-                const int currentDirtyFrame = m_d->stillDirtyFrames.takeFirst();
-
-                initializeRendererForFrame(pair.renderer.get(), pair.image, currentDirtyFrame);
-                pair.renderer->startFrameRegeneration(pair.image, currentDirtyFrame, m_d->regionOfInterest);
-                hadWorkOnPreviousCycle = true;
-                m_d->framesInProgress.append(currentDirtyFrame);
-                break;
-            }
+    const int numWorkers = asyncRenderers.size();
+    KIS_SAFE_ASSERT_RECOVER_RETURN(numWorkers > 0);
+
+    if (contiguous) {
+        const int chunkSize = qCeil(qreal(frames.size()) / numWorkers);
+
+        for (int i = 0; i < numWorkers; i++) {
+            asyncRenderers[i].pendingFrames = frames.mid(i * chunkSize, chunkSize);
         }
+    } else {
+        for (int i = 0; i < frames.size(); i++) {
+            asyncRenderers[i % numWorkers].pendingFrames.append(frames[i]);
+        }
+    }
+}
+
+bool KisAsyncAnimationRenderDialogBase::Private::stealFrames(RendererPair *thief)
+{
+    RendererPair *victim = 0;
 
-        if (!hadWorkOnPreviousCycle) break;
-        hadWorkOnPreviousCycle = false;
+    for (auto &pair : asyncRenderers) {
+        if (!victim || pair.pendingFrames.size() > victim->pendingFrames.size()) {
+            victim = &pair;
+        }
+    }
+
+    if (!victim || victim == thief || victim->pendingFrames.isEmpty()) return false;
+
+    /**
+     * Take the second half of the biggest chunk, so both clones
+     * still walk over contiguous ranges of frames
+     */
+    const int numStolenFrames = qMax(1, victim->pendingFrames.size() / 2);
+    const int firstStolenFrame = victim->pendingFrames.size() - numStolenFrames;
+
+    thief->pendingFrames = victim->pendingFrames.mid(firstStolenFrame);
+    victim->pendingFrames.erase(victim->pendingFrames.begin() + firstStolenFrame,
+                                victim->pendingFrames.end());
+
+    return true;
+}
+
+void KisAsyncAnimationRenderDialogBase::tryInitiateFrameRegeneration()
+{
+    for (auto &pair : m_d->asyncRenderers) {
+        if (pair.renderer->isActive()) continue;
+
+        if (pair.pendingFrames.isEmpty() && !m_d->stealFrames(&pair)) continue;
+        if (!isFrameRegenerationAllowed(pair.pendingFrames.first())) continue;
+
+        const int currentDirtyFrame = pair.pendingFrames.takeFirst();
+
+        initializeRendererForFrame(pair.renderer.get(), pair.image, currentDirtyFrame);
+        pair.renderer->startFrameRegeneration(pair.image, currentDirtyFrame, m_d->regionOfInterest);
+        m_d->framesInProgress.append(currentDirtyFrame);
     }
 }
 
@@ -333,6 +391,17 @@ void KisAsyncAnimationRenderDialogBase::updateProgressLabel()
 
 
 
+bool KisAsyncAnimationRenderDialogBase::useContiguousFrameRanges() const
+{
+    return true;
+}
+
+bool KisAsyncAnimationRenderDialogBase::isFrameRegenerationAllowed(int frame) const
+{
+    Q_UNUSED(frame);
+    return true;
+}
+
 void KisAsyncAnimationRenderDialogBase::setBatchMode(bool value)
 {
     m_d->isBatchMode = value;
@@ -43,8 +43,10 @@ class KisViewManager;
  *   - if the user doesn't have anough RAM, the clones will not be created
  *     (the memory overhead is calculated using "projections" metric of the
  *      statistics server).
- *   - feed the images/threads with dirty frames until the all the frames
- *     are done
+ *   - split the dirty frames into contiguous chunks, one per clone, and
+ *     feed the images/threads with them until the all the frames are done.
+ *     A clone that finishes its chunk early steals the second half of the
+ *     biggest remaining one.
  *
  * Progress reporting:
  *   - if batchMode() is false, the user will see a progress dialog showing
@@ -118,7 +120,6 @@ private Q_SLOTS:
     void slotCancelRegeneration();
 
 private:
-    void tryInitiateFrameRegeneration();
     void updateProgressLabel();
     void cancelProcessingImpl(bool isUserCancelled);
 
@@ -143,6 +144,27 @@ protected:
     virtual void initializeRendererForFrame(KisAsyncAnimationRendererBase *renderer,
                                             KisImageSP image, int frame) = 0;
 
+    /**
+     * @return true if every clone should get a contiguous range of frames,
+     *         false if the frames should be dealt to the clones one by one
+     *
+     * Consumers that need the frames in order (e.g. a stream) should
+     * return false, otherwise the clones will wait for each other.
+     */
+    virtual bool useContiguousFrameRanges() const;
+
+    /**
+     * @return false if the regeneration of \p frame should be postponed,
+     *         e.g. because the consumer of the frames is busy. Call
+     *         tryInitiateFrameRegeneration() when the situation changes.
+     */
+    virtual bool isFrameRegenerationAllowed(int frame) const;
+
+    /**
+     * Starts regeneration of the pending frames on all idle clones
+     */
+    void tryInitiateFrameRegeneration();
+
 private:
     struct Private;
     const QScopedPointer<Private> m_d;
@@ -19,6 +19,7 @@
 #include "kis_animation_frame_cache.h"
 
 #include <QMap>
+#include <QVector>
 
 #include "kis_debug.h"
 
@@ -243,6 +244,28 @@ bool KisAnimationFrameCache::uploadFrame(int time)
     return bool(info);
 }
 
+void KisAnimationFrameCache::prefetchFrames(int time, int numFrames, const KisTimeRange &playbackRange)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(!playbackRange.isInfinite());
+
+    QVector<int> frameIds;
+
+    for (int i = 0; i < numFrames; i++) {
+        const int frameId = m_d->getFrameIdAtTime(time);
+
+        if (frameId >= 0 && !frameIds.contains(frameId)) {
+            frameIds.append(frameId);
+        }
+
+        time++;
+        if (time > playbackRange.end()) {
+            time = playbackRange.start();
+        }
+    }
+
+    m_d->swapper->prefetchFrames(frameIds);
+}
+
 bool KisAnimationFrameCache::shouldUploadNewFrame(int newTime, int oldTime) const
 {
     if (oldTime < 0) return true;
@@ -284,7 +307,9 @@ void KisAnimationFrameCache::slotConfigChanged()
     KisImageConfig cfg(true);
 
     if (cfg.useOnDiskAnimationCacheSwapping()) {
-        m_d->swapper.reset(new KisFrameCacheSwapper(m_d->textures->updateInfoBuilder(), cfg.swapDir()));
+        KisFrameCacheSwapper *swapper = new KisFrameCacheSwapper(m_d->textures->updateInfoBuilder(), cfg.swapDir());
+        swapper->setPrefetchMemoryLimit(qint64(cfg.animationCachePrefetchMemoryLimit()) * 1024 * 1024);
+        m_d->swapper.reset(swapper);
     } else {
         m_d->swapper.reset(new KisInMemoryFrameCacheSwapper());
     }
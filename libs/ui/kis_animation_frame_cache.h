@@ -53,6 +53,13 @@ public:
 
     bool shouldUploadNewFrame(int newTime, int oldTime) const;
 
+    /**
+     * Asks the swapper to prepare the cached frames that are going to be
+     * shown next in background. The frames starting at \p time are
+     * requested in playback order, wrapping around \p playbackRange.
+     */
+    void prefetchFrames(int time, int numFrames, const KisTimeRange &playbackRange);
+
     enum CacheStatus {
         Cached,
         Uncached,
@@ -1644,6 +1644,16 @@ void KisConfig::setLineSmoothingStabilizeSensors(bool value)
     m_cfg.writeEntry("LineSmoothingStabilizeSensors", value);
 }
 
+bool KisConfig::lineSmoothingUseStrokePrediction(bool defaultValue) const
+{
+    return (defaultValue ? false : m_cfg.readEntry("LineSmoothingUseStrokePrediction", false));
+}
+
+void KisConfig::setLineSmoothingUseStrokePrediction(bool value)
+{
+    m_cfg.writeEntry("LineSmoothingUseStrokePrediction", value);
+}
+
 int KisConfig::tabletEventsDelay(bool defaultValue) const
 {
     return (defaultValue ? 10 : m_cfg.readEntry("tabletEventsDelay", 10));
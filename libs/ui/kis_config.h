@@ -466,6 +466,9 @@ public:
     bool lineSmoothingStabilizeSensors(bool defaultValue = false) const;
     void setLineSmoothingStabilizeSensors(bool value);
 
+    bool lineSmoothingUseStrokePrediction(bool defaultValue = false) const;
+    void setLineSmoothingUseStrokePrediction(bool value);
+
     int tabletEventsDelay(bool defaultValue = false) const;
     void setTabletEventsDelay(int value);
 
@@ -21,6 +21,7 @@
 #include <QApplication>
 #include <QPainter>
 #include "kis_canvas2.h"
+#include "kis_animation_player.h"
 #include "kis_coordinates_converter.h"
 #include "opengl/kis_opengl_canvas_debugger.h"
 #include <KisStrokeSpeedMonitor.h>
@@ -51,13 +52,13 @@ KisFpsDecoration::~KisFpsDecoration()
 {
 }
 
-void KisFpsDecoration::drawDecoration(QPainter& gc, const QRectF& /*updateRect*/, const KisCoordinatesConverter */*converter*/, KisCanvas2* /*canvas*/)
+void KisFpsDecoration::drawDecoration(QPainter& gc, const QRectF& /*updateRect*/, const KisCoordinatesConverter */*converter*/, KisCanvas2* canvas)
 {
     // we always paint into a pixmap instead of directly into gc, as the latter
     // approach is known to cause garbled graphics on macOS, Windows, and even
     // sometimes Linux.
 
-    const QString text = getText();
+    const QString text = getText(canvas);
 
     // note that USUALLY the pixmap will have the right size. in very rare cases
     // (e.g. on the very first call) the computed bounding rect will not be right
@@ -107,13 +108,22 @@ bool KisFpsDecoration::draw(const QString &text, QSize &outSize)
     return true;
 }
 
-QString KisFpsDecoration::getText() const
+QString KisFpsDecoration::getText(KisCanvas2 *canvas) const
 {
     QStringList lines;
 
     if (KisOpenglCanvasDebugger::instance()->showFpsOnCanvas()) {
         const qreal value = KisOpenglCanvasDebugger::instance()->accumulatedFps();
         lines << QString("Canvas FPS: %1").arg(QString::number(value, 'f', 1));
+
+        KisAnimationPlayer *player = canvas ? canvas->animationPlayer() : 0;
+
+        if (player && player->isPlaying()) {
+            lines << QString("Playback FPS: %1 (real: %2)")
+                    .arg(player->effectiveFps(), 0, 'f', 1)
+                    .arg(player->realFps(), 0, 'f', 1);
+            lines << QString("Dropped frames: %1").arg(player->droppedFramesCount());
+        }
     }
 
     KisStrokeSpeedMonitor *monitor = KisStrokeSpeedMonitor::instance();
@@ -125,12 +135,19 @@ QString KisFpsDecoration::getText() const
                 .arg(monitor->lastStrokeSaturated() ? " (!)" : "");
         lines << QString("Last brush framerate: %1 fps")
                 .arg(monitor->lastFps(), 0, 'f', 1);
+        lines << QString("Last input latency: %1 ms")
+                .arg(monitor->lastLatency(), 0, 'f', 1);
 
         lines << QString("Average cursor/brush speed (px/ms): %1/%2")
                 .arg(monitor->avgCursorSpeed(), 0, 'f', 1)
                 .arg(monitor->avgRenderingSpeed(), 0, 'f', 1);
         lines << QString("Average brush framerate: %1 fps")
                 .arg(monitor->avgFps(), 0, 'f', 1);
+        lines << QString("Average input latency: %1 ms")
+                .arg(monitor->avgLatency(), 0, 'f', 1);
+        lines << QString("Brush/texture cache hit rate: %1%/%2%")
+                .arg(monitor->brushPrototypeCacheHitRate() * 100.0, 0, 'f', 0)
+                .arg(monitor->textureMaskCacheHitRate() * 100.0, 0, 'f', 0);
     }
 
     return lines.join('\n');
@@ -27,6 +27,16 @@
 #include <QReadLocker>
 #include <QWriteLocker>
 
+#include "KisSharedWorkerPool.h"
+
+namespace {
+/**
+ * The minimal number of tiles in an update that is worth splitting
+ * between the worker threads
+ */
+const int minTilesForParallelConversion = 4;
+}
+
 
 struct KRITAUI_NO_EXPORT KisOpenGLUpdateInfoBuilder::Private
 {
@@ -137,6 +147,9 @@ KisOpenGLUpdateInfoSP KisOpenGLUpdateInfoBuilder::buildUpdateInfo(const QRect &r
         alignedBounds = KisLodTransform::alignedRect(alignedBounds, levelOfDetail);
     }
 
+    KisTextureTileUpdateInfoSPList tiles;
+    tiles.reserve(numItems);
+
     for (int col = firstColumn; col <= lastColumn; col++) {
         for (int row = firstRow; row <= lastRow; row++) {
 
@@ -151,17 +164,7 @@ KisOpenGLUpdateInfoSP KisOpenGLUpdateInfoBuilder::buildUpdateInfo(const QRect &r
                                                      m_d->pool));
             // Don't update empty tiles
             if (tileInfo->valid()) {
-                tileInfo->retrieveData(projection, channelFlags, m_d->onlyOneChannelSelected, m_d->selectedChannelIndex);
-
-                if (convertColorSpace) {
-                    if (m_d->proofingTransform) {
-                        tileInfo->proofTo(m_d->conversionOptions.m_destinationColorSpace, m_d->proofingConfig->conversionFlags, m_d->proofingTransform.data());
-                    } else {
-                        tileInfo->convertTo(m_d->conversionOptions.m_destinationColorSpace, m_d->conversionOptions.m_renderingIntent, m_d->conversionOptions.m_conversionFlags);
-                    }
-                }
-
-                info->tileList.append(tileInfo);
+                tiles.append(tileInfo);
             }
             else {
                 dbgUI << "Trying to create an empty tileinfo record" << col << row << alignedTileTextureRect << updateRect << bounds;
@@ -169,6 +172,40 @@ KisOpenGLUpdateInfoSP KisOpenGLUpdateInfoBuilder::buildUpdateInfo(const QRect &r
         }
     }
 
+    auto prepareTile =
+        [&] (KisTextureTileUpdateInfoSP tileInfo) {
+            tileInfo->retrieveData(projection, channelFlags, m_d->onlyOneChannelSelected, m_d->selectedChannelIndex);
+
+            if (convertColorSpace) {
+                if (m_d->proofingTransform) {
+                    tileInfo->proofTo(m_d->conversionOptions.m_destinationColorSpace, m_d->proofingConfig->conversionFlags, m_d->proofingTransform.data());
+                } else {
+                    tileInfo->convertTo(m_d->conversionOptions.m_destinationColorSpace, m_d->conversionOptions.m_renderingIntent, m_d->conversionOptions.m_conversionFlags);
+                }
+            }
+        };
+
+    /**
+     * Big updates (e.g. a large brush on a 4K canvas) are converted by
+     * the shared worker pool, the calling thread takes part in the
+     * conversion. The caller is blocked until all the tiles are ready,
+     * so an image thread cannot get ahead of the canvas for more than
+     * one update.
+     *
+     * The proofing transform is a single LCMS transform object, which
+     * is not safe to be used from several threads at once, so proofed
+     * tiles are always converted sequentially.
+     */
+    if (tiles.size() >= minTilesForParallelConversion && !m_d->proofingTransform) {
+        KisSharedWorkerPool::blockingMap(tiles, prepareTile);
+    } else {
+        Q_FOREACH (KisTextureTileUpdateInfoSP tileInfo, tiles) {
+            prepareTile(tileInfo);
+        }
+    }
+
+    info->tileList = tiles;
+
     info->assignDirtyImageRect(rect);
     info->assignLevelOfDetail(levelOfDetail);
     return info;
@@ -0,0 +1,106 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisTextureTileFastConversion.h"
+
+#include <KoColorSpace.h>
+#include <KoColorProfile.h>
+#include <KoColorModelStandardIds.h>
+#include <KoColorSpaceMaths.h>
+
+#include <KoConfig.h>
+#ifdef HAVE_OPENEXR
+#include <half.h>
+#endif
+
+
+namespace {
+
+/**
+ * Both the integer and the floating point RGBA color spaces keep their
+ * channels in the same order for all depths of the same kind, so the
+ * conversion is a plain per-channel scaling.
+ */
+template <typename SrcChannel, typename DstChannel>
+void scaleChannels(const quint8 *src, quint8 *dst, int numChannels)
+{
+    const SrcChannel *s = reinterpret_cast<const SrcChannel*>(src);
+    DstChannel *d = reinterpret_cast<DstChannel*>(dst);
+
+    for (int i = 0; i < numChannels; i++) {
+        d[i] = KoColorSpaceMaths<SrcChannel, DstChannel>::scaleToA(s[i]);
+    }
+}
+
+#ifdef HAVE_OPENEXR
+void halfToFloatChannels(const quint8 *src, quint8 *dst, int numChannels)
+{
+    const half *s = reinterpret_cast<const half*>(src);
+    float *d = reinterpret_cast<float*>(dst);
+
+    for (int i = 0; i < numChannels; i++) {
+        d[i] = s[i];
+    }
+}
+#endif
+
+bool profilesAreEqual(const KoColorSpace *srcCS, const KoColorSpace *dstCS)
+{
+    const KoColorProfile *srcProfile = srcCS->profile();
+    const KoColorProfile *dstProfile = dstCS->profile();
+
+    return srcProfile == dstProfile ||
+        (srcProfile && dstProfile && *srcProfile == *dstProfile);
+}
+
+}
+
+bool KisTextureTileFastConversion::tryConvert(const quint8 *src, const KoColorSpace *srcCS,
+                                              quint8 *dst, const KoColorSpace *dstCS,
+                                              int numPixels)
+{
+    if (srcCS->colorModelId() != RGBAColorModelID ||
+        dstCS->colorModelId() != RGBAColorModelID ||
+        !profilesAreEqual(srcCS, dstCS)) {
+
+        return false;
+    }
+
+    const KoID srcDepth = srcCS->colorDepthId();
+    const KoID dstDepth = dstCS->colorDepthId();
+    const int numChannels = 4 * numPixels;
+
+    if (srcDepth == Integer16BitsColorDepthID && dstDepth == Integer8BitsColorDepthID) {
+        scaleChannels<quint16, quint8>(src, dst, numChannels);
+        return true;
+    }
+
+    if (srcDepth == Integer8BitsColorDepthID && dstDepth == Integer16BitsColorDepthID) {
+        scaleChannels<quint8, quint16>(src, dst, numChannels);
+        return true;
+    }
+
+#ifdef HAVE_OPENEXR
+    if (srcDepth == Float16BitsColorDepthID && dstDepth == Float32BitsColorDepthID) {
+        halfToFloatChannels(src, dst, numChannels);
+        return true;
+    }
+#endif
+
+    return false;
+}
@@ -0,0 +1,50 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISTEXTURETILEFASTCONVERSION_H
+#define KISTEXTURETILEFASTCONVERSION_H
+
+#include <QtGlobal>
+
+class KoColorSpace;
+
+/**
+ * Fast paths for the conversions that happen most often when uploading
+ * canvas textures: changing only the channel depth of an RGBA color
+ * space while keeping the profile (U16 -> U8, U8 -> U16 and F16 -> F32).
+ *
+ * The loops are written over plain arrays of channels so that the
+ * compiler can vectorize them. Everything else should go through the
+ * generic KoColorSpace::convertPixelsTo().
+ */
+namespace KisTextureTileFastConversion
+{
+
+/**
+ * Converts \p numPixels from \p src (in \p srcCS) into \p dst
+ * (in \p dstCS) if there is a fast path for this pair of color spaces.
+ *
+ * \return false if no fast path exists; \p dst is untouched then
+ */
+bool tryConvert(const quint8 *src, const KoColorSpace *srcCS,
+                quint8 *dst, const KoColorSpace *dstCS,
+                int numPixels);
+
+}
+
+#endif // KISTEXTURETILEFASTCONVERSION_H
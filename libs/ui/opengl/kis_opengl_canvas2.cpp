@@ -935,6 +935,17 @@ QVector<QRect> KisOpenGLCanvas2::updateCanvasProjection(const QVector<KisUpdateI
     this->makeCurrent();
 #endif
 
+    if (KisOpenglCanvasDebugger::instance()->showFpsOnCanvas()) {
+        int numTiles = 0;
+        Q_FOREACH (KisUpdateInfoSP info, infoObjects) {
+            KisOpenGLUpdateInfo *glInfo = dynamic_cast<KisOpenGLUpdateInfo*>(info.data());
+            if (glInfo) {
+                numTiles += glInfo->tileList.size();
+            }
+        }
+        KisOpenglCanvasDebugger::instance()->nofityTexturesUploaded(infoObjects.size(), numTiles);
+    }
+
     QVector<QRect> result = KisCanvasWidgetBase::updateCanvasProjection(infoObjects);
 
 #ifdef Q_OS_OSX
@@ -34,6 +34,9 @@ struct KisOpenglCanvasDebugger::Private
           fpsSum(0),
           syncFlaggedCounter(0),
           syncFlaggedSum(0),
+          uploadsCounter(0),
+          uploadedInfosSum(0),
+          uploadedTilesSum(0),
           isEnabled(true) {}
 
     QElapsedTimer time;
@@ -44,6 +47,10 @@ struct KisOpenglCanvasDebugger::Private
     int syncFlaggedCounter;
     int syncFlaggedSum;
 
+    int uploadsCounter;
+    int uploadedInfosSum;
+    int uploadedTilesSum;
+
     bool isEnabled;
 };
 
@@ -119,3 +126,21 @@ void KisOpenglCanvasDebugger::nofitySyncStatus(bool isBusy)
         m_d->syncFlaggedCounter = 0;
     }
 }
+
+void KisOpenglCanvasDebugger::nofityTexturesUploaded(int numUpdateInfos, int numTiles)
+{
+    if (!m_d->isEnabled) return;
+
+    m_d->uploadedInfosSum += numUpdateInfos;
+    m_d->uploadedTilesSum += numTiles;
+    m_d->uploadsCounter++;
+
+    if (m_d->uploadsCounter > 100) {
+        qDebug() << "Texture uploads:"
+                 << "update infos per upload" << qreal(m_d->uploadedInfosSum) / m_d->uploadsCounter
+                 << "tiles per upload" << qreal(m_d->uploadedTilesSum) / m_d->uploadsCounter;
+        m_d->uploadedInfosSum = 0;
+        m_d->uploadedTilesSum = 0;
+        m_d->uploadsCounter = 0;
+    }
+}
@@ -36,6 +36,7 @@ public:
 
     void nofityPaintRequested();
     void nofitySyncStatus(bool value);
+    void nofityTexturesUploaded(int numUpdateInfos, int numTiles);
     qreal accumulatedFps();
 
 private Q_SLOTS:
@@ -25,6 +25,7 @@
 
 #include <QMutex>
 #include <QMutexLocker>
+#include <QAtomicInt>
 #include <QSharedPointer>
 #include <QApplication>
 
@@ -134,7 +135,8 @@ class KRITAUI_EXPORT KisTextureTileInfoPool : public QObject
 public:
     KisTextureTileInfoPool(int tileWidth, int tileHeight)
         : m_tileWidth(tileWidth),
-          m_tileHeight(tileHeight)
+          m_tileHeight(tileHeight),
+          m_numTotalAllocations(0)
     {
         m_worker = new KisTextureTileInfoPoolWorker(this);
         m_worker->moveToThread(QApplication::instance()->thread());
@@ -161,6 +163,7 @@ public:
                 new KisTextureTileInfoPoolSingleSize(m_tileWidth, m_tileHeight, pixelSize);
         }
 
+        m_numTotalAllocations++;
         return m_pools[pixelSize]->malloc();
     }
 
@@ -183,6 +186,31 @@ public:
         return m_pools[pixelSize]->chunkSize();
     }
 
+    /**
+     * Called by the buffers every time they have to copy the content
+     * of a shared chunk to detach from it
+     */
+    void notifyDataCopied() {
+        m_numTotalCopies.ref();
+    }
+
+    /**
+     * \return the total number of chunks allocated from the pool during
+     * its lifetime, used for debugging and testing purposes
+     */
+    int numTotalAllocations() const {
+        QMutexLocker l(&m_mutex);
+        return m_numTotalAllocations;
+    }
+
+    /**
+     * \return the total number of chunks copied while detaching shared
+     * buffers, used for debugging and testing purposes
+     */
+    int numTotalCopies() const {
+        return m_numTotalCopies;
+    }
+
     void tryPurge(int pixelSize, int numFrees) {
         QMutexLocker l(&m_mutex);
         m_pools[pixelSize]->tryPurge(numFrees);
@@ -197,6 +225,8 @@ private:
     const int m_tileHeight;
     QVector<KisTextureTileInfoPoolSingleSize*> m_pools;
     KisTextureTileInfoPoolWorker *m_worker;
+    int m_numTotalAllocations;
+    QAtomicInt m_numTotalCopies;
 };
 
 typedef QSharedPointer<KisTextureTileInfoPool> KisTextureTileInfoPoolSP;
@@ -25,11 +25,14 @@
 #include <KoColorSpace.h>
 #include "kis_image.h"
 #include "kis_paint_device.h"
+#include "kis_shared.h"
+#include "kis_shared_ptr.h"
 #include "kis_config.h"
 #include <KoColorConversionTransformation.h>
 #include <KoChannelInfo.h>
 #include <kis_lod_transform.h>
 #include "kis_texture_tile_info_pool.h"
+#include "KisTextureTileFastConversion.h"
 
 
 class KisTextureTileUpdateInfo;
@@ -44,32 +47,55 @@ typedef QVector<KisTextureTileUpdateInfoSP> KisTextureTileUpdateInfoSPList;
  *
  * - the buffer's lifetime defines the lifetime of the allocated chunk
  *   of memory, so you don't have to thing about free'ing the memory
+ *
+ * - the chunk can be shared between several buffers (see share()), e.g.
+ *   a frame restored from the frame cache is uploaded directly from the
+ *   chunks the cache keeps for itself. Everyone who is going to write
+ *   into a possibly shared buffer should call detach() first.
  */
 
 class DataBuffer
 {
+    struct Chunk : public KisShared
+    {
+        Chunk(int pixelSize, KisTextureTileInfoPoolSP pool)
+            : data(pool->malloc(pixelSize)),
+              pixelSize(pixelSize),
+              pool(pool)
+        {
+        }
+
+        ~Chunk() {
+            pool->free(data, pixelSize);
+        }
+
+        quint8 *data;
+        int pixelSize;
+        KisTextureTileInfoPoolSP pool;
+    };
+
+    typedef KisSharedPtr<Chunk> ChunkSP;
+
 public:
     DataBuffer(KisTextureTileInfoPoolSP pool)
-        : m_data(0),
-          m_pixelSize(0),
+        : m_pixelSize(0),
           m_pool(pool)
     {
     }
 
     DataBuffer(int pixelSize, KisTextureTileInfoPoolSP pool)
-        : m_data(0),
-          m_pixelSize(0),
+        : m_pixelSize(0),
           m_pool(pool)
     {
         allocate(pixelSize);
     }
 
     DataBuffer(DataBuffer &&rhs)
-        : m_data(rhs.m_data),
+        : m_chunk(rhs.m_chunk),
           m_pixelSize(rhs.m_pixelSize),
           m_pool(rhs.m_pool)
     {
-        rhs.m_data = 0;
+        rhs.m_chunk = 0;
     }
 
     DataBuffer& operator=(DataBuffer &&rhs) {
@@ -78,30 +104,56 @@ public:
     }
 
     ~DataBuffer() {
-        if (m_data) {
-            m_pool->free(m_data, m_pixelSize);
-        }
     }
 
     void allocate(int pixelSize) {
-        Q_ASSERT(!m_data);
+        Q_ASSERT(!m_chunk);
 
         m_pixelSize = pixelSize;
-        m_data = m_pool->malloc(m_pixelSize);
+        m_chunk = new Chunk(m_pixelSize, m_pool);
     }
 
     inline quint8* data() const {
-        return m_data;
+        return m_chunk ? m_chunk->data : 0;
     }
 
     void swap(DataBuffer &other) {
         std::swap(other.m_pixelSize, m_pixelSize);
-        std::swap(other.m_data, m_data);
+        std::swap(other.m_chunk, m_chunk);
         std::swap(other.m_pool, m_pool);
     }
 
+    /**
+     * \return a buffer referencing the same chunk of memory. No data
+     * is copied.
+     */
+    DataBuffer share() const {
+        DataBuffer buffer(m_pool);
+        buffer.m_pixelSize = m_pixelSize;
+        buffer.m_chunk = m_chunk;
+        return buffer;
+    }
+
+    bool isShared() {
+        return m_chunk && m_chunk->refCount() > 1;
+    }
+
+    /**
+     * Makes sure the chunk is not referenced by any other buffer,
+     * copying the data if needed
+     */
+    void detach() {
+        if (!isShared()) return;
+
+        ChunkSP chunk(new Chunk(m_pixelSize, m_pool));
+        memcpy(chunk->data, m_chunk->data, size());
+        m_pool->notifyDataCopied();
+
+        m_chunk = chunk;
+    }
+
     int size() const {
-        return m_data ? m_pool->chunkSize(m_pixelSize) : 0;
+        return m_chunk ? m_pool->chunkSize(m_pixelSize) : 0;
     }
 
     KisTextureTileInfoPoolSP pool() const {
@@ -115,7 +167,7 @@ public:
 private:
     Q_DISABLE_COPY(DataBuffer)
 
-    quint8 *m_data;
+    ChunkSP m_chunk;
     int m_pixelSize;
     KisTextureTileInfoPoolSP m_pool;
 };
@@ -234,7 +286,12 @@ public:
             const qint32 numPixels = m_patchRect.width() * m_patchRect.height();
             DataBuffer conversionCache(dstCS->pixelSize(), m_pool);
 
-            m_patchColorSpace->convertPixelsTo(m_patchPixels.data(), conversionCache.data(), dstCS, numPixels, renderingIntent, conversionFlags);
+            if (!KisTextureTileFastConversion::tryConvert(m_patchPixels.data(), m_patchColorSpace,
+                                                          conversionCache.data(), dstCS,
+                                                          numPixels)) {
+
+                m_patchColorSpace->convertPixelsTo(m_patchPixels.data(), conversionCache.data(), dstCS, numPixels, renderingIntent, conversionFlags);
+            }
 
             m_patchColorSpace = dstCS;
             conversionCache.swap(m_patchPixels);
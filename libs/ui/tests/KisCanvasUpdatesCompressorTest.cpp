@@ -0,0 +1,263 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisCanvasUpdatesCompressorTest.h"
+
+#include <QTest>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_paint_device.h"
+#include "kis_canvas_updates_compressor.h"
+#include "kis_update_info.h"
+#include "opengl/KisOpenGLUpdateInfoBuilder.h"
+#include "opengl/kis_texture_tile_info_pool.h"
+
+namespace {
+
+const int textureTileSize = 64;
+const QRect imageBounds(0, 0, 512, 512);
+
+/**
+ * Paints dabs on a device and generates the openGL updates for them,
+ * the same way the canvas does it
+ */
+struct UpdatesGenerator
+{
+    UpdatesGenerator()
+        : pool(poolRegistry.getPool(textureTileSize, textureTileSize)),
+          device(new KisPaintDevice(KoColorSpaceRegistry::instance()->rgb8()))
+    {
+        builder.setTextureInfoPool(pool);
+        builder.setConversionOptions(
+            ConversionOptions(device->colorSpace(),
+                              KoColorConversionTransformation::internalRenderingIntent(),
+                              KoColorConversionTransformation::internalConversionFlags()));
+        builder.setTextureBorder(0);
+        builder.setEffectiveTextureSize(QSize(textureTileSize, textureTileSize));
+    }
+
+    KisOpenGLUpdateInfoSP paintDab(const QRect &rc, const QColor &color, int levelOfDetail = 0) {
+        device->fill(rc, KoColor(color, device->colorSpace()));
+        return builder.buildUpdateInfo(rc, device, imageBounds, levelOfDetail, false);
+    }
+
+    KisTextureTileInfoPoolRegistry poolRegistry;
+    KisTextureTileInfoPoolSP pool;
+    KisOpenGLUpdateInfoBuilder builder;
+    KisPaintDeviceSP device;
+};
+
+typedef QHash<QPair<int, int>, QByteArray> TexturesHash;
+
+/**
+ * Takes all the queued updates from the compressor and writes their
+ * tiles into \p textures in the same order the canvas uploads them
+ */
+int uploadUpdates(KisCanvasUpdatesCompressor &compressor, TexturesHash *textures)
+{
+    int numUpdates = 0;
+    KisUpdateInfoSP info;
+
+    while ((info = compressor.takeUpdateInfo())) {
+        KisOpenGLUpdateInfo *glInfo = dynamic_cast<KisOpenGLUpdateInfo*>(info.data());
+        KIS_ASSERT(glInfo);
+
+        Q_FOREACH (KisTextureTileUpdateInfoSP tile, glInfo->tileList) {
+            const QSize tileSize = tile->realTileSize();
+            const int pixelSize = tile->pixelSize();
+
+            QByteArray &texture = (*textures)[qMakePair(tile->tileCol(), tile->tileRow())];
+            if (texture.isEmpty()) {
+                texture.fill(0, tileSize.width() * tileSize.height() * pixelSize);
+            }
+
+            const QPoint offset = tile->realPatchOffset();
+            const QSize patchSize = tile->realPatchSize();
+
+            for (int y = 0; y < patchSize.height(); y++) {
+                memcpy(texture.data() + ((offset.y() + y) * tileSize.width() + offset.x()) * pixelSize,
+                       tile->data() + y * patchSize.width() * pixelSize,
+                       patchSize.width() * pixelSize);
+            }
+        }
+
+        numUpdates++;
+    }
+
+    return numUpdates;
+}
+
+int countTiles(KisUpdateInfoSP info, int col, int row)
+{
+    KisOpenGLUpdateInfo *glInfo = dynamic_cast<KisOpenGLUpdateInfo*>(info.data());
+    KIS_ASSERT(glInfo);
+
+    int numTiles = 0;
+
+    Q_FOREACH (KisTextureTileUpdateInfoSP tile, glInfo->tileList) {
+        if (tile->tileCol() == col && tile->tileRow() == row) {
+            numTiles++;
+        }
+    }
+
+    return numTiles;
+}
+
+}
+
+void KisCanvasUpdatesCompressorTest::testMergeBelowOverhead()
+{
+    UpdatesGenerator gen;
+    KisCanvasUpdatesCompressor compressor;
+    compressor.setMaxMergeOverhead(30);
+
+    // the bounding rect of the two updates is exactly their union
+    QVERIFY(compressor.putUpdateInfo(gen.paintDab(QRect(10,10,100,100), Qt::red)));
+    QVERIFY(compressor.putUpdateInfo(gen.paintDab(QRect(60,10,100,100), Qt::blue)));
+
+    KisUpdateInfoSP info = compressor.takeUpdateInfo();
+    QVERIFY(info);
+    QCOMPARE(info->dirtyImageRect(), QRect(10,10,150,100));
+    QVERIFY(!compressor.takeUpdateInfo());
+}
+
+void KisCanvasUpdatesCompressorTest::testNoMergeAboveOverhead()
+{
+    UpdatesGenerator gen;
+    KisCanvasUpdatesCompressor compressor;
+    compressor.setMaxMergeOverhead(30);
+
+    // the bounding rect is much bigger than the area of the updates
+    QVERIFY(compressor.putUpdateInfo(gen.paintDab(QRect(10,10,50,50), Qt::red)));
+    QVERIFY(!compressor.putUpdateInfo(gen.paintDab(QRect(200,200,50,50), Qt::blue)));
+
+    KisUpdateInfoSP info = compressor.takeUpdateInfo();
+    QVERIFY(info);
+    QCOMPARE(info->dirtyImageRect(), QRect(10,10,50,50));
+
+    info = compressor.takeUpdateInfo();
+    QVERIFY(info);
+    QCOMPARE(info->dirtyImageRect(), QRect(200,200,50,50));
+
+    QVERIFY(!compressor.takeUpdateInfo());
+
+    // negative overhead disables merging completely
+    compressor.setMaxMergeOverhead(-1);
+
+    QVERIFY(compressor.putUpdateInfo(gen.paintDab(QRect(10,10,100,100), Qt::red)));
+    QVERIFY(!compressor.putUpdateInfo(gen.paintDab(QRect(60,10,100,100), Qt::blue)));
+
+    TexturesHash textures;
+    QCOMPARE(uploadUpdates(compressor, &textures), 2);
+}
+
+void KisCanvasUpdatesCompressorTest::testNoMergeDifferentLevelOfDetail()
+{
+    UpdatesGenerator gen;
+    KisCanvasUpdatesCompressor compressor;
+    compressor.setMaxMergeOverhead(30);
+
+    QVERIFY(compressor.putUpdateInfo(gen.paintDab(QRect(10,10,100,100), Qt::red, 0)));
+    QVERIFY(!compressor.putUpdateInfo(gen.paintDab(QRect(60,10,100,100), Qt::blue, 1)));
+
+    KisUpdateInfoSP info = compressor.takeUpdateInfo();
+    QVERIFY(info);
+    QCOMPARE(info->levelOfDetail(), 0);
+
+    info = compressor.takeUpdateInfo();
+    QVERIFY(info);
+    QCOMPARE(info->levelOfDetail(), 1);
+
+    QVERIFY(!compressor.takeUpdateInfo());
+}
+
+void KisCanvasUpdatesCompressorTest::testOverriddenTiles()
+{
+    UpdatesGenerator gen;
+    KisCanvasUpdatesCompressor compressor;
+    compressor.setMaxMergeOverhead(30);
+
+    // covers tiles (0,0) and (1,0) entirely
+    compressor.putUpdateInfo(gen.paintDab(QRect(0,0,128,64), Qt::red));
+
+    // covers tile (0,0) entirely and tile (1,0) partially
+    compressor.putUpdateInfo(gen.paintDab(QRect(0,0,100,64), Qt::blue));
+
+    KisUpdateInfoSP info = compressor.takeUpdateInfo();
+    QVERIFY(info);
+    QVERIFY(!compressor.takeUpdateInfo());
+
+    QCOMPARE(info->dirtyImageRect(), QRect(0,0,128,64));
+
+    // the old tile (0,0) is overridden by the new one and is dropped...
+    QCOMPARE(countTiles(info, 0, 0), 1);
+
+    // ... but the old tile (1,0) is still needed for its right part
+    QCOMPARE(countTiles(info, 1, 0), 2);
+
+    KisOpenGLUpdateInfo *glInfo = dynamic_cast<KisOpenGLUpdateInfo*>(info.data());
+    QVERIFY(glInfo);
+    QCOMPARE(glInfo->tileList.size(), 3);
+}
+
+void KisCanvasUpdatesCompressorTest::testMergedContentMatchesUnmerged()
+{
+    UpdatesGenerator mergedGen;
+    KisCanvasUpdatesCompressor mergedCompressor;
+    mergedCompressor.setMaxMergeOverhead(30);
+    TexturesHash mergedTextures;
+    int numMergedUpdates = 0;
+
+    UpdatesGenerator plainGen;
+    KisCanvasUpdatesCompressor plainCompressor;
+    plainCompressor.setMaxMergeOverhead(-1);
+    TexturesHash plainTextures;
+    int numPlainUpdates = 0;
+
+    const int numDabs = 60;
+    const int dabsPerFrame = 5;
+
+    for (int i = 0; i < numDabs; i++) {
+        const QRect dabRect(20 + i * 6, 100 + (i % 7) * 5, 40, 40);
+        const QColor color = QColor::fromHsv(i * 37 % 360, 255, 255 - i);
+
+        mergedCompressor.putUpdateInfo(mergedGen.paintDab(dabRect, color));
+        plainCompressor.putUpdateInfo(plainGen.paintDab(dabRect, color));
+
+        if (i % dabsPerFrame == dabsPerFrame - 1) {
+            numMergedUpdates += uploadUpdates(mergedCompressor, &mergedTextures);
+            numPlainUpdates += uploadUpdates(plainCompressor, &plainTextures);
+        }
+    }
+
+    numMergedUpdates += uploadUpdates(mergedCompressor, &mergedTextures);
+    numPlainUpdates += uploadUpdates(plainCompressor, &plainTextures);
+
+    QVERIFY(numMergedUpdates < numPlainUpdates);
+
+    QCOMPARE(mergedTextures.keys().toSet(), plainTextures.keys().toSet());
+
+    for (auto it = plainTextures.constBegin(); it != plainTextures.constEnd(); ++it) {
+        QVERIFY(mergedTextures.value(it.key()) == it.value());
+    }
+}
+
+QTEST_MAIN(KisCanvasUpdatesCompressorTest)
@@ -0,0 +1,230 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisFrameCacheSwapperTest.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <testutil.h>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_paint_device.h"
+#include "kis_update_info.h"
+#include "KisFrameCacheStore.h"
+#include "KisFrameCacheSwapper.h"
+#include "opengl/KisOpenGLUpdateInfoBuilder.h"
+#include "opengl/kis_texture_tile_info_pool.h"
+#include "opengl/kis_texture_tile_update_info.h"
+
+namespace {
+
+const int maxTileSize = 256;
+const QRect imageBounds(0, 0, 512, 512);
+
+bool compareFrames(KisOpenGLUpdateInfoSP info1, KisOpenGLUpdateInfoSP info2)
+{
+    KIS_COMPARE_RF(info1->dirtyImageRect(), info2->dirtyImageRect());
+    KIS_COMPARE_RF(info1->levelOfDetail(), info2->levelOfDetail());
+    KIS_COMPARE_RF(info1->tileList.size(), info2->tileList.size());
+
+    for (int i = 0; i < info1->tileList.size(); i++) {
+        KisTextureTileUpdateInfoSP tile1 = info1->tileList[i];
+        KisTextureTileUpdateInfoSP tile2 = info2->tileList[i];
+
+        KIS_COMPARE_RF(tile1->tileCol(), tile2->tileCol());
+        KIS_COMPARE_RF(tile1->tileRow(), tile2->tileRow());
+        KIS_COMPARE_RF(tile1->realPatchRect(), tile2->realPatchRect());
+        KIS_COMPARE_RF(tile1->pixelSize(), tile2->pixelSize());
+
+        const QRect rc = tile1->realPatchRect();
+        const int numRealPixelBytes = rc.width() * rc.height() * tile1->pixelSize();
+
+        if (memcmp(tile1->data(), tile2->data(), numRealPixelBytes) != 0) {
+            qWarning() << "Tile pixels differ:" << ppVar(tile1->tileCol()) << ppVar(tile1->tileRow());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Saves the same frames into a prefetching swapper and into a plain
+ * frame store, so that the frames loaded from the swapper can be
+ * compared with the ones read directly from disk
+ */
+struct SwapperTester
+{
+    SwapperTester()
+        : pool(poolRegistry.getPool(maxTileSize, maxTileSize)),
+          swapper(builder, swapperDir.path()),
+          referenceStore(referenceDir.path())
+    {
+        const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+        builder.setTextureInfoPool(pool);
+        builder.setConversionOptions(
+            ConversionOptions(cs,
+                              KoColorConversionTransformation::internalRenderingIntent(),
+                              KoColorConversionTransformation::internalConversionFlags()));
+        builder.setTextureBorder(8);
+        builder.setEffectiveTextureSize(QSize(maxTileSize - 16, maxTileSize - 16));
+    }
+
+    KisOpenGLUpdateInfoSP createFrame(int seed) {
+        const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+        KisPaintDeviceSP dev = new KisPaintDevice(cs);
+        dev->fill(imageBounds, KoColor(QColor::fromHsv(seed * 37 % 360, 255, 255), cs));
+        dev->fill(QRect(seed * 20, seed * 10, 100, 100), KoColor(Qt::black, cs));
+
+        return builder.buildUpdateInfo(imageBounds, dev, imageBounds, 0, false);
+    }
+
+    void saveFrame(int frameId, int seed) {
+        swapper.saveFrame(frameId, createFrame(seed), imageBounds);
+        referenceStore.saveFrame(frameId, createFrame(seed), imageBounds);
+    }
+
+    void moveFrame(int srcFrameId, int dstFrameId) {
+        swapper.moveFrame(srcFrameId, dstFrameId);
+        referenceStore.moveFrame(srcFrameId, dstFrameId);
+    }
+
+    bool checkLoadedFrame(int frameId) {
+        return compareFrames(swapper.loadFrame(frameId),
+                             referenceStore.loadFrame(frameId, builder));
+    }
+
+    KisTextureTileInfoPoolRegistry poolRegistry;
+    KisTextureTileInfoPoolSP pool;
+    KisOpenGLUpdateInfoBuilder builder;
+
+    QTemporaryDir swapperDir;
+    QTemporaryDir referenceDir;
+
+    KisFrameCacheSwapper swapper;
+    KisFrameCacheStore referenceStore;
+};
+
+qint64 frameMemorySize(KisOpenGLUpdateInfoSP info)
+{
+    qint64 size = 0;
+    Q_FOREACH (KisTextureTileUpdateInfoSP tile, info->tileList) {
+        size += tile->patchPixelsLength();
+    }
+    return size;
+}
+
+}
+
+void KisFrameCacheSwapperTest::testPrefetchedFramesEqualLoaded()
+{
+    SwapperTester t;
+
+    for (int i = 0; i < 5; i++) {
+        t.saveFrame(i, i);
+    }
+
+    t.swapper.setPrefetchMemoryLimit(1024 * 1024 * 1024);
+    t.swapper.prefetchFrames({1, 2, 3});
+    QCOMPARE(t.swapper.testingPrefetchedFrames(), QList<int>({1, 2, 3}));
+
+    for (int i = 1; i <= 3; i++) {
+        QVERIFY(t.checkLoadedFrame(i));
+    }
+
+    // the loaded frames are handed over to the caller
+    QCOMPARE(t.swapper.testingPrefetchedFrames(), QList<int>());
+
+    // the frames that were not prefetched are read directly
+    QVERIFY(t.checkLoadedFrame(0));
+    QVERIFY(t.checkLoadedFrame(4));
+}
+
+void KisFrameCacheSwapperTest::testPrefetchMemoryLimit()
+{
+    SwapperTester t;
+
+    for (int i = 0; i < 5; i++) {
+        t.saveFrame(i, i);
+    }
+
+    const qint64 frameSize = frameMemorySize(t.referenceStore.loadFrame(0, t.builder));
+    QVERIFY(frameSize > 0);
+
+    // zero limit disables prefetching
+    t.swapper.prefetchFrames({0, 1, 2});
+    QCOMPARE(t.swapper.testingPrefetchedFrames(), QList<int>());
+
+    // the frame that exceeds the limit is the last one loaded
+    t.swapper.setPrefetchMemoryLimit(1);
+    t.swapper.prefetchFrames({0, 1, 2});
+    QCOMPARE(t.swapper.testingPrefetchedFrames(), QList<int>({0}));
+
+    // taking a frame frees the budget for the next one
+    QVERIFY(t.checkLoadedFrame(0));
+    QCOMPARE(t.swapper.testingPrefetchedFrames(), QList<int>({1}));
+
+    t.swapper.setPrefetchMemoryLimit(frameSize + 1);
+    t.swapper.prefetchFrames({1, 2, 3, 4});
+    QCOMPARE(t.swapper.testingPrefetchedFrames(), QList<int>({1, 2}));
+
+    // the frames behind the playhead are dropped
+    t.swapper.prefetchFrames({3, 4});
+    QCOMPARE(t.swapper.testingPrefetchedFrames(), QList<int>({3, 4}));
+
+    QVERIFY(t.checkLoadedFrame(3));
+    QVERIFY(t.checkLoadedFrame(4));
+}
+
+void KisFrameCacheSwapperTest::testStalePrefetchedFrames()
+{
+    SwapperTester t;
+
+    for (int i = 0; i < 5; i++) {
+        t.saveFrame(i, i);
+    }
+
+    t.swapper.setPrefetchMemoryLimit(1024 * 1024 * 1024);
+    t.swapper.prefetchFrames({0, 1, 2, 3});
+    QCOMPARE(t.swapper.testingPrefetchedFrames(), QList<int>({0, 1, 2, 3}));
+
+    // overwritten frame
+    t.saveFrame(1, 10);
+    QCOMPARE(t.swapper.testingPrefetchedFrames(), QList<int>({0, 2, 3}));
+    QVERIFY(t.checkLoadedFrame(1));
+
+    // moved frame
+    t.moveFrame(2, 7);
+    QCOMPARE(t.swapper.testingPrefetchedFrames(), QList<int>({0, 3}));
+    QVERIFY(!t.swapper.hasFrame(2));
+    QVERIFY(t.checkLoadedFrame(7));
+
+    // forgotten frame
+    t.swapper.forgetFrame(3);
+    QCOMPARE(t.swapper.testingPrefetchedFrames(), QList<int>({0}));
+    QVERIFY(!t.swapper.hasFrame(3));
+
+    QVERIFY(t.checkLoadedFrame(0));
+}
+
+QTEST_MAIN(KisFrameCacheSwapperTest)
@@ -18,12 +18,16 @@
 
 #include "KisFrameSerializerTest.h"
 
+#include <cstring>
+
 #include <KisFrameDataSerializer.h>
 #include "opengl/kis_texture_tile_info_pool.h"
 
 #include <testutil.h>
 
 #include <QTest>
+#include <QTemporaryDir>
+#include <QDirIterator>
 
 static const int maxTileSize = 256;
 
@@ -219,4 +223,331 @@ void KisFrameSerializerTest::testFrameArithmetics()
     }
 }
 
+void KisFrameSerializerTest::testUnchangedTilesSerialization()
+{
+    KisTextureTileInfoPoolRegistry poolRegistry;
+    KisTextureTileInfoPoolSP pool = poolRegistry.getPool(maxTileSize, maxTileSize);
+
+    KisFrameDataSerializer serializer;
+
+    KisFrameDataSerializer::Frame baseFrame = generateTestFrame(3, pool);
+    KisFrameDataSerializer::Frame testFrame = generateTestFrame(3, pool);
+
+    // change only a single tile (the first one has an empty rect)
+    const int changedTile = 1;
+    *reinterpret_cast<qint32*>(testFrame.frameTiles[changedTile].data.data()) = 0;
+
+    KisFrameDataSerializer::Frame diffFrame = testFrame.clone();
+
+    const bool framesAreSame = KisFrameDataSerializer::subtractFrames(diffFrame, baseFrame);
+    QVERIFY(!framesAreSame);
+
+    for (int i = 0; i < int(diffFrame.frameTiles.size()); i++) {
+        QCOMPARE(diffFrame.frameTiles[i].isValid(), i == changedTile);
+    }
+
+    const int diffFrameId = serializer.saveFrame(diffFrame);
+    KisFrameDataSerializer::Frame loadedFrame = serializer.loadFrame(diffFrameId, pool);
+
+    QCOMPARE(loadedFrame.frameTiles.size(), diffFrame.frameTiles.size());
+    for (int i = 0; i < int(loadedFrame.frameTiles.size()); i++) {
+        QCOMPARE(loadedFrame.frameTiles[i].isValid(), i == changedTile);
+        QCOMPARE(loadedFrame.frameTiles[i].rect, diffFrame.frameTiles[i].rect);
+    }
+
+    KisFrameDataSerializer::addFrames(loadedFrame, baseFrame);
+
+    boost::optional<qreal> result =
+        KisFrameDataSerializer::estimateFrameUniqueness(loadedFrame, testFrame, 1.0);
+    QVERIFY(!!result);
+    QVERIFY(*result == 0.0);
+
+    serializer.forgetFrame(diffFrameId);
+}
+
+void KisFrameSerializerTest::testSharedFrameData()
+{
+    KisTextureTileInfoPoolRegistry poolRegistry;
+    KisTextureTileInfoPoolSP pool = poolRegistry.getPool(maxTileSize, maxTileSize);
+
+    KisFrameDataSerializer::Frame baseFrame = generateTestFrame(3, pool);
+    KisFrameDataSerializer::Frame testFrame = generateTestFrame(3, pool);
+    const int numTiles = int(testFrame.frameTiles.size());
+
+    int numAllocations = pool->numTotalAllocations();
+    int numCopies = pool->numTotalCopies();
+
+    // cloning a frame should neither allocate nor copy anything
+    KisFrameDataSerializer::Frame clonedFrame = testFrame.clone();
+    QCOMPARE(pool->numTotalAllocations(), numAllocations);
+    QCOMPARE(pool->numTotalCopies(), numCopies);
+
+    for (int i = 0; i < numTiles; i++) {
+        QCOMPARE(clonedFrame.frameTiles[i].data.data(), testFrame.frameTiles[i].data.data());
+        QVERIFY(clonedFrame.frameTiles[i].data.isShared());
+    }
+
+    // writing into the clone should detach it from the original
+    KisFrameDataSerializer::subtractFrames(clonedFrame, baseFrame);
+    QCOMPARE(pool->numTotalAllocations(), numAllocations + numTiles);
+    QCOMPARE(pool->numTotalCopies(), numCopies + numTiles);
+    QVERIFY(verifyTestFrame(3, testFrame));
+
+    for (int i = 0; i < numTiles; i++) {
+        QVERIFY(!testFrame.frameTiles[i].data.isShared());
+        QVERIFY(!clonedFrame.frameTiles[i].isValid());
+    }
+
+    numAllocations = pool->numTotalAllocations();
+    numCopies = pool->numTotalCopies();
+
+    // unchanged tiles of a diff frame should reuse the data of the base frame
+    KisFrameDataSerializer::addFrames(clonedFrame, baseFrame);
+    QCOMPARE(pool->numTotalAllocations(), numAllocations);
+    QCOMPARE(pool->numTotalCopies(), numCopies);
+    QVERIFY(verifyTestFrame(3, clonedFrame));
+
+    for (int i = 0; i < numTiles; i++) {
+        QCOMPARE(clonedFrame.frameTiles[i].data.data(), baseFrame.frameTiles[i].data.data());
+    }
+}
+
+void KisFrameSerializerTest::testEmptyRectTileSerialization()
+{
+    KisTextureTileInfoPoolRegistry poolRegistry;
+    KisTextureTileInfoPoolSP pool = poolRegistry.getPool(maxTileSize, maxTileSize);
+
+    KisFrameDataSerializer serializer;
+
+    KisFrameDataSerializer::Frame testFrame = generateTestFrame(3, pool);
+
+    // the first tile is valid, but has an empty rect
+    QVERIFY(testFrame.frameTiles[0].isValid());
+    QVERIFY(testFrame.frameTiles[0].rect.isEmpty());
+
+    // the second tile is unchanged against the base frame
+    {
+        DataBuffer emptyBuffer(pool);
+        testFrame.frameTiles[1].data.swap(emptyBuffer);
+    }
+    QVERIFY(!testFrame.frameTiles[1].isValid());
+
+    const int frameId = serializer.saveFrame(testFrame);
+    KisFrameDataSerializer::Frame loadedFrame = serializer.loadFrame(frameId, pool);
+
+    QCOMPARE(loadedFrame.frameTiles.size(), testFrame.frameTiles.size());
+
+    for (int i = 0; i < int(loadedFrame.frameTiles.size()); i++) {
+        const KisFrameDataSerializer::FrameTile &loadedTile = loadedFrame.frameTiles[i];
+        const KisFrameDataSerializer::FrameTile &testTile = testFrame.frameTiles[i];
+
+        QCOMPARE(loadedTile.isValid(), testTile.isValid());
+        QCOMPARE(loadedTile.rect, testTile.rect);
+
+        if (testTile.isValid()) {
+            const int numBytes = testTile.rect.width() * testTile.rect.height() * testFrame.pixelSize;
+            QVERIFY(std::memcmp(loadedTile.data.data(), testTile.data.data(), numBytes) == 0);
+        }
+    }
+
+    serializer.forgetFrame(frameId);
+}
+
+namespace {
+
+qint64 directorySize(const QString &path)
+{
+    qint64 size = 0;
+
+    QDirIterator it(path, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        size += it.fileInfo().size();
+    }
+
+    return size;
+}
+
+void fillNoisyTile(KisFrameDataSerializer::FrameTile &tile, int pixelSize)
+{
+    const int numPixels = tile.rect.width() * tile.rect.height();
+    quint8 *dataPtr = tile.data.data();
+
+    quint32 seed = 17 * tile.col + 31 * tile.row;
+
+    for (int j = 0; j < numPixels; j++) {
+        const int x = j % tile.rect.width();
+        const int y = j / tile.rect.width();
+
+        // a smooth gradient with a bit of noise, so that the data doesn't
+        // compress too well, like real painted frames
+        seed = seed * 1103515245 + 12345;
+        const quint8 noise = (seed >> 16) & 0x7;
+
+        for (int ch = 0; ch < pixelSize - 1; ch++) {
+            dataPtr[ch] = quint8(x + y * (ch + 1) + noise);
+        }
+        dataPtr[pixelSize - 1] = 255;
+
+        dataPtr += pixelSize;
+    }
+}
+
+KisFrameDataSerializer::Frame generateAnimationFrame(int frame, KisTextureTileInfoPoolSP pool)
+{
+    const int numTileColumns = 6;
+    const int numTileRows = 4;
+    const int stampSize = 32;
+
+    KisFrameDataSerializer::Frame result;
+    result.pixelSize = 4;
+
+    // a small square stamp moves over the static background
+    const QRect stampRect(10 + 41 * frame, 20 + 23 * frame, stampSize, stampSize);
+
+    for (int row = 0; row < numTileRows; row++) {
+        for (int col = 0; col < numTileColumns; col++) {
+            KisFrameDataSerializer::FrameTile tile(pool);
+            tile.col = col;
+            tile.row = row;
+            tile.rect = QRect(col * maxTileSize, row * maxTileSize, maxTileSize, maxTileSize);
+            tile.data.allocate(result.pixelSize);
+
+            fillNoisyTile(tile, result.pixelSize);
+
+            const QRect changedRect = tile.rect & stampRect;
+            if (!changedRect.isEmpty()) {
+                for (int y = changedRect.top(); y <= changedRect.bottom(); y++) {
+                    const int offset =
+                        ((y - tile.rect.y()) * tile.rect.width() +
+                         changedRect.x() - tile.rect.x()) * result.pixelSize;
+
+                    std::memset(tile.data.data() + offset, 0x80, changedRect.width() * result.pixelSize);
+                }
+            }
+
+            result.frameTiles.push_back(std::move(tile));
+        }
+    }
+
+    return result;
+}
+
+enum FrameStorageType {
+    FullFrames,
+    DiffFramesKeptTiles,
+    DiffFramesDroppedTiles
+};
+
+/**
+ * Saves a short animation either as full frames or as difference
+ * frames against its first frame, that keep or drop the unchanged
+ * tiles
+ */
+struct TestAnimationStore
+{
+    TestAnimationStore(FrameStorageType _type, int numFrames, KisTextureTileInfoPoolSP _pool)
+        : type(_type),
+          pool(_pool),
+          serializer(framesDir.path()),
+          baseFrame(generateAnimationFrame(0, _pool))
+    {
+        for (int i = 1; i <= numFrames; i++) {
+            KisFrameDataSerializer::Frame frame = generateAnimationFrame(i, pool);
+
+            if (type != FullFrames) {
+                KisFrameDataSerializer::subtractFrames(frame, baseFrame);
+            }
+
+            if (type == DiffFramesKeptTiles) {
+                // emulate the difference frames without dropped tiles
+                for (auto it = frame.frameTiles.begin(); it != frame.frameTiles.end(); ++it) {
+                    if (!it->isValid()) {
+                        it->data.allocate(frame.pixelSize);
+                        std::memset(it->data.data(), 0, it->data.size());
+                    }
+                }
+            }
+
+            frameIds << serializer.saveFrame(frame);
+        }
+    }
+
+    KisFrameDataSerializer::Frame loadFrame(int index) {
+        KisFrameDataSerializer::Frame frame = serializer.loadFrame(frameIds[index], pool);
+
+        if (type != FullFrames) {
+            KisFrameDataSerializer::addFrames(frame, baseFrame);
+        }
+
+        return frame;
+    }
+
+    qint64 diskSize() const {
+        return directorySize(framesDir.path());
+    }
+
+    FrameStorageType type;
+    KisTextureTileInfoPoolSP pool;
+    QTemporaryDir framesDir;
+    KisFrameDataSerializer serializer;
+    KisFrameDataSerializer::Frame baseFrame;
+    QVector<int> frameIds;
+};
+
+}
+
+void KisFrameSerializerTest::testDifferenceFramesSize()
+{
+    KisTextureTileInfoPoolRegistry poolRegistry;
+    KisTextureTileInfoPoolSP pool = poolRegistry.getPool(maxTileSize, maxTileSize);
+
+    const int numFrames = 12;
+
+    TestAnimationStore fullFrames(FullFrames, numFrames, pool);
+    TestAnimationStore keptTiles(DiffFramesKeptTiles, numFrames, pool);
+    TestAnimationStore droppedTiles(DiffFramesDroppedTiles, numFrames, pool);
+
+    for (int i = 0; i < numFrames; i++) {
+        KisFrameDataSerializer::Frame refFrame = generateAnimationFrame(i + 1, pool);
+
+        Q_FOREACH (TestAnimationStore *store, QList<TestAnimationStore*>({&fullFrames, &keptTiles, &droppedTiles})) {
+            boost::optional<qreal> result =
+                KisFrameDataSerializer::estimateFrameUniqueness(store->loadFrame(i), refFrame, 1.0);
+            QVERIFY(!!result);
+            QVERIFY(*result == 0.0);
+        }
+    }
+
+    QVERIFY(droppedTiles.diskSize() < keptTiles.diskSize());
+    QVERIFY(keptTiles.diskSize() < fullFrames.diskSize());
+}
+
+void KisFrameSerializerTest::benchmarkLoadFrames_data()
+{
+    QTest::addColumn<int>("type");
+
+    QTest::newRow("full") << int(FullFrames);
+    QTest::newRow("diff-kept-tiles") << int(DiffFramesKeptTiles);
+    QTest::newRow("diff-dropped-tiles") << int(DiffFramesDroppedTiles);
+}
+
+void KisFrameSerializerTest::benchmarkLoadFrames()
+{
+    QFETCH(int, type);
+
+    KisTextureTileInfoPoolRegistry poolRegistry;
+    KisTextureTileInfoPoolSP pool = poolRegistry.getPool(maxTileSize, maxTileSize);
+
+    const int numFrames = 12;
+    TestAnimationStore store(FrameStorageType(type), numFrames, pool);
+
+    QBENCHMARK {
+        for (int i = 0; i < numFrames; i++) {
+            KisFrameDataSerializer::Frame frame = store.loadFrame(i);
+            QVERIFY(frame.isValid());
+        }
+    }
+}
+
 QTEST_MAIN(KisFrameSerializerTest)
@@ -29,6 +29,13 @@ private Q_SLOTS:
     void testFrameDataSerialization();
     void testFrameUniquenessEstimation();
     void testFrameArithmetics();
+    void testUnchangedTilesSerialization();
+    void testSharedFrameData();
+    void testEmptyRectTileSerialization();
+    void testDifferenceFramesSize();
+
+    void benchmarkLoadFrames_data();
+    void benchmarkLoadFrames();
 
 };
 
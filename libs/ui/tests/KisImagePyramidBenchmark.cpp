@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisImagePyramidBenchmark.h"
+
+#include <QTest>
+
+#include <KoColor.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_image.h"
+#include "kis_paint_layer.h"
+#include "kis_random_source.h"
+#include "canvas/kis_image_pyramid.h"
+#include "canvas/kis_update_info.h"
+
+static const int imageSize = 4000;
+static const int pyramidHeight = 5;
+
+KisImageSP createTestImage()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageSize, imageSize, cs, "pyramid benchmark");
+
+    KisPaintLayerSP layer = new KisPaintLayer(image, "layer", OPACITY_OPAQUE_U8);
+    image->addNode(layer);
+
+    // fill the layer with blocks of random colors, so that the
+    // downsampling has some real data to average
+    KisRandomSource rnd(1);
+    const int blockSize = 64;
+
+    for (int y = 0; y < imageSize; y += blockSize) {
+        for (int x = 0; x < imageSize; x += blockSize) {
+            const QColor color(rnd.generate(0, 255), rnd.generate(0, 255),
+                               rnd.generate(0, 255), rnd.generate(0, 255));
+            layer->paintDevice()->fill(QRect(x, y, blockSize, blockSize), KoColor(color, cs));
+        }
+    }
+
+    image->initialRefreshGraph();
+    return image;
+}
+
+void KisImagePyramidBenchmark::benchmarkSetImage()
+{
+    KisImageSP image = createTestImage();
+
+    KisImagePyramid pyramid(pyramidHeight);
+    pyramid.setMonitorProfile(0,
+                              KoColorConversionTransformation::internalRenderingIntent(),
+                              KoColorConversionTransformation::internalConversionFlags());
+
+    QBENCHMARK {
+        pyramid.setImage(image);
+    }
+}
+
+void KisImagePyramidBenchmark::benchmarkRecalculateCache()
+{
+    KisImageSP image = createTestImage();
+
+    KisImagePyramid pyramid(pyramidHeight);
+    pyramid.setMonitorProfile(0,
+                              KoColorConversionTransformation::internalRenderingIntent(),
+                              KoColorConversionTransformation::internalConversionFlags());
+    pyramid.setImage(image);
+
+    KisPPUpdateInfoSP info = new KisPPUpdateInfo();
+    info->dirtyImageRectVar = image->bounds();
+
+    QBENCHMARK {
+        pyramid.recalculateCache(info);
+    }
+}
+
+QTEST_MAIN(KisImagePyramidBenchmark)
@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisImagePyramidTest.h"
+
+#include <QTest>
+
+#include "canvas/kis_image_pyramid.h"
+
+static const int pixelSize = 4;
+static const int guardSize = 16;
+static const quint8 guardValue = 0xcd;
+
+void KisImagePyramidTest::testDownsamplePixels_data()
+{
+    QTest::addColumn<int>("numSrcPixels");
+    QTest::addColumn<bool>("saturated");
+
+    QList<int> sizes;
+    sizes << 2 << 4 << 6 << 8 << 10 << 14 << 16 << 18 << 22 << 30 << 32 << 34 << 126 << 254;
+
+    Q_FOREACH (int size, sizes) {
+        QTest::newRow(QString("%1-random").arg(size).toLatin1()) << size << false;
+        QTest::newRow(QString("%1-saturated").arg(size).toLatin1()) << size << true;
+    }
+}
+
+void KisImagePyramidTest::testDownsamplePixels()
+{
+    QFETCH(int, numSrcPixels);
+    QFETCH(bool, saturated);
+
+    const int srcBytes = numSrcPixels * pixelSize;
+    const int dstBytes = numSrcPixels / 2 * pixelSize;
+
+    QVector<quint8> srcRow0(srcBytes);
+    QVector<quint8> srcRow1(srcBytes);
+
+    qsrand(numSrcPixels);
+    for (int i = 0; i < srcBytes; i++) {
+        srcRow0[i] = saturated ? 255 - (qrand() & 0x3) : qrand() & 0xff;
+        srcRow1[i] = saturated ? 255 - (qrand() & 0x3) : qrand() & 0xff;
+    }
+
+    // the guard bytes catch writes past the end of the destination row
+    QVector<quint8> optimized(dstBytes + guardSize, guardValue);
+    QVector<quint8> reference(dstBytes + guardSize, guardValue);
+
+    KisImagePyramid::downsamplePixels(srcRow0.constData(), srcRow1.constData(),
+                                      optimized.data(), numSrcPixels);
+    KisImagePyramid::downsamplePixelsScalar(srcRow0.constData(), srcRow1.constData(),
+                                            reference.data(), numSrcPixels);
+
+    for (int i = 0; i < dstBytes; i++) {
+        if (optimized[i] != reference[i]) {
+            QFAIL(QString("Pixel %1, channel %2 differs: optimized %3, reference %4")
+                  .arg(i / pixelSize).arg(i % pixelSize)
+                  .arg(int(optimized[i])).arg(int(reference[i])).toLatin1());
+        }
+    }
+
+    for (int i = dstBytes; i < dstBytes + guardSize; i++) {
+        QCOMPARE(optimized[i], guardValue);
+    }
+}
+
+QTEST_MAIN(KisImagePyramidTest)
@@ -0,0 +1,49 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisStrokeEfficiencyMeasurerTest.h"
+
+#include <QElapsedTimer>
+#include "strokes/KisStrokeEfficiencyMeasurer.h"
+
+void KisStrokeEfficiencyMeasurerTest::testLatency()
+{
+    QElapsedTimer strokeTime;
+    strokeTime.start();
+
+    /**
+     * The stroke strategy (and its measurer) is created a bit later
+     * than the helper starts timing the events
+     */
+    QTest::qSleep(50);
+
+    KisStrokeEfficiencyMeasurer measurer;
+    measurer.setTimeSource(strokeTime);
+
+    const qint64 eventTime = strokeTime.elapsed();
+
+    QTest::qSleep(100);
+
+    measurer.addLatencySample(eventTime);
+
+    // the sleeps may take a bit longer than requested, but never shorter
+    QVERIFY(measurer.averageLatency() >= 100);
+    QVERIFY(measurer.averageLatency() < 1000);
+}
+
+QTEST_MAIN(KisStrokeEfficiencyMeasurerTest)
@@ -0,0 +1,208 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisTextureTileFastConversionTest.h"
+
+#include <QTest>
+#include <QColor>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+#include <KoColorConversionTransformation.h>
+#include <KoChannelInfo.h>
+
+#include "kis_debug.h"
+#include "kis_random_source.h"
+#include "opengl/KisTextureTileFastConversion.h"
+
+namespace {
+
+const KoColorSpace* rgbColorSpace(const KoID &depth, const KoColorProfile *profile = 0)
+{
+    return profile ?
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), depth.id(), profile) :
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), depth.id());
+}
+
+void fillRandomPixels(const KoColorSpace *cs, quint8 *data, int numPixels)
+{
+    KisRandomSource rnd(1);
+    QVector<float> channels(cs->channelCount());
+
+    for (int i = 0; i < numPixels; i++) {
+        for (int ch = 0; ch < channels.size(); ch++) {
+            channels[ch] = rnd.generateNormalized();
+        }
+        cs->fromNormalisedChannelsValue(data + i * cs->pixelSize(), channels);
+    }
+}
+
+bool channelsAreClose(const KoColorSpace *cs, const quint8 *lhs, const quint8 *rhs, int numPixels)
+{
+    const KoChannelInfo::enumChannelValueType valueType = cs->channels().first()->channelValueType();
+
+    // allow rounding differences of one unit of the destination depth
+    const qreal tolerance =
+        valueType == KoChannelInfo::UINT8 ? 1.0 / 255.0 + 1e-6 :
+        valueType == KoChannelInfo::UINT16 ? 1.0 / 65535.0 + 1e-6 :
+        1e-4;
+
+    QVector<float> lhsChannels(cs->channelCount());
+    QVector<float> rhsChannels(cs->channelCount());
+
+    for (int i = 0; i < numPixels; i++) {
+        cs->normalisedChannelsValue(lhs + i * cs->pixelSize(), lhsChannels);
+        cs->normalisedChannelsValue(rhs + i * cs->pixelSize(), rhsChannels);
+
+        for (int ch = 0; ch < lhsChannels.size(); ch++) {
+            if (qAbs(lhsChannels[ch] - rhsChannels[ch]) > tolerance) {
+                qWarning() << "Channels differ:" << ppVar(i) << ppVar(ch)
+                           << ppVar(lhsChannels[ch]) << ppVar(rhsChannels[ch]);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+}
+
+void KisTextureTileFastConversionTest::testConversion_data()
+{
+    QTest::addColumn<QString>("srcDepth");
+    QTest::addColumn<QString>("dstDepth");
+
+    QTest::newRow("u16-u8") << Integer16BitsColorDepthID.id() << Integer8BitsColorDepthID.id();
+    QTest::newRow("u8-u16") << Integer8BitsColorDepthID.id() << Integer16BitsColorDepthID.id();
+    QTest::newRow("f16-f32") << Float16BitsColorDepthID.id() << Float32BitsColorDepthID.id();
+}
+
+void KisTextureTileFastConversionTest::testConversion()
+{
+    QFETCH(QString, srcDepth);
+    QFETCH(QString, dstDepth);
+
+    const KoColorSpace *srcCS = rgbColorSpace(KoID(srcDepth));
+    if (!srcCS) {
+        QSKIP("The source color space is not available");
+    }
+
+    const KoColorSpace *dstCS = rgbColorSpace(KoID(dstDepth), srcCS->profile());
+    QVERIFY(dstCS);
+
+    const int numPixels = 256 * 256 + 7;
+
+    QVector<quint8> src(numPixels * srcCS->pixelSize());
+    QVector<quint8> fastDst(numPixels * dstCS->pixelSize());
+    QVector<quint8> refDst(numPixels * dstCS->pixelSize());
+
+    fillRandomPixels(srcCS, src.data(), numPixels);
+
+    QVERIFY(KisTextureTileFastConversion::tryConvert(src.data(), srcCS,
+                                                     fastDst.data(), dstCS,
+                                                     numPixels));
+
+    srcCS->convertPixelsTo(src.data(), refDst.data(), dstCS, numPixels,
+                           KoColorConversionTransformation::internalRenderingIntent(),
+                           KoColorConversionTransformation::internalConversionFlags());
+
+    QVERIFY(channelsAreClose(dstCS, fastDst.data(), refDst.data(), numPixels));
+}
+
+void KisTextureTileFastConversionTest::testChannelOrder_data()
+{
+    testConversion_data();
+}
+
+void KisTextureTileFastConversionTest::testChannelOrder()
+{
+    QFETCH(QString, srcDepth);
+    QFETCH(QString, dstDepth);
+
+    const KoColorSpace *srcCS = rgbColorSpace(KoID(srcDepth));
+    if (!srcCS) {
+        QSKIP("The source color space is not available");
+    }
+
+    const KoColorSpace *dstCS = rgbColorSpace(KoID(dstDepth), srcCS->profile());
+    QVERIFY(dstCS);
+
+    /**
+     * Integer RGBA color spaces keep the channels in BGRA order, the floating
+     * point ones in RGBA. Make sure the fast path never swaps red and blue.
+     */
+    const QVector<QColor> colors = {
+        QColor(255, 0, 0, 255),
+        QColor(0, 255, 0, 128),
+        QColor(0, 0, 255, 64),
+        QColor(10, 100, 200, 250)
+    };
+
+    QVector<quint8> src(colors.size() * srcCS->pixelSize());
+    QVector<quint8> dst(colors.size() * dstCS->pixelSize());
+
+    for (int i = 0; i < colors.size(); i++) {
+        srcCS->fromQColor(colors[i], src.data() + i * srcCS->pixelSize());
+    }
+
+    QVERIFY(KisTextureTileFastConversion::tryConvert(src.data(), srcCS,
+                                                     dst.data(), dstCS,
+                                                     colors.size()));
+
+    for (int i = 0; i < colors.size(); i++) {
+        QColor result;
+        dstCS->toQColor(dst.data() + i * dstCS->pixelSize(), &result);
+
+        QVERIFY(qAbs(result.red() - colors[i].red()) <= 1);
+        QVERIFY(qAbs(result.green() - colors[i].green()) <= 1);
+        QVERIFY(qAbs(result.blue() - colors[i].blue()) <= 1);
+        QVERIFY(qAbs(result.alpha() - colors[i].alpha()) <= 1);
+    }
+}
+
+void KisTextureTileFastConversionTest::testNoFastPath()
+{
+    const KoColorSpace *rgb8 = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColorSpace *lab16 = KoColorSpaceRegistry::instance()->lab16();
+    const KoColorSpace *rgb16Linear =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(),
+                                                     Integer16BitsColorDepthID.id(),
+                                                     "sRGB-elle-V2-g10.icc");
+
+    quint8 src[4] = {1, 2, 3, 4};
+    quint8 dst[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+    // different color model
+    QVERIFY(!KisTextureTileFastConversion::tryConvert(src, rgb8, dst, lab16, 1));
+
+    // different profile
+    if (rgb16Linear && !(*rgb16Linear->profile() == *rgb8->profile())) {
+        QVERIFY(!KisTextureTileFastConversion::tryConvert(src, rgb8, dst, rgb16Linear, 1));
+    }
+
+    // the same color space is not a job for the fast path either
+    QVERIFY(!KisTextureTileFastConversion::tryConvert(src, rgb8, dst, rgb8, 1));
+
+    for (int i = 0; i < 8; i++) {
+        QCOMPARE(dst[i], quint8(0));
+    }
+}
+
+QTEST_MAIN(KisTextureTileFastConversionTest)
@@ -0,0 +1,152 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisStrokePredictor.h"
+
+#include <cmath>
+
+#include <QList>
+#include <QPointF>
+#include <QTransform>
+
+#include <brushengine/kis_paint_information.h>
+#include "kis_speed_smoother.h"
+#include "kis_algebra_2d.h"
+#include "kis_global.h"
+#include "kis_assert.h"
+
+namespace {
+// we never predict further than that, the error grows too fast
+const qreal MAX_PREDICTION_TIME = 50.0; // ms
+// the samples with the smaller distance are considered as noise
+const qreal MIN_SAMPLE_DISTANCE = 0.5; // px
+const int HISTORY_SIZE = 4;
+}
+
+struct KisStrokePredictor::Private
+{
+    QList<KisPaintInformation> history;
+    QScopedPointer<KisSpeedSmoother> speedSmoother;
+
+    qreal speed = 0.0; // px/ms
+    qreal avgEventInterval = 0.0; // ms
+};
+
+
+KisStrokePredictor::KisStrokePredictor()
+    : m_d(new Private)
+{
+    reset();
+}
+
+KisStrokePredictor::~KisStrokePredictor()
+{
+}
+
+void KisStrokePredictor::reset()
+{
+    m_d->history.clear();
+    m_d->speedSmoother.reset(new KisSpeedSmoother());
+    m_d->speed = 0.0;
+    m_d->avgEventInterval = 0.0;
+}
+
+void KisStrokePredictor::addSample(const KisPaintInformation &pi)
+{
+    if (!m_d->history.isEmpty()) {
+        const KisPaintInformation &last = m_d->history.last();
+
+        if (kisDistance(last.pos(), pi.pos()) < MIN_SAMPLE_DISTANCE) return;
+
+        const qreal interval = pi.currentTime() - last.currentTime();
+        if (interval > 0) {
+            const qreal alpha = 0.2;
+            m_d->avgEventInterval =
+                m_d->avgEventInterval > 0 ?
+                alpha * interval + (1.0 - alpha) * m_d->avgEventInterval :
+                interval;
+        }
+    }
+
+    m_d->speed = m_d->speedSmoother->getNextSpeed(pi.pos());
+    m_d->history.append(pi);
+
+    while (m_d->history.size() > HISTORY_SIZE) {
+        m_d->history.removeFirst();
+    }
+}
+
+bool KisStrokePredictor::canPredict() const
+{
+    return m_d->history.size() >= 3 && m_d->speed > 0.0;
+}
+
+qreal KisStrokePredictor::averageEventInterval() const
+{
+    return m_d->avgEventInterval;
+}
+
+KisPaintInformation KisStrokePredictor::predict(qreal timeAhead) const
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(!m_d->history.isEmpty(), KisPaintInformation());
+
+    const KisPaintInformation &p2 = m_d->history[m_d->history.size() - 1];
+
+    if (!canPredict()) return p2;
+
+    const KisPaintInformation &p1 = m_d->history[m_d->history.size() - 2];
+    const KisPaintInformation &p0 = m_d->history[m_d->history.size() - 3];
+
+    timeAhead = qBound(0.0, timeAhead, MAX_PREDICTION_TIME);
+
+    const QPointF d1 = p2.pos() - p1.pos();
+    const QPointF d0 = p1.pos() - p0.pos();
+
+    const qreal dt1 = qMax(qreal(1.0), p2.currentTime() - p1.currentTime());
+    const qreal dt0 = qMax(qreal(1.0), p1.currentTime() - p0.currentTime());
+
+    /**
+     * The direction is rotated with the angular velocity measured on
+     * the last two segments, the distance is taken from the smoothed
+     * speed. The rotation is limited to 90 degrees to avoid loops on
+     * sharp corners.
+     */
+    const qreal turn = shortestAngularDistance(std::atan2(d0.y(), d0.x()),
+                                               std::atan2(d1.y(), d1.x()));
+    const qreal signedTurn =
+        KisAlgebra2D::crossProduct(d0, d1) >= 0 ? turn : -turn;
+
+    const qreal angularVelocity = signedTurn / (0.5 * (dt0 + dt1));
+    const qreal rotation = qBound(-M_PI_2, angularVelocity * timeAhead, M_PI_2);
+
+    const QPointF direction = KisAlgebra2D::normalize(d1);
+    const QPointF offset =
+        QTransform().rotateRadians(0.5 * rotation).map(direction) * m_d->speed * timeAhead;
+
+    const qreal pressureSlope = (p2.pressure() - p1.pressure()) / dt1;
+
+    return KisPaintInformation(p2.pos() + offset,
+                               qBound(0.0, p2.pressure() + pressureSlope * timeAhead, 1.0),
+                               p2.xTilt(),
+                               p2.yTilt(),
+                               p2.rotation(),
+                               p2.tangentialPressure(),
+                               p2.perspective(),
+                               p2.currentTime() + timeAhead,
+                               p2.drawingSpeed());
+}
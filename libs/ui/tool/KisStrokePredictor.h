@@ -0,0 +1,79 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISSTROKEPREDICTOR_H
+#define KISSTROKEPREDICTOR_H
+
+#include "kritaui_export.h"
+#include <QScopedPointer>
+
+class KisPaintInformation;
+
+/**
+ * KisStrokePredictor extrapolates the position of the cursor a few
+ * milliseconds ahead of the last input event. The extrapolation uses
+ * the smoothed cursor speed (see KisSpeedSmoother), the current
+ * direction of the stroke and its angular velocity, so curved strokes
+ * are continued along the arc instead of a straight line.
+ *
+ * The prediction is used by KisToolFreehandHelper to paint the segment
+ * ending at the latest event right away, instead of waiting for the next
+ * event to calculate the tangent of the Bezier curve.
+ */
+class KRITAUI_EXPORT KisStrokePredictor
+{
+public:
+    KisStrokePredictor();
+    ~KisStrokePredictor();
+
+    /**
+     * Forget all the collected samples. Should be called on
+     * the start of every stroke.
+     */
+    void reset();
+
+    /**
+     * Add a real input sample to the history of the predictor
+     */
+    void addSample(const KisPaintInformation &pi);
+
+    /**
+     * @return true if the predictor has collected enough samples
+     * to generate a prediction
+     */
+    bool canPredict() const;
+
+    /**
+     * @return the average interval between two input events in
+     * milliseconds
+     */
+    qreal averageEventInterval() const;
+
+    /**
+     * Extrapolate the paint information \p timeAhead milliseconds after
+     * the last sample. Position, pressure and time are extrapolated,
+     * all the other properties are copied from the last sample.
+     */
+    KisPaintInformation predict(qreal timeAhead) const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISSTROKEPREDICTOR_H
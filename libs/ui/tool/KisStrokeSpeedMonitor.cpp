@@ -21,6 +21,7 @@
 #include <QGlobalStatic>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QAtomicInt>
 
 #include <KisRollingMeanAccumulatorWrapper.h>
 #include "kis_paintop_preset.h"
@@ -29,6 +30,7 @@
 #include "kis_config.h"
 #include "kis_config_notifier.h"
 #include "KisImageConfigNotifier.h"
+#include "kis_assert.h"
 
 
 Q_GLOBAL_STATIC(KisStrokeSpeedMonitor, s_instance)
@@ -41,23 +43,31 @@ struct KisStrokeSpeedMonitor::Private
     Private()
         : avgCursorSpeed(averageWindow),
           avgRenderingSpeed(averageWindow),
-          avgFps(averageWindow)
+          avgFps(averageWindow),
+          avgLatency(averageWindow)
     {
     }
 
     KisRollingMeanAccumulatorWrapper avgCursorSpeed;
     KisRollingMeanAccumulatorWrapper avgRenderingSpeed;
     KisRollingMeanAccumulatorWrapper avgFps;
+    KisRollingMeanAccumulatorWrapper avgLatency;
 
     qreal cachedAvgCursorSpeed = 0;
     qreal cachedAvgRenderingSpeed = 0;
     qreal cachedAvgFps = 0;
+    qreal cachedAvgLatency = 0;
 
     qreal lastCursorSpeed = 0;
     qreal lastRenderingSpeed = 0;
     qreal lastFps = 0;
+    qreal lastLatency = 0;
     bool lastStrokeSaturated = false;
 
+    QAtomicInt presetCacheHits[NumPresetCacheTypes];
+    QAtomicInt presetCacheMisses[NumPresetCacheTypes];
+    qreal presetCacheHitRate[NumPresetCacheTypes] = {0, 0};
+
     QByteArray lastPresetMd5;
     QString lastPresetName;
     qreal lastPresetSize = 0;
@@ -101,6 +111,7 @@ void KisStrokeSpeedMonitor::resetAccumulatedValues()
     m_d->avgCursorSpeed.reset(m_d->averageWindow);
     m_d->avgRenderingSpeed.reset(m_d->averageWindow);
     m_d->avgFps.reset(m_d->averageWindow);
+    m_d->avgLatency.reset(m_d->averageWindow);
 }
 
 void KisStrokeSpeedMonitor::slotConfigChanged()
@@ -111,7 +122,7 @@ void KisStrokeSpeedMonitor::slotConfigChanged()
     emit sigStatsUpdated();
 }
 
-void KisStrokeSpeedMonitor::notifyStrokeFinished(qreal cursorSpeed, qreal renderingSpeed, qreal fps, KisPaintOpPresetSP preset)
+void KisStrokeSpeedMonitor::notifyStrokeFinished(qreal cursorSpeed, qreal renderingSpeed, qreal fps, qreal latency, KisPaintOpPresetSP preset)
 {
     if (qFuzzyCompare(cursorSpeed, 0.0) || qFuzzyCompare(renderingSpeed, 0.0)) return;
 
@@ -132,7 +143,16 @@ void KisStrokeSpeedMonitor::notifyStrokeFinished(qreal cursorSpeed, qreal render
     m_d->lastCursorSpeed = cursorSpeed;
     m_d->lastRenderingSpeed = renderingSpeed;
     m_d->lastFps = fps;
+    m_d->lastLatency = latency;
+
+    for (int i = 0; i < NumPresetCacheTypes; i++) {
+        const int hits = m_d->presetCacheHits[i].fetchAndStoreOrdered(0);
+        const int misses = m_d->presetCacheMisses[i].fetchAndStoreOrdered(0);
 
+        if (hits + misses > 0) {
+            m_d->presetCacheHitRate[i] = qreal(hits) / (hits + misses);
+        }
+    }
 
     static const qreal saturationSpeedThreshold = 0.30; // cursor speed should be at least 30% higher
     m_d->lastStrokeSaturated = cursorSpeed / renderingSpeed > (1.0 + saturationSpeedThreshold);
@@ -142,26 +162,43 @@ void KisStrokeSpeedMonitor::notifyStrokeFinished(qreal cursorSpeed, qreal render
         m_d->avgCursorSpeed(cursorSpeed);
         m_d->avgRenderingSpeed(renderingSpeed);
         m_d->avgFps(fps);
+        m_d->avgLatency(latency);
 
         m_d->cachedAvgCursorSpeed = m_d->avgCursorSpeed.rollingMean();
         m_d->cachedAvgRenderingSpeed = m_d->avgRenderingSpeed.rollingMean();
         m_d->cachedAvgFps = m_d->avgFps.rollingMean();
+        m_d->cachedAvgLatency = m_d->avgLatency.rollingMean();
     }
 
     emit sigStatsUpdated();
 
 
     ENTER_FUNCTION() <<
-        QString(" CS: %1  RS: %2  FPS: %3 %4")
+        QString(" CS: %1  RS: %2  FPS: %3  LAT: %4  BCACHE: %5  TCACHE: %6 %7")
             .arg(m_d->lastCursorSpeed, 5)
             .arg(m_d->lastRenderingSpeed, 5)
             .arg(m_d->lastFps, 5)
+            .arg(m_d->lastLatency, 5)
+            .arg(m_d->presetCacheHitRate[BrushPrototypeCache], 5)
+            .arg(m_d->presetCacheHitRate[TextureMaskCache], 5)
             .arg(m_d->lastStrokeSaturated ? "(saturated)" : "");
     ENTER_FUNCTION() <<
-        QString("ACS: %1 ARS: %2 AFPS: %3")
+        QString("ACS: %1 ARS: %2 AFPS: %3 ALAT: %4")
             .arg(m_d->cachedAvgCursorSpeed, 5)
             .arg(m_d->cachedAvgRenderingSpeed, 5)
-            .arg(m_d->cachedAvgFps, 5);
+            .arg(m_d->cachedAvgFps, 5)
+            .arg(m_d->cachedAvgLatency, 5);
+}
+
+void KisStrokeSpeedMonitor::notifyPresetCacheAccess(PresetCacheType type, bool hit)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(type >= 0 && type < NumPresetCacheTypes);
+
+    if (hit) {
+        m_d->presetCacheHits[type].ref();
+    } else {
+        m_d->presetCacheMisses[type].ref();
+    }
 }
 
 QString KisStrokeSpeedMonitor::lastPresetName() const
@@ -189,6 +226,11 @@ qreal KisStrokeSpeedMonitor::lastFps() const
     return m_d->lastFps;
 }
 
+qreal KisStrokeSpeedMonitor::lastLatency() const
+{
+    return m_d->lastLatency;
+}
+
 bool KisStrokeSpeedMonitor::lastStrokeSaturated() const
 {
     return m_d->lastStrokeSaturated;
@@ -208,3 +250,24 @@ qreal KisStrokeSpeedMonitor::avgFps() const
 {
     return m_d->cachedAvgFps;
 }
+
+qreal KisStrokeSpeedMonitor::avgLatency() const
+{
+    return m_d->cachedAvgLatency;
+}
+
+qreal KisStrokeSpeedMonitor::presetCacheHitRate(PresetCacheType type) const
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(type >= 0 && type < NumPresetCacheTypes, 0.0);
+    return m_d->presetCacheHitRate[type];
+}
+
+qreal KisStrokeSpeedMonitor::brushPrototypeCacheHitRate() const
+{
+    return m_d->presetCacheHitRate[BrushPrototypeCache];
+}
+
+qreal KisStrokeSpeedMonitor::textureMaskCacheHitRate() const
+{
+    return m_d->presetCacheHitRate[TextureMaskCache];
+}
@@ -34,12 +34,28 @@ class KRITAUI_EXPORT KisStrokeSpeedMonitor : public QObject
     Q_PROPERTY(qreal lastCursorSpeed READ lastCursorSpeed NOTIFY sigStatsUpdated)
     Q_PROPERTY(qreal lastRenderingSpeed READ lastRenderingSpeed NOTIFY sigStatsUpdated)
     Q_PROPERTY(qreal lastFps READ lastFps NOTIFY sigStatsUpdated)
+    Q_PROPERTY(qreal lastLatency READ lastLatency NOTIFY sigStatsUpdated)
 
     Q_PROPERTY(bool lastStrokeSaturated READ lastCursorSpeed NOTIFY sigStatsUpdated)
 
     Q_PROPERTY(qreal avgCursorSpeed READ avgCursorSpeed NOTIFY sigStatsUpdated)
     Q_PROPERTY(qreal avgRenderingSpeed READ avgRenderingSpeed NOTIFY sigStatsUpdated)
     Q_PROPERTY(qreal avgFps READ avgFps NOTIFY sigStatsUpdated)
+    Q_PROPERTY(qreal avgLatency READ avgLatency NOTIFY sigStatsUpdated)
+
+    Q_PROPERTY(qreal brushPrototypeCacheHitRate READ brushPrototypeCacheHitRate NOTIFY sigStatsUpdated)
+    Q_PROPERTY(qreal textureMaskCacheHitRate READ textureMaskCacheHitRate NOTIFY sigStatsUpdated)
+
+public:
+    /**
+     * The caches shared between strokes, their hit rates are
+     * reported separately
+     */
+    enum PresetCacheType {
+        BrushPrototypeCache = 0,
+        TextureMaskCache,
+        NumPresetCacheTypes
+    };
 
 public:
     KisStrokeSpeedMonitor();
@@ -49,7 +65,22 @@ public:
 
     bool haveStrokeSpeedMeasurement() const;
 
-    void notifyStrokeFinished(qreal cursorSpeed, qreal renderingSpeed, qreal fps, KisPaintOpPresetSP preset);
+    /**
+     * @param latency is the average time in milliseconds between the moment
+     *        an input event arrived and the moment the corresponding part of
+     *        the stroke has been passed to the paintop
+     */
+    void notifyStrokeFinished(qreal cursorSpeed, qreal renderingSpeed, qreal fps, qreal latency, KisPaintOpPresetSP preset);
+
+    /**
+     * Called by the paintops every time they fetch prepared resources
+     * (brushes, texture masks) from the caches shared between strokes.
+     * The method is thread-safe.
+     *
+     * @param type the cache that has been accessed
+     * @param hit true if the resource has been found in the cache
+     */
+    void notifyPresetCacheAccess(PresetCacheType type, bool hit);
 
 
     QString lastPresetName() const;
@@ -58,11 +89,22 @@ public:
     qreal lastCursorSpeed() const;
     qreal lastRenderingSpeed() const;
     qreal lastFps() const;
+    qreal lastLatency() const;
     bool lastStrokeSaturated() const;
 
     qreal avgCursorSpeed() const;
     qreal avgRenderingSpeed() const;
     qreal avgFps() const;
+    qreal avgLatency() const;
+
+    /**
+     * @return the ratio of cache hits to all the accesses to the cache
+     *         \p type during the last stroke that accessed it
+     */
+    qreal presetCacheHitRate(PresetCacheType type) const;
+
+    qreal brushPrototypeCacheHitRate() const;
+    qreal textureMaskCacheHitRate() const;
 
 
 Q_SIGNALS:
@@ -33,6 +33,7 @@ struct KisSmoothingOptions::Private {
     bool useDelayDistance;
     bool finishStabilizedCurve;
     bool stabilizeSensors;
+    bool useStrokePrediction;
 };
 
 KisSmoothingOptions::KisSmoothingOptions(bool useSavedSmoothing)
@@ -48,6 +49,7 @@ KisSmoothingOptions::KisSmoothingOptions(bool useSavedSmoothing)
     m_d->useDelayDistance = cfg.lineSmoothingUseDelayDistance(!useSavedSmoothing);
     m_d->finishStabilizedCurve = cfg.lineSmoothingFinishStabilizedCurve(!useSavedSmoothing);
     m_d->stabilizeSensors = cfg.lineSmoothingStabilizeSensors(!useSavedSmoothing);
+    m_d->useStrokePrediction = cfg.lineSmoothingUseStrokePrediction(!useSavedSmoothing);
 
     connect(&m_d->writeCompressor, SIGNAL(timeout()), this, SLOT(slotWriteConfig()));
 }
@@ -156,6 +158,17 @@ bool KisSmoothingOptions::stabilizeSensors() const
     return m_d->stabilizeSensors;
 }
 
+void KisSmoothingOptions::setUseStrokePrediction(bool value)
+{
+    m_d->useStrokePrediction = value;
+    m_d->writeCompressor.start();
+}
+
+bool KisSmoothingOptions::useStrokePrediction() const
+{
+    return m_d->useStrokePrediction;
+}
+
 void KisSmoothingOptions::slotWriteConfig()
 {
     KisConfig cfg(false);
@@ -168,4 +181,5 @@ void KisSmoothingOptions::slotWriteConfig()
     cfg.setLineSmoothingUseDelayDistance(m_d->useDelayDistance);
     cfg.setLineSmoothingFinishStabilizedCurve(m_d->finishStabilizedCurve);
     cfg.setLineSmoothingStabilizeSensors(m_d->stabilizeSensors);
+    cfg.setLineSmoothingUseStrokePrediction(m_d->useStrokePrediction);
 }
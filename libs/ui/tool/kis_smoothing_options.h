@@ -68,6 +68,15 @@ public:
     void setStabilizeSensors(bool value);
     bool stabilizeSensors() const;
 
+    /**
+     * When enabled, the end tangent of the latest Bezier segment is
+     * extrapolated by KisStrokePredictor, so the segment can be painted
+     * without waiting for the next input event. Used by simple and
+     * weighted smoothing only.
+     */
+    void setUseStrokePrediction(bool value);
+    bool useStrokePrediction() const;
+
 Q_SIGNALS:
     void sigSmoothingTypeChanged();
 
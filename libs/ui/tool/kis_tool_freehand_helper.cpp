@@ -20,6 +20,7 @@
 
 #include <QTimer>
 #include <QQueue>
+#include <QElapsedTimer>
 
 #include <klocalizedstring.h>
 
@@ -37,6 +38,7 @@
 #include "kis_update_time_monitor.h"
 #include "kis_stabilized_events_sampler.h"
 #include "KisStabilizerDelayedPaintHelper.h"
+#include "KisStrokePredictor.h"
 #include "kis_config.h"
 
 #include "kis_random_source.h"
@@ -72,9 +74,13 @@ struct KisToolFreehandHelper::Private
     bool haveTangent;
     QPointF previousTangent;
 
+    // Stroke prediction data
+    KisStrokePredictor predictor;
+    bool predictedTailPainted = false;
+
     bool hasPaintAtLeastOnce;
 
-    QTime strokeTime;
+    QElapsedTimer strokeTime;
     QTimer strokeTimeoutTimer;
 
     QVector<KisFreehandStrokeInfo*> strokeInfos;
@@ -282,6 +288,9 @@ void KisToolFreehandHelper::initPaintImpl(qreal startAngle,
     m_d->haveTangent = false;
     m_d->previousTangent = QPointF();
 
+    m_d->predictor.reset();
+    m_d->predictedTailPainted = false;
+
     m_d->hasPaintAtLeastOnce = false;
 
     m_d->previousPaintInformation = pi;
@@ -307,9 +316,13 @@ void KisToolFreehandHelper::initPaintImpl(qreal startAngle,
     createPainters(m_d->strokeInfos,
                    startDist);
 
-    KisStrokeStrategy *stroke =
+    FreehandStrokeStrategy *stroke =
         new FreehandStrokeStrategy(m_d->resources, m_d->strokeInfos, m_d->transactionText);
 
+    // the paint information is timed with our clock, so share it with
+    // the stroke to measure the input latency properly
+    stroke->setStrokeTimeSource(m_d->strokeTime);
+
     m_d->strokeId = m_d->strokesFacade->startStroke(stroke);
 
     m_d->history.clear();
@@ -564,8 +577,16 @@ void KisToolFreehandHelper::paint(KisPaintInformation &info)
     if (m_d->smoothingOptions->smoothingType() == KisSmoothingOptions::SIMPLE_SMOOTHING
         || m_d->smoothingOptions->smoothingType() == KisSmoothingOptions::WEIGHTED_SMOOTHING)
     {
-        // Now paint between the coordinates, using the bezier curve interpolation
-        if (!m_d->haveTangent) {
+        const bool usePrediction = m_d->smoothingOptions->useStrokePrediction();
+
+        if (usePrediction) {
+            m_d->predictor.addSample(info);
+        }
+
+        if (usePrediction && m_d->predictor.canPredict()) {
+            paintPredictedSegment(info);
+        } else if (!m_d->haveTangent) {
+            // Now paint between the coordinates, using the bezier curve interpolation
             m_d->haveTangent = true;
             m_d->previousTangent =
                 (info.pos() - m_d->previousPaintInformation.pos()) /
@@ -574,7 +595,10 @@ void KisToolFreehandHelper::paint(KisPaintInformation &info)
             QPointF newTangent = (info.pos() - m_d->olderPaintInformation.pos()) /
                 qMax(qreal(1.0), info.currentTime() - m_d->olderPaintInformation.currentTime());
 
-            if (newTangent.isNull() || m_d->previousTangent.isNull())
+            if (m_d->predictedTailPainted) {
+                // the segment has already been painted by the predictor
+                m_d->predictedTailPainted = false;
+            } else if (newTangent.isNull() || m_d->previousTangent.isNull())
             {
                 paintLine(m_d->previousPaintInformation, info);
             } else {
@@ -854,9 +878,67 @@ void KisToolFreehandHelper::slotSmoothingTypeChanged()
     }
 }
 
+void KisToolFreehandHelper::paintPredictedSegment(const KisPaintInformation &info)
+{
+    /**
+     * Without prediction the Bezier segment ending at the latest event is
+     * painted only when the next event arrives, because its end tangent
+     * depends on the next point. Here we take the tangent from the
+     * predicted point instead, so the segment is painted right away. The
+     * end points of the segment are always real, so there is nothing to
+     * roll back when the real event arrives, it only defines the start
+     * tangent of the next segment.
+     */
+
+    QPointF startTangent;
+
+    if (!m_d->haveTangent) {
+        m_d->haveTangent = true;
+        startTangent =
+            (info.pos() - m_d->previousPaintInformation.pos()) /
+            qMax(qreal(1.0), info.currentTime() - m_d->previousPaintInformation.currentTime());
+
+    } else if (!m_d->predictedTailPainted) {
+        // the previous segment is still pending, paint it with the real tangent
+        startTangent = (info.pos() - m_d->olderPaintInformation.pos()) /
+            qMax(qreal(1.0), info.currentTime() - m_d->olderPaintInformation.currentTime());
+
+        if (startTangent.isNull() || m_d->previousTangent.isNull()) {
+            paintLine(m_d->olderPaintInformation, m_d->previousPaintInformation);
+        } else {
+            paintBezierSegment(m_d->olderPaintInformation, m_d->previousPaintInformation,
+                               m_d->previousTangent, startTangent);
+        }
+    } else {
+        startTangent = m_d->previousTangent;
+    }
+
+    const KisPaintInformation predicted =
+        m_d->predictor.predict(m_d->predictor.averageEventInterval());
+
+    const QPointF endTangent =
+        (predicted.pos() - m_d->previousPaintInformation.pos()) /
+        qMax(qreal(1.0), predicted.currentTime() - m_d->previousPaintInformation.currentTime());
+
+    if (startTangent.isNull() || endTangent.isNull()) {
+        paintLine(m_d->previousPaintInformation, info);
+    } else {
+        paintBezierSegment(m_d->previousPaintInformation, info,
+                           startTangent, endTangent);
+    }
+
+    m_d->previousTangent = endTangent;
+    m_d->predictedTailPainted = true;
+}
+
 void KisToolFreehandHelper::finishStroke()
 {
-    if (m_d->haveTangent) {
+    if (m_d->haveTangent && m_d->predictedTailPainted) {
+        // the tail of the stroke has already been painted by the predictor
+        m_d->haveTangent = false;
+        m_d->predictedTailPainted = false;
+
+    } else if (m_d->haveTangent) {
         m_d->haveTangent = false;
 
         QPointF newTangent = (m_d->previousPaintInformation.pos() - m_d->olderPaintInformation.pos()) /
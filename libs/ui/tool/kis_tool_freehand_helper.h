@@ -137,6 +137,7 @@ private:
     void paint(KisPaintInformation &info);
     void paintBezierSegment(KisPaintInformation pi1, KisPaintInformation pi2,
                                                    QPointF tangent1, QPointF tangent2);
+    void paintPredictedSegment(const KisPaintInformation &info);
 
     void stabilizerStart(KisPaintInformation firstPaintInfo);
     void stabilizerEnd();
@@ -23,6 +23,9 @@
 #include "KisFreehandStrokeInfo.h"
 #include "kis_paintop.h"
 #include "kis_paintop_preset.h"
+#include "KisRunnableStrokeJobData.h"
+
+#include <algorithm>
 
 
 KisMaskedFreehandStrokePainter::KisMaskedFreehandStrokePainter(KisFreehandStrokeInfo *strokeData, KisFreehandStrokeInfo *maskData)
@@ -134,7 +137,34 @@ std::pair<int, bool> KisMaskedFreehandStrokePainter::doAsyncronousUpdate(QVector
         result.first = std::max(result.first, maskMetrics.first);
         result.second = result.second | maskMetrics.second;
 
-        jobs.append(maskJobs);
+        /**
+         * The paintops end their update sequences with sequential jobs
+         * (mirroring barriers and bookkeeping), so simply appending the
+         * mask jobs would make the masking brush wait until the main
+         * brush has finished rendering. The two brushes paint on
+         * different devices, so we can safely move the leading concurrent
+         * blitting jobs of both sequences into a single concurrent block
+         * and keep the rest of the jobs in their original order.
+         */
+        auto firstNonConcurrent = [] (QVector<KisRunnableStrokeJobData*> &jobList) {
+            return std::find_if(jobList.begin(), jobList.end(),
+                                [] (KisRunnableStrokeJobData *job) {
+                                    return job->sequentiality() != KisStrokeJobData::CONCURRENT;
+                                });
+        };
+
+        const int strokeConcurrentJobs = std::distance(jobs.begin(), firstNonConcurrent(jobs));
+        const int maskConcurrentJobs = std::distance(maskJobs.begin(), firstNonConcurrent(maskJobs));
+
+        QVector<KisRunnableStrokeJobData*> mergedJobs;
+        mergedJobs.reserve(jobs.size() + maskJobs.size());
+
+        mergedJobs += jobs.mid(0, strokeConcurrentJobs);
+        mergedJobs += maskJobs.mid(0, maskConcurrentJobs);
+        mergedJobs += jobs.mid(strokeConcurrentJobs);
+        mergedJobs += maskJobs.mid(maskConcurrentJobs);
+
+        jobs = mergedJobs;
     }
 
     return result;
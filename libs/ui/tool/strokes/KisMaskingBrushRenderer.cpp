@@ -24,7 +24,6 @@
 #include <KoChannelInfo.h>
 #include <KoCompositeOpRegistry.h>
 
-#include "kis_painter.h"
 #include "kis_paint_device.h"
 #include "kis_random_accessor_ng.h"
 
@@ -86,9 +85,17 @@ void KisMaskingBrushRenderer::updateProjection(const QRect &rc)
 {
     if (rc.isEmpty()) return;
 
-    KisPainter::copyAreaOptimized(rc.topLeft(), m_strokeDevice, m_dstDevice, rc);
+    /**
+     * We copy the stroke data into the destination device and apply the
+     * mask to it in a single pass over contiguous chunks of the three
+     * devices, so that every chunk of the destination is touched while
+     * it is still hot in the cache.
+     */
+
+    const int pixelSize = m_dstDevice->pixelSize();
 
     KisRandomAccessorSP dstIt = m_dstDevice->createRandomAccessorNG(rc.left(), rc.top());
+    KisRandomConstAccessorSP strokeIt = m_strokeDevice->createRandomConstAccessorNG(rc.left(), rc.top());
     KisRandomConstAccessorSP maskIt = m_maskDevice->createRandomConstAccessorNG(rc.left(), rc.top());
 
     qint32 dstY = rc.y();
@@ -98,24 +105,39 @@ void KisMaskingBrushRenderer::updateProjection(const QRect &rc)
         qint32 dstX = rc.x();
 
         const qint32 numContiguousDstRows = dstIt->numContiguousRows(dstY);
+        const qint32 numContiguousStrokeRows = strokeIt->numContiguousRows(dstY);
         const qint32 numContiguousMaskRows = maskIt->numContiguousRows(dstY);
 
-        const qint32 rows = std::min({rowsRemaining, numContiguousDstRows, numContiguousMaskRows});
+        const qint32 rows = std::min({rowsRemaining, numContiguousDstRows,
+                                      numContiguousStrokeRows, numContiguousMaskRows});
 
         qint32 columnsRemaining = rc.width();
 
         while (columnsRemaining > 0) {
 
             const qint32 numContiguousDstColumns = dstIt->numContiguousColumns(dstX);
+            const qint32 numContiguousStrokeColumns = strokeIt->numContiguousColumns(dstX);
             const qint32 numContiguousMaskColumns = maskIt->numContiguousColumns(dstX);
-            const qint32 columns = std::min({columnsRemaining, numContiguousDstColumns, numContiguousMaskColumns});
+            const qint32 columns = std::min({columnsRemaining, numContiguousDstColumns,
+                                             numContiguousStrokeColumns, numContiguousMaskColumns});
 
             const qint32 dstRowStride = dstIt->rowStride(dstX, dstY);
+            const qint32 strokeRowStride = strokeIt->rowStride(dstX, dstY);
             const qint32 maskRowStride = maskIt->rowStride(dstX, dstY);
 
             dstIt->moveTo(dstX, dstY);
+            strokeIt->moveTo(dstX, dstY);
             maskIt->moveTo(dstX, dstY);
 
+            quint8 *dstPtr = dstIt->rawData();
+            const quint8 *strokePtr = strokeIt->rawDataConst();
+
+            for (int y = 0; y < rows; y++) {
+                memcpy(dstPtr, strokePtr, columns * pixelSize);
+                dstPtr += dstRowStride;
+                strokePtr += strokeRowStride;
+            }
+
             m_compositeOp->composite(maskIt->rawDataConst(), maskRowStride,
                                      dstIt->rawData(), dstRowStride,
                                      columns, rows);
@@ -128,4 +150,3 @@ void KisMaskingBrushRenderer::updateProjection(const QRect &rc)
         rowsRemaining -= rows;
     }
 }
-
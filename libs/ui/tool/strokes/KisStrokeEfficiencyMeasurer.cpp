@@ -42,6 +42,8 @@ struct KisStrokeEfficiencyMeasurer::Private
 
     int framesCount = 0;
 
+    qreal totalLatency = 0;
+    int latencySamplesCount = 0;
 };
 
 KisStrokeEfficiencyMeasurer::KisStrokeEfficiencyMeasurer()
@@ -64,6 +66,11 @@ bool KisStrokeEfficiencyMeasurer::isEnabled() const
     return m_d->isEnabled;
 }
 
+void KisStrokeEfficiencyMeasurer::setTimeSource(const QElapsedTimer &timeSource)
+{
+    m_d->strokeTimeSource = timeSource;
+}
+
 void KisStrokeEfficiencyMeasurer::addSample(const QPointF &pt)
 {
     if (!m_d->isEnabled) return;
@@ -85,6 +92,17 @@ void KisStrokeEfficiencyMeasurer::addSamples(const QVector<QPointF> &points)
     }
 }
 
+void KisStrokeEfficiencyMeasurer::addLatencySample(qreal eventTime)
+{
+    if (!m_d->isEnabled) return;
+
+    const qreal latency = m_d->strokeTimeSource.elapsed() - eventTime;
+    if (latency < 0) return;
+
+    m_d->totalLatency += latency;
+    m_d->latencySamplesCount++;
+}
+
 void KisStrokeEfficiencyMeasurer::notifyRenderingStarted()
 {
     m_d->renderingStartTime = m_d->strokeTimeSource.elapsed();
@@ -125,4 +143,9 @@ qreal KisStrokeEfficiencyMeasurer::averageFps() const
     return m_d->renderingTime ? m_d->framesCount * 1000.0 / m_d->renderingTime : 0.0;
 }
 
+qreal KisStrokeEfficiencyMeasurer::averageLatency() const
+{
+    return m_d->latencySamplesCount ? m_d->totalLatency / m_d->latencySamplesCount : 0.0;
+}
+
 
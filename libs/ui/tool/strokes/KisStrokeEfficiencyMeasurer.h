@@ -25,6 +25,7 @@
 #include <QtGlobal>
 
 class QPointF;
+class QElapsedTimer;
 
 class KRITAUI_EXPORT KisStrokeEfficiencyMeasurer
 {
@@ -35,12 +36,30 @@ public:
     void setEnabled(bool value);
     bool isEnabled() const;
 
+    /**
+     * Set the clock the measurer counts the time with. By default the
+     * clock is started on construction of the measurer. The event
+     * times passed to addLatencySample() should be counted from the
+     * same origin, otherwise the latency will be measured incorrectly.
+     *
+     * Should be called before any measurement is started.
+     */
+    void setTimeSource(const QElapsedTimer &timeSource);
+
     void addSample(const QPointF &pt);
     void addSamples(const QVector<QPointF> &points);
 
+    /**
+     * Register the moment when the input sample generated at \p eventTime
+     * (milliseconds since the start of the time source, see setTimeSource())
+     * has been passed to the paintop
+     */
+    void addLatencySample(qreal eventTime);
+
     qreal averageCursorSpeed() const;
     qreal averageRenderingSpeed() const;
     qreal averageFps() const;
+    qreal averageLatency() const;
 
     void notifyRenderingStarted();
     void notifyRenderingFinished();
@@ -55,17 +55,25 @@ struct FreehandStrokeStrategy::Private
     Private(const Private &rhs)
         : randomSource(rhs.randomSource),
           resources(rhs.resources),
+          strokeTimeSource(rhs.strokeTimeSource),
+          hasStrokeTimeSource(rhs.hasStrokeTimeSource),
           needsAsynchronousUpdates(rhs.needsAsynchronousUpdates)
     {
         if (needsAsynchronousUpdates) {
             timeSinceLastUpdate.start();
         }
+
+        if (hasStrokeTimeSource) {
+            efficiencyMeasurer.setTimeSource(strokeTimeSource);
+        }
     }
 
     KisStrokeRandomSource randomSource;
     KisResourcesSnapshotSP resources;
 
     KisStrokeEfficiencyMeasurer efficiencyMeasurer;
+    QElapsedTimer strokeTimeSource;
+    bool hasStrokeTimeSource = false;
 
     QElapsedTimer timeSinceLastUpdate;
     int currentUpdatePeriod = 40;
@@ -106,6 +114,7 @@ FreehandStrokeStrategy::~FreehandStrokeStrategy()
     KisStrokeSpeedMonitor::instance()->notifyStrokeFinished(m_d->efficiencyMeasurer.averageCursorSpeed(),
                                                             m_d->efficiencyMeasurer.averageRenderingSpeed(),
                                                             m_d->efficiencyMeasurer.averageFps(),
+                                                            m_d->efficiencyMeasurer.averageLatency(),
                                                             m_d->resources->currentPaintOpPreset());
 
     KisUpdateTimeMonitor::instance()->endStrokeMeasure();
@@ -162,6 +171,7 @@ void FreehandStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
             d->pi1.setPerStrokeRandomSource(strokeRnd);
             maskedPainter->paintAt(d->pi1);
             m_d->efficiencyMeasurer.addSample(d->pi1.pos());
+            addLatencySample(d->pi1);
             break;
         case Data::LINE:
             d->pi1.setRandomSource(rnd);
@@ -170,6 +180,7 @@ void FreehandStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
             d->pi2.setPerStrokeRandomSource(strokeRnd);
             maskedPainter->paintLine(d->pi1, d->pi2);
             m_d->efficiencyMeasurer.addSample(d->pi2.pos());
+            addLatencySample(d->pi2);
             break;
         case Data::CURVE:
             d->pi1.setRandomSource(rnd);
@@ -181,6 +192,7 @@ void FreehandStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
                                          d->control2,
                                          d->pi2);
             m_d->efficiencyMeasurer.addSample(d->pi2.pos());
+            addLatencySample(d->pi2);
             break;
         case Data::POLYLINE:
             maskedPainter->paintPolyline(d->points, 0, d->points.size());
@@ -226,6 +238,26 @@ void FreehandStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
     }
 }
 
+void FreehandStrokeStrategy::setStrokeTimeSource(const QElapsedTimer &timeSource)
+{
+    m_d->strokeTimeSource = timeSource;
+    m_d->hasStrokeTimeSource = true;
+    m_d->efficiencyMeasurer.setTimeSource(timeSource);
+}
+
+void FreehandStrokeStrategy::addLatencySample(const KisPaintInformation &pi)
+{
+    /**
+     * The time of the paint information is counted from the start of
+     * the stroke in KisToolFreehandHelper, so the latency can be measured
+     * only when the helper has shared its clock with us. The strokes
+     * generated programmatically have no clock set, so they are skipped.
+     */
+    if (!m_d->hasStrokeTimeSource) return;
+
+    m_d->efficiencyMeasurer.addLatencySample(pi.currentTime());
+}
+
 void FreehandStrokeStrategy::tryDoUpdate(bool forceEnd)
 {
     // we should enter this function only once!
@@ -28,6 +28,8 @@
 #include "kis_lod_transform.h"
 #include "KoColor.h"
 
+class QElapsedTimer;
+
 
 
 class KRITAUI_EXPORT FreehandStrokeStrategy : public KisPainterBasedStrokeStrategy
@@ -217,6 +219,16 @@ public:
 
     KisStrokeStrategy* createLodClone(int levelOfDetail) override;
 
+    /**
+     * Set the clock the times of the incoming paint information
+     * (KisPaintInformation::currentTime()) are counted from. It is used
+     * for measuring the latency of the input events. When no clock is
+     * set, the latency is not measured.
+     *
+     * Should be called before the stroke is started.
+     */
+    void setStrokeTimeSource(const QElapsedTimer &timeSource);
+
     void notifyUserStartedStroke() override;
     void notifyUserEndedStroke() override;
 
@@ -228,6 +240,7 @@ private:
 
     void tryDoUpdate(bool forceEnd = false);
     void issueSetDirtySignals();
+    void addLatencySample(const KisPaintInformation &pi);
 
 private:
     struct Private;
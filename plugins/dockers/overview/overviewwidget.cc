@@ -41,6 +41,7 @@
 #include "kis_filter_strategy.h"
 #include <KoColorSpaceRegistry.h>
 #include <QApplication>
+#include "KisPaintDeviceMipChain.h"
 
 const qreal oversample = 2.;
 const int thumbnailTileDim = 128;
@@ -58,15 +59,27 @@ struct OverviewThumbnailStrokeStrategy::Private {
         KisPaintDeviceSP device;
     };
 
+    class UpdateMipChain : public KisStrokeJobData
+    {
+    public:
+        UpdateMipChain(KisPaintDeviceMipChainSP _mipChain)
+            : KisStrokeJobData(SEQUENTIAL),
+              mipChain(_mipChain)
+        {}
+
+        KisPaintDeviceMipChainSP mipChain;
+    };
+
     class ProcessData : public KisStrokeJobData
     {
     public:
-        ProcessData(KisPaintDeviceSP _dev, KisPaintDeviceSP _thumbDev, const QSize& _thumbnailSize, const QRect &_rect)
+        ProcessData(KisPaintDeviceSP _dev, const QRect &_devBounds, KisPaintDeviceSP _thumbDev, const QSize& _thumbnailSize, const QRect &_rect)
             : KisStrokeJobData(CONCURRENT),
-              dev(_dev), thumbDev(_thumbDev), thumbnailSize(_thumbnailSize), tileRect(_rect)
+              dev(_dev), devBounds(_devBounds), thumbDev(_thumbDev), thumbnailSize(_thumbnailSize), tileRect(_rect)
         {}
 
         KisPaintDeviceSP dev;
+        QRect devBounds;
         KisPaintDeviceSP thumbDev;
         QSize thumbnailSize;
         QRect tileRect;
@@ -107,11 +120,12 @@ void OverviewWidget::setCanvas(KoCanvasBase * canvas)
 
     if (m_canvas) {
         m_imageIdleWatcher.setTrackedImage(m_canvas->image());
+        resetMipChain();
 
         connect(&m_imageIdleWatcher, &KisIdleWatcher::startedIdleMode, this, &OverviewWidget::generateThumbnail);
 
-        connect(m_canvas->image(), SIGNAL(sigImageUpdated(QRect)),SLOT(startUpdateCanvasProjection()));
-        connect(m_canvas->image(), SIGNAL(sigSizeChanged(QPointF, QPointF)),SLOT(startUpdateCanvasProjection()));
+        connect(m_canvas->image(), SIGNAL(sigImageUpdated(QRect)),SLOT(slotImageUpdated(QRect)));
+        connect(m_canvas->image(), SIGNAL(sigSizeChanged(QPointF, QPointF)),SLOT(slotImageSizeChanged()));
 
         connect(m_canvas->canvasController()->proxyObject, SIGNAL(canvasOffsetXChanged(int)), this, SLOT(update()), Qt::UniqueConnection);
         generateThumbnail();
@@ -157,6 +171,33 @@ void OverviewWidget::startUpdateCanvasProjection()
     m_imageIdleWatcher.startCountdown();
 }
 
+void OverviewWidget::slotImageUpdated(const QRect &rc)
+{
+    if (m_mipChain) {
+        m_mipChain->setDirty(rc);
+    }
+
+    startUpdateCanvasProjection();
+}
+
+void OverviewWidget::slotImageSizeChanged()
+{
+    resetMipChain();
+    startUpdateCanvasProjection();
+}
+
+void OverviewWidget::resetMipChain()
+{
+    QMutexLocker locker(&mutex);
+
+    m_mipChain.clear();
+
+    if (m_canvas) {
+        KisImageSP image = m_canvas->image();
+        m_mipChain.reset(new KisPaintDeviceMipChain(image->projection(), image->bounds()));
+    }
+}
+
 void OverviewWidget::showEvent(QShowEvent *event)
 {
     Q_UNUSED(event);
@@ -261,9 +302,13 @@ void OverviewWidget::generateThumbnail()
                 KisPaintDeviceSP dev = image->projection();
                 KisPaintDeviceSP thumbDev = new KisPaintDevice(dev->colorSpace());
 
+                if (!m_mipChain || m_mipChain->source() != dev) {
+                    m_mipChain.reset(new KisPaintDeviceMipChain(dev, image->bounds()));
+                }
+
                 //creating a special stroke that computes thumbnail image in small chunks that can be quickly interrupted
                 //if user starts painting
-                QList<KisStrokeJobData*> jobs = OverviewThumbnailStrokeStrategy::createJobsData(dev, image->bounds(), thumbDev, previewSize);
+                QList<KisStrokeJobData*> jobs = OverviewThumbnailStrokeStrategy::createJobsData(m_mipChain, thumbDev, previewSize);
 
                 Q_FOREACH (KisStrokeJobData *jd, jobs) {
                     image->addJob(strokeId, jd);
@@ -322,19 +367,30 @@ OverviewThumbnailStrokeStrategy::OverviewThumbnailStrokeStrategy(KisImageWSP ima
     setCanForgetAboutMe(true);
 }
 
-QList<KisStrokeJobData *> OverviewThumbnailStrokeStrategy::createJobsData(KisPaintDeviceSP dev, const QRect& imageRect, KisPaintDeviceSP thumbDev, const QSize& thumbnailSize)
+QList<KisStrokeJobData *> OverviewThumbnailStrokeStrategy::createJobsData(KisPaintDeviceMipChainSP mipChain, KisPaintDeviceSP thumbDev, const QSize& thumbnailSize)
 {
+    const QRect imageRect = mipChain->levelBounds(0);
     QSize thumbnailOversampledSize = oversample * thumbnailSize;
 
     if ((thumbnailOversampledSize.width() > imageRect.width()) || (thumbnailOversampledSize.height() > imageRect.height())) {
         thumbnailOversampledSize.scale(imageRect.size(), Qt::KeepAspectRatio);
     }
 
+    // sample the smallest level that is still not smaller than the thumbnail
+    const qreal scale = qMax(qreal(thumbnailOversampledSize.width()) / imageRect.width(),
+                             qreal(thumbnailOversampledSize.height()) / imageRect.height());
+    const int levelIndex = mipChain->levelForScale(scale);
+
+    KisPaintDeviceSP dev = mipChain->level(levelIndex);
+    const QRect devBounds = mipChain->levelBounds(levelIndex);
+
     QVector<QRect> tileRects = KritaUtils::splitRectIntoPatches(QRect(QPoint(0, 0), thumbnailOversampledSize), QSize(thumbnailTileDim, thumbnailTileDim));
     QList<KisStrokeJobData*> jobsData;
 
+    jobsData << new OverviewThumbnailStrokeStrategy::Private::UpdateMipChain(mipChain);
+
     Q_FOREACH (const QRect &tileRectangle, tileRects) {
-        jobsData << new OverviewThumbnailStrokeStrategy::Private::ProcessData(dev, thumbDev, thumbnailOversampledSize, tileRectangle);
+        jobsData << new OverviewThumbnailStrokeStrategy::Private::ProcessData(dev, devBounds, thumbDev, thumbnailOversampledSize, tileRectangle);
     }
     jobsData << new OverviewThumbnailStrokeStrategy::Private::FinishProcessing(thumbDev);
 
@@ -352,11 +408,17 @@ void OverviewThumbnailStrokeStrategy::initStrokeCallback()
 
 void OverviewThumbnailStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
 {
+    Private::UpdateMipChain *d_um = dynamic_cast<Private::UpdateMipChain*>(data);
+    if (d_um) {
+        d_um->mipChain->update();
+        return;
+    }
+
     Private::ProcessData *d_pd = dynamic_cast<Private::ProcessData*>(data);
     if (d_pd) {
         //we aren't going to use oversample capability of createThumbnailDevice because it recomputes exact bounds for each small patch, which is
         //slow. We'll handle scaling separately.
-        KisPaintDeviceSP thumbnailTile = d_pd->dev->createThumbnailDeviceOversampled(d_pd->thumbnailSize.width(), d_pd->thumbnailSize.height(), 1, m_image->bounds(), d_pd->tileRect);
+        KisPaintDeviceSP thumbnailTile = d_pd->dev->createThumbnailDeviceOversampled(d_pd->thumbnailSize.width(), d_pd->thumbnailSize.height(), 1, d_pd->devBounds, d_pd->tileRect);
         {
             QMutexLocker locker(&m_thumbnailMergeMutex);
             KisPainter gc(d_pd->thumbDev);
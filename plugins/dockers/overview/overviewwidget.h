@@ -23,6 +23,7 @@
 #include <QWidget>
 #include <QPixmap>
 #include <QPointer>
+#include <QSharedPointer>
 
 #include <QMutex>
 #include "kis_idle_watcher.h"
@@ -32,6 +33,8 @@
 
 class KisSignalCompressor;
 class KoCanvasBase;
+class KisPaintDeviceMipChain;
+typedef QSharedPointer<KisPaintDeviceMipChain> KisPaintDeviceMipChainSP;
 
 class OverviewThumbnailStrokeStrategy : public QObject, public KisSimpleStrokeStrategy
 {
@@ -40,7 +43,7 @@ public:
     OverviewThumbnailStrokeStrategy(KisImageWSP image);
     ~OverviewThumbnailStrokeStrategy() override;
 
-    static QList<KisStrokeJobData*> createJobsData(KisPaintDeviceSP dev, const QRect& imageRect, KisPaintDeviceSP thumbDev, const QSize &thumbnailSize);
+    static QList<KisStrokeJobData*> createJobsData(KisPaintDeviceMipChainSP mipChain, KisPaintDeviceSP thumbDev, const QSize &thumbnailSize);
 
 private:
     void initStrokeCallback() override;
@@ -77,6 +80,8 @@ public:
 
 public Q_SLOTS:
     void startUpdateCanvasProjection();
+    void slotImageUpdated(const QRect &rc);
+    void slotImageSizeChanged();
     void generateThumbnail();
     void updateThumbnail(QImage pixmap);
 
@@ -95,6 +100,7 @@ private:
     QPointF previewOrigin();
     QTransform imageToPreviewTransform();
     QPolygonF previewPolygon();
+    void resetMipChain();
 
     QPixmap m_oldPixmap;
     QPixmap m_pixmap;
@@ -107,6 +113,13 @@ private:
     KisIdleWatcher m_imageIdleWatcher;
     KisStrokeId strokeId;
     QMutex mutex;
+
+    /**
+     * The downscaled copies of the projection the thumbnail is generated
+     * from. Only the areas changed since the previous thumbnail are
+     * recalculated.
+     */
+    KisPaintDeviceMipChainSP m_mipChain;
 };
 
 
@@ -101,23 +101,35 @@ void AnimaterionRenderer::slotRenderAnimation()
                 .arg(extension);
 
 
-        const bool batchMode = false; // TODO: fetch correctly!
-        KisAsyncAnimationFramesSaveDialog exporter(doc->image(),
-                                                   KisTimeRange::fromTime(sequenceConfig->getInt("first_frame"), sequenceConfig->getInt("last_frame")),
-                                                   baseFileName,
-                                                   sequenceConfig->getInt("sequence_start"),
-                                                   dlgAnimationRenderer.getFrameExportConfiguration());
-        exporter.setBatchMode(batchMode);
-
-
-        KisAsyncAnimationFramesSaveDialog::Result result =
-            exporter.regenerateRange(viewManager()->mainWindow()->viewManager());
+        KisPropertiesConfigurationSP videoConfig = dlgAnimationRenderer.getVideoConfiguration();
+
+        /**
+         * When the user wants only the video, the encoder renders the frames
+         * itself and pipes them into ffmpeg, so no image files are written.
+         * GIF needs a palette pass over the files, so it is excluded.
+         */
+        const bool streamFrames =
+            videoConfig && videoConfig->getBool("delete_sequence", false) &&
+            QFileInfo(videoConfig->getString("filename")).suffix().toLower() != "gif";
+
+        KisAsyncAnimationFramesSaveDialog::Result result = KisAsyncAnimationFramesSaveDialog::RenderComplete;
+        QString savedFilesMask;
+
+        if (!streamFrames) {
+            const bool batchMode = false; // TODO: fetch correctly!
+            KisAsyncAnimationFramesSaveDialog exporter(doc->image(),
+                                                       KisTimeRange::fromTime(sequenceConfig->getInt("first_frame"), sequenceConfig->getInt("last_frame")),
+                                                       baseFileName,
+                                                       sequenceConfig->getInt("sequence_start"),
+                                                       dlgAnimationRenderer.getFrameExportConfiguration());
+            exporter.setBatchMode(batchMode);
+
+            result = exporter.regenerateRange(viewManager()->mainWindow()->viewManager());
+            savedFilesMask = exporter.savedFilesMask();
+        }
 
         // the folder could have been read-only or something else could happen
         if (result == KisAsyncAnimationFramesSaveDialog::RenderComplete) {
-            QString savedFilesMask = exporter.savedFilesMask();
-
-            KisPropertiesConfigurationSP videoConfig = dlgAnimationRenderer.getVideoConfiguration();
             if (videoConfig) {
                 kisConfig.setExportConfiguration("ANIMATION_RENDERER", videoConfig);
 
@@ -125,6 +137,7 @@ void AnimaterionRenderer::slotRenderAnimation()
                 if (encoderConfig) {
                     kisConfig.setExportConfiguration("FFMPEG_CONFIG", encoderConfig);
                     encoderConfig->setProperty("savedFilesMask", savedFilesMask);
+                    encoderConfig->setProperty("stream_frames", streamFrames);
                 }
 
                 const QString fileName = videoConfig->getString("filename");
@@ -158,7 +171,7 @@ void AnimaterionRenderer::slotRenderAnimation()
                 if (res != KisImportExportFilter::OK) {
                     QMessageBox::critical(0, i18nc("@title:window", "Krita"), i18n("Could not render animation:\n%1", doc->errorMessage()));
                 }
-                if (videoConfig->getBool("delete_sequence", false)) {
+                if (!streamFrames && videoConfig->getBool("delete_sequence", false)) {
                     QDir d(sequenceConfig->getString("directory"));
                     QStringList sequenceFiles = d.entryList(QStringList() << sequenceConfig->getString("basename") + "*." + extension, QDir::Files);
                     Q_FOREACH(const QString &f, sequenceFiles) {
@@ -33,6 +33,10 @@
 #include <kis_image.h>
 #include <kis_image_animation_interface.h>
 #include <kis_time_range.h>
+#include <kis_paint_device.h>
+
+#include <KisAsyncAnimationRendererBase.h>
+#include <dialogs/KisAsyncAnimationRenderDialogBase.h>
 
 #include "kis_config.h"
 
@@ -43,6 +47,9 @@
 #include <QTemporaryFile>
 #include <QTemporaryDir>
 #include <QTime>
+#include <QMutex>
+#include <QMap>
+#include <QImage>
 
 #include "KisPart.h"
 
@@ -95,6 +102,258 @@ private:
 };
 
 
+/**
+ * Keeps the frames rendered by the image clones until ffmpeg is ready
+ * to take them. The frames are pushed from the image worker threads in
+ * any order and written into ffmpeg's stdin in the GUI thread in order.
+ *
+ * Only the frames within \p capacity of the next frame to be written
+ * are accepted for rendering, which limits the memory consumption.
+ */
+class KisFFMpegFramesQueue : public QObject {
+    Q_OBJECT
+public:
+    KisFFMpegFramesQueue(QProcess &process, int firstFrame, int capacity)
+        : m_process(process),
+          m_nextFrame(firstFrame),
+          m_capacity(capacity)
+    {
+        connect(this, SIGNAL(sigFramePushed()), SLOT(slotWriteFrames()), Qt::QueuedConnection);
+        connect(&m_process, SIGNAL(bytesWritten(qint64)), SLOT(slotWriteFrames()));
+        connect(&m_process, SIGNAL(finished(int, QProcess::ExitStatus)), SLOT(slotWriteFrames()));
+    }
+
+    /**
+     * Called from the image worker thread. The frame will be written
+     * \p numRepeats times, once for every held frame.
+     */
+    void push(int frame, int numRepeats, const QByteArray &data) {
+        {
+            QMutexLocker l(&m_mutex);
+            m_frames.insert(frame, qMakePair(numRepeats, data));
+        }
+        emit sigFramePushed();
+    }
+
+    bool canAccept(int frame) const {
+        return hasFailed() || frame < m_nextFrame + m_capacity;
+    }
+
+    bool hasFailed() const {
+        return m_failed.load();
+    }
+
+    /**
+     * Blocks until all the pushed frames are passed to the pipe
+     */
+    bool flush() {
+        forever {
+            slotWriteFrames();
+            if (hasFailed()) break;
+
+            {
+                QMutexLocker l(&m_mutex);
+                if (m_frames.isEmpty() && !m_pendingRepeats && !m_process.bytesToWrite()) break;
+            }
+
+            if (!m_process.waitForBytesWritten(-1)) {
+                setFailed();
+            }
+        }
+
+        return !hasFailed();
+    }
+
+private Q_SLOTS:
+    void slotWriteFrames() {
+        if (hasFailed()) return;
+
+        if (m_process.state() != QProcess::Running) {
+            setFailed();
+            return;
+        }
+
+        // keep at most one frame in the internal buffer of QProcess
+        while (!m_process.bytesToWrite()) {
+            if (!m_pendingRepeats) {
+                QMutexLocker l(&m_mutex);
+
+                auto it = m_frames.find(m_nextFrame);
+                if (it == m_frames.end()) break;
+
+                m_pendingRepeats = it->first;
+                m_pendingData = it->second;
+                m_frames.erase(it);
+            }
+
+            if (m_process.write(m_pendingData) != m_pendingData.size()) {
+                setFailed();
+                return;
+            }
+
+            m_pendingRepeats--;
+            m_nextFrame++;
+
+            if (!m_pendingRepeats) {
+                m_pendingData.clear();
+            }
+
+            emit sigQueueChanged();
+        }
+    }
+
+Q_SIGNALS:
+    void sigFramePushed();
+    void sigQueueChanged();
+
+private:
+    void setFailed() {
+        m_failed.store(1);
+        emit sigQueueChanged();
+    }
+
+private:
+    QProcess &m_process;
+    int m_nextFrame;
+    const int m_capacity;
+
+    QMutex m_mutex;
+    QMap<int, QPair<int, QByteArray>> m_frames;
+
+    int m_pendingRepeats = 0;
+    QByteArray m_pendingData;
+
+    QAtomicInt m_failed;
+};
+
+
+class KisFFMpegFramesStreamingRenderer : public KisAsyncAnimationRendererBase
+{
+    Q_OBJECT
+public:
+    KisFFMpegFramesStreamingRenderer(KisFFMpegFramesQueue *queue, const KisTimeRange &range)
+        : m_queue(queue),
+          m_range(range)
+    {
+        connect(this, SIGNAL(sigCompleteRegenerationInternal(int)), SLOT(notifyFrameCompleted(int)));
+        connect(this, SIGNAL(sigCancelRegenerationInternal(int)), SLOT(notifyFrameCancelled(int)));
+    }
+
+protected:
+    void frameCompletedCallback(int frame, const QRegion &requestedRegion) override {
+        KisImageSP image = requestedImage();
+        if (!image) return;
+
+        KIS_SAFE_ASSERT_RECOVER (requestedRegion == image->bounds()) {
+            emit sigCancelRegenerationInternal(frame);
+            return;
+        }
+
+        if (m_queue->hasFailed()) {
+            emit sigCancelRegenerationInternal(frame);
+            return;
+        }
+
+        int lastFrame = frame;
+
+        const KisTimeRange stillFrameRange =
+            KisTimeRange::calculateIdenticalFramesRecursive(image->root(), frame);
+
+        if (stillFrameRange.isValid()) {
+            lastFrame =
+                stillFrameRange.isInfinite() ?
+                m_range.end() : qMin(stillFrameRange.end(), m_range.end());
+            lastFrame = qMax(frame, lastFrame);
+        }
+
+        const QImage frameImage =
+            image->projection()->convertToQImage(0, image->bounds())
+                .convertToFormat(QImage::Format_RGBA8888);
+
+        m_queue->push(frame, lastFrame - frame + 1,
+                      QByteArray(reinterpret_cast<const char*>(frameImage.constBits()),
+                                 frameImage.byteCount()));
+
+        emit sigCompleteRegenerationInternal(frame);
+    }
+
+    void frameCancelledCallback(int frame) override {
+        notifyFrameCancelled(frame);
+    }
+
+Q_SIGNALS:
+    void sigCompleteRegenerationInternal(int frame);
+    void sigCancelRegenerationInternal(int frame);
+
+private:
+    KisFFMpegFramesQueue *m_queue;
+    KisTimeRange m_range;
+};
+
+
+class KisFFMpegFramesStreamDialog : public KisAsyncAnimationRenderDialogBase
+{
+public:
+    KisFFMpegFramesStreamDialog(KisImageSP image, const KisTimeRange &range, KisFFMpegFramesQueue *queue)
+        : KisAsyncAnimationRenderDialogBase(i18n("Rendering frames..."), image, 0),
+          m_image(image),
+          m_range(range),
+          m_queue(queue)
+    {
+        connect(m_queue, &KisFFMpegFramesQueue::sigQueueChanged,
+                this, [this] () { tryInitiateFrameRegeneration(); });
+    }
+
+protected:
+    QList<int> calcDirtyFrames() const override {
+        QList<int> result;
+
+        // held frames are rendered once and repeated by the queue
+        for (int frame = m_range.start(); frame <= m_range.end(); frame++) {
+            result.append(frame);
+
+            const KisTimeRange stillFrameRange =
+                KisTimeRange::calculateIdenticalFramesRecursive(m_image->root(), frame);
+
+            if (!stillFrameRange.isValid()) continue;
+
+            if (stillFrameRange.isInfinite()) {
+                break;
+            } else {
+                frame = qMax(frame, stillFrameRange.end());
+            }
+        }
+
+        return result;
+    }
+
+    KisAsyncAnimationRendererBase* createRenderer(KisImageSP image) override {
+        Q_UNUSED(image);
+        return new KisFFMpegFramesStreamingRenderer(m_queue, m_range);
+    }
+
+    void initializeRendererForFrame(KisAsyncAnimationRendererBase *renderer,
+                                    KisImageSP image, int frame) override {
+        Q_UNUSED(renderer);
+        Q_UNUSED(image);
+        Q_UNUSED(frame);
+    }
+
+    bool useContiguousFrameRanges() const override {
+        return false;
+    }
+
+    bool isFrameRegenerationAllowed(int frame) const override {
+        return m_queue->canAccept(frame);
+    }
+
+private:
+    KisImageSP m_image;
+    KisTimeRange m_range;
+    KisFFMpegFramesQueue *m_queue;
+};
+
+
 class KisFFMpegRunner
 {
 public:
@@ -115,27 +374,82 @@ public:
         QTemporaryFile progressFile(QDir::tempPath() + QDir::separator() + "KritaFFmpegProgress.XXXXXX");
         progressFile.open();
 
+        startFFMpeg(specialArgs, logPath, progressFile.fileName());
+        return waitForFFMpegProcess(actionName, progressFile, m_process, totalFrames);
+    }
+
+    /**
+     * Renders \p range of \p image and pipes the frames into ffmpeg's
+     * stdin as raw RGBA data. \p specialArgs should declare stdin as
+     * the rawvideo input.
+     */
+    KisImageBuilder_Result runFFMpegStreaming(const QStringList &specialArgs,
+                                              const QString &actionName,
+                                              const QString &logPath,
+                                              KisImageSP image,
+                                              const KisTimeRange &range,
+                                              bool batchMode)
+    {
+        dbgFile << "runFFMpegStreaming: specialArgs" << specialArgs
+                << "actionName" << actionName
+                << "logPath" << logPath
+                << "range" << range;
+
+        QTemporaryFile progressFile(QDir::tempPath() + QDir::separator() + "KritaFFmpegProgress.XXXXXX");
+        progressFile.open();
+
+        startFFMpeg(specialArgs, logPath, progressFile.fileName());
+
+        if (!m_process.waitForStarted()) {
+            return KisImageBuilder_RESULT_FAILURE;
+        }
+
+        const qint64 frameSize = 4 * qint64(image->width()) * image->height();
+        const int capacity = qMax(qint64(2), maxStreamingQueueSize / qMax(qint64(1), frameSize));
+
+        KisFFMpegFramesQueue queue(m_process, range.start(), capacity);
+
+        KisFFMpegFramesStreamDialog dialog(image, range, &queue);
+        dialog.setBatchMode(batchMode);
+
+        const KisAsyncAnimationRenderDialogBase::Result renderResult = dialog.regenerateRange(0);
+
+        if (renderResult != KisAsyncAnimationRenderDialogBase::RenderComplete || !queue.flush()) {
+            m_process.kill();
+            m_process.waitForFinished();
+
+            return renderResult == KisAsyncAnimationRenderDialogBase::RenderCancelled ?
+                KisImageBuilder_RESULT_CANCEL : KisImageBuilder_RESULT_FAILURE;
+        }
+
+        m_process.closeWriteChannel();
+        return waitForFFMpegProcess(actionName, progressFile, m_process, range.duration());
+    }
+
+    void cancel() {
+        m_cancelled = true;
+        m_process.kill();
+    }
+
+private:
+    void startFFMpeg(const QStringList &specialArgs,
+                     const QString &logPath,
+                     const QString &progressPath)
+    {
         m_process.setStandardOutputFile(logPath);
         m_process.setProcessChannelMode(QProcess::MergedChannels);
         QStringList args;
         args << "-v" << "debug"
              << "-nostdin"
-             << "-progress" << progressFile.fileName()
+             << "-progress" << progressPath
              << specialArgs;
 
         qDebug() << "\t" << m_ffmpegPath << args.join(" ");
 
         m_cancelled = false;
         m_process.start(m_ffmpegPath, args);
-        return waitForFFMpegProcess(actionName, progressFile, m_process, totalFrames);
-    }
-
-    void cancel() {
-        m_cancelled = true;
-        m_process.kill();
     }
 
-private:
     KisImageBuilder_Result waitForFFMpegProcess(const QString &message,
                                                 QFile &progressFile,
                                                 QProcess &ffmpegProcess,
@@ -180,6 +494,11 @@ private:
     }
 
 private:
+    /**
+     * The amount of rendered frames' data waiting for the encoder
+     */
+    static const qint64 maxStreamingQueueSize = 256 * 1024 * 1024;
+
     QProcess m_process;
     bool m_cancelled;
     QString m_ffmpegPath;
@@ -266,6 +585,12 @@ KisImageBuilder_Result VideoSaver::encode(const QString &filename, KisProperties
 
     const QString savedFilesMask = configuration->getString("savedFilesMask");
 
+    /**
+     * GIF needs two passes over the frames to generate the palette,
+     * so it always goes through the image files
+     */
+    const bool streamFrames = configuration->getBool("stream_frames", false) && suffix != "gif";
+
     const QStringList additionalOptionsList = configuration->getString("customUserOptions").split(' ', QString::SkipEmptyParts);
 
     if (suffix == "gif") {
@@ -316,9 +641,18 @@ KisImageBuilder_Result VideoSaver::encode(const QString &filename, KisProperties
         }
     } else {
         QStringList args;
-        args << "-r" << QString::number(frameRate)
-             << "-start_number" << QString::number(clipRange.start())
-             << "-i" << savedFilesMask;
+
+        if (streamFrames) {
+            args << "-f" << "rawvideo"
+                 << "-pix_fmt" << "rgba"
+                 << "-s" << QString("%1x%2").arg(m_image->width()).arg(m_image->height())
+                 << "-r" << QString::number(frameRate)
+                 << "-i" << "-";
+        } else {
+            args << "-r" << QString::number(frameRate)
+                 << "-start_number" << QString::number(clipRange.start())
+                 << "-i" << savedFilesMask;
+        }
 
 
 
@@ -349,9 +683,22 @@ KisImageBuilder_Result VideoSaver::encode(const QString &filename, KisProperties
              << "-y" << resultFile;
 
 
-        result = m_runner->runFFMpeg(args, i18n("Encoding frames..."),
-                                     framesDir.filePath("log_encode.log"),
-                                     clipRange.duration());
+        if (streamFrames) {
+            // nothing else creates the directory for the log file
+            framesDir.mkpath(framesDir.absolutePath());
+
+            const KisTimeRange renderRange =
+                KisTimeRange::fromTime(configuration->getInt("first_frame", fullRange.start()),
+                                       configuration->getInt("last_frame", fullRange.end()));
+
+            result = m_runner->runFFMpegStreaming(args, i18n("Encoding frames..."),
+                                                  framesDir.filePath("log_encode.log"),
+                                                  m_image, renderRange, m_batchMode);
+        } else {
+            result = m_runner->runFFMpeg(args, i18n("Encoding frames..."),
+                                         framesDir.filePath("log_encode.log"),
+                                         clipRange.duration());
+        }
     }
 
     return result;
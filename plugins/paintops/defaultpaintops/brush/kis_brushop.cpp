@@ -52,6 +52,7 @@
 
 #include <QSharedPointer>
 #include <QThread>
+#include <atomic>
 #include "kis_image_config.h"
 #include "kis_wrapped_rect.h"
 
@@ -185,6 +186,23 @@ struct KisBrushOp::UpdateSharedState
     QVector<QPointF> dabPoints;
     QElapsedTimer dabRenderingTimer;
 
+    /**
+     * The jobs of the masking brush may be executed in the same
+     * concurrent block as ours (see KisMaskedFreehandStrokePainter),
+     * so we cannot just read dabRenderingTimer in the final sequential
+     * job: it would count the masking brush rendering as well. Instead,
+     * every job of ours registers the moment it has finished.
+     */
+    std::atomic<int> lastJobFinishedTime {0};
+
+    void notifyJobFinished() {
+        const int time = dabRenderingTimer.elapsed();
+
+        int prevTime = lastJobFinishedTime;
+        while (prevTime < time &&
+               !lastJobFinishedTime.compare_exchange_weak(prevTime, time));
+    }
+
     // final report
     QVector<QRect> allDirtyRects;
 };
@@ -201,6 +219,7 @@ void KisBrushOp::addMirroringJobs(Qt::Orientation direction,
             new KisRunnableStrokeJobData(
                 [state, &dab, direction] () {
                     state->painter->mirrorDab(direction, &dab);
+                    state->notifyJobFinished();
                 },
                 KisStrokeJobData::CONCURRENT));
     }
@@ -214,6 +233,7 @@ void KisBrushOp::addMirroringJobs(Qt::Orientation direction,
             new KisRunnableStrokeJobData(
                 [rc, state] () {
                     state->painter->bltFixed(rc, state->dabsQueue);
+                    state->notifyJobFinished();
                 },
                 KisStrokeJobData::CONCURRENT));
     }
@@ -316,6 +336,7 @@ std::pair<int, bool> KisBrushOp::doAsyncronousUpdate(QVector<KisRunnableStrokeJo
                 new KisRunnableStrokeJobData(
                     [rc, state] () {
                         state->painter->bltFixed(rc, state->dabsQueue);
+                        state->notifyJobFinished();
                     },
                     KisStrokeJobData::CONCURRENT));
         }
@@ -347,7 +368,7 @@ std::pair<int, bool> KisBrushOp::doAsyncronousUpdate(QVector<KisRunnableStrokeJo
 
                     state->painter->setAverageOpacity(state->dabsQueue.last().averageOpacity);
 
-                    const int updateRenderingTime = state->dabRenderingTimer.elapsed();
+                    const int updateRenderingTime = state->lastJobFinishedTime;
                     const qreal dabRenderingTime = m_dabExecutor->averageDabRenderingTime();
 
                     m_avgNumDabs(state->dabsQueue.size());
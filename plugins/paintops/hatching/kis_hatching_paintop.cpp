@@ -181,9 +181,7 @@ KisSpacingInformation KisHatchingPaintOp::paintAt(const KisPaintInformation& inf
 
 
     // The most important line, the one that paints to the screen.
-    painter()->bitBltWithFixedSelection(x, y, m_hatchedDab, maskDab, sw, sh);
-    painter()->renderMirrorMaskSafe(QRect(QPoint(x, y), QSize(sw, sh)), m_hatchedDab, 0, 0, maskDab,
-                                    !m_dabCache->needSeparateOriginal());
+    blitDab(m_hatchedDab, maskDab, QRect(x, y, sw, sh));
     painter()->setOpacity(origOpacity);
 
     return effectiveSpacing(scale);
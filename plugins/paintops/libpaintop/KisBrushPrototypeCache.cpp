@@ -0,0 +1,226 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KisBrushPrototypeCache.h"
+
+#include <QGlobalStatic>
+#include <QDomDocument>
+#include <QFileInfo>
+
+#include <kis_properties_configuration.h>
+#include <kis_imagepipe_brush.h>
+#include <KisStrokeSpeedMonitor.h>
+
+#include "kis_brush_option.h"
+
+
+Q_GLOBAL_STATIC(KisBrushPrototypeCache, s_instance)
+
+KisBrushPrototypeCache::KisBrushPrototypeCache()
+    : m_resourceServer(KisBrushServer::instance()->brushServer())
+{
+    m_resourceServer->addObserver(this, false);
+}
+
+KisBrushPrototypeCache::~KisBrushPrototypeCache()
+{
+    if (m_resourceServer) {
+        m_resourceServer->removeObserver(this);
+    }
+}
+
+KisBrushPrototypeCache *KisBrushPrototypeCache::instance()
+{
+    return s_instance;
+}
+
+QString KisBrushPrototypeCache::cacheKey(const QString &definition) const
+{
+    /**
+     * Predefined brushes are referenced by their filename only, so
+     * the definition stays the same when the resource is edited or
+     * reloaded. Add the md5 of the resource to the key to detect that.
+     */
+
+    QDomDocument doc;
+    doc.setContent(definition, false);
+    const QString fileName =
+        doc.firstChildElement("Brush").attribute("filename", "");
+
+    if (fileName.isEmpty() || !m_resourceServer) return definition;
+
+    KisBrushSP resource = m_resourceServer->resourceByFilename(fileName);
+    if (!resource) {
+        resource = m_resourceServer->resourceByFilename(QFileInfo(fileName).fileName());
+    }
+
+    return resource ?
+        definition + QLatin1Char('\n') + QString::fromLatin1(resource->md5().toHex()) :
+        definition;
+}
+
+qint64 KisBrushPrototypeCache::estimateBrushBytes(KisBrushSP brush)
+{
+    QVector<KisBrush*> brushes;
+
+    KisImagePipeBrush *pipeBrush = dynamic_cast<KisImagePipeBrush*>(brush.data());
+    if (pipeBrush) {
+        Q_FOREACH (KisGbrBrush *subBrush, pipeBrush->brushes()) {
+            brushes << subBrush;
+        }
+    } else {
+        brushes << brush.data();
+    }
+
+    /**
+     * Every brush keeps its RGBA tip image and the pyramid generated
+     * from it. The pyramid has all the downscaled levels and, for the
+     * brushes smaller than 512px, upscaled levels up to 8x (see
+     * KisQImagePyramid).
+     */
+    const qint64 pixelSize = 4;
+    const qreal maxUpscale = 8.0;
+    const int upscaleThreshold = 512;
+
+    qint64 bytes = 0;
+
+    Q_FOREACH (KisBrush *b, brushes) {
+        const qint64 area = qint64(b->width()) * b->height();
+        qint64 pyramidArea = 4 * area / 3;
+
+        for (qreal scale = maxUpscale; scale > 1.0; scale *= 0.5) {
+            if (b->width() * scale <= upscaleThreshold ||
+                b->height() * scale <= upscaleThreshold) {
+
+                pyramidArea += qint64(area * scale * scale);
+            }
+        }
+
+        bytes += (area + pyramidArea) * pixelSize;
+    }
+
+    return bytes;
+}
+
+KisBrushSP KisBrushPrototypeCache::fetchBrush(const KisPropertiesConfigurationSP settings)
+{
+    const QString definition = settings->getString("brush_definition");
+
+    QMutexLocker locker(&m_mutex);
+
+    const QString key = cacheKey(definition);
+    KisBrushSP prototype;
+
+    for (auto it = m_prototypes.begin(); it != m_prototypes.end(); ++it) {
+        if (it->key == key) {
+            prototype = it->brush;
+
+            // keep the most recently used brush at the front
+            m_prototypes.move(std::distance(m_prototypes.begin(), it), 0);
+            break;
+        }
+    }
+
+    KisStrokeSpeedMonitor::instance()->
+        notifyPresetCacheAccess(KisStrokeSpeedMonitor::BrushPrototypeCache, bool(prototype));
+
+    if (!prototype) {
+        KisBrushOptionProperties brushOption;
+        brushOption.readOptionSetting(settings);
+        prototype = brushOption.brush();
+
+        if (!prototype) return prototype;
+
+        const qint64 bytes = estimateBrushBytes(prototype);
+        m_prototypes.prepend({key, prototype, bytes});
+        m_cachedBytes += bytes;
+
+        /**
+         * The brush that has just been created is always kept, even
+         * if it alone exceeds the limit: it is going to be used by the
+         * current stroke anyway.
+         */
+        while (m_prototypes.size() > 1 &&
+               (m_prototypes.size() > maxCachedBrushes ||
+                m_cachedBytes > maxCachedBytes)) {
+
+            m_cachedBytes -= m_prototypes.last().bytes;
+            m_prototypes.removeLast();
+        }
+    }
+
+    /**
+     * The clone shares the pyramid with the prototype, so the pyramid
+     * prepared by one stroke is reused by all the following ones.
+     * Cloning is done under the lock, because the prototype may load
+     * its tip image lazily.
+     */
+    return KisBrushSP(prototype->clone());
+}
+
+void KisBrushPrototypeCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_prototypes.clear();
+    m_cachedBytes = 0;
+}
+
+void KisBrushPrototypeCache::unsetResourceServer()
+{
+    clear();
+
+    QMutexLocker locker(&m_mutex);
+    m_resourceServer = 0;
+}
+
+void KisBrushPrototypeCache::resourceAdded(KisBrushSP resource)
+{
+    Q_UNUSED(resource);
+
+    /**
+     * A newly added resource may replace the one with the same
+     * filename, which some of the prototypes were created from
+     */
+    clear();
+}
+
+void KisBrushPrototypeCache::removingResource(KisBrushSP resource)
+{
+    Q_UNUSED(resource);
+    clear();
+}
+
+void KisBrushPrototypeCache::resourceChanged(KisBrushSP resource)
+{
+    Q_UNUSED(resource);
+    clear();
+}
+
+void KisBrushPrototypeCache::syncTaggedResourceView()
+{
+}
+
+void KisBrushPrototypeCache::syncTagAddition(const QString &tag)
+{
+    Q_UNUSED(tag);
+}
+
+void KisBrushPrototypeCache::syncTagRemoval(const QString &tag)
+{
+    Q_UNUSED(tag);
+}
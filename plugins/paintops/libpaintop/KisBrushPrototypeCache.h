@@ -0,0 +1,99 @@
+/*
+ *  Copyright (c) 2018 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KISBRUSHPROTOTYPECACHE_H
+#define KISBRUSHPROTOTYPECACHE_H
+
+#include <QList>
+#include <QString>
+#include <QMutex>
+
+#include <kis_types.h>
+#include <kis_brush.h>
+#include <kis_brush_server.h>
+
+/**
+ * Creating a brush from its XML definition is rather expensive: auto
+ * brushes render their preview images, predefined brushes are fetched
+ * from the resource server and pipe brushes clone all their
+ * sub-brushes. Moreover, a freshly created brush has an empty pyramid,
+ * so the first dabs of every stroke have to wait for the pyramid to be
+ * regenerated.
+ *
+ * KisBrushPrototypeCache keeps a few recently used brushes (prototypes)
+ * keyed by their XML definition and, for predefined brushes, by the md5
+ * of the brush resource. The paintop gets a clone of the prototype,
+ * which shares the already prepared pyramid with it.
+ *
+ * The cache is invalidated when the settings of the preset change (the
+ * definition changes), when the brush resource is edited (the md5
+ * changes) and whenever the brush resource server reports that a brush
+ * has been added, changed or removed. The total size of the cached
+ * brushes is limited by maxCachedBytes.
+ */
+class KisBrushPrototypeCache : public KoResourceServerObserver<KisBrush, SharedPointerStoragePolicy<KisBrushSP> >
+{
+public:
+    KisBrushPrototypeCache();
+    ~KisBrushPrototypeCache() override;
+
+    static KisBrushPrototypeCache* instance();
+
+    /**
+     * @return a clone of the cached brush matching the "brush_definition"
+     *         of \p settings, or a new brush if there is no match. The
+     *         returned brush is owned by the caller and can be changed
+     *         freely.
+     */
+    KisBrushSP fetchBrush(const KisPropertiesConfigurationSP settings);
+
+    /**
+     * Drops all the cached brushes
+     */
+    void clear();
+
+public:
+    void unsetResourceServer() override;
+    void resourceAdded(KisBrushSP resource) override;
+    void removingResource(KisBrushSP resource) override;
+    void resourceChanged(KisBrushSP resource) override;
+    void syncTaggedResourceView() override;
+    void syncTagAddition(const QString &tag) override;
+    void syncTagRemoval(const QString &tag) override;
+
+private:
+    QString cacheKey(const QString &definition) const;
+    static qint64 estimateBrushBytes(KisBrushSP brush);
+
+private:
+    struct Prototype {
+        QString key;
+        KisBrushSP brush;
+        qint64 bytes;
+    };
+
+    static const int maxCachedBrushes = 8;
+    static const qint64 maxCachedBytes = 64 * 1024 * 1024;
+
+    QMutex m_mutex;
+    QList<Prototype> m_prototypes;
+    qint64 m_cachedBytes = 0;
+    KisBrushResourceServer *m_resourceServer = 0;
+};
+
+#endif // KISBRUSHPROTOTYPECACHE_H
@@ -20,9 +20,11 @@
 #define KISTEXTUREMASKINFO_H
 
 
-#include <kis_paint_device.h>
+#include <kis_types.h>
 #include <QSharedPointer>
 #include <QMutex>
+#include <QVector>
+#include <QRect>
 
 
 #include <boost/operators.hpp>
@@ -46,7 +48,14 @@ public:
 
     bool hasMask() const;
 
-    KisPaintDeviceSP mask();
+    /**
+     * The prescaled alpha8 mask of the pattern, stored as a contiguous
+     * block of maskBounds().width() * maskBounds().height() bytes. The
+     * pattern is stored in its final form (scale, brightness, contrast,
+     * cutoff are already applied), so the paintop can wrap it over the
+     * dab without any further conversions.
+     */
+    const quint8* maskData() const;
 
     QRect maskBounds() const;
 
@@ -68,7 +77,7 @@ private:
     int m_cutoffRight = 255;
     int m_cutoffPolicy = 0;
 
-    KisPaintDeviceSP m_mask;
+    QVector<quint8> m_mask;
     QRect m_maskBounds;
 
 };
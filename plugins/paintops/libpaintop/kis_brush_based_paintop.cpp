@@ -19,14 +19,20 @@
 #include "kis_properties_configuration.h"
 #include <brushengine/kis_paintop_settings.h>
 #include "kis_brush_option.h"
+#include "KisBrushPrototypeCache.h"
 #include <kis_pressure_spacing_option.h>
 #include <kis_pressure_rate_option.h>
 #include "kis_painter.h"
 #include <kis_lod_transform.h>
 #include "kis_paintop_utils.h"
 #include "kis_paintop_plugin_utils.h"
+#include "kis_fixed_paint_device.h"
+#include "kis_algebra_2d.h"
+#include "kis_assert.h"
+#include <KoCompositeOpRegistry.h>
 
 #include <QGlobalStatic>
+#include <QSet>
 
 #include <QImage>
 #include <QPainter>
@@ -79,7 +85,9 @@ void KisBrushBasedPaintOp::preinitializeOpStatically(KisPaintOpSettingsSP settin
 
 KisBrushBasedPaintOp::KisBrushBasedPaintOp(const KisPropertiesConfigurationSP settings, KisPainter* painter)
     : KisPaintOp(painter),
-      m_textureProperties(painter->device()->defaultBounds()->currentLevelOfDetail())
+      m_textureProperties(painter->device()->defaultBounds()->currentLevelOfDetail()),
+      m_dabBatchingActive(false),
+      m_batchedDabsBytes(0)
 {
     Q_ASSERT(settings);
 
@@ -89,9 +97,7 @@ KisBrushBasedPaintOp::KisBrushBasedPaintOp(const KisPropertiesConfigurationSP se
 #endif /* HAVE_THREADED_TEXT_RENDERING_WORKAROUND */
 
     if (!m_brush) {
-        KisBrushOptionProperties brushOption;
-        brushOption.readOptionSetting(settings);
-        m_brush = brushOption.brush();
+        m_brush = KisBrushPrototypeCache::instance()->fetchBrush(settings);
     }
 
     m_brush->notifyStrokeStarted();
@@ -109,6 +115,7 @@ KisBrushBasedPaintOp::KisBrushBasedPaintOp(const KisPropertiesConfigurationSP se
 
 KisBrushBasedPaintOp::~KisBrushBasedPaintOp()
 {
+    KIS_SAFE_ASSERT_RECOVER_NOOP(m_batchedDabs.isEmpty());
     delete m_dabCache;
 }
 
@@ -179,3 +186,206 @@ bool KisBrushBasedPaintOp::canPaint() const
 {
     return m_brush != 0;
 }
+
+void KisBrushBasedPaintOp::paintLine(const KisPaintInformation &pi1,
+                                     const KisPaintInformation &pi2,
+                                     KisDistanceInformation *currentDistance)
+{
+    const bool wasBatching = m_dabBatchingActive;
+    m_dabBatchingActive = true;
+
+    KisPaintOp::paintLine(pi1, pi2, currentDistance);
+
+    m_dabBatchingActive = wasBatching;
+    if (!m_dabBatchingActive) {
+        flushBatchedDabs();
+    }
+}
+
+void KisBrushBasedPaintOp::paintBezierCurve(const KisPaintInformation &pi1,
+                                            const QPointF &control1,
+                                            const QPointF &control2,
+                                            const KisPaintInformation &pi2,
+                                            KisDistanceInformation *currentDistance)
+{
+    const bool wasBatching = m_dabBatchingActive;
+    m_dabBatchingActive = true;
+
+    KisPaintOp::paintBezierCurve(pi1, control1, control2, pi2, currentDistance);
+
+    m_dabBatchingActive = wasBatching;
+    if (!m_dabBatchingActive) {
+        flushBatchedDabs();
+    }
+}
+
+bool KisBrushBasedPaintOp::canBatchDabs() const
+{
+    /**
+     * In wrap-around mode the dabs should be duplicated to cover all the
+     * wrapped pieces (see KisBrushOp::doAsyncronousUpdate()), so we just
+     * paint them one-by-one in this case.
+     */
+    return m_dabBatchingActive &&
+        !painter()->device()->defaultBounds()->wrapAroundMode();
+}
+
+void KisBrushBasedPaintOp::blitDab(KisFixedPaintDeviceSP dab, const QRect &dstRect)
+{
+    if (!canBatchDabs()) {
+        painter()->bltFixed(dstRect.topLeft(), dab, dab->bounds());
+        painter()->renderMirrorMaskSafe(dstRect, dab, !m_dabCache->needSeparateOriginal());
+        return;
+    }
+
+    /**
+     * The dab cache renders every new dab into the same device, so we
+     * take the device away from the cache to keep it till the queue is
+     * flushed. The cache will render the next dab into a recycled one.
+     */
+    KisFixedPaintDeviceSP ownedDab = m_dabCache->takeLastDab();
+
+    KIS_SAFE_ASSERT_RECOVER(ownedDab == dab) {
+        ownedDab = new KisFixedPaintDevice(*dab);
+    }
+
+    queueDab(ownedDab, dstRect);
+}
+
+void KisBrushBasedPaintOp::blitDab(KisPaintDeviceSP srcDevice, KisFixedPaintDeviceSP maskDab, const QRect &dstRect)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(maskDab->pixelSize() == 1);
+
+    /**
+     * COPY composite op uses the mask as a blending factor between
+     * the source and the destination, so premultiplying the mask into
+     * the alpha channel would change the result.
+     */
+    if (!canBatchDabs() ||
+        painter()->compositeOp()->id() == COMPOSITE_COPY) {
+
+        painter()->bitBltWithFixedSelection(dstRect.x(), dstRect.y(),
+                                            srcDevice, maskDab,
+                                            dstRect.width(), dstRect.height());
+        painter()->renderMirrorMaskSafe(dstRect, srcDevice, 0, 0, maskDab,
+                                        !m_dabCache->needSeparateOriginal());
+        return;
+    }
+
+    KisFixedPaintDeviceSP dab = m_dabCache->fetchFreeDevice(srcDevice->colorSpace());
+    dab->setRect(QRect(QPoint(), dstRect.size()));
+    dab->lazyGrowBufferWithoutInitialization();
+    srcDevice->readBytes(dab->data(), dab->bounds());
+
+    dab->colorSpace()->applyAlphaU8Mask(dab->data(), maskDab->data(),
+                                        dstRect.width() * dstRect.height());
+
+    queueDab(dab, dstRect);
+}
+
+void KisBrushBasedPaintOp::queueDab(KisFixedPaintDeviceSP dab, const QRect &dstRect)
+{
+    KisRenderedDab renderedDab;
+    renderedDab.device = dab;
+    renderedDab.offset = dstRect.topLeft();
+    renderedDab.opacity = qreal(painter()->opacity()) / 255.0;
+    renderedDab.flow = qreal(painter()->flow()) / 255.0;
+    renderedDab.averageOpacity = painter()->averageOpacity();
+
+    m_batchedDabs.append(renderedDab);
+    m_batchedDabsBytes += dab->bounds().width() * dab->bounds().height() * dab->pixelSize();
+
+    /**
+     * Don't let the queue grow unbounded for huge brushes or
+     * extremely long segments
+     */
+    const qint64 maxBatchedDabsBytes = 16 * 1024 * 1024;
+    if (m_batchedDabsBytes > maxBatchedDabsBytes) {
+        flushBatchedDabs();
+    }
+}
+
+void KisBrushBasedPaintOp::flushBatchedDabs()
+{
+    if (m_batchedDabs.isEmpty()) return;
+
+    QVector<QRect> dabRects;
+    int diameter = 0;
+
+    Q_FOREACH (const KisRenderedDab &dab, m_batchedDabs) {
+        const QRect rc = dab.realBounds();
+        dabRects.append(rc);
+        diameter = qMax(diameter, KisAlgebra2D::maxDimension(rc.size()));
+    }
+
+    // the stroke segments are usually long and narrow, so split the
+    // bounding rect into patches to avoid walking empty tiles
+    QVector<QRect> rects = KisPaintOpUtils::splitDabsIntoRects(dabRects, 1, diameter, 1.0);
+
+    Q_FOREACH (const QRect &rc, rects) {
+        painter()->bltFixed(rc, m_batchedDabs);
+    }
+    painter()->addDirtyRects(rects);
+
+    /**
+     * Now render all the mirrored copies. This sequence of 'if's has
+     * __no__ 'else' branches intentionally, see KisBrushOp for details.
+     */
+    if (painter()->hasMirroring()) {
+        /**
+         * The mirroring is done in-place, so the dabs still used by the
+         * dab cache should be detached first. All the dabs fetched from
+         * the cache share the same device, so a single copy is enough.
+         */
+        KisFixedPaintDeviceSP detachedCachedDab;
+
+        for (KisRenderedDab &dab : m_batchedDabs) {
+            if (m_dabCache->isCachedDab(dab.device)) {
+                if (!detachedCachedDab) {
+                    detachedCachedDab = new KisFixedPaintDevice(*dab.device);
+                }
+                dab.device = detachedCachedDab;
+            }
+        }
+
+        auto renderMirrored = [this, &rects] (Qt::Orientation direction) {
+            QSet<KisFixedPaintDevice*> mirroredDevices;
+
+            for (KisRenderedDab &dab : m_batchedDabs) {
+                if (mirroredDevices.contains(dab.device.data())) {
+                    QRect rc = dab.realBounds();
+                    painter()->mirrorRect(direction, &rc);
+                    dab.offset = rc.topLeft();
+                } else {
+                    painter()->mirrorDab(direction, &dab);
+                    mirroredDevices.insert(dab.device.data());
+                }
+            }
+
+            for (QRect &rc : rects) {
+                painter()->mirrorRect(direction, &rc);
+                painter()->bltFixed(rc, m_batchedDabs);
+            }
+            painter()->addDirtyRects(rects);
+        };
+
+        if (painter()->hasHorizontalMirroring()) {
+            renderMirrored(Qt::Horizontal);
+        }
+
+        if (painter()->hasVerticalMirroring()) {
+            renderMirrored(Qt::Vertical);
+        }
+
+        if (painter()->hasHorizontalMirroring() && painter()->hasVerticalMirroring()) {
+            renderMirrored(Qt::Horizontal);
+        }
+    }
+
+    Q_FOREACH (const KisRenderedDab &dab, m_batchedDabs) {
+        m_dabCache->recycleDab(dab.device);
+    }
+
+    m_batchedDabs.clear();
+    m_batchedDabsBytes = 0;
+}
@@ -27,6 +27,7 @@
 #include "kis_airbrush_option_widget.h"
 #include "kis_pressure_mirror_option.h"
 #include <kis_threaded_text_rendering_workaround.h>
+#include <KisRenderedDab.h>
 
 
 class KisPropertiesConfiguration;
@@ -80,12 +81,64 @@ public:
     ///Reimplemented, false if brush is 0
     bool canPaint() const override;
 
+    /**
+     * Reimplemented to composite all the dabs of the segment in a
+     * single pass. See blitDab() for details.
+     */
+    void paintLine(const KisPaintInformation &pi1,
+                   const KisPaintInformation &pi2,
+                   KisDistanceInformation *currentDistance) override;
+
+    void paintBezierCurve(const KisPaintInformation &pi1,
+                          const QPointF &control1,
+                          const QPointF &control2,
+                          const KisPaintInformation &pi2,
+                          KisDistanceInformation *currentDistance) override;
+
 #ifdef HAVE_THREADED_TEXT_RENDERING_WORKAROUND
     typedef int needs_preinitialization;
     static void preinitializeOpStatically(KisPaintOpSettingsSP settings);
 #endif /* HAVE_THREADED_TEXT_RENDERING_WORKAROUND */
 
+protected:
+    /**
+     * Paint \p dab at \p dstRect using the current opacity, flow and
+     * composite op of the painter and render all its mirrored copies.
+     * \p dab must be the device returned by the last call to
+     * m_dabCache->fetchDab().
+     *
+     * When called from inside paintLine() or paintBezierCurve() the dab
+     * is not painted immediately, but is queued and later composited
+     * together with all the other dabs of the segment through
+     * KisPainter::bltFixed(QRect, QList<KisRenderedDab>). Overlapping dabs
+     * are then composited tile-by-tile in a single sweep instead of doing
+     * a separate read-modify-write of the device for every dab. The queue
+     * takes the ownership of the dab device from the dab cache, so the
+     * pixels are not copied.
+     *
+     * Only the paintops that do not read back the destination device
+     * while generating the dab may use this method, otherwise they would
+     * see outdated pixels.
+     */
+    void blitDab(KisFixedPaintDeviceSP dab, const QRect &dstRect);
+
+    /**
+     * Same as blitDab(), but paints the rect of size \p dstRect.size()
+     * from the origin of \p srcDevice through the alpha8 \p maskDab,
+     * like KisPainter::bitBltWithFixedSelection() does. When queued,
+     * the mask is multiplied into the alpha channel of the dab.
+     */
+    void blitDab(KisPaintDeviceSP srcDevice, KisFixedPaintDeviceSP maskDab, const QRect &dstRect);
+
+    /**
+     * Composite all the queued dabs onto the device
+     */
+    void flushBatchedDabs();
+
 private:
+    bool canBatchDabs() const;
+    void queueDab(KisFixedPaintDeviceSP dab, const QRect &dstRect);
+
     KisSpacingInformation effectiveSpacing(qreal dabWidth, qreal dabHeight, qreal extraScale, bool isotropicSpacing, qreal rotation, bool axesFlipped) const;
 
 protected: // XXX: make private!
@@ -95,6 +148,10 @@ protected: // XXX: make private!
 private:
     KisTextureProperties m_textureProperties;
 
+    bool m_dabBatchingActive;
+    QList<KisRenderedDab> m_batchedDabs;
+    qint64 m_batchedDabsBytes;
+
 protected:
     KisPressureMirrorOption m_mirrorOption;
     KisPrecisionOption m_precisionOption;
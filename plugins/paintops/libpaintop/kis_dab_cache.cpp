@@ -25,6 +25,7 @@
 #include "kis_color_source.h"
 #include "kis_pressure_sharpness_option.h"
 #include "kis_texture_option.h"
+#include "kis_assert.h"
 
 #include <kundo2command.h>
 
@@ -37,6 +38,14 @@ struct KisDabCache::Private {
     KisFixedPaintDeviceSP dab;
     KisFixedPaintDeviceSP dabOriginal;
 
+    /**
+     * Set when \p dab has been handed over to the user by takeLastDab(),
+     * but is still used as a cached dab. The next generated dab should
+     * be rendered into a different device then.
+     */
+    bool dabIsShared = false;
+    QVector<KisFixedPaintDeviceSP> freeDabs;
+
     KisBrushSP brush;
     KisPaintDeviceSP colorSourceDevice;
 
@@ -71,6 +80,57 @@ bool KisDabCache::needSeparateOriginal() const
     return KisDabCacheBase::needSeparateOriginal(m_d->textureOption, m_d->sharpnessOption);
 }
 
+KisFixedPaintDeviceSP KisDabCache::takeLastDab()
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(m_d->dab, 0);
+
+    KisFixedPaintDeviceSP dab = m_d->dab;
+
+    if (needSeparateOriginal()) {
+        /**
+         * The cached state is stored in dabOriginal, the dab itself
+         * is just a postprocessed copy of it, so we can give it away
+         */
+        m_d->dab = fetchFreeDevice(dab->colorSpace());
+        m_d->dabIsShared = false;
+    } else {
+        m_d->dabIsShared = true;
+    }
+
+    return dab;
+}
+
+bool KisDabCache::isCachedDab(KisFixedPaintDeviceSP dab) const
+{
+    return dab == m_d->dab || dab == m_d->dabOriginal;
+}
+
+KisFixedPaintDeviceSP KisDabCache::fetchFreeDevice(const KoColorSpace *cs)
+{
+    while (!m_d->freeDabs.isEmpty()) {
+        KisFixedPaintDeviceSP dab = m_d->freeDabs.takeLast();
+        if (*dab->colorSpace() == *cs) {
+            return dab;
+        }
+    }
+
+    return new KisFixedPaintDevice(cs);
+}
+
+void KisDabCache::recycleDab(KisFixedPaintDeviceSP dab)
+{
+    const int maxFreeDabs = 16;
+
+    if (isCachedDab(dab) ||
+        m_d->freeDabs.size() >= maxFreeDabs ||
+        m_d->freeDabs.contains(dab)) {
+
+        return;
+    }
+
+    m_d->freeDabs.append(dab);
+}
+
 
 KisFixedPaintDeviceSP KisDabCache::fetchDab(const KoColorSpace *cs,
         KisColorSource *colorSource,
@@ -153,6 +213,7 @@ KisFixedPaintDeviceSP KisDabCache::fetchDabCommon(const KoColorSpace *cs,
 
     if (!m_d->dab || *m_d->dab->colorSpace() != *cs) {
         m_d->dab = new KisFixedPaintDevice(cs);
+        m_d->dabIsShared = false;
         hasDabInCache = false;
     }
 
@@ -196,6 +257,11 @@ KisFixedPaintDeviceSP KisDabCache::fetchDabCommon(const KoColorSpace *cs,
 
     // 3. Generate new dab
 
+    if (m_d->dabIsShared) {
+        m_d->dab = fetchFreeDevice(cs);
+        m_d->dabIsShared = false;
+    }
+
     generateDab(di, &resources, &m_d->dab);
 
     // 4. Do postprocessing
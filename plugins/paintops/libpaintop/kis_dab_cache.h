@@ -79,6 +79,37 @@ public:
 
     bool needSeparateOriginal() const;
 
+    /**
+     * Hands the dab returned by the last fetchDab() call over to the
+     * caller. The cache will never write into the returned device
+     * again, so the caller may keep it as long as needed without
+     * copying the pixels.
+     *
+     * If the dab has been fetched from the cache, the device is still
+     * shared with the cache (see isCachedDab()), so it must not be
+     * modified by the caller.
+     */
+    KisFixedPaintDeviceSP takeLastDab();
+
+    /**
+     * \return true if \p dab is used by the cache for keeping the
+     *         cached dab, so it must not be modified
+     */
+    bool isCachedDab(KisFixedPaintDeviceSP dab) const;
+
+    /**
+     * \return a device in color space \p cs that is not used by anyone.
+     * The device is either a recycled one or a newly created one.
+     */
+    KisFixedPaintDeviceSP fetchFreeDevice(const KoColorSpace *cs);
+
+    /**
+     * Returns a device previously got from takeLastDab() or
+     * fetchFreeDevice() back to the cache, so that its buffer could
+     * be reused for the next dabs
+     */
+    void recycleDab(KisFixedPaintDeviceSP dab);
+
 private:
 
     inline KisFixedPaintDeviceSP fetchFromCache(KisDabCacheUtils::DabRenderingResources *resources, const KisPaintInformation& info,
@@ -38,10 +38,9 @@
 #include <kis_multipliers_double_slider_spinbox.h>
 #include <resources/KoPattern.h>
 #include <kis_paint_device.h>
-#include <kis_fill_painter.h>
 #include <kis_painter.h>
-#include <kis_iterator_ng.h>
 #include <kis_fixed_paint_device.h>
+#include <KoColorSpace.h>
 #include <KisGradientSlider.h>
 #include "kis_embedded_pattern_manager.h"
 #include <brushengine/kis_paintop_lod_limitations.h>
@@ -230,44 +229,89 @@ void KisTextureProperties::apply(KisFixedPaintDeviceSP dab, const QPoint &offset
 {
     if (!m_enabled) return;
 
-    KisPaintDeviceSP fillDevice = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
-    QRect rect = dab->bounds();
+    KIS_SAFE_ASSERT_RECOVER_RETURN(m_maskInfo->hasMask());
 
-    KisPaintDeviceSP mask = m_maskInfo->mask();
+    const QRect rect = dab->bounds();
     const QRect maskBounds = m_maskInfo->maskBounds();
+    const quint8 *maskData = m_maskInfo->maskData();
 
-    KIS_SAFE_ASSERT_RECOVER_RETURN(mask);
+    const int maskWidth = maskBounds.width();
+    const int maskHeight = maskBounds.height();
 
-    int x = offset.x() % maskBounds.width() - m_offsetX;
-    int y = offset.y() % maskBounds.height() - m_offsetY;
+    auto wrapCoordinate = [](int value, int size) {
+        const int result = value % size;
+        return result >= 0 ? result : result + size;
+    };
 
+    const int startX = wrapCoordinate(offset.x() % maskWidth - m_offsetX, maskWidth);
+    const int startY = wrapCoordinate(offset.y() % maskHeight - m_offsetY, maskHeight);
 
-    KisFillPainter fillPainter(fillDevice);
-    fillPainter.fillRect(x - 1, y - 1, rect.width() + 2, rect.height() + 2, mask, maskBounds);
-    fillPainter.end();
+    const qreal pressure = m_strengthOption.apply(info);
 
-    qreal pressure = m_strengthOption.apply(info);
+    /**
+     * The strength of the texture is constant for the whole dab, so
+     * we convert it into a lookup table once and then apply the
+     * pattern to the dab row-by-row, letting the colorspace process
+     * the whole row in its native depth.
+     */
+    quint8 pressureTable[256];
+
+    if (m_texturingMode == MULTIPLY) {
+        for (int i = 0; i < 256; i++) {
+            pressureTable[i] = quint8(i * pressure);
+        }
+    } else {
+        const int pressureOffset = (1.0 - pressure) * 255;
+        for (int i = 0; i < 256; i++) {
+            pressureTable[i] = quint8(qMin(255, i + pressureOffset));
+        }
+    }
+
+    const KoColorSpace *cs = dab->colorSpace();
+    const int pixelSize = cs->pixelSize();
+    const int dabRowStride = rect.width() * pixelSize;
+
+    QVector<quint8> maskRow(rect.width());
     quint8 *dabData = dab->data();
 
-    KisHLineIteratorSP iter = fillDevice->createHLineIteratorNG(x, y, rect.width());
+    int maskY = startY;
+
     for (int row = 0; row < rect.height(); ++row) {
-        for (int col = 0; col < rect.width(); ++col) {
-            if (m_texturingMode == MULTIPLY) {
-                dab->colorSpace()->multiplyAlpha(dabData, quint8(*iter->oldRawData() * pressure), 1);
-            }
-            else {
-                int pressureOffset = (1.0 - pressure) * 255;
+        const quint8 *maskLine = maskData + maskY * maskWidth;
 
-                qint16 maskA = *iter->oldRawData() + pressureOffset;
-                quint8 dabA = dab->colorSpace()->opacityU8(dabData);
+        int maskX = startX;
+        int col = 0;
 
-                dabA = qMax(0, (qint16)dabA - maskA);
-                dab->colorSpace()->setOpacity(dabData, dabA, 1);
+        while (col < rect.width()) {
+            const int numColumns = qMin(maskWidth - maskX, rect.width() - col);
+            memcpy(maskRow.data() + col, maskLine + maskX, numColumns);
+
+            col += numColumns;
+            maskX = 0;
+        }
+
+        quint8 *maskPtr = maskRow.data();
+        for (int i = 0; i < rect.width(); i++, maskPtr++) {
+            *maskPtr = pressureTable[*maskPtr];
+        }
+
+        if (m_texturingMode == MULTIPLY) {
+            cs->applyAlphaU8Mask(dabData, maskRow.constData(), rect.width());
+        } else {
+            quint8 *pixelPtr = dabData;
+            maskPtr = maskRow.data();
+
+            for (int i = 0; i < rect.width(); i++, maskPtr++) {
+                const quint8 dabA = cs->opacityU8(pixelPtr);
+                cs->setOpacity(pixelPtr, quint8(qMax(0, int(dabA) - int(*maskPtr))), 1);
+                pixelPtr += pixelSize;
             }
+        }
+
+        dabData += dabRowStride;
 
-            iter->nextPixel();
-            dabData += dab->pixelSize();
+        if (++maskY >= maskHeight) {
+            maskY = 0;
         }
-        iter->nextRow();
     }
 }
@@ -161,8 +161,7 @@ KisSpacingInformation KisTangentNormalPaintOp::paintAt(const KisPaintInformation
     //paint with the default color? Copied this from color smudge.//
     //painter()->setCompositeOp(COMPOSITE_COPY);
     //painter()->fill(0, 0, m_dstDabRect.width(), m_dstDabRect.height(), color);
-    painter()->bltFixed(m_dstDabRect.topLeft(), m_maskDab, m_maskDab->bounds());
-    painter()->renderMirrorMaskSafe(m_dstDabRect, m_maskDab, !m_dabCache->needSeparateOriginal());
+    blitDab(m_maskDab, m_dstDabRect);
 
     // restore original opacity and composite mode values
     painter()->setOpacity(oldOpacity);
@@ -248,6 +247,6 @@ void KisTangentNormalPaintOp::paintLine(const KisPaintInformation& pi1, const Ki
         painter()->renderMirrorMask(rc, m_lineCacheDevice);
     }
     else {
-        KisPaintOp::paintLine(pi1, pi2, currentDistance);
+        KisBrushBasedPaintOp::paintLine(pi1, pi2, currentDistance);
     }
 }
@@ -137,6 +137,7 @@ void KisToolBrush::slotSetSmoothingType(int index)
         showControl(m_sliderDelayDistance, false);
         showControl(m_chkFinishStabilizedCurve, false);
         showControl(m_chkStabilizeSensors, false);
+        showControl(m_chkUseStrokePrediction, false);
         break;
     case 1:
         smoothingOptions()->setSmoothingType(KisSmoothingOptions::SIMPLE_SMOOTHING);
@@ -147,6 +148,7 @@ void KisToolBrush::slotSetSmoothingType(int index)
         showControl(m_sliderDelayDistance, false);
         showControl(m_chkFinishStabilizedCurve, false);
         showControl(m_chkStabilizeSensors, false);
+        showControl(m_chkUseStrokePrediction, true);
         break;
     case 2:
         smoothingOptions()->setSmoothingType(KisSmoothingOptions::WEIGHTED_SMOOTHING);
@@ -157,6 +159,7 @@ void KisToolBrush::slotSetSmoothingType(int index)
         showControl(m_sliderDelayDistance, false);
         showControl(m_chkFinishStabilizedCurve, false);
         showControl(m_chkStabilizeSensors, false);
+        showControl(m_chkUseStrokePrediction, true);
         break;
     case 3:
     default:
@@ -168,6 +171,7 @@ void KisToolBrush::slotSetSmoothingType(int index)
         showControl(m_sliderDelayDistance, true);
         showControl(m_chkFinishStabilizedCurve, true);
         showControl(m_chkStabilizeSensors, true);
+        showControl(m_chkUseStrokePrediction, false);
     }
 
     emit smoothingTypeChanged();
@@ -278,6 +282,17 @@ bool KisToolBrush::stabilizeSensors() const
     return smoothingOptions()->stabilizeSensors();
 }
 
+void KisToolBrush::setUseStrokePrediction(bool value)
+{
+    smoothingOptions()->setUseStrokePrediction(value);
+    emit useStrokePredictionChanged();
+}
+
+bool KisToolBrush::useStrokePrediction() const
+{
+    return smoothingOptions()->useStrokePrediction();
+}
+
 void KisToolBrush::updateSettingsViews()
 {
     m_cmbSmoothingType->setCurrentIndex(smoothingOptions()->smoothingType());
@@ -290,6 +305,7 @@ void KisToolBrush::updateSettingsViews()
     m_chkUseScalableDistance->setChecked(smoothingOptions()->useScalableDistance());
     m_cmbSmoothingType->setCurrentIndex((int)smoothingOptions()->smoothingType());
     m_chkStabilizeSensors->setChecked(smoothingOptions()->stabilizeSensors());
+    m_chkUseStrokePrediction->setChecked(smoothingOptions()->useStrokePrediction());
 
     emit smoothnessQualityChanged();
     emit smoothnessFactorChanged();
@@ -405,6 +421,17 @@ QWidget * KisToolBrush::createOptionWidget()
     connect(m_chkUseScalableDistance, SIGNAL(toggled(bool)), this, SLOT(setUseScalableDistance(bool)));
     addOptionWidgetOption(m_chkUseScalableDistance, new QLabel(QString("%1:").arg(i18n("Scalable Distance"))));
 
+    m_chkUseStrokePrediction = new QCheckBox(optionsWidget);
+    m_chkUseStrokePrediction->setChecked(smoothingOptions()->useStrokePrediction());
+    m_chkUseStrokePrediction->setMinimumHeight(qMax(m_sliderSmoothnessDistance->sizeHint().height()-3,
+                                                    m_chkUseStrokePrediction->sizeHint().height()));
+    m_chkUseStrokePrediction->setToolTip(i18nc("@info:tooltip",
+                                               "Predict the direction of the stroke "
+                                               "to paint the latest segment without "
+                                               "waiting for the next tablet event"));
+    connect(m_chkUseStrokePrediction, SIGNAL(toggled(bool)), this, SLOT(setUseStrokePrediction(bool)));
+    addOptionWidgetOption(m_chkUseStrokePrediction, new QLabel(QString("%1:").arg(i18n("Predict Stroke"))));
+
 
     // add a line spacer so we know that the next set of options are for different settings
     QFrame* line = new QFrame(optionsWidget);
@@ -56,6 +56,7 @@ class KisToolBrush : public KisToolFreehand
 
     Q_PROPERTY(bool finishStabilizedCurve READ finishStabilizedCurve WRITE setFinishStabilizedCurve NOTIFY finishStabilizedCurveChanged)
     Q_PROPERTY(bool stabilizeSensors READ stabilizeSensors WRITE setStabilizeSensors NOTIFY stabilizeSensorsChanged)
+    Q_PROPERTY(bool useStrokePrediction READ useStrokePrediction WRITE setUseStrokePrediction NOTIFY useStrokePredictionChanged)
 
 
 public:
@@ -75,6 +76,7 @@ public:
 
     bool finishStabilizedCurve() const;
     bool stabilizeSensors() const;
+    bool useStrokePrediction() const;
 
 protected:
     KConfigGroup m_configGroup; // only used in the multihand tool for now
@@ -96,6 +98,7 @@ public Q_SLOTS:
     void setDelayDistance(qreal value);
 
     void setStabilizeSensors(bool value);
+    void setUseStrokePrediction(bool value);
 
     void setFinishStabilizedCurve(bool value);
 
@@ -112,6 +115,7 @@ Q_SIGNALS:
     void delayDistanceChanged();
     void finishStabilizedCurveChanged();
     void stabilizeSensorsChanged();
+    void useStrokePredictionChanged();
 
 private:
     void addSmoothingAction(int enumId, const QString &id, const QString &name, const QIcon &icon, KActionCollection *globalCollection);
@@ -128,6 +132,7 @@ private:
     QCheckBox *m_chkUseScalableDistance;
 
     QCheckBox *m_chkStabilizeSensors;
+    QCheckBox *m_chkUseStrokePrediction;
     QCheckBox *m_chkDelayDistance;
     KisDoubleSliderSpinBox *m_sliderDelayDistance;
 
@@ -260,6 +260,34 @@ void KisToolLazyBrushOptionsWidget::slotUpdateNodeProperties()
 
     m_d->ui->chkLimitToDevice->setEnabled(m_d->activeMask);
     m_d->ui->chkLimitToDevice->setChecked(m_d->activeMask && m_d->activeMask->limitToDeviceBounds());
+
+    const KisColorizeMask::RegenerationTimings timings =
+        m_d->activeMask ?
+            m_d->activeMask->lastRegenerationTimings() :
+            KisColorizeMask::RegenerationTimings();
+
+    QString timingsText;
+
+    if (timings.totalTime >= 0) {
+        QStringList steps;
+
+        if (timings.prefilteringTime >= 0) {
+            steps << i18n("prefiltering: %1 ms", timings.prefilteringTime);
+        }
+
+        if (timings.watershedTime >= 0) {
+            steps << i18n("filling: %1 ms", timings.watershedTime);
+        }
+
+        timingsText = i18n("Last update took %1 ms", timings.totalTime);
+
+        if (!steps.isEmpty()) {
+            timingsText += QString(" (%1)").arg(steps.join(", "));
+        }
+    }
+
+    m_d->ui->lblTimings->setText(timingsText);
+    m_d->ui->lblTimings->setVisible(!timingsText.isEmpty());
 }
 
 void KisToolLazyBrushOptionsWidget::slotCurrentNodeChanged(KisNodeSP node)
@@ -30,11 +30,13 @@
 struct KisCageTransformStrategy::Private
 {
     Private(KisCageTransformStrategy *_q)
-        : q(_q)
+        : q(_q),
+          gridCache(new KisCageTransformWorker::PreparedGridCache())
     {
     }
 
     KisCageTransformStrategy * const q;
+    KisCageTransformWorker::PreparedGridCacheSP gridCache;
 };
 
 
@@ -55,6 +57,11 @@ KisCageTransformStrategy::~KisCageTransformStrategy()
 {
 }
 
+void KisCageTransformStrategy::releaseCachedGrids()
+{
+    m_d->gridCache->clear();
+}
+
 void KisCageTransformStrategy::drawConnectionLines(QPainter &gc,
                                                    const QVector<QPointF> &origPoints,
                                                    const QVector<QPointF> &transfPoints,
@@ -95,6 +102,7 @@ QImage KisCageTransformStrategy::calculateTransformedImage(ToolTransformArgs &cu
                                   origPoints,
                                   0,
                                   16);
+    worker.setPreparedGridCache(m_d->gridCache);
     worker.prepareTransform();
     worker.setTransformedCage(transfPoints);
     return worker.runOnQImage(dstOffset);
@@ -41,6 +41,12 @@ public:
                              TransformTransactionProperties &transaction);
     ~KisCageTransformStrategy() override;
 
+    /**
+     * Drops the grids prepared for the preview of the current
+     * stroke. Should be called when the stroke is finished.
+     */
+    void releaseCachedGrids();
+
 protected:
     void drawConnectionLines(QPainter &gc,
                              const QVector<QPointF> &origPoints,
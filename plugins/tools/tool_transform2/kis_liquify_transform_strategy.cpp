@@ -49,6 +49,7 @@ struct KisLiquifyTransformStrategy::Private
           converter(_converter),
           currentArgs(_currentArgs),
           transaction(_transaction),
+          scaledOriginalImageKey(0),
           helper(_converter),
           recalculateOnNextRedraw(false)
     {
@@ -76,6 +77,15 @@ struct KisLiquifyTransformStrategy::Private
 
     QImage transformedImage;
 
+    /**
+     * The original image scaled into the flake coordinates. It is
+     * kept between the redraws, so that the liquify worker could
+     * recognize the same source and update its preview incrementally.
+     */
+    QImage scaledOriginalImage;
+    qint64 scaledOriginalImageKey;
+    QTransform scaledOriginalTransform;
+
     // size-gesture-related
     QPointF lastMouseWidgetPos;
     QPointF startResizeImagePos;
@@ -277,11 +287,21 @@ void KisLiquifyTransformStrategy::Private::recalculateTransformations()
 
     paintingOffset = transaction.originalTopLeft();
     if (!q->originalImage().isNull()) {
+        QImage srcImage;
+
         if (useFlakeOptimization) {
-            transformedImage = q->originalImage().transformed(resultThumbTransform);
+            if (scaledOriginalImageKey != q->originalImage().cacheKey() ||
+                scaledOriginalTransform != resultThumbTransform) {
+
+                scaledOriginalImage = q->originalImage().transformed(resultThumbTransform);
+                scaledOriginalImageKey = q->originalImage().cacheKey();
+                scaledOriginalTransform = resultThumbTransform;
+            }
+
+            srcImage = scaledOriginalImage;
             paintingTransform = QTransform();
         } else {
-            transformedImage = q->originalImage();
+            srcImage = q->originalImage();
             paintingTransform = resultThumbTransform;
         }
 
@@ -293,8 +313,14 @@ void KisLiquifyTransformStrategy::Private::recalculateTransformations()
         QPointF origTLInFlake =
             imageToRealThumbTransform.map(transaction.originalTopLeft());
 
+        /**
+         * Release the previous preview, so that the worker could
+         * update it in place without copying
+         */
+        transformedImage = QImage();
+
         transformedImage =
-            currentArgs.liquifyWorker()->runOnQImage(transformedImage,
+            currentArgs.liquifyWorker()->runOnQImage(srcImage,
                                                      origTLInFlake,
                                                      imageToRealThumbTransform,
                                                      &paintingOffset);
@@ -984,6 +984,7 @@ void KisToolTransform::endStroke()
     m_strokeData.clear();
     m_changesTracker.reset();
     m_transaction = TransformTransactionProperties(QRectF(), &m_currentArgs, KisNodeSP(), {});
+    m_cageStrategy->releaseCachedGrids();
     outlineChanged();
 }
 
@@ -1017,6 +1018,7 @@ void KisToolTransform::cancelStroke()
         m_strokeData.clear();
         m_changesTracker.reset();
         m_transaction = TransformTransactionProperties(QRectF(), &m_currentArgs, KisNodeSP(), {});
+        m_cageStrategy->releaseCachedGrids();
         outlineChanged();
     }
 }